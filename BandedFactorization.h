@@ -0,0 +1,261 @@
+//
+//  BandedFactorization.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+#import <Accelerate/Accelerate.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class BandedFactorization
+ This class is the banded LU factorization of the system of equations
+ defined by a PoissonStencil. The factorization - the expensive part of
+ the banded solution - only depends on the operator, and not on the
+ fixed potentials or the charges that make up the RHS, so this holds on
+ to it and lets the caller solve for as many RHS vectors as it wants,
+ all at once if it likes, with just the cheap forward and backward
+ substitutions in DGBTRS.
+
+ It also holds on to the stencil it was made from, so that it can tell
+ if a new stencil has the same operator, and this factorization can be
+ used for it as well. When only a few rows of the operator change - as
+ they do when a small object is added or moved - the factorization can
+ be updated to the new operator with a low-rank Sherman-Morrison-Woodbury
+ correction instead of being redone, until the number of changed rows
+ makes refactoring the cheaper of the two.
+
+ When the band won't fit in memory, the factors are kept in a scratch
+ file that's mapped into memory instead, and the operator is factored a
+ line of the grid at a time as a block tridiagonal system - which takes
+ a third of the space of the band - with each block going out to the
+ file as the next one is being done. The solves then bring the blocks
+ back in, one ahead of the one being used, and the bytes going to and
+ from the file are counted up so the user can see what it's costing.
+ */
+@interface BandedFactorization : NSObject {
+	@private
+	PoissonStencil*		_stencil;
+	__CLPK_integer		_n;
+	__CLPK_integer		_kl;
+	__CLPK_integer		_ku;
+	__CLPK_integer		_ldab;
+	BOOL				_rowMajor;
+	__CLPK_doublereal*	_ab;
+	__CLPK_integer*		_ipiv;
+	double*				_blocks;
+	size_t				_blockStride;
+	size_t				_mapLength;
+	unsigned long long	_ioBytes;
+	PoissonStencil*		_target;
+	int					_rank;
+	int*				_updated;
+	double*				_z;
+	__CLPK_doublereal*	_cap;
+	__CLPK_integer*		_capIpiv;
+}
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the stencil that this factorization was made from.
+ */
+- (PoissonStencil*) getStencil;
+
+/*!
+ This method gets the total number of nodes - rows * cols - in the
+ grid, which is also the length of each RHS vector to solve for.
+ */
+- (int) getNodeCount;
+
+/*!
+ This method returns YES if the stencil has exactly the same operator
+ as the one this was made from - or updated to - the same grid, the same fixed nodes
+ and the same coefficients - so that this factorization is good for it,
+ regardless of the RHS it has.
+ */
+- (BOOL) isFactorOf:(PoissonStencil*)stencil;
+
+/*!
+ This method returns the number of rows of the operator that have been
+ changed by -updateTo: since the factorization was made - the rank of
+ the correction that's applied to every solve - or 0 if the original
+ operator is the one being solved.
+ */
+- (int) getUpdateRank;
+
+/*!
+ This method returns the largest rank of correction that -updateTo:
+ will take on before it's cheaper to simply refactor the operator. The
+ correction costs one solve per changed row, and the factorization
+ costs about the band width in solves, so this is a fraction of that.
+ */
+- (int) getMaxUpdateRank;
+
+/*!
+ This method returns YES if the factors are being kept in a scratch
+ file on disk rather than in memory.
+ */
+- (BOOL) isOutOfCore;
+
+/*!
+ This method returns the number of bytes that have been written to, or
+ read from, the scratch file of an out-of-core factorization - by the
+ factorization and all the solves since. It's 0 for one in memory.
+ */
+- (unsigned long long) getIOVolume;
+
+/*!
+ This method returns the number of entries the factors hold - all the
+ diagonals of the band, with the room the pivoting needs, or all the
+ blocks of an out-of-core factorization - which is the fill of the
+ factorization, as the operator itself only has five per node.
+ */
+- (unsigned long long) getFactorNonZeros;
+
+/*!
+ This method returns the number of bytes the factors and the pivots
+ take up - in memory, or for an out-of-core factorization, mostly in
+ the scratch file.
+ */
+- (unsigned long long) getFactorSize;
+
+/*!
+ This method returns how the nodes are numbered in the factorization -
+ a row at a time or a column at a time, whichever makes the band the
+ narrowest - and whether the factors are in memory or out of core.
+ */
+- (NSString*) getOrdering;
+
+//----------------------------------------------------------------------------
+//               Initialization Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method factors the stencil in memory if the band fits in a
+ reasonable part of it, and out of core if it doesn't - or if the
+ memory for it simply can't be had. If the factorization can't be
+ done, this will return nil.
+ */
+- (id) initWithStencil:(PoissonStencil*)stencil;
+
+/*!
+ This is the designated initializer for this class. It assembles the
+ stencil into the banded storage that LAPACK needs, and factors it with
+ DGBTRF. The node numbering is chosen so that the band is as narrow as
+ possible for the grid. If 'outOfCore' is YES - or the band storage
+ can't be allocated - it's factored out of core with -_factorOutOfCore:
+ instead, which only works for the 5-point stencil. If the
+ factorization can't be done, this will return nil.
+ */
+- (id) initWithStencil:(PoissonStencil*)stencil outOfCore:(BOOL)outOfCore;
+
+/*!
+ This method clears out all the storage that this instance is using.
+ It's called in dealloc, but it's also a nice way to clean up early.
+ */
+- (void) freeAllStorage;
+
+/*!
+ This method factors the stencil out of core. Rather than the band, the
+ grid is cut into lines along its long side, each as long as the band
+ is wide, and the block tridiagonal operator is factored one line at a
+ time - each line's dense LU going into its own pages of a scratch file
+ that's mapped into memory. Only the line being factored and the one
+ before it have to be in memory, and as each one is finished, it's
+ written out while the next one is being done. The scratch file is in
+ the temporary directory - $TMPDIR - and it's removed as soon as it's
+ opened, so it goes away with the mapping, however that happens. The
+ pivoting is only within each line, and that's all the diagonally
+ dominant rows of the stencil need. This only works for the 5-point
+ stencil.
+ */
+- (BOOL) _factorOutOfCore:(PoissonStencil*)stencil;
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the factored system for the 'nrhs' RHS vectors in
+ 'b' with one call to DGBTRS, and then applies the low-rank correction
+ if the factorization has been updated. Each vector is a row-major grid
+ of getNodeCount values, and they are one after the other in 'b'. The
+ solutions are placed in 'x' in the same layout, and 'x' can be the same
+ as 'b' if the caller wishes.
+ */
+- (BOOL) solve:(double*)b count:(int)nrhs into:(double*)x;
+
+/*!
+ This method updates the factorization to solve the operator of the
+ stencil, which has to be the same shape as the one this was made from.
+ The rows that differ from the original operator are found, and the
+ solutions for a unit vector on each of them, along with the LU
+ factorization of the small capacitance matrix, are kept for the
+ Sherman-Morrison-Woodbury correction. If there are more changed rows
+ than -getMaxUpdateRank, this returns NO and leaves things as they
+ were, as it's time to refactor.
+ */
+- (BOOL) updateTo:(PoissonStencil*)stencil;
+
+/*!
+ This method drops any update that's been made, and this goes back to
+ solving the operator it was made from.
+ */
+- (void) clearUpdate;
+
+/*!
+ This method solves the factored system for the 'nrhs' RHS vectors in
+ 'b' with one call to DGBTRS, ignoring any update. Each vector is a
+ row-major grid of getNodeCount values, and they are one after the
+ other in 'b'. The solutions are placed in 'x' in the same layout, and
+ 'x' can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveOriginal:(double*)b count:(int)nrhs into:(double*)x;
+
+/*!
+ This method solves the out-of-core factors for the 'nrhs' RHS vectors
+ in 'b', with one sweep forward and one back over the blocks in the
+ scratch file, each one being read in while the one before it is being
+ used. The vectors are in the same layout as for -_solveOriginal:count:
+ into:, and 'x' can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveOutOfCore:(double*)b count:(int)nrhs into:(double*)x;
+
+//----------------------------------------------------------------------------
+//               NSObject Overridden Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called by the runtime when the released object is about
+ to get cleaned up. This gives us an opportunity to clean up all the
+ memory we're using at the time and be a good citizen.
+ */
+- (void) dealloc;
+
+@end
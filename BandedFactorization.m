@@ -0,0 +1,1107 @@
+//
+//  BandedFactorization.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/mount.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "BandedFactorization.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * Each changed row of an update costs one more solve up front, and a
+ * little more work on every solve after that, while the factorization
+ * costs about a sixth of the lower band width in solves. So we take on
+ * updates up to that many rows, but never more than this, as the
+ * solutions for each of them have to be kept around.
+ */
+#define	UPDATE_BAND_DIVISOR		6
+#define	MAX_UPDATE_RANK			128
+
+/*
+ * If the band needs more than this fraction of the physical memory of
+ * the machine, it's just going to page, so we factor it out of core in
+ * a scratch file instead.
+ */
+#define	MAX_MEMORY_FRACTION		0.5
+
+// Public Macros
+#define	MEGABYTES(b)			((double)(b) / (1024.0 * 1024.0))
+
+
+/*
+ * The out-of-core factorization cuts the grid into lines along its
+ * long side - rows if it's taller than it is wide, columns otherwise -
+ * so that each line is a block of 'm' nodes, as many as the band is
+ * wide, coupled only to the lines on either side of it. These give the
+ * grid node of node 'k' of line 'i', the dense diagonal block of the
+ * operator for line 'i' - column-major, 'm' square - and the couplings
+ * of each node of it to the previous and next lines, which are just
+ * diagonal for the 5-point stencil.
+ */
+static size_t blockNode(const StencilArrays* a, BOOL rowMajor, int i, int k)
+{
+	return (rowMajor ? ((size_t)i * a->cols + k) : ((size_t)k * a->cols + i));
+}
+
+
+static void fillDiagonalBlock(const StencilArrays* a, BOOL rowMajor, int i, int m, double* d)
+{
+	const double*	prev = (rowMajor ? a->left : a->top);
+	const double*	next = (rowMajor ? a->right : a->bottom);
+	memset(d, 0, (size_t)m * m * sizeof(double));
+	for (int k = 0; k < m; k++) {
+		size_t		ij = blockNode(a, rowMajor, i, k);
+		d[(size_t)k*m + k] = a->center[ij];
+		if (k > 0) {
+			d[(size_t)(k - 1)*m + k] = prev[ij];
+		}
+		if (k < (m - 1)) {
+			d[(size_t)(k + 1)*m + k] = next[ij];
+		}
+	}
+}
+
+
+static void blockCouplings(const StencilArrays* a, BOOL rowMajor, int i, int m, double* lo, double* up)
+{
+	for (int k = 0; k < m; k++) {
+		size_t		ij = blockNode(a, rowMajor, i, k);
+		lo[k] = (rowMajor ? a->top[ij] : a->left[ij]);
+		up[k] = (rowMajor ? a->bottom[ij] : a->right[ij]);
+	}
+}
+
+
+/*
+ * These tell the kernel what we're about to do with block 'i' of the
+ * scratch file - that we'll be reading it soon, so it can start bringing
+ * it in while we work on the one before it, and that we're done writing
+ * it, so it can start writing it out while we work on the next one.
+ * Each block starts on a page, so these line up as they need to.
+ */
+static void prefetchBlock(double* blocks, size_t stride, int i, int count)
+{
+	if ((i >= 0) && (i < count)) {
+		madvise(blocks + (size_t)i * stride, stride * sizeof(double), MADV_WILLNEED);
+	}
+}
+
+
+static void writeBehindBlock(double* blocks, size_t stride, int i, int count)
+{
+	if ((i >= 0) && (i < count)) {
+		msync(blocks + (size_t)i * stride, stride * sizeof(double), MS_ASYNC);
+	}
+}
+
+
+/*
+ * This is the block LU factorization of the block tridiagonal operator,
+ * one line of the grid at a time:
+ *
+ *     D'(i) = D(i) - L(i) inv(D'(i-1)) U(i-1)
+ *
+ * where L(i) and U(i-1) are the diagonal couplings between the lines,
+ * and each D'(i) is factored with DGETRF - pivoting within the line -
+ * into its place in 'blocks', 'stride' doubles apart. Only the last
+ * block is needed to make the next one, so that's all that has to be
+ * in memory at any one time. This returns the DGETRF 'info' of the
+ * first block that fails, offset to the node, or -1 if the working
+ * storage can't be had.
+ */
+static __CLPK_integer factorBlocks(const StencilArrays* a, BOOL rowMajor, int m, int count, size_t stride, double* blocks, __CLPK_integer* ipiv)
+{
+	__CLPK_integer		info = 0;
+	__CLPK_integer		nn = m;
+	double*				w = (double *) calloc((size_t)m * m, sizeof(double));
+	double*				lo = (double *) calloc(m, sizeof(double));
+	double*				up = (double *) calloc(m, sizeof(double));
+	double*				upPrev = (double *) calloc(m, sizeof(double));
+	if ((w == NULL) || (lo == NULL) || (up == NULL) || (upPrev == NULL)) {
+		info = -1;
+	}
+
+	for (int i = 0; (info == 0) && (i < count); i++) {
+		double*		d = blocks + (size_t)i * stride;
+		fillDiagonalBlock(a, rowMajor, i, m, d);
+		blockCouplings(a, rowMajor, i, m, lo, up);
+		if (i > 0) {
+			// W = inv(D'(i-1)) U(i-1), and then D(i) -= L(i) W
+			char		trans = 'N';
+			memset(w, 0, (size_t)m * m * sizeof(double));
+			for (int k = 0; k < m; k++) {
+				w[(size_t)k*m + k] = upPrev[k];
+			}
+			dgetrs_(&trans, &nn, &nn, d - stride, &nn, ipiv + (size_t)(i - 1) * m, w, &nn, &info);
+			for (int c = 0; (info == 0) && (c < m); c++) {
+				for (int k = 0; k < m; k++) {
+					d[(size_t)c*m + k] -= lo[k] * w[(size_t)c*m + k];
+				}
+			}
+			// the block before this one is done for good
+			writeBehindBlock(blocks, stride, i - 1, count);
+		}
+		if (info == 0) {
+			dgetrf_(&nn, &nn, d, &nn, ipiv + (size_t)i * m, &info);
+			if (info > 0) {
+				info += i * m;
+			}
+		}
+		memcpy(upPrev, up, m * sizeof(double));
+	}
+	writeBehindBlock(blocks, stride, count - 1, count);
+
+	if (w != NULL) {
+		free(w);
+	}
+	if (lo != NULL) {
+		free(lo);
+	}
+	if (up != NULL) {
+		free(up);
+	}
+	if (upPrev != NULL) {
+		free(upPrev);
+	}
+	return info;
+}
+
+
+/*
+ * This solves the block factored system for the 'nrhs' row-major RHS
+ * vectors in 'b', placing the solutions in 'x' - which can be 'b'. The
+ * forward sweep leaves z(i) = b(i) - L(i) inv(D'(i-1)) z(i-1) in 'x',
+ * and the backward sweep replaces it with:
+ *
+ *     x(i) = inv(D'(i)) (z(i) - U(i) x(i+1))
+ *
+ * so each block is read once going forward and once coming back, with
+ * the next one being brought in while the current one is used. This
+ * returns NO if the working storage can't be had.
+ */
+static BOOL solveBlocks(const StencilArrays* a, BOOL rowMajor, int m, int count, size_t stride, double* blocks, __CLPK_integer* ipiv, const double* b, int nrhs, double* x)
+{
+	BOOL				ok = YES;
+	size_t				n = (size_t)m * count;
+	char				trans = 'N';
+	__CLPK_integer		nn = m;
+	__CLPK_integer		cnt = nrhs;
+	__CLPK_integer		info = 0;
+	double*				z = (double *) calloc((size_t)m * nrhs, sizeof(double));
+	double*				y = (double *) calloc((size_t)m * nrhs, sizeof(double));
+	double*				lo = (double *) calloc(m, sizeof(double));
+	double*				up = (double *) calloc(m, sizeof(double));
+	if ((z == NULL) || (y == NULL) || (lo == NULL) || (up == NULL)) {
+		ok = NO;
+	}
+
+	// forward: z(i) into 'x', and y(i) = inv(D'(i)) z(i) for the next line
+	for (int i = 0; ok && (i < count); i++) {
+		prefetchBlock(blocks, stride, i + 1, count);
+		blockCouplings(a, rowMajor, i, m, lo, up);
+		for (int j = 0; j < nrhs; j++) {
+			for (int k = 0; k < m; k++) {
+				size_t		ij = (size_t)j * n + blockNode(a, rowMajor, i, k);
+				double		v = b[ij];
+				if (i > 0) {
+					v -= lo[k] * y[(size_t)j*m + k];
+				}
+				z[(size_t)j*m + k] = v;
+				x[ij] = v;
+			}
+		}
+		memcpy(y, z, (size_t)m * nrhs * sizeof(double));
+		dgetrs_(&trans, &nn, &cnt, blocks + (size_t)i * stride, &nn, ipiv + (size_t)i * m, y, &nn, &info);
+	}
+
+	// backward: x(i) from z(i) and the x(i+1) that's left in 'y'
+	for (int i = count - 1; ok && (i >= 0); i--) {
+		prefetchBlock(blocks, stride, i - 1, count);
+		blockCouplings(a, rowMajor, i, m, lo, up);
+		for (int j = 0; j < nrhs; j++) {
+			for (int k = 0; k < m; k++) {
+				double		v = x[(size_t)j * n + blockNode(a, rowMajor, i, k)];
+				if (i < (count - 1)) {
+					v -= up[k] * y[(size_t)j*m + k];
+				}
+				z[(size_t)j*m + k] = v;
+			}
+		}
+		dgetrs_(&trans, &nn, &cnt, blocks + (size_t)i * stride, &nn, ipiv + (size_t)i * m, z, &nn, &info);
+		for (int j = 0; j < nrhs; j++) {
+			for (int k = 0; k < m; k++) {
+				x[(size_t)j * n + blockNode(a, rowMajor, i, k)] = z[(size_t)j*m + k];
+			}
+		}
+		memcpy(y, z, (size_t)m * nrhs * sizeof(double));
+	}
+
+	if (z != NULL) {
+		free(z);
+	}
+	if (y != NULL) {
+		free(y);
+	}
+	if (lo != NULL) {
+		free(lo);
+	}
+	if (up != NULL) {
+		free(up);
+	}
+	return ok;
+}
+
+
+/*!
+ @class BandedFactorization
+ This class is the banded LU factorization of the system of equations
+ defined by a PoissonStencil. The factorization - the expensive part of
+ the banded solution - only depends on the operator, and not on the
+ fixed potentials or the charges that make up the RHS, so this holds on
+ to it and lets the caller solve for as many RHS vectors as it wants,
+ all at once if it likes, with just the cheap forward and backward
+ substitutions in DGBTRS.
+
+ It also holds on to the stencil it was made from, so that it can tell
+ if a new stencil has the same operator, and this factorization can be
+ used for it as well. When only a few rows of the operator change - as
+ they do when a small object is added or moved - the factorization can
+ be updated to the new operator with a low-rank Sherman-Morrison-Woodbury
+ correction instead of being redone, until the number of changed rows
+ makes refactoring the cheaper of the two.
+ */
+@implementation BandedFactorization
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the stencil that this factorization was made from.
+ */
+- (PoissonStencil*) getStencil
+{
+	return _stencil;
+}
+
+
+/*!
+ This method gets the total number of nodes - rows * cols - in the
+ grid, which is also the length of each RHS vector to solve for.
+ */
+- (int) getNodeCount
+{
+	return _n;
+}
+
+
+/*!
+ This method returns YES if the stencil has exactly the same operator
+ as the one this was made from - or updated to - the same grid, the same fixed nodes
+ and the same coefficients - so that this factorization is good for it,
+ regardless of the RHS it has.
+ */
+- (BOOL) isFactorOf:(PoissonStencil*)stencil
+{
+	PoissonStencil*		op = (_target != nil ? _target : _stencil);
+	return (stencil == op) || [op hasSameOperatorAs:stencil];
+}
+
+
+/*!
+ This method returns the number of rows of the operator that have been
+ changed by -updateTo: since the factorization was made - the rank of
+ the correction that's applied to every solve - or 0 if the original
+ operator is the one being solved.
+ */
+- (int) getUpdateRank
+{
+	return _rank;
+}
+
+
+/*!
+ This method returns the largest rank of correction that -updateTo:
+ will take on before it's cheaper to simply refactor the operator. The
+ correction costs one solve per changed row, and the factorization
+ costs about the band width in solves, so this is a fraction of that.
+ */
+- (int) getMaxUpdateRank
+{
+	return MIN(MAX(_kl / UPDATE_BAND_DIVISOR, 1), MAX_UPDATE_RANK);
+}
+
+
+/*!
+ This method returns YES if the factors are being kept in a scratch
+ file on disk rather than in memory.
+ */
+- (BOOL) isOutOfCore
+{
+	return (_blocks != NULL);
+}
+
+
+/*!
+ This method returns the number of bytes that have been written to, or
+ read from, the scratch file of an out-of-core factorization - by the
+ factorization and all the solves since. It's 0 for one in memory.
+ */
+- (unsigned long long) getIOVolume
+{
+	return _ioBytes;
+}
+
+
+/*!
+ This method returns the number of entries the factors hold - all the
+ diagonals of the band, with the room the pivoting needs, or all the
+ blocks of an out-of-core factorization - which is the fill of the
+ factorization, as the operator itself only has five per node.
+ */
+- (unsigned long long) getFactorNonZeros
+{
+	unsigned long long	retval = (unsigned long long)_ldab * _n;
+	if (_blocks != NULL) {
+		retval = (unsigned long long)_kl * _kl * (_n / MAX(_kl, 1));
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the number of bytes the factors and the pivots
+ take up - in memory, or for an out-of-core factorization, mostly in
+ the scratch file.
+ */
+- (unsigned long long) getFactorSize
+{
+	unsigned long long	retval = (unsigned long long)_n * sizeof(__CLPK_integer);
+	if (_blocks != NULL) {
+		retval += _mapLength;
+	} else {
+		retval += (unsigned long long)_ldab * _n * sizeof(__CLPK_doublereal);
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns how the nodes are numbered in the factorization -
+ a row at a time or a column at a time, whichever makes the band the
+ narrowest - and whether the factors are in memory or out of core.
+ */
+- (NSString*) getOrdering
+{
+	return [NSString stringWithFormat:@"%@, band of %d%@", (_rowMajor ? @"row-major" : @"column-major"), _kl, ([self isOutOfCore] ? @", out of core" : @"")];
+}
+
+
+//----------------------------------------------------------------------------
+//               Initialization Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method factors the stencil in memory if the band fits in a
+ reasonable part of it, and out of core if it doesn't - or if the
+ memory for it simply can't be had. If the factorization can't be
+ done, this will return nil.
+ */
+- (id) initWithStencil:(PoissonStencil*)stencil
+{
+	BOOL			outOfCore = NO;
+
+	if ((stencil != nil) && ![stencil hasCorners]) {
+		double		kl = MIN([stencil getRowCount], [stencil getColCount]);
+		double		bandSize = (3*kl + 1) * [stencil getNodeCount] * sizeof(__CLPK_doublereal);
+		outOfCore = (bandSize > MAX_MEMORY_FRACTION * [[NSProcessInfo processInfo] physicalMemory]);
+	}
+	return [self initWithStencil:stencil outOfCore:outOfCore];
+}
+
+
+/*!
+ This is the designated initializer for this class. It assembles the
+ stencil into the banded storage that LAPACK needs, and factors it with
+ DGBTRF. The node numbering is chosen so that the band is as narrow as
+ possible for the grid. If 'outOfCore' is YES - or the band storage
+ can't be allocated - it's factored out of core with -_factorOutOfCore:
+ instead, which only works for the 5-point stencil. If the
+ factorization can't be done, this will return nil.
+ */
+- (id) initWithStencil:(PoissonStencil*)stencil outOfCore:(BOOL)outOfCore
+{
+	BOOL			error = NO;
+	BOOL			allDone = NO;
+
+	// first, let's check the arguments for reasonable values
+	if (!error) {
+		if (stencil == nil) {
+			error = YES;
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - the stencil is missing, and that means there's nothing I can do. Please make sure the argument to this method is not nil.");
+		}
+	}
+
+	// next, let's make sure the super can be initialized
+	if (!error) {
+		if (!(self = [super init])) {
+			error = YES;
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - the superclass could not complete it's -init method. Please check the logs for a possible cause.");
+		}
+	}
+
+	// see if this one is going to the scratch file
+	if (!error && !allDone && outOfCore && ![stencil hasCorners]) {
+		error = ![self _factorOutOfCore:stencil];
+		allDone = YES;
+	}
+
+	/*
+	 * Next, determine storage format and allocate space for the factors.
+	 * For a more complete description of the arguments and what they are,
+	 * how big they need to be, etc. please see the docs on DGBTRF in LAPACK.
+	 */
+	int				rows = [stencil getRowCount];
+	int				cols = [stencil getColCount];
+	BOOL			corners = [stencil hasCorners];
+	if (!error && !allDone) {
+		[self freeAllStorage];
+		_n = rows * cols;
+		_kl = MIN(rows, cols) + (corners ? 1 : 0);
+		_ku = _kl;
+		_ldab = 2*_kl + _ku + 1;
+		_rowMajor = (cols <= rows);
+		_ab = (__CLPK_doublereal *) calloc( (size_t)_ldab*_n, sizeof(__CLPK_doublereal) );
+		_ipiv = (__CLPK_integer *) calloc( _n, sizeof(__CLPK_integer) );
+		if (((_ab == NULL) || (_ipiv == NULL)) && !corners) {
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - the banded A matrix storage (%dx%d) for the factorization is more than we can allocate, so we'll do it out of core.", _ldab, _n);
+			error = ![self _factorOutOfCore:stencil];
+			allDone = YES;
+		} else if ((_ab == NULL) || (_ipiv == NULL)) {
+			error = YES;
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - while trying to allocate the banded A matrix storage (%dx%d) for the factorization, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", _ldab, _n);
+		}
+	}
+
+	/*
+	 * Now we can populate the matrix with the equations to solve. We
+	 * do this by going through all the nodes and placing the stencil for
+	 * that node into the cLAPACK matrix ab[] based on the location of
+	 * each node.
+	 *
+	 * Because cLAPACK uses banded storage and a vector as opposed to a
+	 * two-dimensional array of numbers, we need to be able to convert
+	 * the matrix notation into the actual values placed in the banded
+	 * storage. Here's how it goes:
+	 *
+	 * The banded storage format is given as:
+	 *     ab(kl+ku+1+i-j, j) = a(i, j)
+	 * where i, j are constrained to be in the banded storage "coverage"
+	 * and are both in the range (1,n), i.e. FORTRAN-style. To convert
+	 * this to C-style arrays:
+	 *     ab[kl+ku+i-j][j] = a[i][j]
+	 * where now i and j run from 0..(n-1). The important difference is
+	 * in the loss of the "+1" for the limiting case of kl=ku=0 needs to
+	 * map to row=0 not row=1. The conversion to the row-major storage is,
+	 * in general, accomplished with:
+	 *     ab[col*ldab + row] = ab[row][col]
+	 * for a given row and column, where again, row and col are in the range
+	 * (0,n-1). Therefore, to map a general FORTRAN-style i,j from
+	 * A into the banded storage is:
+	 *     ab[j*ldab + kl+ku+i-j] = a(i, j)
+	 * with the addition of a simple variable for speed:
+	 *     ab[j*ldab + klpku + i-j] = a(i, j)
+	 * and that's what we're implementing. The RHS is handled at solve time.
+	 *
+	 * The mirror conditions at the edges of the grid and the identity
+	 * rows of the fixed nodes are already in the stencil, so all we have
+	 * to do is to place the non-zero coefficients. The coarse grids of
+	 * the multigrid solver have corner coefficients as well, and they
+	 * reach one node further, which is why the band is one wider.
+	 */
+	if (!error && !allDone) {
+		StencilArrays*	a = [stencil getArrays];
+		__CLPK_integer	ldab = _ldab;
+		__CLPK_integer	klpku = _kl + _ku;
+		BOOL			rowMajor = _rowMajor;
+		__CLPK_doublereal*	ab = _ab;
+		// these will be the node numbers in the simulation
+		size_t			ij = 0;
+		__CLPK_integer	ijn = 0;
+		__CLPK_integer	nn = 0;
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				ij = (size_t)row * cols + col;
+				/*
+				 * We need to convert the row and col into a node number based
+				 * on the most efficient banding possible.
+				 */
+				ijn = (rowMajor ? (row * cols + col) : (col * rows + row));
+				// first, do the 'ij' node
+				ab[(size_t)ijn*ldab + klpku] = a->center[ij];
+				// next, do the 'top' node
+				if (a->top[ij] != 0.0) {
+					nn = (rowMajor ? (ijn - cols) : (ijn - 1));
+					ab[(size_t)nn*ldab + klpku + ijn-nn] += a->top[ij];
+				}
+				// next, do the 'bottom' node
+				if (a->bottom[ij] != 0.0) {
+					nn = (rowMajor ? (ijn + cols) : (ijn + 1));
+					ab[(size_t)nn*ldab + klpku + ijn-nn] += a->bottom[ij];
+				}
+				// next, do the 'left' node
+				if (a->left[ij] != 0.0) {
+					nn = (rowMajor ? (ijn - 1) : (ijn - rows));
+					ab[(size_t)nn*ldab + klpku + ijn-nn] += a->left[ij];
+				}
+				// next, do the 'right' node
+				if (a->right[ij] != 0.0) {
+					nn = (rowMajor ? (ijn + 1) : (ijn + rows));
+					ab[(size_t)nn*ldab + klpku + ijn-nn] += a->right[ij];
+				}
+				// finally, do the corners if we have them
+				if (corners) {
+					if (a->topLeft[ij] != 0.0) {
+						nn = (rowMajor ? (ijn - cols - 1) : (ijn - rows - 1));
+						ab[(size_t)nn*ldab + klpku + ijn-nn] += a->topLeft[ij];
+					}
+					if (a->topRight[ij] != 0.0) {
+						nn = (rowMajor ? (ijn - cols + 1) : (ijn + rows - 1));
+						ab[(size_t)nn*ldab + klpku + ijn-nn] += a->topRight[ij];
+					}
+					if (a->bottomLeft[ij] != 0.0) {
+						nn = (rowMajor ? (ijn + cols - 1) : (ijn - rows + 1));
+						ab[(size_t)nn*ldab + klpku + ijn-nn] += a->bottomLeft[ij];
+					}
+					if (a->bottomRight[ij] != 0.0) {
+						nn = (rowMajor ? (ijn + cols + 1) : (ijn + rows + 1));
+						ab[(size_t)nn*ldab + klpku + ijn-nn] += a->bottomRight[ij];
+					}
+				}
+			}
+		}
+	}
+
+	// finally, we can factor the matrix using dgbtrf_ in cLAPACK
+	if (!error && !allDone) {
+		__CLPK_integer	info = 0;
+		dgbtrf_(&_n, &_n, &_kl, &_ku, _ab, &_ldab, _ipiv, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - argument #%d had an illegal value to DGBTRF in LAPACK. Please check into this.", -1*info);
+		} else if (info > 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -initWithStencil:outOfCore:] - diagonal #%d is zero indicating singularity which shouldn't happen.", info);
+		}
+	}
+
+	// ...and hold on to the stencil so we can check the operator later
+	if (!error) {
+		_stencil = [stencil retain];
+	} else {
+		[self freeAllStorage];
+	}
+
+	return error ? nil : self;
+}
+
+
+/*!
+ This method clears out all the storage that this instance is using.
+ It's called in dealloc, but it's also a nice way to clean up early.
+ */
+- (void) freeAllStorage
+{
+	[self clearUpdate];
+	if (_ab != NULL) {
+		free(_ab);
+		_ab = NULL;
+	}
+	if (_ipiv != NULL) {
+		free(_ipiv);
+		_ipiv = NULL;
+	}
+	if (_blocks != NULL) {
+		munmap(_blocks, _mapLength);
+		_blocks = NULL;
+		_mapLength = 0;
+	}
+	_ioBytes = 0;
+	[_stencil release];
+	_stencil = nil;
+}
+
+
+/*!
+ This method factors the stencil out of core. Rather than the band, the
+ grid is cut into lines along its long side, each as long as the band
+ is wide, and the block tridiagonal operator is factored one line at a
+ time - each line's dense LU going into its own pages of a scratch file
+ that's mapped into memory. Only the line being factored and the one
+ before it have to be in memory, and as each one is finished, it's
+ written out while the next one is being done. The scratch file is in
+ the temporary directory - $TMPDIR - and it's removed as soon as it's
+ opened, so it goes away with the mapping, however that happens. The
+ pivoting is only within each line, and that's all the diagonally
+ dominant rows of the stencil need. This only works for the 5-point
+ stencil.
+ */
+- (BOOL) _factorOutOfCore:(PoissonStencil*)stencil
+{
+	BOOL			error = NO;
+	int				rows = [stencil getRowCount];
+	int				cols = [stencil getColCount];
+	int				fd = -1;
+
+	// first, see how big it all is
+	if (!error) {
+		[self freeAllStorage];
+		_n = rows * cols;
+		_kl = MIN(rows, cols);
+		_ku = _kl;
+		_ldab = 2*_kl + _ku + 1;
+		_rowMajor = (cols <= rows);
+		size_t		page = (size_t)getpagesize();
+		_blockStride = (((size_t)_kl * _kl * sizeof(double) + page - 1) / page) * page / sizeof(double);
+		_mapLength = _blockStride * MAX(rows, cols) * sizeof(double);
+		_ipiv = (__CLPK_integer *) calloc( _n, sizeof(__CLPK_integer) );
+		if (_ipiv == NULL) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - while trying to allocate the pivots (%dx1) for the factorization, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", _n);
+		}
+	}
+
+	// next, get the scratch file, and make sure there's room for it
+	if (!error) {
+		NSString*	path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"Potentials.XXXXXX"];
+		char*		name = strdup([path fileSystemRepresentation]);
+		struct statfs	fs;
+		fd = (name == NULL ? -1 : mkstemp(name));
+		if (fd < 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - the scratch file '%@' could not be created. Please make sure $TMPDIR is somewhere we can write.", path);
+		} else {
+			unlink(name);
+			if ((fstatfs(fd, &fs) == 0) && (((unsigned long long)fs.f_bavail * fs.f_bsize) < _mapLength)) {
+				error = YES;
+				NSLog(@"[BandedFactorization -_factorOutOfCore:] - the scratch file needs %.1f MB, but there's only %.1f MB free where it is. Please point $TMPDIR at a bigger disk.", MEGABYTES(_mapLength), MEGABYTES((unsigned long long)fs.f_bavail * fs.f_bsize));
+			} else if (ftruncate(fd, (off_t)_mapLength) != 0) {
+				error = YES;
+				NSLog(@"[BandedFactorization -_factorOutOfCore:] - the scratch file could not be made %.1f MB long. Please check into this as soon as possible.", MEGABYTES(_mapLength));
+			}
+		}
+		if (name != NULL) {
+			free(name);
+		}
+	}
+
+	// map it into memory...
+	if (!error) {
+		void*		map = mmap(NULL, _mapLength, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - the %.1f MB scratch file could not be mapped into memory. Please check into this as soon as possible.", MEGABYTES(_mapLength));
+		} else {
+			_blocks = (double *) map;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	// ...and factor it, one line of the grid at a time
+	if (!error) {
+		__CLPK_integer	info = factorBlocks([stencil getArrays], _rowMajor, _kl, MAX(rows, cols), _blockStride, _blocks, _ipiv);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - while trying to allocate the working storage for a %dx%d block, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", _kl, _kl);
+		} else if (info > 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - diagonal #%d is zero indicating singularity which shouldn't happen.", info);
+		} else {
+			_ioBytes += (unsigned long long)_kl * _kl * MAX(rows, cols) * sizeof(double);
+			NSLog(@"[BandedFactorization -_factorOutOfCore:] - the %dx%d system was factored out of core in %d blocks of %d nodes, writing %.1f MB to the scratch file", rows, cols, MAX(rows, cols), _kl, MEGABYTES(_ioBytes));
+		}
+	}
+
+	// in the end, we don't leave a broken factorization behind
+	if (error) {
+		[self freeAllStorage];
+	}
+
+	return !error;
+}
+
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the factored system for the 'nrhs' RHS vectors in
+ 'b' with one call to DGBTRS, and then applies the low-rank correction
+ if the factorization has been updated. Each vector is a row-major grid
+ of getNodeCount values, and they are one after the other in 'b'. The
+ solutions are placed in 'x' in the same layout, and 'x' can be the same
+ as 'b' if the caller wishes.
+ */
+- (BOOL) solve:(double*)b count:(int)nrhs into:(double*)x
+{
+	BOOL				error = NO;
+	BOOL				allDone = NO;
+	__CLPK_integer		k = _rank;
+	__CLPK_integer		cnt = nrhs;
+	__CLPK_doublereal*	w = NULL;
+
+	// without an update, this is just the original solve
+	if (!error && !allDone && (k == 0)) {
+		error = ![self _solveOriginal:b count:nrhs into:x];
+		allDone = YES;
+	}
+
+	/*
+	 * The updated operator is A = A0 + U V', where U picks out the changed
+	 * rows and V' is the change in each. With y = inv(A0) b, the solution
+	 * is then:
+	 *
+	 *     x = y - Z inv(C) V' y
+	 *
+	 * where Z = inv(A0) U and C = I + V' Z are what -updateTo: kept. Since
+	 * A0 y = b, V' y is just the new row times y less b on that row, so we
+	 * need to grab those values of b before 'x' overwrites them.
+	 */
+	if (!error && !allDone) {
+		w = (__CLPK_doublereal *) calloc( (size_t)k*nrhs, sizeof(__CLPK_doublereal) );
+		if (w == NULL) {
+			error = YES;
+			NSLog(@"[BandedFactorization -solve:count:into:] - while trying to allocate the correction storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", k, nrhs);
+		} else {
+			for (int j = 0; j < nrhs; j++) {
+				for (int a = 0; a < k; a++) {
+					w[(size_t)j*k + a] = -b[(size_t)j*_n + _updated[a]];
+				}
+			}
+		}
+	}
+
+	// solve the original system...
+	if (!error && !allDone) {
+		error = ![self _solveOriginal:b count:nrhs into:x];
+	}
+
+	// ...and correct it for the rows that have changed
+	if (!error && !allDone) {
+		for (int j = 0; j < nrhs; j++) {
+			double*		xj = x + (size_t)j*_n;
+			for (int a = 0; a < k; a++) {
+				w[(size_t)j*k + a] += [_target multiplyRow:_updated[a] by:xj];
+			}
+		}
+		char			trans = 'N';
+		__CLPK_integer	info = 0;
+		dgetrs_(&trans, &k, &cnt, _cap, &k, _capIpiv, w, &k, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -solve:count:into:] - argument #%d had an illegal value to DGETRS in LAPACK. Please check into this.", -1*info);
+		} else {
+			cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, _n, nrhs, k, -1.0, _z, _n, w, k, 1.0, x, _n);
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (w != NULL) {
+		free(w);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method updates the factorization to solve the operator of the
+ stencil, which has to be the same shape as the one this was made from.
+ The rows that differ from the original operator are found, and the
+ solutions for a unit vector on each of them, along with the LU
+ factorization of the small capacitance matrix, are kept for the
+ Sherman-Morrison-Woodbury correction. If there are more changed rows
+ than -getMaxUpdateRank, this returns NO and leaves things as they
+ were, as it's time to refactor.
+ */
+- (BOOL) updateTo:(PoissonStencil*)stencil
+{
+	BOOL				error = NO;
+	BOOL				allDone = NO;
+	int					maxRank = [self getMaxUpdateRank];
+	int*				updated = NULL;
+	__CLPK_integer		k = 0;
+	double*				z = NULL;
+	__CLPK_doublereal*	cap = NULL;
+	__CLPK_integer*		capIpiv = NULL;
+
+	// first, make sure we have something to do
+	if (!error && !allDone) {
+		if ((stencil == nil) || ((_ab == NULL) && (_blocks == NULL))) {
+			error = YES;
+			NSLog(@"[BandedFactorization -updateTo:] - the stencil is missing, or there is no factorization, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// next, find the rows of the operator that have changed
+	if (!error && !allDone) {
+		updated = (int *) calloc(maxRank, sizeof(int));
+		if (updated == NULL) {
+			error = YES;
+			NSLog(@"[BandedFactorization -updateTo:] - while trying to allocate the list of changed rows (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", maxRank);
+		} else {
+			k = [_stencil getRowsDifferingFrom:stencil into:updated max:maxRank];
+			if (k < 0) {
+				// not an error, really, it's just time to refactor
+				error = YES;
+			}
+		}
+	}
+
+	// if it's the original operator, then there's nothing to correct
+	if (!error && !allDone && (k == 0)) {
+		[self clearUpdate];
+		allDone = YES;
+	}
+
+	// get Z = inv(A0) U - the solution for a unit vector on each changed row
+	if (!error && !allDone) {
+		z = (double *) calloc((size_t)_n * k, sizeof(double));
+		cap = (__CLPK_doublereal *) calloc( (size_t)k*k, sizeof(__CLPK_doublereal) );
+		capIpiv = (__CLPK_integer *) calloc( k, sizeof(__CLPK_integer) );
+		if ((z == NULL) || (cap == NULL) || (capIpiv == NULL)) {
+			error = YES;
+			NSLog(@"[BandedFactorization -updateTo:] - while trying to allocate the storage for a rank %d update, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", k);
+		} else {
+			for (int a = 0; a < k; a++) {
+				z[(size_t)a*_n + updated[a]] = 1.0;
+			}
+			error = ![self _solveOriginal:z count:k into:z];
+		}
+	}
+
+	/*
+	 * The capacitance matrix is C = I + V' Z, but since A0 Z = U, that's
+	 * simply the changed rows of the new operator times Z, and that's what
+	 * we factor for the corrections.
+	 */
+	if (!error && !allDone) {
+		for (int c = 0; c < k; c++) {
+			for (int a = 0; a < k; a++) {
+				cap[(size_t)c*k + a] = [stencil multiplyRow:updated[a] by:(z + (size_t)c*_n)];
+			}
+		}
+		__CLPK_integer	info = 0;
+		dgetrf_(&k, &k, cap, &k, capIpiv, &info);
+		if (info != 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -updateTo:] - the %dx%d capacitance matrix could not be factored (info=%d), so the update can't be done. The factorization will have to be redone.", k, k, info);
+		}
+	}
+
+	// if it's all good, then we can replace the update we had
+	if (!error && !allDone) {
+		[self clearUpdate];
+		_target = [stencil retain];
+		_rank = k;
+		_updated = updated;
+		_z = z;
+		_cap = cap;
+		_capIpiv = capIpiv;
+	} else {
+		// in the end, we can release what it is that we don't need
+		if (updated != NULL) {
+			free(updated);
+		}
+		if (z != NULL) {
+			free(z);
+		}
+		if (cap != NULL) {
+			free(cap);
+		}
+		if (capIpiv != NULL) {
+			free(capIpiv);
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method drops any update that's been made, and this goes back to
+ solving the operator it was made from.
+ */
+- (void) clearUpdate
+{
+	if (_updated != NULL) {
+		free(_updated);
+		_updated = NULL;
+	}
+	if (_z != NULL) {
+		free(_z);
+		_z = NULL;
+	}
+	if (_cap != NULL) {
+		free(_cap);
+		_cap = NULL;
+	}
+	if (_capIpiv != NULL) {
+		free(_capIpiv);
+		_capIpiv = NULL;
+	}
+	[_target release];
+	_target = nil;
+	_rank = 0;
+}
+
+
+/*!
+ This method solves the factored system for the 'nrhs' RHS vectors in
+ 'b' with one call to DGBTRS, ignoring any update. Each vector is a
+ row-major grid of getNodeCount values, and they are one after the
+ other in 'b'. The solutions are placed in 'x' in the same layout, and
+ 'x' can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveOriginal:(double*)b count:(int)nrhs into:(double*)x
+{
+	BOOL			error = NO;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((b == NULL) || (x == NULL) || (nrhs <= 0) || ((_ab == NULL) && (_blocks == NULL))) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_solveOriginal:count:into:] - the RHS or solution vectors are missing, there are no RHS vectors (%d), or there is no factorization, and that means there's nothing I can do. Please make sure the arguments to this method are reasonable.", nrhs);
+		}
+	}
+
+	// the out of core factors are solved a block at a time
+	if (!error && (_blocks != NULL)) {
+		return [self _solveOutOfCore:b count:nrhs into:x];
+	}
+
+	/*
+	 * The RHS matrix is column-major, one column per RHS vector, in the
+	 * banded node numbering, so we need our own copy of it.
+	 */
+	int					rows = [_stencil getRowCount];
+	int					cols = [_stencil getColCount];
+	__CLPK_integer		ldb = _n;
+	__CLPK_integer		cnt = nrhs;
+	__CLPK_doublereal	*bb = NULL;
+	if (!error) {
+		bb = (__CLPK_doublereal *) calloc( (size_t)ldb*nrhs, sizeof(__CLPK_doublereal) );
+		if (bb == NULL) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_solveOriginal:count:into:] - while trying to allocate the RHS b matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldb, nrhs);
+		} else {
+			for (int k = 0; k < nrhs; k++) {
+				size_t		o = (size_t)k * _n;
+				for (int row = 0; row < rows; row++) {
+					for (int col = 0; col < cols; col++) {
+						bb[o + (_rowMajor ? (row * cols + col) : (col * rows + row))] = b[o + (size_t)row * cols + col];
+					}
+				}
+			}
+		}
+	}
+
+	// now we can solve the factored system with dgbtrs_ in cLAPACK
+	if (!error) {
+		char			trans = 'N';
+		__CLPK_integer	info = 0;
+		dgbtrs_(&trans, &_n, &_kl, &_ku, &cnt, _ab, &_ldab, _ipiv, bb, &ldb, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[BandedFactorization -_solveOriginal:count:into:] - argument #%d had an illegal value to DGBTRS in LAPACK. Please check into this.", -1*info);
+		}
+	}
+
+	// put the solutions back into the row-major ordering of the caller
+	if (!error) {
+		for (int k = 0; k < nrhs; k++) {
+			size_t		o = (size_t)k * _n;
+			for (int row = 0; row < rows; row++) {
+				for (int col = 0; col < cols; col++) {
+					x[o + (size_t)row * cols + col] = bb[o + (_rowMajor ? (row * cols + col) : (col * rows + row))];
+				}
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (bb != NULL) {
+		free(bb);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method solves the out-of-core factors for the 'nrhs' RHS vectors
+ in 'b', with one sweep forward and one back over the blocks in the
+ scratch file, each one being read in while the one before it is being
+ used. The vectors are in the same layout as for -_solveOriginal:count:
+ into:, and 'x' can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveOutOfCore:(double*)b count:(int)nrhs into:(double*)x
+{
+	BOOL			error = NO;
+	int				count = _n / _kl;
+
+	if (!solveBlocks([_stencil getArrays], _rowMajor, _kl, count, _blockStride, _blocks, _ipiv, b, nrhs, x)) {
+		error = YES;
+		NSLog(@"[BandedFactorization -_solveOutOfCore:count:into:] - while trying to allocate the working storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", _kl, nrhs);
+	} else {
+		// the workspace puts this in the report of the solve
+		_ioBytes += 2ULL * _kl * _kl * count * sizeof(double);
+	}
+
+	return !error;
+}
+
+
+//----------------------------------------------------------------------------
+//               NSObject Overridden Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called by the runtime when the released object is about
+ to get cleaned up. This gives us an opportunity to clean up all the
+ memory we're using at the time and be a good citizen.
+ */
+- (void) dealloc
+{
+	// drop all the memory we're using
+	[self freeAllStorage];
+	// ...and don't forget to call the super's dealloc too...
+	[super dealloc];
+}
+
+@end
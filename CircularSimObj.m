@@ -240,9 +240,10 @@
 		// get the center's location for speedy access
 		float		xc = [self getCenterX];
 		float		yc = [self getCenterY];
-		// precompute the squared radii that define the 'painting'
+		// precompute the squared radius that defines the 'painting'
 		float		r2hi = [self getRadius] * [self getRadius];
-		float		r2lo = ([self isSolid] ? -1.0 : ([self getRadius] - 2.0*MAX([ws getDeltaX], [ws getDeltaY]))*([self getRadius] - 2.0*MAX([ws getDeltaX], [ws getDeltaY])));
+		float		r2lo = -1.0;
+		float		rlo = 0.0;
 		// now go through all the points checking each one
 		for (r = ylo; !error && (r <= yhi); r++) {
 			for (c = xlo; !error && (c <= xhi); c++) {
@@ -255,6 +256,12 @@
 					continue;
 				}
 
+				// a hollow circle is two nodes thick - where ever it is on the grid
+				if (![self isSolid]) {
+					rlo = [self getRadius] - 2.0*MAX([ws getDeltaXAtCol:c], [ws getDeltaYAtRow:r]);
+					r2lo = rlo * rlo;
+				}
+
 				// see if we should be painting this point
 				if (((x*x + y*y) <= r2hi) && ((x*x + y*y) >= r2lo)) {
 					if (![self addObjPropsToWorkspace:ws atNodeRow:r andCol:c]) {
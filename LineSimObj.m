@@ -386,6 +386,10 @@
 	 */
 	if (!error && !allDone) {
 		float		slope = 0;
+		// on a graded grid, the line is only straight in real-space
+		BOOL		graded = ![ws isUniformGrid];
+		NSPoint		zeroReal = zero;
+		NSPoint		oneReal = one;
 
 		// convert the real-space values to simulation grid coordinates
 		zero.x = [ws getColForXValue:zero.x];
@@ -402,19 +406,24 @@
 			 */
 			// first make sure that the zero point is less than the one point
 			if (zero.x > one.x) {
-				float tx = zero.x;
-				float ty = zero.y;
-				zero.x = one.x;
-				zero.y = one.y;
-				one.x = tx;
-				one.y = ty;
+				NSPoint tp = zero;
+				zero = one;
+				one = tp;
+				tp = zeroReal;
+				zeroReal = oneReal;
+				oneReal = tp;
 			}
 			// calculate the linear slope of the line
 			slope = (one.y - zero.y)/(one.x - zero.x);
 			// now scan from zero to one on the x-axis
 			for (c = zero.x; !error && !allDone && (c <= one.x); c++) {
 				// compute the row that this point should appear on
-				r = slope * (c - zero.x) + zero.y;
+				if (graded) {
+					y = zeroReal.y + (oneReal.y - zeroReal.y) * ([ws getXValueForCol:c] - zeroReal.x) / (oneReal.x - zeroReal.x);
+					r = MIN(MAX([ws getRowForYValue:y], MIN(zero.y, one.y)), MAX(zero.y, one.y));
+				} else {
+					r = slope * (c - zero.x) + zero.y;
+				}
 				// ...and then paint it there
 				if (![self addObjPropsToWorkspace:ws atNodeRow:r andCol:c]) {
 					error = YES;
@@ -430,19 +439,24 @@
 			 */
 			// first make sure that the zero point is less than the one point
 			if (zero.y > one.y) {
-				float tx = zero.x;
-				float ty = zero.y;
-				zero.x = one.x;
-				zero.y = one.y;
-				one.x = tx;
-				one.y = ty;
+				NSPoint tp = zero;
+				zero = one;
+				one = tp;
+				tp = zeroReal;
+				zeroReal = oneReal;
+				oneReal = tp;
 			}
 			// calculate the inverse linear slope of the line
 			slope = (one.x - zero.x)/(one.y - zero.y);
 			// now scan from zero to one on the y-axis
 			for (r = zero.y; !error && !allDone && (r <= one.y); r++) {
 				// compute the column that this point should appear on
-				c = slope * (r - zero.y) + zero.x;
+				if (graded) {
+					x = (zero.y == one.y) ? zeroReal.x : zeroReal.x + (oneReal.x - zeroReal.x) * ([ws getYValueForRow:r] - zeroReal.y) / (oneReal.y - zeroReal.y);
+					c = MIN(MAX([ws getColForXValue:x], MIN(zero.x, one.x)), MAX(zero.x, one.x));
+				} else {
+					c = slope * (r - zero.y) + zero.x;
+				}
 				// ...and then paint it there
 				if (![self addObjPropsToWorkspace:ws atNodeRow:r andCol:c]) {
 					error = YES;
@@ -18,6 +18,11 @@
 // Class Headers
 #import "BaseSimObj.h"
 #import "SimWorkspace.h"
+#import "SimWorkspace_Superposition.h"
+#import "SimWorkspace_Refinement.h"
+#import "SimWorkspace_Progressive.h"
+#import "SimWorkspace_Convergence.h"
+#import "PoissonStencil.h"
 #import "SimObjFactory.h"
 #import "ResultsView.h"
 
@@ -50,6 +55,10 @@
 	IBOutlet NSMenuItem*			_plotExy;
 	SimWorkspace*					_workspace;
 	NSURL*							_srcFileName;
+	NSMutableArray*					_sweeps;
+	BOOL							_writeReport;
+	double							_convergenceTarget;
+	BOOL							_writeCapacitance;
 }
 
 //----------------------------------------------------------------------------
@@ -211,6 +220,62 @@
  */
 - (NSURL*) getSrcFileName;
 
+/*!
+ This method sets the list of conductor voltage sweeps read from the
+ source. Each is an NSArray of NSNumbers - one voltage for each of the
+ conductors in the factory's inventory, in the order they appear.
+ */
+- (void) setSweeps:(NSMutableArray*)sweeps;
+
+/*!
+ This method returns the list of conductor voltage sweeps read from
+ the source, each of which is an NSArray of NSNumber voltages for the
+ conductors in the factory's inventory.
+ */
+- (NSMutableArray*) getSweeps;
+
+/*!
+ This method sets whether the report of each solve is written out as
+ JSON next to the results, which is what the 'REPORT' line in the
+ source asks for.
+ */
+- (void) setWriteReport:(BOOL)flag;
+
+/*!
+ This method returns YES if the report of each solve is to be written
+ out as JSON next to the results.
+ */
+- (BOOL) getWriteReport;
+
+/*!
+ This method sets the largest error, in volts, that the grid of the
+ workspace is supposed to have, which is what the 'CONVERGENCE' line in
+ the source asks for. Then the simulation is a grid convergence study,
+ and zero means there's no target to recommend a grid for. Anything
+ less than zero - the default - means no study at all.
+ */
+- (void) setConvergenceTarget:(double)target;
+
+/*!
+ This method returns the largest error, in volts, that the grid of the
+ workspace is supposed to have - zero if there's no target - or a
+ value less than zero if the simulation isn't a convergence study.
+ */
+- (double) getConvergenceTarget;
+
+/*!
+ This method sets whether the capacitance matrix of the conductors is
+ extracted and written out next to the results, which is what the
+ 'CAPACITANCE' line in the source asks for.
+ */
+- (void) setWriteCapacitance:(BOOL)flag;
+
+/*!
+ This method returns YES if the capacitance matrix of the conductors
+ is to be extracted and written out next to the results.
+ */
+- (BOOL) getWriteCapacitance;
+
 //----------------------------------------------------------------------------
 //					IB Actions
 //----------------------------------------------------------------------------
@@ -311,6 +376,14 @@
  */
 - (void) showStatus:(NSString*)status;
 
+/*!
+ This method plots one of the coarser previews of a progressive
+ simulation - V(x,y) or E(x,y), just like the final results - and
+ says so on the status line, right away, while the finer grids are
+ still being solved.
+ */
+- (void) showPreview:(SimWorkspace*)preview;
+
 //----------------------------------------------------------------------------
 //					Actions Helper Methods
 //----------------------------------------------------------------------------
@@ -335,6 +408,181 @@
  */
 - (SimWorkspace*) createWorkspace:(NSString*)line;
 
+/*!
+ This method takes the line from the input source that has the form:
+
+     SOLVER <engine> [<tolerance> [<maxIterations>]]
+
+ and sets up the workspace to use that engine in its simulation. The
+ engines are: LU - the banded LU decomposition, LU32 - the banded LU
+ in single precision with iterative refinement in double, CHOL - the
+ banded Cholesky decomposition with the fixed nodes folded in, SPARSE - the
+ sparse Cholesky with nested dissection ordering, FPS - the fast
+ Poisson solver with a capacitance matrix for the conductors, MGV and
+ MGW - multigrid with V or W-cycles, PCGJ, PCGSSOR and PCGIC - conjugate
+ gradient with Jacobi, SSOR or IC(0) preconditioning, SOR -
+ multithreaded red-black SOR with an adaptive relaxation factor, and
+ SCHWARZ and SCHWARZ1 - overlapping Schwarz domain decomposition on
+ all the cores, with or without the coarse grid correction. The
+ tolerance and maximum iterations are only used by the iterative
+ engines. The workspace has to be defined before this line in the
+ source, as it's the workspace that's being configured.
+ */
+- (BOOL) configureSolver:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that grades one axis
+ of the workspace's grid, and has one of the forms:
+
+     GX <x0> <n1> <x1> <n2> <x2> ... <nK> <xK>
+     GY <y0> <n1> <y1> <n2> <y2> ... <nK> <yK>
+     GRADEX <ratio> <x1> [<x2> ...]
+     GRADEY <ratio> <y1> [<y2> ...]
+
+ The 'GX' and 'GY' lines are breakpoints along the axis, with the
+ intervals between each pair of them split evenly into the number of
+ intervals given. They have to start and end at the edges of the
+ workspace, and the intervals have to add up to one less than the
+ columns (or rows) of the workspace. The 'GRADEX' and 'GRADEY' lines
+ grade the axis toward the listed lines, with the spacing growing by
+ 'ratio' from one interval to the next moving away from them. The
+ workspace has to be defined before this line in the source, as it's
+ the workspace that's being graded.
+ */
+- (BOOL) configureGrid:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     GEOMETRY <PLANAR|RZ>
+
+ and sets whether the workspace is a planar slice of something that
+ goes on forever in z - the default - or the (r, z) half-plane of a
+ body of revolution, where x is the radius and y is the axis. In that
+ case a circle is a ring around the axis and a rectangle a cylinder,
+ or a tube if it's off the axis. The workspace has to be defined before
+ this line in the source, and can't start at a negative radius.
+ */
+- (BOOL) configureGeometry:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     BOUNDARY <MIRROR|OPEN> [<x> <y>]
+
+ and sets the condition on the edges of the workspace - the mirrors,
+ where no field crosses them, which is the default, or open, where the
+ field goes out as if the potential fell off as one over the distance
+ from the point (x, y). If the point is left off, it's the center of
+ the objects on the workspace. The workspace has to be defined before
+ this line in the source.
+ */
+- (BOOL) configureBoundary:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     REFINE <nodes>
+
+ and sets the refinement budget of the workspace - the number of extra
+ nodes it can use on finer patches around the places where the
+ potential changes the fastest, like the edges of thin conductors. A
+ budget of 0 turns the refinement off. The workspace has to be defined
+ before this line in the source, as it's the workspace that's being
+ configured.
+ */
+- (BOOL) configureRefinement:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     PROGRESSIVE [<factor>]
+
+ and has the simulation show previews on grids coarser than that of
+ the workspace, starting 'factor' times coarser - 8 if it's not given -
+ and each one twice as fine as the last, each starting from the last,
+ before the workspace's own grid is solved. The workspace has to be
+ defined before this line in the source, as it's the workspace that's
+ being configured.
+ */
+- (BOOL) configurePreview:(NSString*)line forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     KERNELS <AUTO|SCALAR|VECTOR> [BENCH]
+
+ and picks the kernels the stencils use for the multiply and residual
+ of the iterative solvers. AUTO uses the vector kernels if the CPU has
+ the vector units for them - which is the default - SCALAR never uses
+ them, and VECTOR asks for them, but can't get them on a CPU without
+ those units. If BENCH is on the line, the kernels are benchmarked on
+ a grid the size of the workspace - or 1000x1000 if there isn't one
+ yet - and the rates are logged.
+ */
+- (BOOL) configureKernels:(NSString*)line;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     CONVERGENCE [<target>]
+
+ and has the simulation solve the workspace on its own grid and on
+ grids two and four times as fine, all at once, to see how well it's
+ converged. If the 'target' - the largest error in volts - is given,
+ the grid that's predicted to just meet it is logged and written out
+ with the rest of the study.
+ */
+- (BOOL) configureConvergence:(NSString*)line;
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     SWEEP <v1> <v2> ... <vN>
+
+ where there is one voltage for each of the N conductors in the factory's
+ inventory, in the order they appear in the source, and adds it to the
+ list of sweeps to run. Each sweep is written out just like the main
+ results, but to its own file.
+ */
+- (BOOL) addSweep:(NSString*)line;
+
+/*!
+ This method creates one MaskedMatrix for each of the conductors in the
+ factory's inventory - in the order they appear - with a value at each
+ node of the workspace that conductor covers. This is done by placing
+ each conductor by itself on a scratch workspace just like 'ws'. The
+ returned array is autoreleased.
+ */
+- (NSArray*) createConductorMaps:(SimWorkspace*)ws;
+
+/*!
+ This method runs all the conductor voltage sweeps on the workspace by
+ superposition - the workspace solves once for the charges, and once
+ for each conductor, and then each sweep is just the weighted sum of
+ those solutions. The results of each sweep are written out next to
+ the source file with the sweep's number in the name.
+ */
+- (BOOL) runSweepsOnWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method runs the grid convergence study on the workspace - its
+ own grid, and the ones two and four times as fine - and writes out the
+ study as JSON, the estimated error at each node of the workspace, and
+ the Richardson extrapolation on the finest grid, all next to the
+ source file. The workspace is left with the results on its own grid.
+ */
+- (BOOL) runConvergenceOnWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method extracts the capacitance matrix of the conductors in the
+ factory's inventory - in the order they appear in the source - with
+ the one factorization of the workspace, and writes it out next to the
+ source file as a tab delimited matrix, with the conductor numbers on
+ the first row and column.
+ */
+- (BOOL) runCapacitanceOnWorkspace:(SimWorkspace*)ws;
+
 /*!
  This method writes out the results of the simulation so that the user
  can plot them, etc. There's nothing special about the format - tab
@@ -342,6 +590,28 @@
  */
 - (void) writeOutResults:(NSURL*)filename;
 
+/*!
+ This method writes out the results of the simulation on the workspace
+ 'ws' - which doesn't have to be the one that's being shown - in the
+ same format as -writeOutResults:.
+ */
+- (void) writeOutResults:(NSURL*)filename forWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method writes out the report of the last solve of the workspace -
+ the engine, the times, the residuals, the fill and the memory - as
+ JSON, along with the version of the application, so that the solvers
+ can be compared from one release to the next.
+ */
+- (void) writeOutReport:(NSURL*)filename;
+
+/*!
+ This method writes out the grid convergence study as JSON, and the
+ estimated error at each node of the workspace's grid in the same tab
+ delimited grid as the potentials, next to the results.
+ */
+- (void) writeOutConvergence:(NSDictionary*)study withErrors:(MaskedMatrix*)errors to:(NSURL*)filename;
+
 /*!
  This method looks at each of the BaseSimObj instances in the SimObjFactory's
  Inventory, and asks them to map themselves to the SimWorkspace on a linear
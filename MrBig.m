@@ -9,6 +9,7 @@
 // Apple Headers
 
 // System Headers
+#import <math.h>
 
 // Third Party Headers
 
@@ -310,6 +311,97 @@
 	return _srcFileName;
 }
 
+/*!
+ This method sets the list of conductor voltage sweeps read from the
+ source. Each is an NSArray of NSNumbers - one voltage for each of the
+ conductors in the factory's inventory, in the order they appear.
+ */
+- (void) setSweeps:(NSMutableArray*)sweeps
+{
+	if (_sweeps != sweeps) {
+		[_sweeps release];
+		_sweeps = [sweeps retain];
+	}
+}
+
+
+/*!
+ This method returns the list of conductor voltage sweeps read from
+ the source, each of which is an NSArray of NSNumber voltages for the
+ conductors in the factory's inventory.
+ */
+- (NSMutableArray*) getSweeps
+{
+	return _sweeps;
+}
+
+
+/*!
+ This method sets whether the report of each solve is written out as
+ JSON next to the results, which is what the 'REPORT' line in the
+ source asks for.
+ */
+- (void) setWriteReport:(BOOL)flag
+{
+	_writeReport = flag;
+}
+
+
+/*!
+ This method returns YES if the report of each solve is to be written
+ out as JSON next to the results.
+ */
+- (BOOL) getWriteReport
+{
+	return _writeReport;
+}
+
+
+/*!
+ This method sets the largest error, in volts, that the grid of the
+ workspace is supposed to have, which is what the 'CONVERGENCE' line in
+ the source asks for. Then the simulation is a grid convergence study,
+ and zero means there's no target to recommend a grid for. Anything
+ less than zero - the default - means no study at all.
+ */
+- (void) setConvergenceTarget:(double)target
+{
+	_convergenceTarget = target;
+}
+
+
+/*!
+ This method returns the largest error, in volts, that the grid of the
+ workspace is supposed to have - zero if there's no target - or a
+ value less than zero if the simulation isn't a convergence study.
+ */
+- (double) getConvergenceTarget
+{
+	return _convergenceTarget;
+}
+
+
+/*!
+ This method sets whether the capacitance matrix of the conductors is
+ extracted and written out next to the results, which is what the
+ 'CAPACITANCE' line in the source asks for.
+ */
+- (void) setWriteCapacitance:(BOOL)flag
+{
+	_writeCapacitance = flag;
+}
+
+
+/*!
+ This method returns YES if the capacitance matrix of the conductors
+ is to be extracted and written out next to the results.
+ */
+- (BOOL) getWriteCapacitance
+{
+	return _writeCapacitance;
+}
+
+
 
 //----------------------------------------------------------------------------
 //               IB Actions
@@ -493,6 +585,7 @@
 	// clear out the factory of all instruments
 	[[self getFactory] removeAllInventory];
 	[self setWorkspace:nil];
+	[self setSweeps:nil];
 	// clear out the content and it's filename
 	[[self getContentText] setString:@""];
 	[self setSrcFileName:nil];
@@ -511,6 +604,8 @@
 {
 	BOOL				error = NO;
 	SimWorkspace*		ws = nil;
+	// hold on to the last workspace so we can start from its results
+	SimWorkspace*		last = [[[self getWorkspace] retain] autorelease];
 
 	// first, load up the simulation engine (factory & workspace)
 	if (!error) {
@@ -534,6 +629,18 @@
 		}
 	}
 
+	// the iterative engines can start from the last results, if we have them
+	if (!error && ([last getResultantVoltage] != nil)) {
+		if ([ws setInitialGuessFromWorkspace:last]) {
+			NSLog(@"[MrBig -runSim:] - the iterative engines will start from the results of the last simulation");
+		}
+	}
+
+	// ...and the LU engine can start from the last factorization
+	if (!error && (last != nil)) {
+		[ws reuseFactorizationFrom:last];
+	}
+
 	// now add all the factory's objects to the workspace
 	if (!error) {
 		[self showStatus:@"Adding objects to workspace"];
@@ -545,10 +652,38 @@
 		}
 	}
 
+	// if the capacitance matrix is wanted, get it before anything else
+	if (!error && [self getWriteCapacitance]) {
+		[self showStatus:@"Extracting capacitance matrix"];
+		if (![self runCapacitanceOnWorkspace:ws]) {
+			error = YES;
+			NSLog(@"[MrBig -runSim:] - the capacitance matrix of the conductors could not be extracted. Please check the logs for a possible cause.");
+		}
+	}
+
+	// if there are sweeps of the conductor voltages, run them first
+	if (!error && ([[self getSweeps] count] > 0)) {
+		[self showStatus:@"Sweeping conductor voltages"];
+		if (![self runSweepsOnWorkspace:ws]) {
+			error = YES;
+			NSLog(@"[MrBig -runSim:] - the conductor voltage sweeps could not be run on the workspace. Please check the logs for a possible cause.");
+		}
+	}
+
 	// now run the simulation on the workspace
 	if (!error) {
 		[self showStatus:@"Simulating workspace"];
-		if (![ws simulateWorkspace]) {
+		BOOL	ok = NO;
+		if ([self getConvergenceTarget] >= 0.0) {
+			ok = [self runConvergenceOnWorkspace:ws];
+		} else if ([ws getPreviewFactor] > 0) {
+			ok = [ws simulateWorkspaceWithObjects:[[self getFactory] getInventory] notifying:self selector:@selector(showPreview:)];
+		} else if ([ws getRefinementBudget] > 0) {
+			ok = [ws simulateWorkspaceWithObjects:[[self getFactory] getInventory]];
+		} else {
+			ok = [ws simulateWorkspace];
+		}
+		if (!ok) {
 			error = YES;
 			NSLog(@"[MrBig -runSim:] - the workspace could not properly be simulated. Please check the logs for a possible cause.");
 		}
@@ -563,7 +698,11 @@
 			[[self getResultsView] plotElectricField:ws with:[self createDrawableSimObjs]];
 		}
 		// finally, we can write this data out to the files
-		[self writeOutResults:[[[self getSrcFileName] URLByDeletingPathExtension] URLByAppendingPathExtension:@"ans"]];
+		NSURL*		ans = [[[self getSrcFileName] URLByDeletingPathExtension] URLByAppendingPathExtension:@"ans"];
+		[self writeOutResults:ans];
+		if ([self getWriteReport]) {
+			[self writeOutReport:ans];
+		}
 	}
 
 	// change the status line to something useful
@@ -655,6 +794,8 @@
 	[[self getContentText] setFont:[NSFont fontWithName:@"Consolas" size:10.0]];
 	// clear out the content area as we wish it to appear clean
 	[[self getContentText] setString:@""];
+	// ...and there's no convergence study until the source asks for one
+	[self setConvergenceTarget:-1.0];
 
 	// Set the status to a simple 'Ready'
 	[self showStatus:@"Ready"];
@@ -707,6 +848,25 @@
 }
 
 
+/*!
+ This method plots one of the coarser previews of a progressive
+ simulation - V(x,y) or E(x,y), just like the final results - and
+ says so on the status line, right away, while the finer grids are
+ still being solved.
+ */
+- (void) showPreview:(SimWorkspace*)preview
+{
+	if ([[self getPlotVxy] state] == 1) {
+		[[self getResultsView] plotVoltage:preview with:[self createDrawableSimObjs]];
+	} else {
+		[[self getResultsView] plotElectricField:preview with:[self createDrawableSimObjs]];
+	}
+	[self showStatus:[NSString stringWithFormat:@"Preview at %dx%d - simulating workspace", [preview getRowCount], [preview getColCount]]];
+	// we're not getting back to the run loop until it's all done
+	[[self getStatusLine] display];
+}
+
+
 //----------------------------------------------------------------------------
 //               Actions Helper Methods
 //----------------------------------------------------------------------------
@@ -740,10 +900,18 @@
 	/*
 	 * For each line in the array, see if it's a comment, if so skip it.
 	 * If it starts with "WS" then it's the SimWorkspace definition line
-	 * and we need to build a new workspace based on what it says. If it's
-	 * anything else, pass it to the Factory for it to process.
+	 * and we need to build a new workspace based on what it says. The
+	 * "SOLVER", "GEOMETRY", "BOUNDARY", "REFINE", "PROGRESSIVE", "KERNELS",
+	 * "SWEEP", "REPORT", "CONVERGENCE", "CAPACITANCE" and grid grading
+	 * lines configure the simulation. If it's anything else, pass it to
+	 * the Factory for it to process.
 	 */
 	if (!error) {
+		// the sweeps and the report are only those in this source
+		[self setSweeps:[NSMutableArray array]];
+		[self setWriteReport:NO];
+		[self setConvergenceTarget:-1.0];
+		[self setWriteCapacitance:NO];
 		for (NSString* line in lines) {
 			// see if it starts with a '#' - a comment
 			if ([line hasPrefix:@"#"] || ([line length] == 0)) {
@@ -766,6 +934,122 @@
 				continue;
 			}
 
+			// see if it starts with 'SOLVER' - the engine for the workspace
+			if ([line hasPrefix:@"SOLVER"]) {
+				if (![self configureSolver:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to pick the solver for the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'GEOMETRY' - planar or axisymmetric
+			if ([line hasPrefix:@"GEOMETRY"]) {
+				if (![self configureGeometry:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to set the geometry of the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'BOUNDARY' - mirror or open edges
+			if ([line hasPrefix:@"BOUNDARY"]) {
+				if (![self configureBoundary:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to set the boundary condition of the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it's one of the lines that grade the grid
+			if ([line hasPrefix:@"GX"] || [line hasPrefix:@"GY"] ||
+				[line hasPrefix:@"GRADEX"] || [line hasPrefix:@"GRADEY"]) {
+				if (![self configureGrid:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to grade the grid of the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'REFINE' - the budget for refinement
+			if ([line hasPrefix:@"REFINE"]) {
+				if (![self configureRefinement:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to set the refinement of the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'PROGRESSIVE' - previews on coarser grids
+			if ([line hasPrefix:@"PROGRESSIVE"]) {
+				if (![self configurePreview:line forWorkspace:[self getWorkspace]]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to set up the previews of the workspace, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'KERNELS' - the kernels for the stencils
+			if ([line hasPrefix:@"KERNELS"]) {
+				if (![self configureKernels:line]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to pick the kernels for the solvers, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'SWEEP' - a set of conductor voltages
+			if ([line hasPrefix:@"SWEEP"]) {
+				if (![self addSweep:line]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to add a sweep of the conductor voltages, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it's 'REPORT' - write the solve report out as JSON
+			if ([line hasPrefix:@"REPORT"]) {
+				[self setWriteReport:YES];
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it's 'CAPACITANCE' - extract the capacitance matrix
+			if ([line hasPrefix:@"CAPACITANCE"]) {
+				[self setWriteCapacitance:YES];
+
+				// go back and get another line
+				continue;
+			}
+
+			// see if it starts with 'CONVERGENCE' - a grid convergence study
+			if ([line hasPrefix:@"CONVERGENCE"]) {
+				if (![self configureConvergence:line]) {
+					error = YES;
+					NSLog(@"[MrBig -loadEngine:] - the line in the source was supposed to set up the grid convergence study, but it failed. Please check the logs for the possible cause: '%@'", line);
+				}
+
+				// go back and get another line
+				continue;
+			}
+
 			// everything else goes to the Factory
 			if ([[self getFactory] createSimObjWithString:line] == nil) {
 				error = YES;
@@ -871,104 +1155,1005 @@
 
 
 /*!
- This method writes out the results of the simulation so that the user
- can plot them, etc. There's nothing special about the format - tab
- delimited data with column headings in the first row.
+ This method takes the line from the input source that has the form:
+
+     SOLVER <engine> [<tolerance> [<maxIterations>]]
+
+ and sets up the workspace to use that engine in its simulation. The
+ engines are: LU - the banded LU decomposition, LU32 - the banded LU
+ in single precision with iterative refinement in double, CHOL - the
+ banded Cholesky decomposition with the fixed nodes folded in, SPARSE - the
+ sparse Cholesky with nested dissection ordering, FPS - the fast
+ Poisson solver with a capacitance matrix for the conductors, MGV and
+ MGW - multigrid with V or W-cycles, PCGJ, PCGSSOR and PCGIC - conjugate
+ gradient with Jacobi, SSOR or IC(0) preconditioning, SOR -
+ multithreaded red-black SOR with an adaptive relaxation factor,
+ SCHWARZ and SCHWARZ1 - overlapping Schwarz domain decomposition on
+ all the cores, with or without the coarse grid correction, and AUTO -
+ whichever of these the cost model says will be the quickest for each
+ simulation. The tolerance and maximum iterations are only used by the
+ iterative engines. The workspace has to be defined before this line in the
+ source, as it's the workspace that's being configured.
  */
-- (void) writeOutResults:(NSURL*)filename
+- (BOOL) configureSolver:(NSString*)line forWorkspace:(SimWorkspace*)ws
 {
 	BOOL				error = NO;
-	SimWorkspace*		ws = nil;
+	NSString*			engine = nil;
+	double				tolerance = -1.0;
+	int					maxIterations = -1;
 
-	// first, make sure we have a filename to use
+	// first, see if we have anything to do
 	if (!error) {
-		if (filename == nil) {
+		if ((line == nil) || (ws == nil)) {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - the passed-in filename is nil and that means that there's nothing that can be done. Please make sure that the argument to this method is not nil before calling.");
+			NSLog(@"[MrBig -configureSolver:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly configure the solver. Please make sure that the 'WS' line comes before the 'SOLVER' line in the source.");
 		}
 	}
 
-	// now make sure that there's a workspace to output
+	// next, make sure it starts with "SOLVER"
 	if (!error) {
-		ws = [self getWorkspace];
-		if (ws == nil) {
+		if (![line hasPrefix:@"SOLVER"]) {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - there is no simulation workspace defined at this time. You need to make sure to load up a simulation workspace by any means and then call this method.");
+			NSLog(@"[MrBig -configureSolver:forWorkspace:] - the line: '%@' was supposed to configure the solver but the line didn't start with 'SOLVER' as it was supposed to. Please correct this formatting error.", line);
 		}
 	}
-	// ...and that it's got results to output
+
+	// now create a scanner and get all the values we're looking for
 	if (!error) {
-		if ([ws getResultantVoltage] == nil) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:6]];
+		if (scanner == nil) {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - there are no resultant voltages for the simulation workspace defined at this time. You need to make sure to simulate the workspace by -runSim: and then call this method.");
+			NSLog(@"[MrBig -configureSolver:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else {
+			if (![scanner scanUpToCharactersFromSet:[NSCharacterSet whitespaceCharacterSet] intoString:&engine]) {
+				error = YES;
+				NSLog(@"[MrBig -configureSolver:forWorkspace:] - the name of the engine could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+			}
+			// the tolerance and iterations are optional
+			if (!error && ![scanner isAtEnd] && ![scanner scanDouble:&tolerance]) {
+				error = YES;
+				NSLog(@"[MrBig -configureSolver:forWorkspace:] - the value of 'tolerance' could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+			}
+			if (!error && ![scanner isAtEnd] && ![scanner scanInt:&maxIterations]) {
+				error = YES;
+				NSLog(@"[MrBig -configureSolver:forWorkspace:] - the value of 'maxIterations' could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+			}
 		}
 	}
 
-	// change the status line to something useful
-	[self showStatus:@"Writing out results"];
+	// now map the name of the engine to the solver for the workspace
+	if (!error) {
+		if (![ws setSolverByName:engine]) {
+			error = YES;
+			NSLog(@"[MrBig -configureSolver:forWorkspace:] - the engine '%@' is not one that I know about. Please use one of the supported engines.", engine);
+		}
+	}
 
-	// let's open up a standard C FILE for this as we don't need anything fancy
+	// ...and the optional limits on the iterative engines
 	if (!error) {
-		FILE	*all = fopen([[filename path] UTF8String], "w");
-		FILE	*volt = fopen([[[filename path] stringByAppendingString:@"_v.txt"] UTF8String], "w");
-		FILE	*mage = fopen([[[filename path] stringByAppendingString:@"_e.txt"] UTF8String], "w");
-		if (all == NULL) {
+		if (tolerance > 0.0) {
+			[ws setTolerance:tolerance];
+		}
+		if (maxIterations > 0) {
+			[ws setMaxIterations:maxIterations];
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that grades one axis
+ of the workspace's grid, and has one of the forms:
+
+     GX <x0> <n1> <x1> <n2> <x2> ... <nK> <xK>
+     GY <y0> <n1> <y1> <n2> <y2> ... <nK> <yK>
+     GRADEX <ratio> <x1> [<x2> ...]
+     GRADEY <ratio> <y1> [<y2> ...]
+
+ The 'GX' and 'GY' lines are breakpoints along the axis, with the
+ intervals between each pair of them split evenly into the number of
+ intervals given. They have to start and end at the edges of the
+ workspace, and the intervals have to add up to one less than the
+ columns (or rows) of the workspace. The 'GRADEX' and 'GRADEY' lines
+ grade the axis toward the listed lines, with the spacing growing by
+ 'ratio' from one interval to the next moving away from them. The
+ workspace has to be defined before this line in the source, as it's
+ the workspace that's being graded.
+ */
+- (BOOL) configureGrid:(NSString*)line forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	BOOL				cols = NO;
+	BOOL				grade = NO;
+	NSUInteger			skip = 0;
+	NSMutableArray*		values = nil;
+	double*				p = NULL;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || (ws == nil)) {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [filename path]);
-		} else if (volt == NULL) {
+			NSLog(@"[MrBig -configureGrid:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly grade the grid. Please make sure that the 'WS' line comes before the grid lines in the source.");
+		} else if ([line hasPrefix:@"GRADEX"] || [line hasPrefix:@"GRADEY"]) {
+			grade = YES;
+			cols = [line hasPrefix:@"GRADEX"];
+			skip = 6;
+		} else if ([line hasPrefix:@"GX"] || [line hasPrefix:@"GY"]) {
+			cols = [line hasPrefix:@"GX"];
+			skip = 2;
+		} else {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [[filename URLByAppendingPathComponent:@"_v.txt"] path]);
-		} else if (mage == NULL) {
+			NSLog(@"[MrBig -configureGrid:forWorkspace:] - the line: '%@' was supposed to grade the grid but the line didn't start with 'GX', 'GY', 'GRADEX' or 'GRADEY' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get all the values on the line
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:skip]];
+		values = [NSMutableArray array];
+		if ((scanner == nil) || (values == nil)) {
 			error = YES;
-			NSLog(@"[MrBig -writeOutResults:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [[filename URLByAppendingPathComponent:@"_e.txt"] path]);
+			NSLog(@"[MrBig -configureGrid:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
 		} else {
-			int		r = 0;
-			int		c = 0;
-			int		rows = [ws getRowCount];
-			int		cols = [ws getColCount];
-			float	x = 0.0;
-			float	y = 0.0;
-			double	v = 0.0;
-			double	magE = 0.0;
-			double	dirE = 0.0;
-
-			// write out the header for this file
-			fprintf(all, "x\ty\tv\tmagE\tdirE\n");
-			// ...and this header for the voltage and electric field magnitude
-			for (c = 0; c < cols; c++) {
-				x = [ws getXValueForCol:c];
-				fprintf(volt, "\t%g", x);
-				fprintf(mage, "\t%g", x);
+			double		v = 0.0;
+			while (!error && ![scanner isAtEnd]) {
+				if (![scanner scanDouble:&v]) {
+					error = YES;
+					NSLog(@"[MrBig -configureGrid:forWorkspace:] - value %lu could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", (unsigned long)([values count] + 1), line);
+				} else {
+					[values addObject:[NSNumber numberWithDouble:v]];
+				}
 			}
-			// end the title row with a CRLF and we're ready for data
-			fprintf(volt, "\n");
-			fprintf(mage, "\n");
-			// now let's loop over all the points and write out what we want...
-			for (r = (rows-1); r >= 0; r--) {
-				for (c = 0; c < cols; c++) {
-					// get the location of this node in real-space
-					x = [ws getXValueForCol:c];
-					y = [ws getYValueForRow:r];
-
-					// now get the results at this node
-					v = [ws getResultantVoltageAtNodeRow:r andCol:c];
-					magE = [ws getResultantElectricFieldMagnitudeAtNodeRow:r andCol:c];
-					dirE = [ws getResultantElectricFieldDirectionAtNodeRow:r andCol:c];
+		}
+	}
 
-					// write it out
-					fprintf(all, "%f\t%f\t%g\t%g\t%g\n", x, y, v, magE, dirE);
-					if (c == 0) {
-						fprintf(volt, "%g", y);
-						fprintf(mage, "%g", y);
-					}
-					fprintf(volt, "\t%g", v);
-					fprintf(mage, "\t%g", magE);
+	// grading toward lines is just the ratio and the lines
+	if (!error && grade) {
+		int			count = (int)[values count] - 1;
+		if (count < 1) {
+			error = YES;
+			NSLog(@"[MrBig -configureGrid:forWorkspace:] - the line: '%@' needs a ratio and at least one line to grade toward. Please correct this formatting error.", line);
+		} else {
+			p = (double *) malloc(count * sizeof(double));
+			if (p == NULL) {
+				error = YES;
+				NSLog(@"[MrBig -configureGrid:forWorkspace:] - while trying to allocate the %d lines to grade toward, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count);
+			} else {
+				for (int j = 0; j < count; j++) {
+					p[j] = [[values objectAtIndex:(j + 1)] doubleValue];
+				}
+				double		ratio = [[values objectAtIndex:0] doubleValue];
+				if (cols) {
+					error = ![ws gradeColsTowardXValues:p count:count withRatio:ratio];
+				} else {
+					error = ![ws gradeRowsTowardYValues:p count:count withRatio:ratio];
 				}
-				// for these two, end the line of data now and be ready for the next
-				fprintf(volt, "\n");
-				fprintf(mage, "\n");
 			}
-
+		}
+	}
+
+	// ...and the breakpoints are filled in evenly between each pair
+	if (!error && !grade) {
+		int			n = (cols ? [ws getColCount] : [ws getRowCount]);
+		int			pairs = ((int)[values count] - 1) / 2;
+		int			total = 0;
+		if ((([values count] % 2) != 1) || (pairs < 1)) {
+			error = YES;
+			NSLog(@"[MrBig -configureGrid:forWorkspace:] - the line: '%@' needs to alternate breakpoints and interval counts, starting and ending with a breakpoint. Please correct this formatting error.", line);
+		} else {
+			for (int k = 0; k < pairs; k++) {
+				int		cnt = [[values objectAtIndex:(2 * k + 1)] intValue];
+				if (cnt < 1) {
+					error = YES;
+				}
+				total += cnt;
+			}
+			if (error || (total != (n - 1))) {
+				error = YES;
+				NSLog(@"[MrBig -configureGrid:forWorkspace:] - the intervals on the line: '%@' need to be positive, and add up to %d for the %d nodes of the workspace. Please correct this formatting error.", line, (n - 1), n);
+			}
+		}
+		if (!error) {
+			p = (double *) malloc(n * sizeof(double));
+			if (p == NULL) {
+				error = YES;
+				NSLog(@"[MrBig -configureGrid:forWorkspace:] - while trying to allocate the %d node coordinates, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", n);
+			} else {
+				int		i = 0;
+				for (int k = 0; k < pairs; k++) {
+					double	lo = [[values objectAtIndex:(2 * k)] doubleValue];
+					double	hi = [[values objectAtIndex:(2 * k + 2)] doubleValue];
+					int		cnt = [[values objectAtIndex:(2 * k + 1)] intValue];
+					for (int j = 0; j < cnt; j++) {
+						p[i++] = lo + (hi - lo) * j / cnt;
+					}
+				}
+				p[i] = [[values lastObject] doubleValue];
+				if (cols) {
+					error = ![ws setColCoordinates:p];
+				} else {
+					error = ![ws setRowCoordinates:p];
+				}
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (p != NULL) {
+		free(p);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     GEOMETRY <PLANAR|RZ>
+
+ and sets whether the workspace is a planar slice of something that
+ goes on forever in z - the default - or the (r, z) half-plane of a
+ body of revolution, where x is the radius and y is the axis. In that
+ case a circle is a ring around the axis and a rectangle a cylinder,
+ or a tube if it's off the axis. The workspace has to be defined before
+ this line in the source, and can't start at a negative radius.
+ */
+- (BOOL) configureGeometry:(NSString*)line forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	NSString*			mode = nil;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || (ws == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly configure the geometry. Please make sure that the 'WS' line comes before the 'GEOMETRY' line in the source.");
+		}
+	}
+
+	// next, make sure it starts with "GEOMETRY"
+	if (!error) {
+		if (![line hasPrefix:@"GEOMETRY"]) {
+			error = YES;
+			NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the line: '%@' was supposed to configure the geometry but the line didn't start with 'GEOMETRY' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the mode
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:8]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner scanCharactersFromSet:[NSCharacterSet alphanumericCharacterSet] intoString:&mode]) {
+			error = YES;
+			NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the geometry could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+		}
+	}
+
+	// ...and set it on the workspace
+	if (!error) {
+		if ([mode isEqualToString:@"PLANAR"]) {
+			[ws setAxisymmetric:NO];
+		} else if ([mode isEqualToString:@"RZ"]) {
+			if ([ws getWorkspaceOrigin].x < 0.0) {
+				error = YES;
+				NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the workspace starts at x=%g, and in the RZ geometry x is the radius, so it can't be negative. Please move the workspace to x >= 0.", [ws getWorkspaceOrigin].x);
+			} else {
+				[ws setAxisymmetric:YES];
+			}
+		} else {
+			error = YES;
+			NSLog(@"[MrBig -configureGeometry:forWorkspace:] - the geometry '%@' on the line: '%@' isn't one that I know. Please use PLANAR or RZ.", mode, line);
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     BOUNDARY <MIRROR|OPEN> [<x> <y>]
+
+ and sets the condition on the edges of the workspace - the mirrors,
+ where no field crosses them, which is the default, or open, where the
+ field goes out as if the potential fell off as one over the distance
+ from the point (x, y). If the point is left off, it's the center of
+ the objects on the workspace. The workspace has to be defined before
+ this line in the source.
+ */
+- (BOOL) configureBoundary:(NSString*)line forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	NSString*			mode = nil;
+	double				x = NAN;
+	double				y = NAN;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || (ws == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly configure the boundary. Please make sure that the 'WS' line comes before the 'BOUNDARY' line in the source.");
+		}
+	}
+
+	// next, make sure it starts with "BOUNDARY"
+	if (!error) {
+		if (![line hasPrefix:@"BOUNDARY"]) {
+			error = YES;
+			NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the line: '%@' was supposed to configure the boundary but the line didn't start with 'BOUNDARY' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the mode, and the center if it's there
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:8]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner scanCharactersFromSet:[NSCharacterSet alphanumericCharacterSet] intoString:&mode]) {
+			error = YES;
+			NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the boundary condition could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+		} else if ([scanner scanDouble:&x]) {
+			if (![scanner scanDouble:&y]) {
+				error = YES;
+				NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the center of the open boundary on the line: '%@' needs both an x and a y. Please correct this formatting error.", line);
+			}
+		}
+	}
+
+	// ...and set it on the workspace
+	if (!error) {
+		if ([mode isEqualToString:@"MIRROR"]) {
+			[ws setBoundaryCondition:kMirrorBoundary];
+		} else if ([mode isEqualToString:@"OPEN"]) {
+			[ws setBoundaryCondition:kOpenBoundary];
+			[ws setOpenBoundaryCenter:NSMakePoint(x, y)];
+		} else {
+			error = YES;
+			NSLog(@"[MrBig -configureBoundary:forWorkspace:] - the boundary condition '%@' on the line: '%@' isn't one that I know. Please use MIRROR or OPEN.", mode, line);
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     REFINE <nodes>
+
+ and sets the refinement budget of the workspace - the number of extra
+ nodes it can use on finer patches around the places where the
+ potential changes the fastest, like the edges of thin conductors. A
+ budget of 0 turns the refinement off. The workspace has to be defined
+ before this line in the source, as it's the workspace that's being
+ configured.
+ */
+- (BOOL) configureRefinement:(NSString*)line forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	int					nodes = 0;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || (ws == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -configureRefinement:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly configure the refinement. Please make sure that the 'WS' line comes before the 'REFINE' line in the source.");
+		}
+	}
+
+	// next, make sure it starts with "REFINE"
+	if (!error) {
+		if (![line hasPrefix:@"REFINE"]) {
+			error = YES;
+			NSLog(@"[MrBig -configureRefinement:forWorkspace:] - the line: '%@' was supposed to configure the refinement but the line didn't start with 'REFINE' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the budget
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:6]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configureRefinement:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner scanInt:&nodes] || (nodes < 0)) {
+			error = YES;
+			NSLog(@"[MrBig -configureRefinement:forWorkspace:] - the value of 'nodes' could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+		}
+	}
+
+	// ...and set it on the workspace
+	if (!error) {
+		[ws setRefinementBudget:nodes];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     PROGRESSIVE [<factor>]
+
+ and has the simulation show previews on grids coarser than that of
+ the workspace, starting 'factor' times coarser - 8 if it's not given -
+ and each one twice as fine as the last, each starting from the last,
+ before the workspace's own grid is solved. The workspace has to be
+ defined before this line in the source, as it's the workspace that's
+ being configured.
+ */
+- (BOOL) configurePreview:(NSString*)line forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	int					factor = 8;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || (ws == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -configurePreview:forWorkspace:] - the passed-in line or workspace is nil and that means that I can't possibly configure the previews. Please make sure that the 'WS' line comes before the 'PROGRESSIVE' line in the source.");
+		}
+	}
+
+	// next, make sure it starts with "PROGRESSIVE"
+	if (!error) {
+		if (![line hasPrefix:@"PROGRESSIVE"]) {
+			error = YES;
+			NSLog(@"[MrBig -configurePreview:forWorkspace:] - the line: '%@' was supposed to configure the previews but the line didn't start with 'PROGRESSIVE' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the optional factor
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:11]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configurePreview:forWorkspace:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner isAtEnd] && (![scanner scanInt:&factor] || (factor < 2))) {
+			error = YES;
+			NSLog(@"[MrBig -configurePreview:forWorkspace:] - the value of 'factor' could not be read from the line: '%@', or it's less than 2. This is a serious formatting problem and it needs to be addressed.", line);
+		}
+	}
+
+	// ...and set it on the workspace
+	if (!error) {
+		[ws setPreviewFactor:factor];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     KERNELS <AUTO|SCALAR|VECTOR> [BENCH]
+
+ and picks the kernels the stencils use for the multiply and residual
+ of the iterative solvers. AUTO uses the vector kernels if the CPU has
+ the vector units for them - which is the default - SCALAR never uses
+ them, and VECTOR asks for them, but can't get them on a CPU without
+ those units. If BENCH is on the line, the kernels are benchmarked on
+ a grid the size of the workspace - or 1000x1000 if there isn't one
+ yet - and the rates are logged.
+ */
+- (BOOL) configureKernels:(NSString*)line
+{
+	BOOL				error = NO;
+	NSString*			mode = nil;
+	NSString*			bench = nil;
+
+	// first, make sure it starts with "KERNELS"
+	if (!error) {
+		if ((line == nil) || ![line hasPrefix:@"KERNELS"]) {
+			error = YES;
+			NSLog(@"[MrBig -configureKernels:] - the line: '%@' was supposed to pick the kernels but the line didn't start with 'KERNELS' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the mode and the optional benchmark
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:7]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configureKernels:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner scanCharactersFromSet:[NSCharacterSet alphanumericCharacterSet] intoString:&mode]) {
+			error = YES;
+			NSLog(@"[MrBig -configureKernels:] - the kernels could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", line);
+		} else {
+			[scanner scanCharactersFromSet:[NSCharacterSet alphanumericCharacterSet] intoString:&bench];
+			if ((bench != nil) && ![bench isEqualToString:@"BENCH"]) {
+				error = YES;
+				NSLog(@"[MrBig -configureKernels:] - the only option after the kernels is 'BENCH', and the line: '%@' has '%@'. Please correct this formatting error.", line, bench);
+			}
+		}
+	}
+
+	// ...and set them on all the stencils
+	if (!error) {
+		if ([mode isEqualToString:@"AUTO"]) {
+			[PoissonStencil setVectorKernels:YES];
+		} else if ([mode isEqualToString:@"SCALAR"]) {
+			[PoissonStencil setVectorKernels:NO];
+		} else if ([mode isEqualToString:@"VECTOR"]) {
+			[PoissonStencil setVectorKernels:YES];
+			if (![PoissonStencil usesVectorKernels]) {
+				NSLog(@"[MrBig -configureKernels:] - the vector kernels were asked for, but this CPU doesn't have the vector units for them, so it'll be the scalar kernels.");
+			}
+		} else {
+			error = YES;
+			NSLog(@"[MrBig -configureKernels:] - the kernels: '%@' on the line: '%@' aren't one of AUTO, SCALAR or VECTOR. Please correct this formatting error.", mode, line);
+		}
+	}
+
+	// see if they want to know how fast the kernels are
+	if (!error && (bench != nil)) {
+		SimWorkspace*	ws = [self getWorkspace];
+		if (ws == nil) {
+			[PoissonStencil benchmarkKernelsWithRows:1000 andCols:1000];
+		} else {
+			[PoissonStencil benchmarkKernelsWithRows:[ws getRowCount] andCols:[ws getColCount]];
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     CONVERGENCE [<target>]
+
+ and has the simulation solve the workspace on its own grid and on
+ grids two and four times as fine, all at once, to see how well it's
+ converged. If the 'target' - the largest error in volts - is given,
+ the grid that's predicted to just meet it is logged and written out
+ with the rest of the study.
+ */
+- (BOOL) configureConvergence:(NSString*)line
+{
+	BOOL				error = NO;
+	double				target = 0.0;
+
+	// first, make sure it starts with "CONVERGENCE"
+	if (!error) {
+		if ((line == nil) || ![line hasPrefix:@"CONVERGENCE"]) {
+			error = YES;
+			NSLog(@"[MrBig -configureConvergence:] - the line: '%@' was supposed to set up the convergence study but the line didn't start with 'CONVERGENCE' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get the optional target
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:11]];
+		if (scanner == nil) {
+			error = YES;
+			NSLog(@"[MrBig -configureConvergence:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else if (![scanner isAtEnd] && (![scanner scanDouble:&target] || (target <= 0.0))) {
+			error = YES;
+			NSLog(@"[MrBig -configureConvergence:] - the value of 'target' could not be read from the line: '%@', or it's not more than zero. This is a serious formatting problem and it needs to be addressed.", line);
+		}
+	}
+
+	// ...and save it for the run
+	if (!error) {
+		[self setConvergenceTarget:target];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the line from the input source that has the form:
+
+     SWEEP <v1> <v2> ... <vN>
+
+ where there is one voltage for each of the N conductors in the factory's
+ inventory, in the order they appear in the source, and adds it to the
+ list of sweeps to run. Each sweep is written out just like the main
+ results, but to its own file.
+ */
+- (BOOL) addSweep:(NSString*)line
+{
+	BOOL				error = NO;
+	NSMutableArray*		volts = nil;
+
+	// first, see if we have anything to do
+	if (!error) {
+		if ((line == nil) || ![line hasPrefix:@"SWEEP"]) {
+			error = YES;
+			NSLog(@"[MrBig -addSweep:] - the line: '%@' was supposed to add a sweep of the conductor voltages but the line didn't start with 'SWEEP' as it was supposed to. Please correct this formatting error.", line);
+		}
+	}
+
+	// now create a scanner and get all the voltages we're looking for
+	if (!error) {
+		NSScanner*	scanner = [NSScanner scannerWithString:[line substringFromIndex:5]];
+		volts = [NSMutableArray array];
+		if ((scanner == nil) || (volts == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -addSweep:] - the scanner for the line: '%@' could not be made. This is a serious problem.", line);
+		} else {
+			double		v = 0.0;
+			while (!error && ![scanner isAtEnd]) {
+				if (![scanner scanDouble:&v]) {
+					error = YES;
+					NSLog(@"[MrBig -addSweep:] - the voltage of conductor %lu could not be read from the line: '%@'. This is a serious formatting problem and it needs to be addressed.", (unsigned long)([volts count] + 1), line);
+				} else {
+					[volts addObject:[NSNumber numberWithDouble:v]];
+				}
+			}
+			if (!error && ([volts count] == 0)) {
+				error = YES;
+				NSLog(@"[MrBig -addSweep:] - there are no voltages on the line: '%@'. There needs to be one for each conductor in the source.", line);
+			}
+		}
+	}
+
+	// ...and add it to the sweeps to run
+	if (!error) {
+		if ([self getSweeps] == nil) {
+			[self setSweeps:[NSMutableArray array]];
+		}
+		[[self getSweeps] addObject:volts];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method creates one MaskedMatrix for each of the conductors in the
+ factory's inventory - in the order they appear - with a value at each
+ node of the workspace that conductor covers. This is done by placing
+ each conductor by itself on a scratch workspace just like 'ws'. The
+ returned array is autoreleased.
+ */
+- (NSArray*) createConductorMaps:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	SimWorkspace*		scratch = nil;
+	NSMutableArray*		retval = nil;
+
+	// first, make the scratch workspace to place the conductors on
+	if (!error) {
+		if (ws == nil) {
+			error = YES;
+			NSLog(@"[MrBig -createConductorMaps:] - the passed-in workspace is nil and that means that there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		} else {
+			scratch = [[[SimWorkspace alloc] initWithRect:[ws getWorkspaceRect] usingRows:[ws getRowCount] andCols:[ws getColCount]] autorelease];
+			retval = [NSMutableArray array];
+			if ((scratch == nil) || (retval == nil) || ![scratch copyGridFromWorkspace:ws]) {
+				error = YES;
+				NSLog(@"[MrBig -createConductorMaps:] - the scratch workspace for mapping the conductors could not be created. This is a serious allocation error and needs to be looked into as soon as possible.");
+			}
+		}
+	}
+
+	// now place each conductor by itself and see what nodes it covers
+	if (!error) {
+		int			rows = [ws getRowCount];
+		int			cols = [ws getColCount];
+		for (BaseSimObj* obj in [[self getFactory] getInventory]) {
+			if (![obj isAConductor]) {
+				continue;
+			}
+			[scratch clearWorkspace];
+			MaskedMatrix*	map = [[[MaskedMatrix alloc] initWithRows:rows andCols:cols] autorelease];
+			if ((map == nil) || ![obj addToWorkspace:scratch]) {
+				error = YES;
+				NSLog(@"[MrBig -createConductorMaps:] - the map of conductor %lu could not be made. Please check the logs for a possible cause.", (unsigned long)([retval count] + 1));
+				break;
+			}
+			for (int r = 0; r < rows; r++) {
+				for (int c = 0; c < cols; c++) {
+					if ([[scratch getVoltage] haveValueAtRow:r andCol:c]) {
+						[map setValue:1.0 atRow:r andCol:c];
+					}
+				}
+			}
+			[retval addObject:map];
+		}
+	}
+
+	return (error ? nil : retval);
+}
+
+
+/*!
+ This method runs all the conductor voltage sweeps on the workspace by
+ superposition - the workspace solves once for the charges, and once
+ for each conductor, and then each sweep is just the weighted sum of
+ those solutions. The results of each sweep are written out next to
+ the source file with the sweep's number in the name.
+ */
+- (BOOL) runSweepsOnWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	NSArray*			maps = nil;
+	int					count = 0;
+	double*				volts = NULL;
+
+	// first, map out the conductors in the inventory
+	if (!error) {
+		maps = [self createConductorMaps:ws];
+		if (maps == nil) {
+			error = YES;
+			NSLog(@"[MrBig -runSweepsOnWorkspace:] - the conductors in the inventory could not be mapped onto the workspace. Please check the logs for a possible cause.");
+		} else {
+			count = (int)[maps count];
+		}
+	}
+
+	// ...and have the workspace build the basis for them
+	if (!error) {
+		if (![ws prepareSuperpositionForConductors:maps]) {
+			error = YES;
+			NSLog(@"[MrBig -runSweepsOnWorkspace:] - the superposition basis for the %d conductors could not be built. Please check the logs for a possible cause.", count);
+		}
+	}
+
+	// get the storage for the voltages of each sweep
+	if (!error) {
+		volts = (double *) calloc(count, sizeof(double));
+		if (volts == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -runSweepsOnWorkspace:] - while trying to allocate the voltages for the %d conductors, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count);
+		}
+	}
+
+	// now do each sweep and write it out to its own file
+	if (!error) {
+		int			k = 0;
+		for (NSArray* sweep in [self getSweeps]) {
+			k++;
+			if ((int)[sweep count] != count) {
+				error = YES;
+				NSLog(@"[MrBig -runSweepsOnWorkspace:] - sweep %d has %lu voltages, but there are %d conductors in the source. Please give one voltage for each conductor.", k, (unsigned long)[sweep count], count);
+				break;
+			}
+			for (int i = 0; i < count; i++) {
+				volts[i] = [[sweep objectAtIndex:i] doubleValue];
+			}
+			if (![ws superposeConductorVoltages:volts count:count]) {
+				error = YES;
+				NSLog(@"[MrBig -runSweepsOnWorkspace:] - sweep %d could not be superposed. Please check the logs for a possible cause.", k);
+				break;
+			}
+			NSString*	ext = [NSString stringWithFormat:@"sweep%d.ans", k];
+			[self writeOutResults:[[[self getSrcFileName] URLByDeletingPathExtension] URLByAppendingPathExtension:ext]];
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (volts != NULL) {
+		free(volts);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method runs the grid convergence study on the workspace - its
+ own grid, and the ones two and four times as fine - and writes out the
+ study as JSON, the estimated error at each node of the workspace, and
+ the Richardson extrapolation on the finest grid, all next to the
+ source file. The workspace is left with the results on its own grid.
+ */
+- (BOOL) runConvergenceOnWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	NSDictionary*		study = nil;
+	SimWorkspace*		fine = nil;
+	MaskedMatrix*		errors = nil;
+
+	// first, run the study on the workspace and the finer grids
+	if (!error) {
+		if (ws == nil) {
+			error = YES;
+			NSLog(@"[MrBig -runConvergenceOnWorkspace:] - the passed-in workspace is nil and that means that there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		} else {
+			study = [ws simulateConvergenceWithObjects:[[self getFactory] getInventory] target:[self getConvergenceTarget] extrapolated:&fine errors:&errors];
+			if (study == nil) {
+				error = YES;
+				NSLog(@"[MrBig -runConvergenceOnWorkspace:] - the grid convergence study of the %dx%d workspace could not be run. Please check the logs for a possible cause.", [ws getRowCount], [ws getColCount]);
+			}
+		}
+	}
+
+	// ...and write it all out next to the source
+	if (!error) {
+		NSURL*		base = [[self getSrcFileName] URLByDeletingPathExtension];
+		[self writeOutConvergence:study withErrors:errors to:[base URLByAppendingPathExtension:@"ans"]];
+		[self writeOutResults:[base URLByAppendingPathExtension:@"richardson.ans"] forWorkspace:fine];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method extracts the capacitance matrix of the conductors in the
+ factory's inventory - in the order they appear in the source - with
+ the one factorization of the workspace, and writes it out next to the
+ source file as a tab delimited matrix, with the conductor numbers on
+ the first row and column.
+ */
+- (BOOL) runCapacitanceOnWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+	NSArray*			maps = nil;
+	MaskedMatrix*		cap = nil;
+
+	// first, map out the conductors in the inventory
+	if (!error) {
+		maps = [self createConductorMaps:ws];
+		if (maps == nil) {
+			error = YES;
+			NSLog(@"[MrBig -runCapacitanceOnWorkspace:] - the conductors in the inventory could not be mapped onto the workspace. Please check the logs for a possible cause.");
+		} else if ([maps count] == 0) {
+			error = YES;
+			NSLog(@"[MrBig -runCapacitanceOnWorkspace:] - there are no conductors in the source, so there's no capacitance matrix to extract. Please add at least one metal object.");
+		}
+	}
+
+	// ...and have the workspace extract the matrix for them
+	if (!error) {
+		cap = [ws extractCapacitanceForConductors:maps];
+		if (cap == nil) {
+			error = YES;
+			NSLog(@"[MrBig -runCapacitanceOnWorkspace:] - the capacitance matrix of the %lu conductors could not be extracted. Please check the logs for a possible cause.", (unsigned long)[maps count]);
+		}
+	}
+
+	// finally, write it out next to the results
+	if (!error) {
+		NSURL*		ans = [[[self getSrcFileName] URLByDeletingPathExtension] URLByAppendingPathExtension:@"ans"];
+		NSString*	path = [[ans path] stringByAppendingString:@"_capacitance.txt"];
+		FILE		*out = fopen([path UTF8String], "w");
+		if (out == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -runCapacitanceOnWorkspace:] - the file: '%@' could not be opened for writing out the capacitance matrix. This is a serious problem that needs to be looked into.", path);
+		} else {
+			int		count = [cap getRowCount];
+			for (int j = 0; j < count; j++) {
+				fprintf(out, "\t%d", (j + 1));
+			}
+			fprintf(out, "\n");
+			for (int i = 0; i < count; i++) {
+				fprintf(out, "%d", (i + 1));
+				for (int j = 0; j < count; j++) {
+					fprintf(out, "\t%g", [cap getValueAtRow:i andCol:j]);
+				}
+				fprintf(out, "\n");
+			}
+			fclose(out);
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method writes out the results of the simulation so that the user
+ can plot them, etc. There's nothing special about the format - tab
+ delimited data with column headings in the first row.
+ */
+- (void) writeOutResults:(NSURL*)filename
+{
+	[self writeOutResults:filename forWorkspace:[self getWorkspace]];
+}
+
+
+/*!
+ This method writes out the results of the simulation on the workspace
+ 'ws' - which doesn't have to be the one that's being shown - in the
+ same format as -writeOutResults:.
+ */
+- (void) writeOutResults:(NSURL*)filename forWorkspace:(SimWorkspace*)ws
+{
+	BOOL				error = NO;
+
+	// first, make sure we have a filename to use
+	if (!error) {
+		if (filename == nil) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - the passed-in filename is nil and that means that there's nothing that can be done. Please make sure that the argument to this method is not nil before calling.");
+		}
+	}
+
+	// now make sure that there's a workspace to output
+	if (!error) {
+		if (ws == nil) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - there is no simulation workspace defined at this time. You need to make sure to load up a simulation workspace by any means and then call this method.");
+		}
+	}
+	// ...and that it's got results to output
+	if (!error) {
+		if ([ws getResultantVoltage] == nil) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - there are no resultant voltages for the simulation workspace defined at this time. You need to make sure to simulate the workspace by -runSim: and then call this method.");
+		}
+	}
+
+	// change the status line to something useful
+	[self showStatus:@"Writing out results"];
+
+	// let's open up a standard C FILE for this as we don't need anything fancy
+	if (!error) {
+		FILE	*all = fopen([[filename path] UTF8String], "w");
+		FILE	*volt = fopen([[[filename path] stringByAppendingString:@"_v.txt"] UTF8String], "w");
+		FILE	*mage = fopen([[[filename path] stringByAppendingString:@"_e.txt"] UTF8String], "w");
+		if (all == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [filename path]);
+		} else if (volt == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [[filename URLByAppendingPathComponent:@"_v.txt"] path]);
+		} else if (mage == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutResults:forWorkspace:] - the file: '%@' could not be opened for writing out the results. This is a serious problem that needs to be looked into.", [[filename URLByAppendingPathComponent:@"_e.txt"] path]);
+		} else {
+			int		r = 0;
+			int		c = 0;
+			int		rows = [ws getRowCount];
+			int		cols = [ws getColCount];
+			float	x = 0.0;
+			float	y = 0.0;
+			double	v = 0.0;
+			double	magE = 0.0;
+			double	dirE = 0.0;
+
+			// write out the header for this file
+			fprintf(all, "x\ty\tv\tmagE\tdirE\n");
+			// ...and this header for the voltage and electric field magnitude
+			for (c = 0; c < cols; c++) {
+				x = [ws getXValueForCol:c];
+				fprintf(volt, "\t%g", x);
+				fprintf(mage, "\t%g", x);
+			}
+			// end the title row with a CRLF and we're ready for data
+			fprintf(volt, "\n");
+			fprintf(mage, "\n");
+			// now let's loop over all the points and write out what we want...
+			for (r = (rows-1); r >= 0; r--) {
+				for (c = 0; c < cols; c++) {
+					// get the location of this node in real-space
+					x = [ws getXValueForCol:c];
+					y = [ws getYValueForRow:r];
+
+					// now get the results at this node
+					v = [ws getResultantVoltageAtNodeRow:r andCol:c];
+					magE = [ws getResultantElectricFieldMagnitudeAtNodeRow:r andCol:c];
+					dirE = [ws getResultantElectricFieldDirectionAtNodeRow:r andCol:c];
+
+					// write it out
+					fprintf(all, "%f\t%f\t%g\t%g\t%g\n", x, y, v, magE, dirE);
+					if (c == 0) {
+						fprintf(volt, "%g", y);
+						fprintf(mage, "%g", y);
+					}
+					fprintf(volt, "\t%g", v);
+					fprintf(mage, "\t%g", magE);
+				}
+				// for these two, end the line of data now and be ready for the next
+				fprintf(volt, "\n");
+				fprintf(mage, "\n");
+			}
+
 			// close out the file as we're done.
 			fclose(all);
 			fclose(volt);
@@ -978,6 +2163,128 @@
 }
 
 
+/*!
+ This method writes out the report of the last solve of the workspace -
+ the engine, the times, the residuals, the fill and the memory - as
+ JSON, along with the version of the application, so that the solvers
+ can be compared from one release to the next.
+ */
+- (void) writeOutReport:(NSURL*)filename
+{
+	BOOL				error = NO;
+	NSMutableDictionary*	report = nil;
+	NSData*				json = nil;
+
+	// first, make sure we have a filename to use
+	if (!error) {
+		if (filename == nil) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutReport:] - the passed-in filename is nil and that means that there's nothing that can be done. Please make sure that the argument to this method is not nil before calling.");
+		}
+	}
+
+	// now make sure that there's a report to write
+	if (!error) {
+		report = [[[[self getWorkspace] getSolveReport] mutableCopy] autorelease];
+		if (report == nil) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutReport:] - there is no report of a solve of the simulation workspace at this time. You need to make sure to simulate the workspace by -runSim: and then call this method.");
+		} else {
+			NSString*	version = [[[NSBundle mainBundle] infoDictionary] objectForKey:@"CFBundleShortVersionString"];
+			if (version != nil) {
+				[report setObject:version forKey:@"version"];
+			}
+		}
+	}
+
+	// ...and that it can be written as JSON - no NaNs or infinities
+	if (!error) {
+		if (![NSJSONSerialization isValidJSONObject:report]) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutReport:] - the report of the solve has something in it that can't be written as JSON - most likely a residual that's not a number. Please check the logs for a possible cause.");
+		} else {
+			json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:NULL];
+		}
+	}
+
+	// finally, write it out next to the results
+	if (!error) {
+		NSString*	path = [[filename path] stringByAppendingString:@"_report.json"];
+		if ((json == nil) || ![json writeToFile:path atomically:YES]) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutReport:] - the file: '%@' could not be written with the report of the solve. This is a serious problem that needs to be looked into.", path);
+		}
+	}
+}
+
+
+/*!
+ This method writes out the grid convergence study as JSON, and the
+ estimated error at each node of the workspace's grid in the same tab
+ delimited grid as the potentials, next to the results.
+ */
+- (void) writeOutConvergence:(NSDictionary*)study withErrors:(MaskedMatrix*)errors to:(NSURL*)filename
+{
+	BOOL				error = NO;
+	SimWorkspace*		ws = [self getWorkspace];
+	NSData*				json = nil;
+
+	// first, make sure we have everything to write
+	if (!error) {
+		if ((filename == nil) || (study == nil) || (errors == nil) || (ws == nil)) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutConvergence:withErrors:to:] - the passed-in filename, study or errors - or the workspace - is nil and that means that there's nothing that can be done. Please make sure that the arguments to this method are not nil before calling.");
+		}
+	}
+
+	// ...and that the study can be written as JSON
+	if (!error) {
+		if (![NSJSONSerialization isValidJSONObject:study]) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutConvergence:withErrors:to:] - the convergence study has something in it that can't be written as JSON - most likely an error that's not a number. Please check the logs for a possible cause.");
+		} else {
+			json = [NSJSONSerialization dataWithJSONObject:study options:NSJSONWritingPrettyPrinted error:NULL];
+		}
+	}
+
+	// write out the study next to the results
+	if (!error) {
+		NSString*	path = [[filename path] stringByAppendingString:@"_convergence.json"];
+		if ((json == nil) || ![json writeToFile:path atomically:YES]) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutConvergence:withErrors:to:] - the file: '%@' could not be written with the convergence study. This is a serious problem that needs to be looked into.", path);
+		}
+	}
+
+	// ...and the errors in the same grid as the potentials
+	if (!error) {
+		NSString*	path = [[filename path] stringByAppendingString:@"_err.txt"];
+		FILE		*err = fopen([path UTF8String], "w");
+		if (err == NULL) {
+			error = YES;
+			NSLog(@"[MrBig -writeOutConvergence:withErrors:to:] - the file: '%@' could not be opened for writing out the estimated errors. This is a serious problem that needs to be looked into.", path);
+		} else {
+			int		rows = [ws getRowCount];
+			int		cols = [ws getColCount];
+			// the header is the x of each column...
+			for (int c = 0; c < cols; c++) {
+				fprintf(err, "\t%g", [ws getXValueForCol:c]);
+			}
+			fprintf(err, "\n");
+			// ...and each row starts with its y, from the top down
+			for (int r = (rows - 1); r >= 0; r--) {
+				fprintf(err, "%g", [ws getYValueForRow:r]);
+				for (int c = 0; c < cols; c++) {
+					fprintf(err, "\t%g", [errors getValueAtRow:r andCol:c]);
+				}
+				fprintf(err, "\n");
+			}
+			fclose(err);
+		}
+	}
+}
+
+
 /*!
  This method looks at each of the BaseSimObj instances in the SimObjFactory's
  Inventory, and asks them to map themselves to the SimWorkspace on a linear
@@ -1033,6 +2340,7 @@
 {
 	// drop all the memory we're using
 	[self setWorkspace:nil];
+	[self setSweeps:nil];
 	// ...and don't forget to call the super's dealloc too...
 	[super dealloc];
 }
@@ -0,0 +1,474 @@
+//
+//  PoissonStencil.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+/*
+ * The coefficients of each node's equation are held in separate,
+ * row-major arrays (node = row * cols + col) so that the kernels can
+ * simply stream through them. This is the 'view' of those arrays that
+ * the C-level kernels are handed, and it's the only thing they need to
+ * know about the operator. The corner coefficients are only there for
+ * the 9-point coarse grid operators of the multigrid solver, and are
+ * NULL for the usual 5-point stencil.
+ */
+typedef struct {
+	int			rows;
+	int			cols;
+	double*		center;
+	double*		left;
+	double*		right;
+	double*		top;
+	double*		bottom;
+	double*		topLeft;
+	double*		topRight;
+	double*		bottomLeft;
+	double*		bottomRight;
+	BOOL*		fixed;
+} StencilArrays;
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class PoissonStencil
+ This class is the matrix-free form of the system of equations that the
+ SimWorkspace solves. Rather than assembling the banded matrix, we hold
+ the 5-point stencil coefficients for every node - with the mirror
+ (symmetry) conditions at the edges of the workspace already folded in,
+ and the fixed-voltage nodes as simple identity rows - and then the
+ solvers can apply the operator, compute residuals and relax the nodes
+ without ever needing more than a handful of doubles per node.
+
+ For the multigrid solver, a stencil can also create the coarse grid
+ version of itself, and move vectors between the two grids. These
+ coarse operators are 9-point stencils, but everything else about them
+ is the same.
+
+ The operator is div(er grad V) = -rho, with the dielectric constant
+ on each face between two nodes being the harmonic mean of theirs, so
+ that the normal component of D is continuous across an interface. In
+ a uniform dielectric that's just the Laplacian times er, and the sign
+ convention is that of the original banded assembly in the workspace:
+ the diagonal is -2er(1/hx^2 + 1/hy^2) and the RHS is -rho.
+
+ A stencil can also be axisymmetric, where the columns are the radius
+ and the rows the axis of a body of revolution, and then the operator
+ is the cylindrical (1/r) d/dr(r er dV/dr) + d/dz(er dV/dz) instead.
+
+ The edges of the grid are mirrors - no field crosses them - unless the
+ stencil has an open boundary, and then they're the Robin condition
+ dV/dn = -(d.n/|d|^2) V, where 'd' is from the center of the objects to
+ the node. That's exact for a potential that falls off radially from
+ the center as 1/|d|, and only an approximation for anything else, but
+ it lets the field out of a workspace a few times the size of what's in
+ it.
+ */
+@interface PoissonStencil : NSObject {
+	@private
+	StencilArrays	_arrays;
+	double*			_colSpacing;
+	double*			_rowSpacing;
+	double*			_rhs;
+	double*			_dielectric;
+	BOOL			_axisymmetric;
+	double			_innerRadius;
+	BOOL			_openBoundary;
+	double			_centerX;
+	double			_centerY;
+}
+
+//----------------------------------------------------------------------------
+//               Kernel Selection Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called when the class is initialized, and we take the
+ opportunity to see if the CPU has the vector units for the vector
+ kernels, and if so, turn them on. The tiles of those kernels, and the
+ temporal blocking of the relaxation, are also sized to the L2 cache
+ of the machine.
+ */
++ (void) initialize;
+
+/*!
+ This method returns YES if the CPU this is running on has the vector
+ units that the vector kernels need - AVX2 and FMA on Intel, and NEON,
+ which all of Apple Silicon has.
+ */
++ (BOOL) hasVectorKernels;
+
+/*!
+ This method sets whether all the stencils use the vector kernels for
+ the multiply and residual - but only if the CPU has the vector units
+ for them. Otherwise, it's the scalar kernels regardless.
+ */
++ (void) setVectorKernels:(BOOL)flag;
+
+/*!
+ This method returns YES if the stencils are using the vector kernels
+ for the multiply and residual.
+ */
++ (BOOL) usesVectorKernels;
+
+/*!
+ This method is a microbenchmark of the kernels. It makes a stencil of
+ the given size - a capacitor with a point charge between the plates -
+ and times the multiply and residual, with both the scalar and vector
+ kernels, as well as the scalar relaxation. For each one it logs the
+ memory bandwidth and the floating point rate, counting the bytes of
+ the arrays each node has to read and write, and the flops it takes.
+ Then it logs the sweeps per second of the relaxation done the plain
+ way and with the temporal blocking of -relax:forRHS:withOmega:sweeps:.
+ The kernel selection is left just as it was.
+ */
++ (void) benchmarkKernelsWithRows:(int)rows andCols:(int)cols;
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method gets the number of rows (y-dimension) in the grid that
+ this stencil covers.
+ */
+- (int) getRowCount;
+
+/*!
+ This method gets the number of columns (x-dimension) in the grid that
+ this stencil covers.
+ */
+- (int) getColCount;
+
+/*!
+ This method gets the total number of nodes - rows * cols - in the
+ grid, which is also the length of every vector that's handed to the
+ kernels of this stencil.
+ */
+- (int) getNodeCount;
+
+/*!
+ This method sets the real-space distance between the nodes in the
+ x and y directions for a uniform grid. This needs to be done before
+ -assemble is called as it's the spacing that determines the
+ coefficients of the stencil.
+ */
+- (void) setDeltaX:(double)hx andDeltaY:(double)hy;
+
+/*!
+ This method returns the array of distances between adjacent columns
+ of nodes - element 'c' is the distance from column 'c' to column
+ 'c+1'. The grid is uniform unless the caller changes these, which is
+ what the coarse stencils of the multigrid solver need to do.
+ */
+- (double*) getColSpacing;
+
+/*!
+ This method returns the array of distances between adjacent rows of
+ nodes - element 'r' is the distance from row 'r' to row 'r+1'. As
+ with the columns, the caller is free to change these before calling
+ -assemble.
+ */
+- (double*) getRowSpacing;
+
+/*!
+ This method fills in the lengths of the axis that each column and row
+ of nodes covers - half the interval on either side, and just the one
+ half at the edges. The product wx[c]*wy[r] is the area of the node's
+ cell, and scaling each 5-point row by it - and flipping the sign -
+ makes the operator on the free nodes symmetric and positive definite,
+ which is what the conjugate gradient and Cholesky solvers need. On an
+ axisymmetric grid wx[c] is the integral of r over the column's cell,
+ so that the product is the volume of the node's ring (over 2pi).
+ */
+- (void) getColWeights:(double*)wx andRowWeights:(double*)wy;
+
+/*!
+ This method sets whether the grid is the (r, z) half-plane of a body
+ of revolution - with the columns running out from the axis and the
+ rows along it - and how far from the axis the first column is. If
+ the first column is on the axis, that edge has the r = 0 symmetry
+ condition. Like the spacing, this needs to be done before -assemble
+ is called.
+ */
+- (void) setAxisymmetric:(BOOL)flag withInnerRadius:(double)r0;
+
+/*!
+ This method returns YES if this stencil is the cylindrical operator
+ of an axisymmetric grid, and not the planar one.
+ */
+- (BOOL) isAxisymmetric;
+
+/*!
+ This method returns the distance of the first column of nodes from
+ the axis of an axisymmetric grid. It means nothing for a planar one.
+ */
+- (double) getInnerRadius;
+
+/*!
+ This method sets whether the edges of the grid are open - with the
+ Robin condition that lets the field out as if the potential fell off
+ as 1/|d| from the point (x0, y0) - or the mirrors they are by default.
+ The point is measured from the first node of the grid, along the rows
+ and columns, so on an axisymmetric grid the axis is at x0 = -r0. Like
+ the spacing, this needs to be done before -assemble is called.
+ */
+- (void) setOpenBoundary:(BOOL)flag withCenterX:(double)x0 andY:(double)y0;
+
+/*!
+ This method returns YES if the edges of the grid have the open
+ boundary condition, and not the mirror one.
+ */
+- (BOOL) hasOpenBoundary;
+
+/*!
+ This method returns the C-level view of the coefficient arrays so
+ that the solvers can run their own kernels over the operator. The
+ arrays are owned by this instance, so don't free them.
+ */
+- (StencilArrays*) getArrays;
+
+/*!
+ This method returns the row-major array of flags that indicate which
+ nodes are held at a fixed potential. The caller is free to set these
+ values prior to calling -assemble, which is really the point.
+ */
+- (BOOL*) getFixedMask;
+
+/*!
+ This method returns the row-major RHS vector for this stencil. For
+ the fixed nodes this is the fixed potential, and for all others it's
+ the -rho source term, as the dielectric constant is in the operator.
+ It's owned by this instance, but the caller is free to fill it as
+ needed.
+ */
+- (double*) getRHS;
+
+/*!
+ This method returns the row-major array of the relative dielectric
+ constants of the nodes. Like the fixed node mask, the caller is free
+ to set these prior to calling -assemble, and anything that's not more
+ than zero - which is how they start out - is taken as 1.0, so if they
+ aren't set at all, the operator is just the Laplacian.
+ */
+- (double*) getDielectric;
+
+/*!
+ This method returns YES if the node at row 'r' and column 'c' is held
+ at a fixed potential. This is a simple convenience method as the mask
+ itself is available for the speed-sensitive code.
+ */
+- (BOOL) isFixedAtRow:(int)r andCol:(int)c;
+
+/*!
+ This method returns YES if this stencil has the corner coefficients
+ of a 9-point stencil, which is only the case for the coarse grids that
+ are created for the multigrid solver.
+ */
+- (BOOL) hasCorners;
+
+/*!
+ This method returns YES if the other stencil has exactly the same
+ operator as this one - the same grid, the same fixed nodes and the
+ same coefficients - regardless of the RHS. That's what a solver needs
+ to know to reuse anything it's built from the operator alone.
+ */
+- (BOOL) hasSameOperatorAs:(PoissonStencil*)other;
+
+/*!
+ This method compares the operator of this stencil to the other one,
+ row by row, and places the index of each row that's different - in
+ the fixed node or any of the coefficients - in 'list', returning how
+ many there are. If there are more than 'max' of them, or the grids
+ aren't the same shape, this returns -1 as the two aren't close enough
+ to be worth comparing.
+ */
+- (int) getRowsDifferingFrom:(PoissonStencil*)other into:(int*)list max:(int)max;
+
+//----------------------------------------------------------------------------
+//               Initialization Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method allocates all the coefficient arrays, the fixed node mask
+ and the RHS vector for a grid of the given size. Everything is cleared
+ to zero, so the caller needs to set the spacing and the fixed nodes and
+ then call -assemble to have a useful operator.
+ */
+- (id) initWithRows:(int)rowCnt andCols:(int)colCnt;
+
+/*!
+ This method allocates all the storage for a grid of the given size,
+ and if 'corners' is YES, the storage for the four corner coefficients
+ of a 9-point stencil as well. Everything is cleared to zero, just like
+ the 5-point version.
+ */
+- (id) initWithRows:(int)rowCnt andCols:(int)colCnt withCorners:(BOOL)corners;
+
+/*!
+ This method drops all the storage that this instance has allocated,
+ and is used in the dealloc method as well as the init method to make
+ sure that we're not leaking anything.
+ */
+- (void) freeAllStorage;
+
+//----------------------------------------------------------------------------
+//               Assembly Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method takes the current spacing, dielectric constants and fixed
+ node mask and builds up the 5-point stencil for every node. Fixed
+ nodes become identity rows, and the edges of the grid use the same
+ mirror conditions as the original banded assembly - the missing
+ neighbor is simply added to the one on the other side of the node,
+ with that node's dielectric constant as well. If the spacing isn't
+ uniform the usual three-point second difference for unequal intervals
+ is used, which reduces to the original stencil on a uniform grid. Each
+ coefficient is then scaled by the dielectric constant of its face.
+ On an axisymmetric grid the radial part is the flux through the inner
+ and outer faces of each node's ring over its volume. At the edges the
+ ring just stops at the node, which is the same as the mirror in the
+ planar case, and on the axis it's the r = 0 symmetry condition - the
+ 4/h^2 to the next column that the limit of the cylindrical Laplacian
+ has there. If the stencil has an open boundary, the Robin term of
+ each edge node is then taken off its diagonal.
+ */
+- (void) assemble;
+
+/*!
+ This method creates the next coarser stencil for the multigrid solver.
+ The coarse grid takes every other node in each direction - and always
+ the last one, so an odd count of intervals leaves a short one at the
+ far edge - unless the cells are long and thin, in which case only the
+ short side is coarsened. A coarse node is fixed if the fine node it
+ sits on is fixed, and the coarse operator is the Galerkin product of
+ the restriction, this operator and the interpolation, so that the
+ conductors that fall between the coarse nodes are still felt on the
+ coarse grid. The returned stencil is autoreleased.
+ */
+- (PoissonStencil*) createCoarseStencil;
+
+/*!
+ This method moves the residual 'r' on this grid to the RHS 'b' of the
+ coarse grid correction equation on the 'coarse' stencil that was made
+ from this one. It's full weighting on a uniform grid, and the fixed
+ nodes of the coarse grid have a zero RHS as their correction is zero.
+ */
+- (void) restrictResidual:(double*)r toCoarse:(PoissonStencil*)coarse into:(double*)b;
+
+/*!
+ This method interpolates the correction 'xc' on the 'coarse' stencil
+ that was made from this one, and adds it to 'x' on this grid for all
+ the nodes that aren't fixed.
+ */
+- (void) addCorrection:(double*)xc fromCoarse:(PoissonStencil*)coarse into:(double*)x;
+
+/*!
+ This method creates a stencil for the block of this grid that starts
+ at row 'r0' and column 'c0' and is 'rowCnt' by 'colCnt' nodes, for the
+ domain decomposition solvers. The operator of each node in the block
+ is copied just as it is, except for the nodes on the edges of the
+ block that aren't on the edges of this grid - those are held fixed, as
+ that's where the potentials of the neighboring blocks come in. The
+ RHS is copied as well, so only those edges need to be filled in
+ before each solve. The returned stencil is autoreleased.
+ */
+- (PoissonStencil*) createBlockAtRow:(int)r0 andCol:(int)c0 withRows:(int)rowCnt andCols:(int)colCnt;
+
+//----------------------------------------------------------------------------
+//               Kernel Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method applies the operator to the vector 'x' and places the
+ result in 'y'. Both need to be getNodeCount long, and can't be the
+ same vector.
+ */
+- (void) multiply:(double*)x into:(double*)y;
+
+/*!
+ This method applies just the row of the operator for node 'ij' - in
+ row-major order - to the vector 'x', and returns the result. That's
+ one element of what -multiply:into: would compute.
+ */
+- (double) multiplyRow:(int)ij by:(double*)x;
+
+/*!
+ This method computes the residual r = b - Ax for the given 'x' and
+ 'b' and places it in 'r', returning the 2-norm of that residual as
+ a convenience to the iterative solvers.
+ */
+- (double) residualOf:(double*)x forRHS:(double*)b into:(double*)r;
+
+/*!
+ This method does one red-black ordered SOR sweep over the grid with
+ the relaxation factor 'omega' - omega = 1 is just Gauss-Seidel. The
+ fixed nodes are simply set to their RHS values. For a 9-point stencil
+ the nodes of one color aren't independent, so this is still a proper
+ sweep, but only when it's done serially.
+ */
+- (void) relax:(double*)x forRHS:(double*)b withOmega:(double)omega;
+
+/*!
+ This method computes the residual r = b - Ax just like -residualOf:
+ forRHS:into: but splits the rows up across all the cores of the
+ machine. It returns the 2-norm of the residual.
+ */
+- (double) residualConcurrentlyOf:(double*)x forRHS:(double*)b into:(double*)r;
+
+/*!
+ This method does one red-black ordered SOR sweep over the grid, just
+ like -relax:forRHS:withOmega:, but with the rows of each color split
+ up across all the cores of the machine. That's only safe for the
+ 5-point stencil, so a 9-point one is relaxed serially. It returns the
+ 2-norm of the change in 'x' so the caller can see how fast it's going.
+ */
+- (double) relaxConcurrently:(double*)x forRHS:(double*)b withOmega:(double)omega;
+
+/*!
+ This method does 'sweeps' red-black ordered SOR sweeps over the grid,
+ just like calling -relaxConcurrently:forRHS:withOmega: that many times,
+ but when the grid is too big for the L2 cache, it does several sweeps
+ on each pass over it. Each core takes a band of rows and relaxes them
+ as a wavefront - each sweep a row behind the last - so every row is
+ relaxed several times before it leaves the cache, and then the rows
+ at the edges between the bands are finished up. On a grid that fits
+ in the cache, or a 9-point stencil, it's just the plain sweeps. It
+ returns the 2-norm of the change in 'x' in the last sweep.
+ */
+- (double) relax:(double*)x forRHS:(double*)b withOmega:(double)omega sweeps:(int)sweeps;
+
+//----------------------------------------------------------------------------
+//               NSObject Overridden Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called by the runtime when the released object is about
+ to get cleaned up. This gives us an opportunity to clean up all the
+ memory we're using at the time and be a good citizen.
+ */
+- (void) dealloc;
+
+@end
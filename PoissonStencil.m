@@ -0,0 +1,1940 @@
+//
+//  PoissonStencil.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <dispatch/dispatch.h>
+
+// System Headers
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sysctl.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+/*
+ * The coarse grid for the multigrid solver keeps every other node along
+ * an axis, and always the last one, so that the coarse grid covers the
+ * same extent as the fine one regardless of the node count. These map
+ * between the fine and coarse node indexes along an axis of 'n' nodes.
+ */
+#define	COARSE_COUNT(n)			((n)/2 + 1)
+#define	FINE_INDEX(k, n)		MIN(2*(k), (n) - 1)
+#define	COARSE_INDEX(i, n)		(((i) == ((n) - 1)) ? ((n)/2) : ((i)/2))
+/*
+ * When the kernels are run concurrently, the rows are split up into
+ * 'chunks' nearly equal bands, and this is the first row of band 'k'.
+ */
+#define	CHUNK_START(k, chunks, rows)	((int)(((size_t)(k) * (rows)) / (chunks)))
+/*
+ * The vector kernels do the rows in tiles of columns sized to the L2
+ * cache, and if the machine won't tell us how big that is, we assume
+ * this. A tile is never narrower than the minimum, though.
+ */
+#define	DEFAULT_L2_CACHE_SIZE			(256 * 1024)
+#define	MIN_VECTOR_TILE_COLS			64
+/*
+ * The microbenchmark runs each kernel until it's taken at least this
+ * many seconds so that the timer resolution doesn't matter.
+ */
+#define	MIN_BENCHMARK_TIME				0.25
+#define	BENCHMARK_SWEEPS				8
+/*
+ * Each row of the relaxation reads the five coefficients, the RHS and
+ * 'x' - and the fixed mask - so this is how many bytes a row of nodes
+ * takes in the cache when it's being relaxed.
+ */
+#define	RELAX_BYTES_PER_NODE			(7 * sizeof(double) + sizeof(BOOL))
+
+/*
+ * These are the class-wide settings for the kernels - whether to use the
+ * vector ones, how many columns to put in each tile of them, and how big
+ * the L2 cache is for the temporal blocking of the relaxation. They are
+ * set up in +initialize from what the CPU can do.
+ */
+static BOOL			vectorKernels = NO;
+static int			vectorTileCols = 4096;
+static long long	cacheSize = DEFAULT_L2_CACHE_SIZE;
+
+
+/*
+ * This is the dielectric constant of the face between the free node 'ij'
+ * and its neighbor 'kl' - the harmonic mean of the two, which is what
+ * keeps the flux across the face the same from either side. A fixed
+ * neighbor is a conductor, and it's the free node's dielectric that
+ * fills the space between them. Anything that isn't set is taken to be
+ * the vacuum, just as the original source term did.
+ */
+static double faceDielectric(const double* er, const BOOL* fixed, size_t ij, size_t kl)
+{
+	double		a = (er[ij] > 0.0) ? er[ij] : 1.0;
+	double		b = (er[kl] > 0.0) ? er[kl] : 1.0;
+	return (fixed[kl] || (a == b)) ? a : (2.0 * a * b)/(a + b);
+}
+
+
+/*
+ * This is the Robin coefficient of an open edge whose outward normal is
+ * 'dn' along the vector from the center of the objects to the node, of
+ * squared length 'd2'. The edges that face back towards the center -
+ * which only happens if it's outside the grid - are left as mirrors.
+ */
+static double openEdge(double dn, double d2)
+{
+	return ((dn > 0.0) && (d2 > 0.0)) ? dn/d2 : 0.0;
+}
+
+
+/*
+ * These are the C-level kernels for the stencil. They work on a range
+ * of rows [rlo, rhi) so that the callers can split the grid up across
+ * threads if they wish, and they only need the StencilArrays to do
+ * their work. The relaxation returns the sum of the squares of the
+ * changes it made so that the iterative solvers can watch how fast
+ * they're converging. The multiply is also there for a single node, as
+ * that's all the low-rank updates of the banded factorization need.
+ */
+static void stencilMultiply(const StencilArrays* a, const double* x, double* y, int rlo, int rhi)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	BOOL		corners = (a->topLeft != NULL);
+	for (int r = rlo; r < rhi; r++) {
+		size_t			o = (size_t)r * cols;
+		const double*	xr = x + o;
+		const double*	xt = (r > 0) ? (xr - cols) : NULL;
+		const double*	xb = (r < (rows - 1)) ? (xr + cols) : NULL;
+		for (int c = 0; c < cols; c++) {
+			double		s = a->center[o + c] * xr[c];
+			if (c > 0) {
+				s += a->left[o + c] * xr[c - 1];
+			}
+			if (c < (cols - 1)) {
+				s += a->right[o + c] * xr[c + 1];
+			}
+			if (xt != NULL) {
+				s += a->top[o + c] * xt[c];
+			}
+			if (xb != NULL) {
+				s += a->bottom[o + c] * xb[c];
+			}
+			if (corners) {
+				if ((xt != NULL) && (c > 0)) {
+					s += a->topLeft[o + c] * xt[c - 1];
+				}
+				if ((xt != NULL) && (c < (cols - 1))) {
+					s += a->topRight[o + c] * xt[c + 1];
+				}
+				if ((xb != NULL) && (c > 0)) {
+					s += a->bottomLeft[o + c] * xb[c - 1];
+				}
+				if ((xb != NULL) && (c < (cols - 1))) {
+					s += a->bottomRight[o + c] * xb[c + 1];
+				}
+			}
+			y[o + c] = s;
+		}
+	}
+}
+
+static double stencilMultiplyNode(const StencilArrays* a, const double* x, int r, int c)
+{
+	int				rows = a->rows;
+	int				cols = a->cols;
+	size_t			ij = (size_t)r * cols + c;
+	double			s = a->center[ij] * x[ij];
+	if (c > 0) {
+		s += a->left[ij] * x[ij - 1];
+	}
+	if (c < (cols - 1)) {
+		s += a->right[ij] * x[ij + 1];
+	}
+	if (r > 0) {
+		s += a->top[ij] * x[ij - cols];
+	}
+	if (r < (rows - 1)) {
+		s += a->bottom[ij] * x[ij + cols];
+	}
+	if (a->topLeft != NULL) {
+		if ((r > 0) && (c > 0)) {
+			s += a->topLeft[ij] * x[ij - cols - 1];
+		}
+		if ((r > 0) && (c < (cols - 1))) {
+			s += a->topRight[ij] * x[ij - cols + 1];
+		}
+		if ((r < (rows - 1)) && (c > 0)) {
+			s += a->bottomLeft[ij] * x[ij + cols - 1];
+		}
+		if ((r < (rows - 1)) && (c < (cols - 1))) {
+			s += a->bottomRight[ij] * x[ij + cols + 1];
+		}
+	}
+	return s;
+}
+
+
+
+static double stencilResidual(const StencilArrays* a, const double* x, const double* b, double* res, int rlo, int rhi)
+{
+	double		sum = 0.0;
+	stencilMultiply(a, x, res, rlo, rhi);
+	size_t		lo = (size_t)rlo * a->cols;
+	size_t		hi = (size_t)rhi * a->cols;
+	for (size_t i = lo; i < hi; i++) {
+		res[i] = b[i] - res[i];
+		sum += res[i] * res[i];
+	}
+	return sum;
+}
+
+
+static double stencilRelaxColor(const StencilArrays* a, double* x, const double* b, double omega, int color, int rlo, int rhi)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	BOOL		corners = (a->topLeft != NULL);
+	double		change = 0.0;
+	for (int r = rlo; r < rhi; r++) {
+		size_t			o = (size_t)r * cols;
+		double*			xr = x + o;
+		const double*	xt = (r > 0) ? (xr - cols) : NULL;
+		const double*	xb = (r < (rows - 1)) ? (xr + cols) : NULL;
+		for (int c = ((r + color) & 1); c < cols; c += 2) {
+			if (a->fixed[o + c]) {
+				change += (b[o + c] - xr[c]) * (b[o + c] - xr[c]);
+				xr[c] = b[o + c];
+				continue;
+			}
+			double		s = b[o + c];
+			if (c > 0) {
+				s -= a->left[o + c] * xr[c - 1];
+			}
+			if (c < (cols - 1)) {
+				s -= a->right[o + c] * xr[c + 1];
+			}
+			if (xt != NULL) {
+				s -= a->top[o + c] * xt[c];
+			}
+			if (xb != NULL) {
+				s -= a->bottom[o + c] * xb[c];
+			}
+			if (corners) {
+				if ((xt != NULL) && (c > 0)) {
+					s -= a->topLeft[o + c] * xt[c - 1];
+				}
+				if ((xt != NULL) && (c < (cols - 1))) {
+					s -= a->topRight[o + c] * xt[c + 1];
+				}
+				if ((xb != NULL) && (c > 0)) {
+					s -= a->bottomLeft[o + c] * xb[c - 1];
+				}
+				if ((xb != NULL) && (c < (cols - 1))) {
+					s -= a->bottomRight[o + c] * xb[c + 1];
+				}
+			}
+			double		dx = omega * (s / a->center[o + c] - xr[c]);
+			xr[c] += dx;
+			change += dx * dx;
+		}
+	}
+	return change;
+}
+
+
+/*
+ * These are the vector versions of the multiply and residual kernels
+ * for the 5-point stencil. They do four nodes of a row at a time with
+ * the compiler's generic vector types - AVX2 and FMA on Intel, and NEON
+ * on Apple Silicon - and leave the first and last rows and columns,
+ * where the neighbors are missing, to the scalar kernels. The fixed
+ * nodes are identity rows in the arrays, so they need no special
+ * handling here. The rows are done in tiles of columns so that the
+ * rows of 'x' a tile needs are still in the L2 cache when the next row
+ * comes around, which only matters on the widest of grids.
+ */
+typedef double	vdouble __attribute__((vector_size(4 * sizeof(double))));
+
+#if defined(__x86_64__)
+#define	VECTOR_TARGET	__attribute__((target("avx2,fma")))
+#else
+#define	VECTOR_TARGET
+#endif
+
+VECTOR_TARGET
+static inline vdouble vload(const double* p)
+{
+	vdouble		v;
+	memcpy(&v, p, sizeof(vdouble));
+	return v;
+}
+
+VECTOR_TARGET
+static inline void vstore(double* p, vdouble v)
+{
+	memcpy(p, &v, sizeof(vdouble));
+}
+
+
+/*
+ * This does the rows [rlo, rhi) but only the columns [1, cols-1). If
+ * 'b' is NULL it's the multiply, and 'res' gets Ax, otherwise it's the
+ * residual b - Ax. The sum of the squares of what's in 'res' is
+ * returned either way.
+ */
+VECTOR_TARGET
+static double vectorResidualRows(const StencilArrays* a, const double* x, const double* b, double* res, int rlo, int rhi, int tile)
+{
+	int			cols = a->cols;
+	int			last = cols - 1;
+	vdouble		sum = { 0.0, 0.0, 0.0, 0.0 };
+	for (int t = 1; t < last; t += tile) {
+		int			tend = MIN(t + tile, last);
+		for (int r = rlo; r < rhi; r++) {
+			size_t			o = (size_t)r * cols;
+			const double*	xr = x + o;
+			int				c = t;
+			for (; (c + 4) <= tend; c += 4) {
+				vdouble		d = vload(a->center + o + c) * vload(xr + c) +
+								vload(a->left + o + c) * vload(xr + c - 1) +
+								vload(a->right + o + c) * vload(xr + c + 1) +
+								vload(a->top + o + c) * vload(xr + c - cols) +
+								vload(a->bottom + o + c) * vload(xr + c + cols);
+				if (b != NULL) {
+					d = vload(b + o + c) - d;
+				}
+				vstore(res + o + c, d);
+				sum += d * d;
+			}
+			for (; c < tend; c++) {
+				double		d = a->center[o + c] * xr[c] + a->left[o + c] * xr[c - 1] +
+								a->right[o + c] * xr[c + 1] + a->top[o + c] * xr[c - cols] +
+								a->bottom[o + c] * xr[c + cols];
+				if (b != NULL) {
+					d = b[o + c] - d;
+				}
+				res[o + c] = d;
+				sum[0] += d * d;
+			}
+		}
+	}
+	return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+
+/*
+ * These pick the vector or scalar kernel for a range of rows. The vector
+ * ones are only for the 5-point stencil on a grid big enough to have an
+ * inside to it, and the scalar ones still do the edges. The relaxation
+ * stays scalar - every other node of a row doesn't fill a vector without
+ * shuffling, and measured, that was slower than the scalar loop.
+ */
+static BOOL useVectorKernels(const StencilArrays* a)
+{
+	return vectorKernels && (a->topLeft == NULL) && (a->rows >= 3) && (a->cols >= 6);
+}
+
+
+static void kernelMultiply(const StencilArrays* a, const double* x, double* y, int rlo, int rhi)
+{
+	if (!useVectorKernels(a)) {
+		stencilMultiply(a, x, y, rlo, rhi);
+		return;
+	}
+	int			lo = MAX(rlo, 1);
+	int			hi = MIN(rhi, a->rows - 1);
+	if (rlo == 0) {
+		stencilMultiply(a, x, y, 0, 1);
+	}
+	if (rhi == a->rows) {
+		stencilMultiply(a, x, y, a->rows - 1, a->rows);
+	}
+	for (int r = lo; r < hi; r++) {
+		size_t		o = (size_t)r * a->cols;
+		y[o] = stencilMultiplyNode(a, x, r, 0);
+		y[o + a->cols - 1] = stencilMultiplyNode(a, x, r, a->cols - 1);
+	}
+	vectorResidualRows(a, x, NULL, y, lo, hi, vectorTileCols);
+}
+
+
+static double kernelResidual(const StencilArrays* a, const double* x, const double* b, double* res, int rlo, int rhi)
+{
+	if (!useVectorKernels(a)) {
+		return stencilResidual(a, x, b, res, rlo, rhi);
+	}
+	double		sum = 0.0;
+	int			lo = MAX(rlo, 1);
+	int			hi = MIN(rhi, a->rows - 1);
+	if (rlo == 0) {
+		sum += stencilResidual(a, x, b, res, 0, 1);
+	}
+	if (rhi == a->rows) {
+		sum += stencilResidual(a, x, b, res, a->rows - 1, a->rows);
+	}
+	for (int r = lo; r < hi; r++) {
+		size_t		o = (size_t)r * a->cols;
+		size_t		e = o + a->cols - 1;
+		res[o] = b[o] - stencilMultiplyNode(a, x, r, 0);
+		res[e] = b[e] - stencilMultiplyNode(a, x, r, a->cols - 1);
+		sum += res[o] * res[o] + res[e] * res[e];
+	}
+	return sum + vectorResidualRows(a, x, b, res, lo, hi, vectorTileCols);
+}
+
+
+/*
+ * This asks the kernel for an integer setting by name, and returns 0
+ * if there isn't one - which is what a missing CPU feature looks like.
+ */
+static long long sysctlValue(const char* name)
+{
+	long long	value = 0;
+	size_t		len = sizeof(value);
+	if (sysctlbyname(name, &value, &len, NULL, 0) != 0) {
+		return 0;
+	}
+	// some of them are only an int, and that's in the first bytes
+	if (len == sizeof(int)) {
+		int		small = 0;
+		memcpy(&small, &value, sizeof(small));
+		return small;
+	}
+	return value;
+}
+
+
+/*
+ * This is the number of columns for each tile of the vector kernels,
+ * given the size of the L2 cache - the three rows of 'x' a row of the
+ * tile reads have to fit in half of it, leaving the rest for the
+ * coefficients streaming through.
+ */
+static int tileColsForCache(long long l2)
+{
+	if (l2 <= 0) {
+		l2 = DEFAULT_L2_CACHE_SIZE;
+	}
+	return (int)MAX(l2 / (2 * 3 * sizeof(double)), MIN_VECTOR_TILE_COLS);
+}
+
+
+/*
+ * This is the number of bands the rows are split into when the kernels
+ * are run concurrently - one per core, but never more than there are
+ * rows to go around.
+ */
+static int concurrentChunkCount(int rows)
+{
+	NSUInteger		cores = [[NSProcessInfo processInfo] activeProcessorCount];
+	return (int)MAX(MIN(cores, (NSUInteger)rows), (NSUInteger)1);
+}
+
+
+/*
+ * This does 'phases' half-sweeps of the red-black relaxation - red,
+ * black, red, ... - over a region of the rows as a wavefront, so that
+ * every row is relaxed 'phases' times while it's still in the cache.
+ * Half-sweep 'p' trails half-sweep p-1 by one row: its color only
+ * reads the other color in the rows on either side, and those rows
+ * have been done by p-1, and not yet by p+1, when it gets to them. So
+ * this is exactly the same as doing the half-sweeps one after another
+ * over the region.
+ *
+ * The region for half-sweep 'p' is the rows [lo + dlo*p, hi + dhi*p)
+ * on the grid. When the rows are split into bands across the cores,
+ * each band first does a trapezoid - shrinking by a row each half-sweep
+ * at the edges it shares with another band - and then the triangles
+ * that are left at each of those edges are done - starting with just
+ * the edge and growing by a row each half-sweep. The change of the
+ * last red and black half-sweeps is returned, as that's the change of
+ * the last full sweep.
+ */
+static double relaxWavefront(const StencilArrays* a, double* x, const double* b, double omega, int phases, int lo, int dlo, int hi, int dhi)
+{
+	double		change = 0.0;
+	int			first = MAX(MIN(lo, lo + dlo * (phases - 1)), 0);
+	int			last = MIN(MAX(hi, hi + dhi * (phases - 1)), a->rows);
+	for (int t = first; t < (last + phases - 1); t++) {
+		for (int p = 0; p < phases; p++) {
+			int		r = t - p;
+			if ((r >= MAX(lo + dlo * p, 0)) && (r < MIN(hi + dhi * p, a->rows))) {
+				double		dx = stencilRelaxColor(a, x, b, omega, (p & 1), r, r + 1);
+				if (p >= (phases - 2)) {
+					change += dx;
+				}
+			}
+		}
+	}
+	return change;
+}
+
+
+/*
+ * This is how many sweeps the wavefront can do on each pass over the
+ * grid, and still have all the rows it's working on - two for each
+ * sweep, and one more on either side - fit in half of the L2 cache.
+ * If that's fewer than two, there's no point in the blocking at all.
+ */
+static int temporalBlockDepth(const StencilArrays* a)
+{
+	long long	rowBytes = (long long)a->cols * RELAX_BYTES_PER_NODE;
+	long long	rowsInCache = (cacheSize / 2) / rowBytes;
+	return (int)MAX((rowsInCache - 2) / 2, 0);
+}
+
+
+/*
+ * These are the one-dimensional interpolation weights along an axis of
+ * 'n' fine nodes with the intervals 'd' between them. A fine node that
+ * sits on a coarse node just takes its value, and the others are the
+ * linear interpolation of the coarse nodes on either side. If the axis
+ * wasn't 'coarsened' at all, it's simply the identity. The coarse
+ * node indexes go in 'k' and the weights in 'w', and the count of them
+ * is returned.
+ */
+static int interpolationWeights(const double* d, int n, BOOL coarsened, int i, int* k, double* w)
+{
+	if (!coarsened) {
+		k[0] = i;
+		w[0] = 1.0;
+		return 1;
+	}
+	if ((i == (n - 1)) || ((i & 1) == 0)) {
+		k[0] = COARSE_INDEX(i, n);
+		w[0] = 1.0;
+		return 1;
+	}
+	k[0] = i/2;
+	k[1] = i/2 + 1;
+	w[0] = d[i]/(d[i - 1] + d[i]);
+	w[1] = d[i - 1]/(d[i - 1] + d[i]);
+	return 2;
+}
+
+
+/*
+ * The restriction weights for coarse node 'k' are the transpose of the
+ * interpolation, with each fine node weighted by the length of the axis
+ * it covers, and then normalized. On a uniform grid this is the usual
+ * 1/4, 1/2, 1/4 full weighting, and at the edges it's what the mirror
+ * conditions would give. The fine node indexes go in 'j' and the
+ * weights in 'w', and the count of them is returned.
+ */
+static int restrictionWeights(const double* d, int n, BOOL coarsened, int k, int* j, double* w)
+{
+	int			cnt = 0;
+	double		sum = 0.0;
+	if (!coarsened) {
+		j[0] = k;
+		w[0] = 1.0;
+		return 1;
+	}
+	int			f = FINE_INDEX(k, n);
+	for (int i = MAX(f - 1, 0); i <= MIN(f + 1, n - 1); i++) {
+		int			pk[2];
+		double		pw[2];
+		int			pc = interpolationWeights(d, n, coarsened, i, pk, pw);
+		for (int p = 0; p < pc; p++) {
+			if (pk[p] == k) {
+				double		len = 0.5*((i > 0 ? d[i - 1] : 0.0) + (i < (n - 1) ? d[i] : 0.0));
+				j[cnt] = i;
+				w[cnt] = pw[p] * len;
+				sum += w[cnt];
+				cnt++;
+			}
+		}
+	}
+	for (int p = 0; p < cnt; p++) {
+		w[p] /= sum;
+	}
+	return cnt;
+}
+
+
+/*
+ * On an axisymmetric grid, the cell of the node in column 'c' - at the
+ * radius 'r' - runs out to halfway to the columns on either side, or to
+ * just the node itself at the edges. Those inner and outer radii go in
+ * 'lo' and 'hi', and the integral of r over the cell - the volume of
+ * the ring over 2pi, per unit of length along the axis - is returned.
+ */
+static double radialCell(const double* h, int cols, int c, double r, double* lo, double* hi)
+{
+	*lo = (c > 0) ? r - 0.5*h[c - 1] : r;
+	*hi = (c < (cols - 1)) ? r + 0.5*h[c] : r;
+	return 0.5*((*hi) * (*hi) - (*lo) * (*lo));
+}
+
+
+/*!
+ @class PoissonStencil
+ This class is the matrix-free form of the system of equations that the
+ SimWorkspace solves. Rather than assembling the banded matrix, we hold
+ the 5-point stencil coefficients for every node - with the mirror
+ (symmetry) conditions at the edges of the workspace already folded in,
+ and the fixed-voltage nodes as simple identity rows - and then the
+ solvers can apply the operator, compute residuals and relax the nodes
+ without ever needing more than a handful of doubles per node.
+
+ For the multigrid solver, a stencil can also create the coarse grid
+ version of itself, and move vectors between the two grids. These
+ coarse operators are 9-point stencils, but everything else about them
+ is the same.
+
+ The operator is div(er grad V) = -rho, with the dielectric constant
+ on each face between two nodes being the harmonic mean of theirs, so
+ that the normal component of D is continuous across an interface. In
+ a uniform dielectric that's just the Laplacian times er, and the sign
+ convention is that of the original banded assembly in the workspace:
+ the diagonal is -2er(1/hx^2 + 1/hy^2) and the RHS is -rho.
+
+ A stencil can also be axisymmetric, where the columns are the radius
+ and the rows the axis of a body of revolution, and then the operator
+ is the cylindrical (1/r) d/dr(r er dV/dr) + d/dz(er dV/dz) instead.
+
+ The edges of the grid are mirrors - no field crosses them - unless the
+ stencil has an open boundary, and then they're the Robin condition
+ dV/dn = -(d.n/|d|^2) V, where 'd' is from the center of the objects to
+ the node. That's exact for a potential that falls off radially from
+ the center as 1/|d|, and only an approximation for anything else, but
+ it lets the field out of a workspace a few times the size of what's in
+ it.
+ */
+@implementation PoissonStencil
+
+//----------------------------------------------------------------------------
+//               Kernel Selection Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called when the class is initialized, and we take the
+ opportunity to see if the CPU has the vector units for the vector
+ kernels, and if so, turn them on. The tiles of those kernels, and the
+ temporal blocking of the relaxation, are also sized to the L2 cache
+ of the machine.
+ */
++ (void) initialize
+{
+	/*
+	 * Because it's possible that subclasses will implement this
+	 * method as well, we need to make sure that we're only doing
+	 * the initialization for *this* class and not all other
+	 * subclasses.
+	 */
+	if (self == [PoissonStencil class]) {
+		vectorKernels = [PoissonStencil hasVectorKernels];
+		long long	l2 = sysctlValue("hw.l2cachesize");
+		if (l2 > 0) {
+			cacheSize = l2;
+		}
+		vectorTileCols = tileColsForCache(cacheSize);
+	}
+}
+
+
+/*!
+ This method returns YES if the CPU this is running on has the vector
+ units that the vector kernels need - AVX2 and FMA on Intel, and NEON,
+ which all of Apple Silicon has.
+ */
++ (BOOL) hasVectorKernels
+{
+#if defined(__x86_64__)
+	return (sysctlValue("hw.optional.avx2_0") != 0) && (sysctlValue("hw.optional.fma") != 0);
+#elif defined(__arm64__) || defined(__aarch64__)
+	return YES;
+#else
+	return NO;
+#endif
+}
+
+
+/*!
+ This method sets whether all the stencils use the vector kernels for
+ the multiply and residual - but only if the CPU has the vector units
+ for them. Otherwise, it's the scalar kernels regardless.
+ */
++ (void) setVectorKernels:(BOOL)flag
+{
+	vectorKernels = flag && [PoissonStencil hasVectorKernels];
+}
+
+
+/*!
+ This method returns YES if the stencils are using the vector kernels
+ for the multiply and residual.
+ */
++ (BOOL) usesVectorKernels
+{
+	return vectorKernels;
+}
+
+
+/*!
+ This method is a microbenchmark of the kernels. It makes a stencil of
+ the given size - a capacitor with a point charge between the plates -
+ and times the multiply and residual, with both the scalar and vector
+ kernels, as well as the scalar relaxation. For each one it logs the
+ memory bandwidth and the floating point rate, counting the bytes of
+ the arrays each node has to read and write, and the flops it takes.
+ Then it logs the sweeps per second of the relaxation done the plain
+ way and with the temporal blocking of -relax:forRHS:withOmega:sweeps:.
+ The kernel selection is left just as it was.
+ */
++ (void) benchmarkKernelsWithRows:(int)rows andCols:(int)cols
+{
+	BOOL				error = NO;
+	PoissonStencil*		stencil = nil;
+	double*				x = NULL;
+	double*				y = NULL;
+
+	// first, make the stencil and the vectors to work with
+	if (!error) {
+		stencil = [[[PoissonStencil alloc] initWithRows:rows andCols:cols] autorelease];
+		x = (double *) calloc((size_t)rows * cols, sizeof(double));
+		y = (double *) calloc((size_t)rows * cols, sizeof(double));
+		if ((stencil == nil) || (x == NULL) || (y == NULL)) {
+			error = YES;
+			NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - the stencil and vectors for a %dx%d grid could not be made. This is a serious allocation error.", rows, cols);
+		}
+	}
+
+	// now fill it in with the plates and the charge
+	if (!error) {
+		size_t		n = (size_t)rows * cols;
+		BOOL*		fixed = [stencil getFixedMask];
+		double*		rhs = [stencil getRHS];
+		[stencil setDeltaX:1.0 andDeltaY:1.0];
+		for (int c = 0; c < cols; c++) {
+			fixed[c] = YES;
+			rhs[c] = 0.0;
+			fixed[n - cols + c] = YES;
+			rhs[n - cols + c] = 1.0;
+		}
+		rhs[(size_t)(rows/2) * cols + cols/2] = -1.0;
+		[stencil assemble];
+		for (size_t i = 0; i < n; i++) {
+			x[i] = (double)(i % 17) / 17.0;
+		}
+	}
+
+	// ...and time each kernel for as long as it takes to be accurate
+	if (!error) {
+		StencilArrays*	a = [stencil getArrays];
+		double*			b = [stencil getRHS];
+		double			nodes = (double)rows * cols;
+		BOOL			wasVector = vectorKernels;
+		double			(^timePerPass)(void (^)(void)) = ^(void (^pass)(void)) {
+			int					cnt = 0;
+			NSTimeInterval		begin = [NSDate timeIntervalSinceReferenceDate];
+			NSTimeInterval		elapsed = 0.0;
+			while (elapsed < MIN_BENCHMARK_TIME) {
+				pass();
+				cnt++;
+				elapsed = [NSDate timeIntervalSinceReferenceDate] - begin;
+			}
+			return elapsed / cnt;
+		};
+		for (int v = 0; v < 2; v++) {
+			vectorKernels = (v == 1);
+			if (vectorKernels && ![PoissonStencil hasVectorKernels]) {
+				NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - this CPU doesn't have the vector units for the vector kernels.");
+				break;
+			}
+			const char*	name = (vectorKernels ? "vector" : "scalar");
+			double		t = timePerPass(^{ kernelMultiply(a, x, y, 0, rows); });
+			NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - %dx%d %s multiply: %.2f GB/s, %.2f GFLOP/s", rows, cols, name, nodes * 56 / t * 1e-9, nodes * 9 / t * 1e-9);
+			t = timePerPass(^{ kernelResidual(a, x, b, y, 0, rows); });
+			NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - %dx%d %s residual: %.2f GB/s, %.2f GFLOP/s", rows, cols, name, nodes * 64 / t * 1e-9, nodes * 12 / t * 1e-9);
+		}
+		vectorKernels = NO;
+		double			t = timePerPass(^{
+			stencilRelaxColor(a, x, b, 1.0, 0, 0, rows);
+			stencilRelaxColor(a, x, b, 1.0, 1, 0, rows);
+		});
+		NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - %dx%d scalar relax: %.2f GB/s, %.2f GFLOP/s", rows, cols, nodes * 73 / t * 1e-9, nodes * 13 / t * 1e-9);
+		// ...and the plain sweeps against the temporally blocked ones
+		t = timePerPass(^{
+			for (int s = 0; s < BENCHMARK_SWEEPS; s++) {
+				[stencil relaxConcurrently:x forRHS:b withOmega:1.0];
+			}
+		});
+		double			tb = timePerPass(^{
+			[stencil relax:x forRHS:b withOmega:1.0 sweeps:BENCHMARK_SWEEPS];
+		});
+		NSLog(@"[PoissonStencil +benchmarkKernelsWithRows:andCols:] - %dx%d relax: %.1f sweeps/s plain, %.1f sweeps/s temporally blocked %d deep", rows, cols, BENCHMARK_SWEEPS / t, BENCHMARK_SWEEPS / tb, MIN(temporalBlockDepth(a), BENCHMARK_SWEEPS));
+		vectorKernels = wasVector;
+	}
+
+	// clean up what we made
+	if (x != NULL) {
+		free(x);
+	}
+	if (y != NULL) {
+		free(y);
+	}
+}
+
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method gets the number of rows (y-dimension) in the grid that
+ this stencil covers.
+ */
+- (int) getRowCount
+{
+	return _arrays.rows;
+}
+
+
+/*!
+ This method gets the number of columns (x-dimension) in the grid that
+ this stencil covers.
+ */
+- (int) getColCount
+{
+	return _arrays.cols;
+}
+
+
+/*!
+ This method gets the total number of nodes - rows * cols - in the
+ grid, which is also the length of every vector that's handed to the
+ kernels of this stencil.
+ */
+- (int) getNodeCount
+{
+	return _arrays.rows * _arrays.cols;
+}
+
+
+/*!
+ This method sets the real-space distance between the nodes in the
+ x and y directions for a uniform grid. This needs to be done before
+ -assemble is called as it's the spacing that determines the
+ coefficients of the stencil.
+ */
+- (void) setDeltaX:(double)hx andDeltaY:(double)hy
+{
+	for (int c = 0; c < _arrays.cols; c++) {
+		_colSpacing[c] = hx;
+	}
+	for (int r = 0; r < _arrays.rows; r++) {
+		_rowSpacing[r] = hy;
+	}
+}
+
+
+/*!
+ This method returns the array of distances between adjacent columns
+ of nodes - element 'c' is the distance from column 'c' to column
+ 'c+1'. The grid is uniform unless the caller changes these, which is
+ what the coarse stencils of the multigrid solver need to do.
+ */
+- (double*) getColSpacing
+{
+	return _colSpacing;
+}
+
+
+/*!
+ This method returns the array of distances between adjacent rows of
+ nodes - element 'r' is the distance from row 'r' to row 'r+1'. As
+ with the columns, the caller is free to change these before calling
+ -assemble.
+ */
+- (double*) getRowSpacing
+{
+	return _rowSpacing;
+}
+
+
+/*!
+ This method fills in the lengths of the axis that each column and row
+ of nodes covers - half the interval on either side, and just the one
+ half at the edges. The product wx[c]*wy[r] is the area of the node's
+ cell, and scaling each 5-point row by it - and flipping the sign -
+ makes the operator on the free nodes symmetric and positive definite,
+ which is what the conjugate gradient and Cholesky solvers need. On an
+ axisymmetric grid wx[c] is the integral of r over the column's cell,
+ so that the product is the volume of the node's ring (over 2pi).
+ */
+- (void) getColWeights:(double*)wx andRowWeights:(double*)wy
+{
+	int			rows = _arrays.rows;
+	int			cols = _arrays.cols;
+
+	if (_axisymmetric && (cols > 1)) {
+		double		r = _innerRadius;
+		double		lo = 0.0;
+		double		hi = 0.0;
+		for (int c = 0; c < cols; c++) {
+			wx[c] = radialCell(_colSpacing, cols, c, r, &lo, &hi);
+			r += _colSpacing[c];
+		}
+	} else {
+		for (int c = 0; c < cols; c++) {
+			wx[c] = 0.5*((c > 0 ? _colSpacing[c - 1] : 0.0) + (c < (cols - 1) ? _colSpacing[c] : 0.0));
+		}
+	}
+	for (int r = 0; r < rows; r++) {
+		wy[r] = 0.5*((r > 0 ? _rowSpacing[r - 1] : 0.0) + (r < (rows - 1) ? _rowSpacing[r] : 0.0));
+	}
+}
+
+
+/*!
+ This method sets whether the grid is the (r, z) half-plane of a body
+ of revolution - with the columns running out from the axis and the
+ rows along it - and how far from the axis the first column is. If
+ the first column is on the axis, that edge has the r = 0 symmetry
+ condition. Like the spacing, this needs to be done before -assemble
+ is called.
+ */
+- (void) setAxisymmetric:(BOOL)flag withInnerRadius:(double)r0
+{
+	_axisymmetric = flag;
+	_innerRadius = (flag ? MAX(r0, 0.0) : 0.0);
+}
+
+
+/*!
+ This method returns YES if this stencil is the cylindrical operator
+ of an axisymmetric grid, and not the planar one.
+ */
+- (BOOL) isAxisymmetric
+{
+	return _axisymmetric;
+}
+
+
+/*!
+ This method returns the distance of the first column of nodes from
+ the axis of an axisymmetric grid. It means nothing for a planar one.
+ */
+- (double) getInnerRadius
+{
+	return _innerRadius;
+}
+
+
+/*!
+ This method sets whether the edges of the grid are open - with the
+ Robin condition that lets the field out as if the potential fell off
+ as 1/|d| from the point (x0, y0) - or the mirrors they are by default.
+ The point is measured from the first node of the grid, along the rows
+ and columns, so on an axisymmetric grid the axis is at x0 = -r0. Like
+ the spacing, this needs to be done before -assemble is called.
+ */
+- (void) setOpenBoundary:(BOOL)flag withCenterX:(double)x0 andY:(double)y0
+{
+	_openBoundary = flag;
+	_centerX = (flag ? x0 : 0.0);
+	_centerY = (flag ? y0 : 0.0);
+}
+
+
+/*!
+ This method returns YES if the edges of the grid have the open
+ boundary condition, and not the mirror one.
+ */
+- (BOOL) hasOpenBoundary
+{
+	return _openBoundary;
+}
+
+
+/*!
+ This method returns the C-level view of the coefficient arrays so
+ that the solvers can run their own kernels over the operator. The
+ arrays are owned by this instance, so don't free them.
+ */
+- (StencilArrays*) getArrays
+{
+	return &_arrays;
+}
+
+
+/*!
+ This method returns the row-major array of flags that indicate which
+ nodes are held at a fixed potential. The caller is free to set these
+ values prior to calling -assemble, which is really the point.
+ */
+- (BOOL*) getFixedMask
+{
+	return _arrays.fixed;
+}
+
+
+/*!
+ This method returns the row-major RHS vector for this stencil. For
+ the fixed nodes this is the fixed potential, and for all others it's
+ the -rho source term, as the dielectric constant is in the operator.
+ It's owned by this instance, but the caller is free to fill it as
+ needed.
+ */
+- (double*) getRHS
+{
+	return _rhs;
+}
+
+
+/*!
+ This method returns the row-major array of the relative dielectric
+ constants of the nodes. Like the fixed node mask, the caller is free
+ to set these prior to calling -assemble, and anything that's not more
+ than zero - which is how they start out - is taken as 1.0, so if they
+ aren't set at all, the operator is just the Laplacian.
+ */
+- (double*) getDielectric
+{
+	return _dielectric;
+}
+
+
+/*!
+ This method returns YES if the node at row 'r' and column 'c' is held
+ at a fixed potential. This is a simple convenience method as the mask
+ itself is available for the speed-sensitive code.
+ */
+- (BOOL) isFixedAtRow:(int)r andCol:(int)c
+{
+	BOOL		retval = NO;
+	if ((r >= 0) && (r < _arrays.rows) && (c >= 0) && (c < _arrays.cols)) {
+		retval = _arrays.fixed[r * _arrays.cols + c];
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns YES if this stencil has the corner coefficients
+ of a 9-point stencil, which is only the case for the coarse grids that
+ are created for the multigrid solver.
+ */
+- (BOOL) hasCorners
+{
+	return (_arrays.topLeft != NULL);
+}
+
+
+/*!
+ This method returns YES if the other stencil has exactly the same
+ operator as this one - the same grid, the same fixed nodes and the
+ same coefficients - regardless of the RHS. That's what a solver needs
+ to know to reuse anything it's built from the operator alone.
+ */
+- (BOOL) hasSameOperatorAs:(PoissonStencil*)other
+{
+	BOOL				same = YES;
+	StencilArrays*		b = [other getArrays];
+	size_t				n = (size_t)_arrays.rows * _arrays.cols;
+
+	// first, it has to be the same shape
+	if ((other == nil) || (b->rows != _arrays.rows) || (b->cols != _arrays.cols) ||
+		([other hasCorners] != [self hasCorners])) {
+		same = NO;
+	}
+
+	// ...and then every coefficient and fixed node has to match
+	if (same) {
+		same = (memcmp(_arrays.fixed, b->fixed, n * sizeof(BOOL)) == 0) &&
+			   (memcmp(_arrays.center, b->center, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.left, b->left, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.right, b->right, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.top, b->top, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.bottom, b->bottom, n * sizeof(double)) == 0);
+	}
+	if (same && [self hasCorners]) {
+		same = (memcmp(_arrays.topLeft, b->topLeft, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.topRight, b->topRight, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.bottomLeft, b->bottomLeft, n * sizeof(double)) == 0) &&
+			   (memcmp(_arrays.bottomRight, b->bottomRight, n * sizeof(double)) == 0);
+	}
+
+	return same;
+}
+
+/*!
+ This method compares the operator of this stencil to the other one,
+ row by row, and places the index of each row that's different - in
+ the fixed node or any of the coefficients - in 'list', returning how
+ many there are. If there are more than 'max' of them, or the grids
+ aren't the same shape, this returns -1 as the two aren't close enough
+ to be worth comparing.
+ */
+- (int) getRowsDifferingFrom:(PoissonStencil*)other into:(int*)list max:(int)max
+{
+	int					count = 0;
+	StencilArrays*		b = [other getArrays];
+	size_t				n = (size_t)_arrays.rows * _arrays.cols;
+	BOOL				corners = [self hasCorners];
+
+	// first, it has to be the same shape
+	if ((other == nil) || (b->rows != _arrays.rows) || (b->cols != _arrays.cols) ||
+		([other hasCorners] != corners)) {
+		count = -1;
+	}
+
+	// ...and then look for the rows that aren't the same
+	for (size_t i = 0; (count >= 0) && (i < n); i++) {
+		BOOL		same = (_arrays.fixed[i] == b->fixed[i]) &&
+						   (_arrays.center[i] == b->center[i]) &&
+						   (_arrays.left[i] == b->left[i]) &&
+						   (_arrays.right[i] == b->right[i]) &&
+						   (_arrays.top[i] == b->top[i]) &&
+						   (_arrays.bottom[i] == b->bottom[i]);
+		if (same && corners) {
+			same = (_arrays.topLeft[i] == b->topLeft[i]) &&
+				   (_arrays.topRight[i] == b->topRight[i]) &&
+				   (_arrays.bottomLeft[i] == b->bottomLeft[i]) &&
+				   (_arrays.bottomRight[i] == b->bottomRight[i]);
+		}
+		if (!same) {
+			if (count == max) {
+				count = -1;
+			} else {
+				list[count++] = (int)i;
+			}
+		}
+	}
+
+	return count;
+}
+
+
+
+//----------------------------------------------------------------------------
+//               Initialization Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method allocates all the coefficient arrays, the fixed node mask
+ and the RHS vector for a grid of the given size. Everything is cleared
+ to zero, so the caller needs to set the spacing and the fixed nodes and
+ then call -assemble to have a useful operator.
+ */
+- (id) initWithRows:(int)rowCnt andCols:(int)colCnt
+{
+	return [self initWithRows:rowCnt andCols:colCnt withCorners:NO];
+}
+
+
+/*!
+ This method allocates all the storage for a grid of the given size,
+ and if 'corners' is YES, the storage for the four corner coefficients
+ of a 9-point stencil as well. Everything is cleared to zero, just like
+ the 5-point version.
+ */
+- (id) initWithRows:(int)rowCnt andCols:(int)colCnt withCorners:(BOOL)corners
+{
+	BOOL			error = NO;
+	size_t			n = (size_t)rowCnt * colCnt;
+
+	// first, let's check the arguments for reasonable values
+	if (!error) {
+		if ((rowCnt <= 0) || (colCnt <= 0)) {
+			error = YES;
+			NSLog(@"[PoissonStencil -initWithRows:andCols:withCorners:] - the size of the grid is nonsense: rows=%d and cols=%d. Please make sure that you have reasonable values here.", rowCnt, colCnt);
+		}
+	}
+
+	// next, let's make sure the super can be initialized
+	if (!error) {
+		if (!(self = [super init])) {
+			error = YES;
+			NSLog(@"[PoissonStencil -initWithRows:andCols:withCorners:] - the superclass could not complete it's -init method. Please check the logs for a possible cause.");
+		}
+	}
+
+	// now try to get all the storage we need in one go
+	if (!error) {
+		[self freeAllStorage];
+		_arrays.center = (double *) calloc(n, sizeof(double));
+		_arrays.left = (double *) calloc(n, sizeof(double));
+		_arrays.right = (double *) calloc(n, sizeof(double));
+		_arrays.top = (double *) calloc(n, sizeof(double));
+		_arrays.bottom = (double *) calloc(n, sizeof(double));
+		if (corners) {
+			_arrays.topLeft = (double *) calloc(n, sizeof(double));
+			_arrays.topRight = (double *) calloc(n, sizeof(double));
+			_arrays.bottomLeft = (double *) calloc(n, sizeof(double));
+			_arrays.bottomRight = (double *) calloc(n, sizeof(double));
+		}
+		_arrays.fixed = (BOOL *) calloc(n, sizeof(BOOL));
+		_colSpacing = (double *) calloc(colCnt, sizeof(double));
+		_rowSpacing = (double *) calloc(rowCnt, sizeof(double));
+		_rhs = (double *) calloc(n, sizeof(double));
+		_dielectric = (double *) calloc(n, sizeof(double));
+		if ((_arrays.center == NULL) || (_arrays.left == NULL) ||
+			(_arrays.right == NULL) || (_arrays.top == NULL) ||
+			(_arrays.bottom == NULL) || (_arrays.fixed == NULL) ||
+			(corners && ((_arrays.topLeft == NULL) || (_arrays.topRight == NULL) ||
+						 (_arrays.bottomLeft == NULL) || (_arrays.bottomRight == NULL))) ||
+			(_colSpacing == NULL) || (_rowSpacing == NULL) ||
+			(_rhs == NULL) || (_dielectric == NULL)) {
+			error = YES;
+			NSLog(@"[PoissonStencil -initWithRows:andCols:withCorners:] - while trying to allocate the stencil storage for a %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rowCnt, colCnt);
+			[self freeAllStorage];
+		} else {
+			_arrays.rows = rowCnt;
+			_arrays.cols = colCnt;
+		}
+	}
+
+	return error ? nil : self;
+}
+
+
+/*!
+ This method drops all the storage that this instance has allocated,
+ and is used in the dealloc method as well as the init method to make
+ sure that we're not leaking anything.
+ */
+- (void) freeAllStorage
+{
+	if (_arrays.center != NULL) {
+		free(_arrays.center);
+	}
+	if (_arrays.left != NULL) {
+		free(_arrays.left);
+	}
+	if (_arrays.right != NULL) {
+		free(_arrays.right);
+	}
+	if (_arrays.top != NULL) {
+		free(_arrays.top);
+	}
+	if (_arrays.bottom != NULL) {
+		free(_arrays.bottom);
+	}
+	if (_arrays.topLeft != NULL) {
+		free(_arrays.topLeft);
+	}
+	if (_arrays.topRight != NULL) {
+		free(_arrays.topRight);
+	}
+	if (_arrays.bottomLeft != NULL) {
+		free(_arrays.bottomLeft);
+	}
+	if (_arrays.bottomRight != NULL) {
+		free(_arrays.bottomRight);
+	}
+	if (_arrays.fixed != NULL) {
+		free(_arrays.fixed);
+	}
+	if (_colSpacing != NULL) {
+		free(_colSpacing);
+	}
+	if (_rowSpacing != NULL) {
+		free(_rowSpacing);
+	}
+	if (_rhs != NULL) {
+		free(_rhs);
+	}
+	if (_dielectric != NULL) {
+		free(_dielectric);
+	}
+	memset(&_arrays, 0, sizeof(StencilArrays));
+	_colSpacing = NULL;
+	_rowSpacing = NULL;
+	_rhs = NULL;
+	_dielectric = NULL;
+}
+
+
+//----------------------------------------------------------------------------
+//               Assembly Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method takes the current spacing, dielectric constants and fixed
+ node mask and builds up the 5-point stencil for every node. Fixed
+ nodes become identity rows, and the edges of the grid use the same
+ mirror conditions as the original banded assembly - the missing
+ neighbor is simply added to the one on the other side of the node,
+ with that node's dielectric constant as well. If the spacing isn't
+ uniform the usual three-point second difference for unequal intervals
+ is used, which reduces to the original stencil on a uniform grid. Each
+ coefficient is then scaled by the dielectric constant of its face.
+ On an axisymmetric grid the radial part is the flux through the inner
+ and outer faces of each node's ring over its volume. At the edges the
+ ring just stops at the node, which is the same as the mirror in the
+ planar case, and on the axis it's the r = 0 symmetry condition - the
+ 4/h^2 to the next column that the limit of the cylindrical Laplacian
+ has there. If the stencil has an open boundary, the Robin term of
+ each edge node is then taken off its diagonal.
+ */
+- (void) assemble
+{
+	int			rows = _arrays.rows;
+	int			cols = _arrays.cols;
+	BOOL		radial = (_axisymmetric && (cols > 1));
+	double		y = 0.0;
+
+	for (int r = 0; r < rows; r++) {
+		/*
+		 * At the top and bottom edges the mirror node is as far away as
+		 * the real one on the other side, so the intervals are the same.
+		 */
+		double		ht = (r > 0) ? _rowSpacing[r - 1] : _rowSpacing[r];
+		double		hb = (r < (rows - 1)) ? _rowSpacing[r] : ht;
+		double		ct = 2.0/(ht * (ht + hb));
+		double		cb = 2.0/(hb * (ht + hb));
+		double		radius = _innerRadius;
+		double		x = 0.0;
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			double		rc = radius;
+			double		xc = x;
+			radius += _colSpacing[c];
+			x += _colSpacing[c];
+			// start with a clean slate for this node
+			_arrays.left[ij] = 0.0;
+			_arrays.right[ij] = 0.0;
+			_arrays.top[ij] = 0.0;
+			_arrays.bottom[ij] = 0.0;
+			if (_arrays.fixed[ij]) {
+				// v(i,j) = v_fixed
+				_arrays.center[ij] = 1.0;
+				continue;
+			}
+			double		hl = (c > 0) ? _colSpacing[c - 1] : _colSpacing[c];
+			double		hr = (c < (cols - 1)) ? _colSpacing[c] : hl;
+			// the neighbors - or their mirrors at the edges
+			size_t		tk = (r > 0) ? ij - cols : ij + cols;
+			size_t		bk = (r < (rows - 1)) ? ij + cols : ij - cols;
+			size_t		lk = (c > 0) ? ij - 1 : ij + 1;
+			size_t		rk = (c < (cols - 1)) ? ij + 1 : ij - 1;
+			double		cl = 2.0/(hl * (hl + hr));
+			double		cr = 2.0/(hr * (hl + hr));
+			double		lo = 0.0;
+			double		hi = 0.0;
+			double		vol = 0.0;
+			if (radial) {
+				// the flux through the faces of the ring over its volume
+				vol = radialCell(_colSpacing, cols, c, rc, &lo, &hi);
+				cl = (c > 0) ? lo/(hl * vol) : 0.0;
+				cr = (c < (cols - 1)) ? hi/(hr * vol) : 0.0;
+			}
+			cl *= faceDielectric(_dielectric, _arrays.fixed, ij, lk);
+			cr *= faceDielectric(_dielectric, _arrays.fixed, ij, rk);
+			double		et = ct * faceDielectric(_dielectric, _arrays.fixed, ij, tk);
+			double		eb = cb * faceDielectric(_dielectric, _arrays.fixed, ij, bk);
+			_arrays.center[ij] = -((cl + cr) + (et + eb));
+			/*
+			 * On an open edge, the mirror node is moved by the Robin
+			 * condition to v(mirror) - 2h(d.n/|d|^2)v(i,j), and that part of
+			 * it lands on the diagonal. On the radial edges there's no
+			 * mirror - the ring just ends at the node - so it's the flux
+			 * through the face at the node over the volume of the ring.
+			 */
+			if (_openBoundary) {
+				double		dx = xc - _centerX;
+				double		dy = y - _centerY;
+				double		d2 = dx*dx + dy*dy;
+				double		own = faceDielectric(_dielectric, _arrays.fixed, ij, ij);
+				double		robin = 0.0;
+				if (c == 0) {
+					robin += openEdge(-dx, d2) * (radial ? own * lo/vol : 2.0 * hl * cl);
+				}
+				if (c == (cols - 1)) {
+					robin += openEdge(dx, d2) * (radial ? own * hi/vol : 2.0 * hr * cr);
+				}
+				if (r == 0) {
+					robin += openEdge(-dy, d2) * 2.0 * ht * et;
+				}
+				if (r == (rows - 1)) {
+					robin += openEdge(dy, d2) * 2.0 * hb * eb;
+				}
+				_arrays.center[ij] -= robin;
+			}
+			// the 'top' node - or the mirror of the 'bottom' one
+			if (r == 0) {
+				_arrays.bottom[ij] += et;
+			} else {
+				_arrays.top[ij] += et;
+			}
+			// the 'bottom' node - or the mirror of the 'top' one
+			if (r == (rows - 1)) {
+				_arrays.top[ij] += eb;
+			} else {
+				_arrays.bottom[ij] += eb;
+			}
+			// the 'left' node - or the mirror of the 'right' one
+			if (c == 0) {
+				_arrays.right[ij] += cl;
+			} else {
+				_arrays.left[ij] += cl;
+			}
+			// the 'right' node - or the mirror of the 'left' one
+			if (c == (cols - 1)) {
+				_arrays.left[ij] += cr;
+			} else {
+				_arrays.right[ij] += cr;
+			}
+		}
+		y += _rowSpacing[r];
+	}
+}
+
+
+/*!
+ This method creates the next coarser stencil for the multigrid solver.
+ The coarse grid takes every other node in each direction - and always
+ the last one, so an odd count of intervals leaves a short one at the
+ far edge - unless the cells are long and thin, in which case only the
+ short side is coarsened. A coarse node is fixed if the fine node it
+ sits on is fixed, and the coarse operator is the Galerkin product of
+ the restriction, this operator and the interpolation, so that the
+ conductors that fall between the coarse nodes are still felt on the
+ coarse grid. The returned stencil is autoreleased.
+ */
+- (PoissonStencil*) createCoarseStencil
+{
+	BOOL				error = NO;
+	int					rows = _arrays.rows;
+	int					cols = _arrays.cols;
+	size_t				n = (size_t)rows * cols;
+
+	/*
+	 * If the cells are long and thin, the smoothing only works along the
+	 * short side, so we only coarsen along that side until the cells are
+	 * closer to square - this is plain semi-coarsening.
+	 */
+	double				hx = 0.0;
+	for (int c = 0; c < (cols - 1); c++) {
+		hx += _colSpacing[c];
+	}
+	hx /= MAX(cols - 1, 1);
+	double				hy = 0.0;
+	for (int r = 0; r < (rows - 1); r++) {
+		hy += _rowSpacing[r];
+	}
+	hy /= MAX(rows - 1, 1);
+	BOOL				byRows = (hy <= M_SQRT2 * hx);
+	BOOL				byCols = (hx <= M_SQRT2 * hy);
+	int					crows = (byRows ? COARSE_COUNT(rows) : rows);
+	int					ccols = (byCols ? COARSE_COUNT(cols) : cols);
+	size_t				cn = (size_t)crows * ccols;
+	PoissonStencil*		retval = nil;
+
+	// first, get the coarse stencil and the scratch vectors for building it
+	if (!error) {
+		retval = [[[PoissonStencil alloc] initWithRows:crows andCols:ccols withCorners:YES] autorelease];
+		if (retval == nil) {
+			error = YES;
+			NSLog(@"[PoissonStencil -createCoarseStencil] - the coarse %dx%d stencil could not be created and this is a serious storage problem. Check into this.", crows, ccols);
+		}
+	}
+	double*		e = NULL;
+	double*		ce = NULL;
+	double*		fe = NULL;
+	double*		afe = NULL;
+	if (!error) {
+		e = (double *) calloc(cn, sizeof(double));
+		ce = (double *) calloc(cn, sizeof(double));
+		fe = (double *) calloc(n, sizeof(double));
+		afe = (double *) calloc(n, sizeof(double));
+		if ((e == NULL) || (ce == NULL) || (fe == NULL) || (afe == NULL)) {
+			error = YES;
+			NSLog(@"[PoissonStencil -createCoarseStencil] - while trying to allocate the scratch vectors for building the coarse %dx%d stencil, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", crows, ccols);
+		}
+	}
+
+	// the coarse nodes are fixed where the fine ones are, and the intervals add up
+	if (!error) {
+		BOOL*		cfixed = [retval getFixedMask];
+		for (int r = 0; r < crows; r++) {
+			for (int c = 0; c < ccols; c++) {
+				int		fr = (byRows ? FINE_INDEX(r, rows) : r);
+				int		fc = (byCols ? FINE_INDEX(c, cols) : c);
+				cfixed[(size_t)r * ccols + c] = _arrays.fixed[(size_t)fr * cols + fc];
+			}
+		}
+		double*		cdx = [retval getColSpacing];
+		for (int c = 0; c < (ccols - 1); c++) {
+			cdx[c] = _colSpacing[c];
+			if (byCols) {
+				cdx[c] = 0.0;
+				for (int fc = FINE_INDEX(c, cols); fc < FINE_INDEX(c + 1, cols); fc++) {
+					cdx[c] += _colSpacing[fc];
+				}
+			}
+		}
+		double*		cdy = [retval getRowSpacing];
+		for (int r = 0; r < (crows - 1); r++) {
+			cdy[r] = _rowSpacing[r];
+			if (byRows) {
+				cdy[r] = 0.0;
+				for (int fr = FINE_INDEX(r, rows); fr < FINE_INDEX(r + 1, rows); fr++) {
+					cdy[r] += _rowSpacing[fr];
+				}
+			}
+		}
+		// the coarse grid is the same body of revolution, if it is one
+		[retval setAxisymmetric:_axisymmetric withInnerRadius:_innerRadius];
+		// ...and its edges are open if ours are - the Galerkin product carries the Robin terms
+		[retval setOpenBoundary:_openBoundary withCenterX:_centerX andY:_centerY];
+	}
+
+	/*
+	 * The Galerkin operator only couples a coarse node to the eight
+	 * around it, so if we put a unit correction on every third coarse
+	 * node in each direction, interpolate it, apply this operator, and
+	 * restrict the result, each coarse node sees exactly one of those
+	 * unit corrections in its 3x3 neighborhood, and what it gets is that
+	 * one coefficient of its row. Nine of these probes and we have the
+	 * whole operator, without ever having to form the product.
+	 */
+	if (!error) {
+		StencilArrays*	ca = [retval getArrays];
+		BOOL*			cfixed = ca->fixed;
+		double*			coef[9] = { ca->topLeft, ca->top, ca->topRight,
+									ca->left, ca->center, ca->right,
+									ca->bottomLeft, ca->bottom, ca->bottomRight };
+		for (int pr = 0; pr < 3; pr++) {
+			for (int pc = 0; pc < 3; pc++) {
+				memset(e, 0, cn * sizeof(double));
+				for (int r = pr; r < crows; r += 3) {
+					for (int c = pc; c < ccols; c += 3) {
+						e[(size_t)r * ccols + c] = 1.0;
+					}
+				}
+				memset(fe, 0, n * sizeof(double));
+				[self addCorrection:e fromCoarse:retval into:fe];
+				stencilMultiply(&_arrays, fe, afe, 0, rows);
+				[self restrictResidual:afe toCoarse:retval into:ce];
+				// now pull out the coefficient each node got from this probe
+				for (int r = 0; r < crows; r++) {
+					for (int c = 0; c < ccols; c++) {
+						size_t		ij = (size_t)r * ccols + c;
+						int			dr = ((pr - r) % 3 + 4) % 3 - 1;
+						int			dc = ((pc - c) % 3 + 4) % 3 - 1;
+						if (!cfixed[ij] && (r + dr >= 0) && (r + dr < crows) &&
+							(c + dc >= 0) && (c + dc < ccols) &&
+							!cfixed[(size_t)(r + dr) * ccols + (c + dc)]) {
+							coef[(dr + 1)*3 + (dc + 1)][ij] = ce[ij];
+						}
+					}
+				}
+			}
+		}
+		// ...and the fixed nodes are just identity rows, as always
+		for (size_t ij = 0; ij < cn; ij++) {
+			if (cfixed[ij]) {
+				ca->center[ij] = 1.0;
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (e != NULL) {
+		free(e);
+	}
+	if (ce != NULL) {
+		free(ce);
+	}
+	if (fe != NULL) {
+		free(fe);
+	}
+	if (afe != NULL) {
+		free(afe);
+	}
+
+	return error ? nil : retval;
+}
+
+
+/*!
+ This method moves the residual 'r' on this grid to the RHS 'b' of the
+ coarse grid correction equation on the 'coarse' stencil that was made
+ from this one. It's full weighting on a uniform grid, and the fixed
+ nodes of the coarse grid have a zero RHS as their correction is zero.
+ */
+- (void) restrictResidual:(double*)r toCoarse:(PoissonStencil*)coarse into:(double*)b
+{
+	int			rows = _arrays.rows;
+	int			cols = _arrays.cols;
+	int			crows = [coarse getRowCount];
+	int			ccols = [coarse getColCount];
+	BOOL		byRows = (crows < rows);
+	BOOL		byCols = (ccols < cols);
+	BOOL*		cfixed = [coarse getFixedMask];
+
+	for (int cr = 0; cr < crows; cr++) {
+		int			jr[3];
+		double		wr[3];
+		int			nr = restrictionWeights(_rowSpacing, rows, byRows, cr, jr, wr);
+		for (int cc = 0; cc < ccols; cc++) {
+			size_t		ij = (size_t)cr * ccols + cc;
+			double		s = 0.0;
+			if (!cfixed[ij]) {
+				int			jc[3];
+				double		wc[3];
+				int			nc = restrictionWeights(_colSpacing, cols, byCols, cc, jc, wc);
+				for (int i = 0; i < nr; i++) {
+					const double*	rr = r + (size_t)jr[i] * cols;
+					for (int j = 0; j < nc; j++) {
+						s += wr[i] * wc[j] * rr[jc[j]];
+					}
+				}
+			}
+			b[ij] = s;
+		}
+	}
+}
+
+
+/*!
+ This method interpolates the correction 'xc' on the 'coarse' stencil
+ that was made from this one, and adds it to 'x' on this grid for all
+ the nodes that aren't fixed.
+ */
+- (void) addCorrection:(double*)xc fromCoarse:(PoissonStencil*)coarse into:(double*)x
+{
+	int			rows = _arrays.rows;
+	int			cols = _arrays.cols;
+	int			ccols = [coarse getColCount];
+	BOOL		byRows = ([coarse getRowCount] < rows);
+	BOOL		byCols = (ccols < cols);
+
+	for (int r = 0; r < rows; r++) {
+		int			kr[2];
+		double		wr[2];
+		int			nr = interpolationWeights(_rowSpacing, rows, byRows, r, kr, wr);
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			if (!_arrays.fixed[ij]) {
+				int			kc[2];
+				double		wc[2];
+				int			nc = interpolationWeights(_colSpacing, cols, byCols, c, kc, wc);
+				double		s = 0.0;
+				for (int i = 0; i < nr; i++) {
+					const double*	xr = xc + (size_t)kr[i] * ccols;
+					for (int j = 0; j < nc; j++) {
+						s += wr[i] * wc[j] * xr[kc[j]];
+					}
+				}
+				x[ij] += s;
+			}
+		}
+	}
+}
+
+
+/*!
+ This method creates a stencil for the block of this grid that starts
+ at row 'r0' and column 'c0' and is 'rowCnt' by 'colCnt' nodes, for the
+ domain decomposition solvers. The operator of each node in the block
+ is copied just as it is, except for the nodes on the edges of the
+ block that aren't on the edges of this grid - those are held fixed, as
+ that's where the potentials of the neighboring blocks come in. The
+ RHS is copied as well, so only those edges need to be filled in
+ before each solve. The returned stencil is autoreleased.
+ */
+- (PoissonStencil*) createBlockAtRow:(int)r0 andCol:(int)c0 withRows:(int)rowCnt andCols:(int)colCnt
+{
+	BOOL				error = NO;
+	int					rows = _arrays.rows;
+	int					cols = _arrays.cols;
+	BOOL				corners = (_arrays.topLeft != NULL);
+	PoissonStencil*		retval = nil;
+
+	// first, make sure the block is inside this grid
+	if (!error) {
+		if ((r0 < 0) || (c0 < 0) || (rowCnt < 2) || (colCnt < 2) ||
+			((r0 + rowCnt) > rows) || ((c0 + colCnt) > cols)) {
+			error = YES;
+			NSLog(@"[PoissonStencil -createBlockAtRow:andCol:withRows:andCols:] - the %dx%d block at (row=%d, col=%d) isn't inside the %dx%d grid. Please check the arguments.", rowCnt, colCnt, r0, c0, rows, cols);
+		}
+	}
+
+	// next, get the stencil for the block
+	if (!error) {
+		retval = [[[PoissonStencil alloc] initWithRows:rowCnt andCols:colCnt withCorners:corners] autorelease];
+		if (retval == nil) {
+			error = YES;
+			NSLog(@"[PoissonStencil -createBlockAtRow:andCol:withRows:andCols:] - the %dx%d block stencil could not be created and this is a serious storage problem. Check into this.", rowCnt, colCnt);
+		}
+	}
+
+	// the spacing of the block is just that part of ours
+	if (!error) {
+		memcpy([retval getColSpacing], _colSpacing + c0, colCnt * sizeof(double));
+		memcpy([retval getRowSpacing], _rowSpacing + r0, rowCnt * sizeof(double));
+		double		rb = _innerRadius;
+		for (int c = 0; c < c0; c++) {
+			rb += _colSpacing[c];
+		}
+		[retval setAxisymmetric:_axisymmetric withInnerRadius:rb];
+		double		yb = 0.0;
+		for (int r = 0; r < r0; r++) {
+			yb += _rowSpacing[r];
+		}
+		[retval setOpenBoundary:_openBoundary withCenterX:(_centerX - (rb - _innerRadius)) andY:(_centerY - yb)];
+	}
+
+	/*
+	 * Now copy over the operator for each node. The nodes on the inner
+	 * edges of the block are fixed, and for all the others every neighbor
+	 * they have is in the block, so the coefficients are good as they are.
+	 */
+	if (!error) {
+		StencilArrays*	a = [retval getArrays];
+		double*			rhs = [retval getRHS];
+		double*			er = [retval getDielectric];
+		for (int r = 0; r < rowCnt; r++) {
+			BOOL		innerRow = (((r == 0) && (r0 > 0)) || ((r == (rowCnt - 1)) && ((r0 + rowCnt) < rows)));
+			for (int c = 0; c < colCnt; c++) {
+				size_t		ij = (size_t)r * colCnt + c;
+				size_t		pj = (size_t)(r0 + r) * cols + (c0 + c);
+				BOOL		inner = (innerRow || ((c == 0) && (c0 > 0)) || ((c == (colCnt - 1)) && ((c0 + colCnt) < cols)));
+				rhs[ij] = _rhs[pj];
+				er[ij] = _dielectric[pj];
+				if (inner) {
+					a->fixed[ij] = YES;
+					a->center[ij] = 1.0;
+					continue;
+				}
+				a->fixed[ij] = _arrays.fixed[pj];
+				a->center[ij] = _arrays.center[pj];
+				a->left[ij] = _arrays.left[pj];
+				a->right[ij] = _arrays.right[pj];
+				a->top[ij] = _arrays.top[pj];
+				a->bottom[ij] = _arrays.bottom[pj];
+				if (corners) {
+					a->topLeft[ij] = _arrays.topLeft[pj];
+					a->topRight[ij] = _arrays.topRight[pj];
+					a->bottomLeft[ij] = _arrays.bottomLeft[pj];
+					a->bottomRight[ij] = _arrays.bottomRight[pj];
+				}
+			}
+		}
+	}
+
+	return error ? nil : retval;
+}
+
+
+//----------------------------------------------------------------------------
+//               Kernel Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method applies the operator to the vector 'x' and places the
+ result in 'y'. Both need to be getNodeCount long, and can't be the
+ same vector.
+ */
+- (void) multiply:(double*)x into:(double*)y
+{
+	kernelMultiply(&_arrays, x, y, 0, _arrays.rows);
+}
+
+/*!
+ This method applies just the row of the operator for node 'ij' - in
+ row-major order - to the vector 'x', and returns the result. That's
+ one element of what -multiply:into: would compute.
+ */
+- (double) multiplyRow:(int)ij by:(double*)x
+{
+	return stencilMultiplyNode(&_arrays, x, ij / _arrays.cols, ij % _arrays.cols);
+}
+
+
+
+/*!
+ This method computes the residual r = b - Ax for the given 'x' and
+ 'b' and places it in 'r', returning the 2-norm of that residual as
+ a convenience to the iterative solvers.
+ */
+- (double) residualOf:(double*)x forRHS:(double*)b into:(double*)r
+{
+	return sqrt(kernelResidual(&_arrays, x, b, r, 0, _arrays.rows));
+}
+
+
+/*!
+ This method does one red-black ordered SOR sweep over the grid with
+ the relaxation factor 'omega' - omega = 1 is just Gauss-Seidel. The
+ fixed nodes are simply set to their RHS values. For a 9-point stencil
+ the nodes of one color aren't independent, so this is still a proper
+ sweep, but only when it's done serially.
+ */
+- (void) relax:(double*)x forRHS:(double*)b withOmega:(double)omega
+{
+	stencilRelaxColor(&_arrays, x, b, omega, 0, 0, _arrays.rows);
+	stencilRelaxColor(&_arrays, x, b, omega, 1, 0, _arrays.rows);
+}
+
+
+/*!
+ This method computes the residual r = b - Ax just like -residualOf:
+ forRHS:into: but splits the rows up across all the cores of the
+ machine. It returns the 2-norm of the residual.
+ */
+- (double) residualConcurrentlyOf:(double*)x forRHS:(double*)b into:(double*)r
+{
+	StencilArrays*	a = &_arrays;
+	int				chunks = concurrentChunkCount(a->rows);
+	double*			sums = (double *) calloc(chunks, sizeof(double));
+	double			sum = 0.0;
+	if (sums == NULL) {
+		// no room to split it up, so just do it all on this thread
+		sum = kernelResidual(a, x, b, r, 0, a->rows);
+	} else {
+		dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t k) {
+			sums[k] = kernelResidual(a, x, b, r, CHUNK_START(k, chunks, a->rows), CHUNK_START(k + 1, chunks, a->rows));
+		});
+		for (int k = 0; k < chunks; k++) {
+			sum += sums[k];
+		}
+		free(sums);
+	}
+	return sqrt(sum);
+}
+
+
+/*!
+ This method does one red-black ordered SOR sweep over the grid, just
+ like -relax:forRHS:withOmega:, but with the rows of each color split
+ up across all the cores of the machine. That's only safe for the
+ 5-point stencil, so a 9-point one is relaxed serially. It returns the
+ 2-norm of the change in 'x' so the caller can see how fast it's going.
+ */
+- (double) relaxConcurrently:(double*)x forRHS:(double*)b withOmega:(double)omega
+{
+	StencilArrays*	a = &_arrays;
+	int				chunks = concurrentChunkCount(a->rows);
+	double*			sums = ([self hasCorners] ? NULL : (double *) calloc(chunks, sizeof(double)));
+	double			sum = 0.0;
+	if (sums == NULL) {
+		sum = stencilRelaxColor(a, x, b, omega, 0, 0, a->rows);
+		sum += stencilRelaxColor(a, x, b, omega, 1, 0, a->rows);
+	} else {
+		/*
+		 * Every neighbor of a red node is black, and the other way around,
+		 * so all the nodes of one color can be done at the same time - all
+		 * we have to do is finish one color before starting the next.
+		 */
+		dispatch_queue_t	queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+		for (int color = 0; color < 2; color++) {
+			dispatch_apply(chunks, queue, ^(size_t k) {
+				sums[k] += stencilRelaxColor(a, x, b, omega, color, CHUNK_START(k, chunks, a->rows), CHUNK_START(k + 1, chunks, a->rows));
+			});
+		}
+		for (int k = 0; k < chunks; k++) {
+			sum += sums[k];
+		}
+		free(sums);
+	}
+	return sqrt(sum);
+}
+
+
+/*!
+ This method does 'sweeps' red-black ordered SOR sweeps over the grid,
+ just like calling -relaxConcurrently:forRHS:withOmega: that many times,
+ but when the grid is too big for the L2 cache, it does several sweeps
+ on each pass over it. Each core takes a band of rows and relaxes them
+ as a wavefront - each sweep a row behind the last - so every row is
+ relaxed several times before it leaves the cache, and then the rows
+ at the edges between the bands are finished up. On a grid that fits
+ in the cache, or a 9-point stencil, it's just the plain sweeps. It
+ returns the 2-norm of the change in 'x' in the last sweep.
+ */
+- (double) relax:(double*)x forRHS:(double*)b withOmega:(double)omega sweeps:(int)sweeps
+{
+	StencilArrays*	a = &_arrays;
+	int				chunks = concurrentChunkCount(a->rows);
+	int				depth = MIN(temporalBlockDepth(a), sweeps);
+	BOOL			fits = (((long long)a->rows * a->cols * RELAX_BYTES_PER_NODE) <= cacheSize);
+	double*			sums = NULL;
+	double			change = 0.0;
+
+	/*
+	 * The triangles at the edges of the bands are as tall as twice the
+	 * half-sweeps, so the bands have to be at least that tall for them
+	 * not to run into one another.
+	 */
+	if (chunks > 1) {
+		depth = MIN(depth, (a->rows / chunks) / 4);
+	}
+	if (![self hasCorners] && !fits && (depth >= 2)) {
+		sums = (double *) calloc(chunks, sizeof(double));
+	}
+
+	if (sums == NULL) {
+		for (int s = 0; s < sweeps; s++) {
+			change = [self relaxConcurrently:x forRHS:b withOmega:omega];
+		}
+	} else {
+		dispatch_queue_t	queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+		int					rows = a->rows;
+		for (int done = 0; done < sweeps; done += depth) {
+			int		phases = 2 * MIN(depth, sweeps - done);
+			// the trapezoid of each band first...
+			dispatch_apply(chunks, queue, ^(size_t k) {
+				int		lo = CHUNK_START(k, chunks, rows);
+				int		hi = CHUNK_START(k + 1, chunks, rows);
+				sums[k] = relaxWavefront(a, x, b, omega, phases, lo, (lo > 0 ? 1 : 0), hi, (hi < rows ? -1 : 0));
+			});
+			// ...and then the triangles at the edges between them
+			dispatch_apply(chunks - 1, queue, ^(size_t k) {
+				int		edge = CHUNK_START(k + 1, chunks, rows);
+				sums[k] += relaxWavefront(a, x, b, omega, phases, edge, -1, edge, 1);
+			});
+		}
+		change = 0.0;
+		for (int k = 0; k < chunks; k++) {
+			change += sums[k];
+		}
+		change = sqrt(change);
+		free(sums);
+	}
+
+	return change;
+}
+
+
+
+//----------------------------------------------------------------------------
+//               NSObject Overridden Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method is called by the runtime when the released object is about
+ to get cleaned up. This gives us an opportunity to clean up all the
+ memory we're using at the time and be a good citizen.
+ */
+- (void) dealloc
+{
+	// drop all the memory we're using
+	[self freeAllStorage];
+	// ...and don't forget to call the super's dealloc too...
+	[super dealloc];
+}
+
+@end
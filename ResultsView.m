@@ -10,6 +10,7 @@
 #import <Accelerate/Accelerate.h>
 
 // System Headers
+#include <math.h>
 
 // Third Party Headers
 
@@ -29,6 +30,34 @@
 // Public Macros
 
 
+/*
+ * The plots are drawn on an evenly spaced grid, so a graded workspace
+ * has to be sampled at those evenly spaced points. This returns the
+ * value of 'm' at the point that's at node (r,c) of the even grid - by
+ * interpolating between the four workspace nodes around it, or taking
+ * the nearest one if 'nearest' is set, as it needs to be for angles.
+ */
+static double sampleGraded(SimWorkspace* ws, MaskedMatrix* m, int r, int c, BOOL nearest)
+{
+	int			rows = [ws getRowCount];
+	int			cols = [ws getColCount];
+	NSRect		rect = [ws getWorkspaceRect];
+	float		fx = [ws getColPositionForXValue:(rect.origin.x + rect.size.width * c / (cols - 1.0))];
+	float		fy = [ws getRowPositionForYValue:(rect.origin.y + rect.size.height * r / (rows - 1.0))];
+	fx = isnan(fx) ? c : MIN(MAX(fx, 0.0), cols - 1.0);
+	fy = isnan(fy) ? r : MIN(MAX(fy, 0.0), rows - 1.0);
+	if (nearest) {
+		return [m getValueAtRow:(int)lroundf(fy) andCol:(int)lroundf(fx)];
+	}
+	int			i = MIN((int)fy, rows - 2);
+	int			j = MIN((int)fx, cols - 2);
+	double		ty = fy - i;
+	double		tx = fx - j;
+	return (1.0 - ty) * ((1.0 - tx) * [m getValueAtRow:i andCol:j] + tx * [m getValueAtRow:i andCol:(j + 1)])
+		   + ty * ((1.0 - tx) * [m getValueAtRow:(i + 1) andCol:j] + tx * [m getValueAtRow:(i + 1) andCol:(j + 1)]);
+}
+
+
 /*!
  @class ResultsView
  This class is the output plotting view of the Voltage and Electric Field
@@ -161,8 +190,12 @@
 		// now let's loop over all the points and write out what we want...
 		for (int r = 0; r < [self getRowCount]; r++) {
 			for (int c = 0; c < [self getColCount]; c++) {
-				// now get the results at this node
-				v = [workspace getResultantVoltageAtNodeRow:r andCol:c];
+				// now get the results at this node - or where it'd be if graded
+				if ([workspace isUniformGrid]) {
+					v = [workspace getResultantVoltageAtNodeRow:r andCol:c];
+				} else {
+					v = sampleGraded(workspace, [workspace getResultantVoltage], r, c, NO);
+				}
 				// save all this for drawing
 				_values[r][c] = (v - Vmin)/(Vmax - Vmin);
 			}
@@ -224,9 +257,14 @@
 		// now let's loop over all the points and write out what we want...
 		for (int r = 0; r < [self getRowCount]; r++) {
 			for (int c = 0; c < [self getColCount]; c++) {
-				// now get the results at this node
-				em = [workspace getResultantElectricFieldMagnitudeAtNodeRow:r andCol:c];
-				ed = [workspace getResultantElectricFieldDirectionAtNodeRow:r andCol:c];
+				// now get the results at this node - or where it'd be if graded
+				if ([workspace isUniformGrid]) {
+					em = [workspace getResultantElectricFieldMagnitudeAtNodeRow:r andCol:c];
+					ed = [workspace getResultantElectricFieldDirectionAtNodeRow:r andCol:c];
+				} else {
+					em = sampleGraded(workspace, [workspace getResultantElectricFieldMagnitude], r, c, NO);
+					ed = sampleGraded(workspace, [workspace getResultantElectricFieldDirection], r, c, YES);
+				}
 				// save all this for drawing
 				_values[r][c] = (em - Emin)/(Emax - Emin);
 				_direction[r][c] = ed;
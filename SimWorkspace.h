@@ -21,10 +21,108 @@
 // Superclass Headers
 
 // Forward Class Declarations
+@class BandedFactorization;
 
 // Public Data Types
+/*
+ * These are the different numerical engines that -simulateWorkspace can
+ * use to solve the system of equations for the workspace. The banded LU
+ * decomposition is the original, and still the default, as it's exact,
+ * but it's the band width that limits the size of the grids it can do.
+ * The automatic solver isn't an engine of its own - it picks whichever
+ * one of the others the cost model says will be the quickest.
+ */
+typedef enum {
+	kBandedLUSolver = 0,
+	kMultigridSolver,
+	kConjugateGradientSolver,
+	kSORSolver,
+	kBandedCholeskySolver,
+	kSparseCholeskySolver,
+	kFastPoissonSolver,
+	kMixedPrecisionLUSolver,
+	kSchwarzSolver,
+	kAutomaticSolver
+} SimSolverType;
+
+/*
+ * The multigrid solver can use either V-cycles or W-cycles, and the value
+ * of each is the number of times the coarser level is visited per cycle.
+ */
+typedef enum {
+	kVCycle = 1,
+	kWCycle = 2
+} MultigridCycle;
+
+/*
+ * The conjugate gradient solver needs a preconditioner to be of any
+ * real use, and these are the ones it has - from the cheapest per
+ * iteration to the one that needs the fewest iterations.
+ */
+typedef enum {
+	kJacobiPreconditioner = 0,
+	kSSORPreconditioner,
+	kIncompleteCholeskyPreconditioner
+} CGPreconditioner;
+
+/*
+ * The edges of the workspace are mirrors by default - no field crosses
+ * them - which is right for a box with the objects in it, but pulls the
+ * field of anything that's meant to be out in the open towards the
+ * edges. An open boundary lets it out as if the potential fell off as
+ * one over the distance from the objects, so the workspace only has to
+ * be a few times the size of what's in it.
+ */
+typedef enum {
+	kMirrorBoundary = 0,
+	kOpenBoundary
+} SimBoundaryCondition;
 
 // Public Constants
+/*
+ * These are the keys of the report that -getSolveReport returns for the
+ * last solve. The times are in seconds and the memory in bytes, and the
+ * relative residuals are against the norm of the RHS. The fill and the
+ * memory are totals - each factorization, and each piece of storage, the
+ * engine used adds to them. Anything that doesn't apply to the engine
+ * that did the solve is simply left out - like the predicted time and
+ * memory, which are only there when the automatic solver picked the
+ * engine. If the engine couldn't solve the system and another one had
+ * to, the report is of the one that did, with the name of the one that
+ * didn't, and why, in the fallback keys. The I/O volume is only there
+ * when the LU was factored out of core - it's all the bytes its scratch
+ * file has moved since it was factored, this solve included.
+ */
+#define kReportSolver				@"solver"
+#define kReportRows					@"rows"
+#define kReportCols					@"cols"
+#define kReportAssemblyTime			@"assemblyTime"
+#define kReportFactorTime			@"factorTime"
+#define kReportSolveTime			@"solveTime"
+#define kReportTotalTime			@"totalTime"
+#define kReportResidualNorm			@"residualNorm"
+#define kReportRelativeResidual		@"relativeResidual"
+#define kReportIterations			@"iterations"
+#define kReportResidualHistory		@"residualHistory"
+#define kReportFactorReused			@"factorReused"
+#define kReportFill					@"fill"
+#define kReportMemory				@"memory"
+#define kReportOrdering				@"ordering"
+#define kReportIOVolume				@"ioVolume"
+#define kReportPredictedTime		@"predictedTime"
+#define kReportPredictedMemory		@"predictedMemory"
+#define kReportFallbackFrom			@"fallbackFrom"
+#define kReportFallbackReason		@"fallbackReason"
+
+/*
+ * These are the keys of the result set of each scenario that
+ * -simulateScenariosWithVoltages:andRhos: returns - the same resultant
+ * voltage and electric field matrices that a simulation leaves in the
+ * workspace itself.
+ */
+#define kScenarioVoltage					@"voltage"
+#define kScenarioElectricFieldMagnitude		@"electricFieldMagnitude"
+#define kScenarioElectricFieldDirection		@"electricFieldDirection"
 
 // Public Macros
 
@@ -47,12 +145,31 @@
 	int					_rowCnt;
 	int					_colCnt;
 	NSRect				_workspaceRect;
+	double*				_colFractions;
+	double*				_rowFractions;
 	MaskedMatrix*		_rho;
 	MaskedMatrix*		_er;
 	MaskedMatrix*		_voltage;
 	MaskedMatrix*		_resultantVoltage;
 	MaskedMatrix*		_resultantElectricFieldMagnitude;
 	MaskedMatrix*		_resultantElectricFieldDirection;
+	SimSolverType		_solverType;
+	MultigridCycle		_multigridCycle;
+	CGPreconditioner	_preconditioner;
+	BOOL				_schwarzCoarseCorrection;
+	double				_tolerance;
+	int					_maxIterations;
+	MaskedMatrix*		_initialGuess;
+	int					_refinementBudget;
+	int					_previewFactor;
+	BOOL				_axisymmetric;
+	SimBoundaryCondition	_boundaryCondition;
+	NSPoint				_openBoundaryCenter;
+	BandedFactorization*	_factorization;
+	double*				_superpositionBasis;
+	int					_superpositionCount;
+	NSMutableDictionary*	_solveReport;
+	NSDictionary*		_lastSolveReport;
 }
 
 //----------------------------------------------------------------------------
@@ -334,13 +451,217 @@
  */
 - (double) getResultantElectricFieldDirectionAtNodeRow:(int)r andCol:(int)c;
 
+/*!
+ This method sets the numerical engine that -simulateWorkspace will use
+ to solve the system of equations for the workspace. The default is the
+ banded LU decomposition in LAPACK, but for the larger grids, the other
+ solvers are going to be a lot faster, and use a lot less memory.
+ */
+- (void) setSolverType:(SimSolverType)type;
+
+/*!
+ This method returns the numerical engine that -simulateWorkspace will
+ use to solve the system of equations for the workspace.
+ */
+- (SimSolverType) getSolverType;
+
+/*!
+ This method sets the numerical engine - and the cycle, preconditioner
+ or coarse correction that goes with it - by the name it has in the
+ input deck: LU, LU32, CHOL, SPARSE, FPS, MGV, MGW, PCGJ, PCGSSOR,
+ PCGIC, SOR, SCHWARZ, SCHWARZ1 or AUTO. It returns NO, and changes
+ nothing, if the name isn't one of these.
+ */
+- (BOOL) setSolverByName:(NSString*)name;
+
+/*!
+ This method returns the name - as it would be in the input deck - of
+ the numerical engine that -simulateWorkspace will use.
+ */
+- (NSString*) getSolverName;
+
+/*!
+ This method sets the type of cycle the multigrid solver will use - a
+ V-cycle is the cheapest, but a W-cycle can be more robust when there
+ are a lot of thin conductors in the workspace.
+ */
+- (void) setMultigridCycle:(MultigridCycle)cycle;
+
+/*!
+ This method returns the type of cycle the multigrid solver will use.
+ */
+- (MultigridCycle) getMultigridCycle;
+
+/*!
+ This method sets the preconditioner that the conjugate gradient solver
+ will use. Jacobi is the cheapest per iteration, but SSOR and IC(0) take
+ a lot fewer iterations on the larger grids.
+ */
+- (void) setPreconditioner:(CGPreconditioner)type;
+
+/*!
+ This method returns the preconditioner that the conjugate gradient
+ solver will use.
+ */
+- (CGPreconditioner) getPreconditioner;
+
+/*!
+ This method sets whether the domain decomposition solver follows each
+ sweep over its blocks with a correction on a coarse grid. The blocks
+ only pass the error along to their neighbors a little each sweep, so
+ without it, the sweeps it takes grow with the number of blocks.
+ */
+- (void) setSchwarzCoarseCorrection:(BOOL)flag;
+
+/*!
+ This method returns YES if the domain decomposition solver follows
+ each sweep over its blocks with a correction on a coarse grid.
+ */
+- (BOOL) getSchwarzCoarseCorrection;
+
+/*!
+ This method sets the tolerance on the relative residual, |b - Ax|/|b|,
+ that the iterative solvers will use to know when they're done. The
+ direct solvers don't need this, as they're as good as it gets.
+ */
+- (void) setTolerance:(double)tol;
+
+/*!
+ This method returns the tolerance on the relative residual that the
+ iterative solvers will use to know when they're done.
+ */
+- (double) getTolerance;
+
+/*!
+ This method sets the maximum number of iterations (or cycles) that
+ the iterative solvers will do before giving up on reaching the
+ tolerance and reporting the failure to converge. If this is zero, each
+ solver picks a limit that makes sense for it and the size of the grid.
+ */
+- (void) setMaxIterations:(int)count;
+
+/*!
+ This method returns the maximum number of iterations (or cycles) that
+ the iterative solvers will do before giving up.
+ */
+- (int) getMaxIterations;
+
+/*!
+ This method sets the potentials that the iterative solvers start from
+ on the free nodes - a node without a value starts at zero. This is
+ usually the result of the last simulation, so that re-running after a
+ small change to the workspace takes a fraction of the iterations. If
+ there's no initial guess, the iterative solvers start from the last
+ result of this workspace, if there is one.
+ */
+- (void) setInitialGuess:(MaskedMatrix*)guess;
+
+/*!
+ This method returns the potentials that the iterative solvers start
+ from, or nil if there aren't any.
+ */
+- (MaskedMatrix*) getInitialGuess;
+
+/*!
+ This method sets the number of extra nodes that the workspace can add
+ in refined patches around the conductor edges and other places where
+ the field changes quickly. If this is zero - the default - the regular
+ grid is all there is.
+ */
+- (void) setRefinementBudget:(int)nodes;
+
+/*!
+ This method returns the number of extra nodes that the workspace can
+ add in refined patches, or zero if there's no refinement.
+ */
+- (int) getRefinementBudget;
+
+/*!
+ This method sets how much coarser the first preview of a progressive
+ simulation is than the workspace's grid - 4 or 8 are good choices.
+ The workspace is solved on a grid that many times coarser, then on
+ one twice as fine, and so on up to the real grid, with each one
+ starting from the last. Anything that's not a power of two is rounded
+ down to the next lower power of two, and zero - the default - or one
+ turns the previews off.
+ */
+- (void) setPreviewFactor:(int)factor;
+
+/*!
+ This method returns how much coarser the first preview of a
+ progressive simulation is than the workspace's grid, or zero if the
+ previews are off.
+ */
+- (int) getPreviewFactor;
+
+/*!
+ This method sets whether the workspace is the (r, z) half-plane of a
+ body of revolution - x is the radius and y is the axis - rather than
+ a slice of something that goes on forever in z. Then a circle is a
+ ring around the axis, a rectangle is a cylinder - or a tube, if it's
+ off the axis - and the edge at x = 0 is the axis itself. The origin
+ of the workspace can't be at a negative radius.
+ */
+- (void) setAxisymmetric:(BOOL)flag;
+
+/*!
+ This method returns YES if the workspace is the (r, z) half-plane of
+ a body of revolution, and NO if it's the usual planar slice.
+ */
+- (BOOL) getAxisymmetric;
+
+/*!
+ This method sets the condition on the edges of the workspace - the
+ mirrors, where no field crosses them, or open, where the field goes
+ out as if the potential fell off as one over the distance from the
+ center of the objects. The open edges are exact only for a potential
+ that falls off radially from that center as 1/d - like a net charge
+ in the axisymmetric geometry. For any other field they're just an
+ approximation, which gets better the further the edges are from the
+ objects.
+ */
+- (void) setBoundaryCondition:(SimBoundaryCondition)condition;
+
+/*!
+ This method returns the condition on the edges of the workspace, which
+ is kMirrorBoundary unless it's been set otherwise.
+ */
+- (SimBoundaryCondition) getBoundaryCondition;
+
+/*!
+ This method sets the point in real space that the open boundary sees
+ the field coming from. If either coordinate is NAN - the default - it
+ is the center of the conductors and charges placed on the workspace,
+ and on an axisymmetric workspace, the x of the center is always the
+ axis.
+ */
+- (void) setOpenBoundaryCenter:(NSPoint)center;
+
+/*!
+ This method returns the point in real space that the open boundary
+ sees the field coming from, with NAN coordinates if it's the center of
+ the objects on the workspace.
+ */
+- (NSPoint) getOpenBoundaryCenter;
+
+/*!
+ This method returns the report of the last -simulateWorkspace: the
+ engine, the times it took to assemble, factor and solve the system,
+ the norm of the final residual - and for the iterative engines, the
+ relative residual at each check along the way - and for the direct
+ ones, the fill, the memory and the ordering of the factors. The keys
+ are the kReport constants, and this is nil before the first solve.
+ */
+- (NSDictionary*) getSolveReport;
+
 //----------------------------------------------------------------------------
 //               Coordinate Mapping Methods
 //----------------------------------------------------------------------------
 
 /*!
  This method returns the simulation grid coordinate for the real-space
- x-axis coordinate passed in. If this value does not fit within the
+ x-axis coordinate passed in - the node nearest to it, whether the
+ grid is uniform or graded. If this value does not fit within the
  simulation grid this method will return a -1 to alert the caller that
  this won't come into play in the simulation.
  */
@@ -360,13 +681,32 @@
  node along the x-axis. This is useful in a lot of different ways
  and it's a major convenience method as well. If not enough data
  has been provided to this point to compute this value, NAN will be
- returned to the caller.
+ returned to the caller. On a graded grid, this is the average of the
+ spacings, and -getDeltaXAtCol: has the spacing at a given node.
  */
 - (float) getDeltaX;
 
+/*!
+ This method returns the real-space distance along the x-axis that the
+ node in column 'c' covers - half the interval on either side of it,
+ or just the one interval at the edges. On a uniform grid this is the
+ same as -getDeltaX. If the column isn't on the grid, NAN is returned.
+ */
+- (float) getDeltaXAtCol:(int)c;
+
+/*!
+ This method returns the fractional column - the column of the node at
+ or to the left of 'x', plus how far 'x' is along the interval to the
+ next one - for the real-space x-axis coordinate passed in. This is
+ what's needed to interpolate between the nodes of the grid. If the
+ value isn't within the workspace, NAN is returned.
+ */
+- (float) getColPositionForXValue:(float)x;
+
 /*!
  This method returns the simulation grid coordinate for the real-space
- y-axis coordinate passed in. If this value does not fit within the
+ y-axis coordinate passed in - the node nearest to it, whether the
+ grid is uniform or graded. If this value does not fit within the
  simulation grid this method will return a -1 to alert the caller that
  this won't come into play in the simulation.
  */
@@ -386,10 +726,28 @@
  node along the y-axis. This is useful in a lot of different ways
  and it's a major convenience method as well. If not enough data
  has been provided to this point to compute this value, NAN will be
- returned to the caller.
+ returned to the caller. On a graded grid, this is the average of the
+ spacings, and -getDeltaYAtRow: has the spacing at a given node.
  */
 - (float) getDeltaY;
 
+/*!
+ This method returns the real-space distance along the y-axis that the
+ node in row 'r' covers - half the interval on either side of it, or
+ just the one interval at the edges. On a uniform grid this is the
+ same as -getDeltaY. If the row isn't on the grid, NAN is returned.
+ */
+- (float) getDeltaYAtRow:(int)r;
+
+/*!
+ This method returns the fractional row - the row of the node at or
+ below 'y', plus how far 'y' is along the interval to the next one -
+ for the real-space y-axis coordinate passed in. This is what's needed
+ to interpolate between the nodes of the grid. If the value isn't
+ within the workspace, NAN is returned.
+ */
+- (float) getRowPositionForYValue:(float)y;
+
 /*!
  This method takes a point in real-space and mapps it to the simulation
  grid node that's currently defined for this guy. If a point lies outside
@@ -426,6 +784,65 @@
  */
 - (NSPoint) getPointInWorkspaceAtNodeRow:(int)r andCol:(int)c;
 
+//----------------------------------------------------------------------------
+//               Grid Grading Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns YES if the nodes of the grid are evenly spaced
+ along both axes - which is the way every workspace starts out - and
+ NO if either axis has been graded.
+ */
+- (BOOL) isUniformGrid;
+
+/*!
+ This method sets the real-space x-axis coordinates of the columns of
+ nodes. There must be one for each column, they must increase from
+ one to the next, and the first and last must be the left and right
+ edges of the workspace. If 'x' is NULL, the columns go back to being
+ evenly spaced. Since the grid is changing, anything already placed on
+ the workspace needs to be placed again.
+ */
+- (BOOL) setColCoordinates:(double*)x;
+
+/*!
+ This method sets the real-space y-axis coordinates of the rows of
+ nodes. There must be one for each row, they must increase from one
+ to the next, and the first and last must be the bottom and top edges
+ of the workspace. If 'y' is NULL, the rows go back to being evenly
+ spaced. Since the grid is changing, anything already placed on the
+ workspace needs to be placed again.
+ */
+- (BOOL) setRowCoordinates:(double*)y;
+
+/*!
+ This method grades the columns of nodes toward the 'count' vertical
+ lines at the real-space x-axis coordinates 'xs'. The spacing is the
+ smallest at the lines, and grows by 'ratio' from one interval to the
+ next moving away from them, with the smallest spacing picked so that
+ the columns still span the workspace. A 'ratio' of 1.2 or so puts a
+ good deal of the grid near the lines without the far intervals
+ getting too long.
+ */
+- (BOOL) gradeColsTowardXValues:(double*)xs count:(int)count withRatio:(double)ratio;
+
+/*!
+ This method grades the rows of nodes toward the 'count' horizontal
+ lines at the real-space y-axis coordinates 'ys'. The spacing is the
+ smallest at the lines, and grows by 'ratio' from one interval to the
+ next moving away from them, with the smallest spacing picked so that
+ the rows still span the workspace.
+ */
+- (BOOL) gradeRowsTowardYValues:(double*)ys count:(int)count withRatio:(double)ratio;
+
+/*!
+ This method gives this workspace the same node coordinates as 'ws',
+ which needs to have the same number of rows and columns, and cover
+ the same real-space area. It's what's needed to make a scratch copy
+ of a graded workspace.
+ */
+- (BOOL) copyGridFromWorkspace:(SimWorkspace*)ws;
+
 //----------------------------------------------------------------------------
 //               Initialization Methods
 //----------------------------------------------------------------------------
@@ -473,10 +890,51 @@
  This method will take the existing workspace with all the objects placed
  on it and simulate it for the potential at each simulation grid point.
  This needs to be done before you can get any values out of the workspace,
- but that's pretty obvious if you think about it.
+ but that's pretty obvious if you think about it. The solver that's used
+ is the one set with -setSolverType: - or, in the automatic mode, the
+ one that's predicted to be the quickest for this workspace. The banded
+ LU solver holds on to its factorization, and as long as only the
+ potentials and charges change, the next simulation skips right to the
+ substitutions.
  */
 - (BOOL) simulateWorkspace;
 
+/*!
+ This method sets the initial guess of this workspace from the result
+ of another one that covers some or all of the same real-space region,
+ possibly with a different grid. The other workspace's potentials are
+ interpolated bilinearly onto the nodes of this one, and the nodes that
+ are outside the other workspace are left to start at zero. If the
+ other workspace has no result, this returns NO.
+ */
+- (BOOL) setInitialGuessFromWorkspace:(SimWorkspace*)ws;
+
+/*!
+ This method has this workspace take over the banded LU factorization
+ that another one is holding on to, if the grids are the same size. If
+ the operator of this workspace is the same, or only a few rows off, the
+ next simulation with the LU engine won't have to factor it all again.
+ */
+- (void) reuseFactorizationFrom:(SimWorkspace*)ws;
+
+/*!
+ This method solves the workspace for a whole batch of scenarios at
+ once. Each scenario is the workspace as it stands, but with its own
+ fixed potentials from 'voltages' and its own charge densities from
+ 'rhos' - arrays of MaskedMatrix objects the size of the workspace -
+ and either array can be nil to use the workspace's own for every
+ scenario. The geometry can't change: each of the voltage matrices has
+ to fix exactly the nodes that the workspace does. That means that the
+ operator is the same for all of them, so the banded LU factorization
+ is done once - or reused from the last simulation - and all the
+ scenarios are solved in one multi-RHS substitution. The result is an
+ array of result sets, one per scenario - each a dictionary with the
+ resultant voltage and electric field matrices under the kScenario
+ keys - or nil if it couldn't be done. The workspace's own results are
+ left alone.
+ */
+- (NSArray*) simulateScenariosWithVoltages:(NSArray*)voltages andRhos:(NSArray*)rhos;
+
 //----------------------------------------------------------------------------
 //               NSObject Overridden Methods
 //----------------------------------------------------------------------------
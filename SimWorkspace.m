@@ -7,10 +7,11 @@
 //
 
 // Apple Headers
-#import <Accelerate/Accelerate.h>
 
 // System Headers
 #import <math.h>
+#import <stdlib.h>
+#import <string.h>
 
 // Third Party Headers
 
@@ -18,6 +19,14 @@
 
 // Class Headers
 #import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+#import "SimWorkspace_Multigrid.h"
+#import "SimWorkspace_ConjugateGradient.h"
+#import "SimWorkspace_SOR.h"
+#import "SimWorkspace_Sparse.h"
+#import "SimWorkspace_FastPoisson.h"
+#import "SimWorkspace_Schwarz.h"
+#import "SimWorkspace_Automatic.h"
 
 // Superclass Headers
 
@@ -30,6 +39,214 @@
 // Public Macros
 
 
+/*
+ * On a graded axis, the node positions are held as fractions of the
+ * width (or height) of the workspace, and these find the node nearest
+ * to a fraction 't', and the fractional node - the node at or before
+ * 't' plus how far along the next interval it is. Both are simple
+ * bisections as the fractions are increasing.
+ */
+static int nodeBefore(const double* f, int n, double t)
+{
+	int			lo = 0;
+	int			hi = n - 1;
+	while ((hi - lo) > 1) {
+		int		mid = (lo + hi) / 2;
+		if (f[mid] <= t) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+
+static int nearestNode(const double* f, int n, double t)
+{
+	int			k = nodeBefore(f, n, t);
+	if ((k < (n - 1)) && ((t - f[k]) > (f[k + 1] - t))) {
+		k++;
+	}
+	return k;
+}
+
+
+static double nodePosition(const double* f, int n, double t)
+{
+	int			k = MIN(nodeBefore(f, n, t), n - 2);
+	return k + (t - f[k])/(f[k + 1] - f[k]);
+}
+
+
+/*
+ * This takes the 'n' real-space coordinates of the nodes along an axis
+ * that runs from 'lo' for 'span', and returns them as fractions of the
+ * span - or NULL if they don't increase from one edge to the other. The
+ * ends are allowed a little slop for the rounding of the edges.
+ */
+static double* createFractions(const double* p, int n, double lo, double span)
+{
+	double*		retval = NULL;
+	double		slop = 1.0e-6 * span;
+	BOOL		ok = (n >= 2) && (span > 0.0) && (fabs(p[0] - lo) <= slop) &&
+					 (fabs(p[n - 1] - (lo + span)) <= slop);
+	for (int i = 1; ok && (i < n); i++) {
+		ok = (p[i] > p[i - 1]);
+	}
+	if (ok) {
+		retval = (double *) malloc(n * sizeof(double));
+		if (retval != NULL) {
+			for (int i = 0; i < n; i++) {
+				retval[i] = (p[i] - lo)/span;
+			}
+			retval[0] = 0.0;
+			retval[n - 1] = 1.0;
+		}
+	}
+	return retval;
+}
+
+
+/*
+ * The grading of an axis is done on the unit interval, and then scaled
+ * to the workspace. The spacing is smallest on the chosen lines and
+ * grows by 'ratio' from one interval to the next moving away from them,
+ * which is the same as asking for a spacing that grows linearly with
+ * the distance to the nearest line: h(t) = h0 + (ratio - 1) d(t). The
+ * nodes are then placed so that each interval holds the same amount of
+ * 1/h(t), and h0 is whatever makes that come out to 'n' nodes. Between
+ * the lines, and out to the ends, d(t) is made up of pieces that run
+ * linearly up from 0 to L, or back down to 0, and on each of those the
+ * integral of 1/h(t), and its inverse, are simple logs and exponentials.
+ */
+typedef struct {
+	double		start;
+	double		length;
+	BOOL		rising;
+} GradingPiece;
+
+
+static double gradingIntegral(const GradingPiece* p, int count, double a, double h0)
+{
+	double		sum = 0.0;
+	for (int k = 0; k < count; k++) {
+		sum += log1p(a * p[k].length / h0) / a;
+	}
+	return sum;
+}
+
+
+static BOOL gradedFractions(int n, const double* lines, int count, double ratio, double* f)
+{
+	BOOL			error = NO;
+	double			a = ratio - 1.0;
+	double*			t = NULL;
+	GradingPiece*	pieces = NULL;
+	int				pc = 0;
+
+	// first, make sure we have something to do
+	if ((n < 2) || (count < 1) || !(a > 0.0)) {
+		error = YES;
+	}
+
+	// get the lines in order, and clamped to the axis
+	if (!error) {
+		t = (double *) malloc(count * sizeof(double));
+		pieces = (GradingPiece *) malloc((2 * count + 1) * sizeof(GradingPiece));
+		if ((t == NULL) || (pieces == NULL)) {
+			error = YES;
+		} else {
+			for (int j = 0; j < count; j++) {
+				double		v = MIN(MAX(lines[j], 0.0), 1.0);
+				int			i = j;
+				for (; (i > 0) && (t[i - 1] > v); i--) {
+					t[i] = t[i - 1];
+				}
+				t[i] = v;
+			}
+		}
+	}
+
+	// break the axis up into the pieces running to and from the lines
+	if (!error) {
+		double		edges[2 * count + 2];
+		int			ec = 0;
+		edges[ec++] = 0.0;
+		for (int j = 0; j < count; j++) {
+			if (j > 0) {
+				edges[ec++] = 0.5 * (t[j - 1] + t[j]);
+			}
+			edges[ec++] = t[j];
+		}
+		edges[ec++] = 1.0;
+		for (int k = 0; k < (ec - 1); k++) {
+			if (edges[k + 1] > edges[k]) {
+				pieces[pc].start = edges[k];
+				pieces[pc].length = edges[k + 1] - edges[k];
+				// the pieces that start on a line are the ones moving away from it
+				pieces[pc].rising = (k % 2) == 1;
+				pc++;
+			}
+		}
+	}
+
+	/*
+	 * The integral drops as h0 grows, and it's already less than n-1 for
+	 * the uniform spacing, so bisect - on the log of h0 - below that.
+	 */
+	double		h0 = 1.0/(n - 1);
+	if (!error) {
+		double		lo = log(1.0e-12);
+		double		hi = log(h0);
+		for (int it = 0; it < 200; it++) {
+			double		mid = 0.5 * (lo + hi);
+			if (gradingIntegral(pieces, pc, a, exp(mid)) > (n - 1)) {
+				lo = mid;
+			} else {
+				hi = mid;
+			}
+		}
+		h0 = exp(0.5 * (lo + hi));
+	}
+
+	// now place the nodes at equal steps of the integral
+	if (!error) {
+		double		total = gradingIntegral(pieces, pc, a, h0);
+		double		phiStart = 0.0;
+		int			k = 0;
+		f[0] = 0.0;
+		for (int i = 1; i < (n - 1); i++) {
+			double		phi = total * i / (n - 1);
+			double		span = log1p(a * pieces[k].length / h0) / a;
+			while ((k < (pc - 1)) && (phi > (phiStart + span))) {
+				phiStart += span;
+				k++;
+				span = log1p(a * pieces[k].length / h0) / a;
+			}
+			double		s = MIN(phi - phiStart, span);
+			double		L = pieces[k].length;
+			if (pieces[k].rising) {
+				f[i] = pieces[k].start + h0 * expm1(a * s) / a;
+			} else {
+				f[i] = pieces[k].start + L - ((h0 + a * L) * exp(-a * s) - h0) / a;
+			}
+		}
+		f[n - 1] = 1.0;
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (t != NULL) {
+		free(t);
+	}
+	if (pieces != NULL) {
+		free(pieces);
+	}
+
+	return !error;
+}
+
+
 /*!
  @class SimWorkspace
  This class is the main simulation tool as it brings together the
@@ -591,236 +808,1025 @@
 }
 
 
-//----------------------------------------------------------------------------
-//               Coordinate Mapping Methods
-//----------------------------------------------------------------------------
+/*!
+ This method sets the numerical engine that -simulateWorkspace will use
+ to solve the system of equations for the workspace. The default is the
+ banded LU decomposition in LAPACK, but for the larger grids, the other
+ solvers are going to be a lot faster, and use a lot less memory.
+ */
+- (void) setSolverType:(SimSolverType)type
+{
+	_solverType = type;
+}
+
 
 /*!
- This method returns the simulation grid coordinate for the real-space
- x-axis coordinate passed in. If this value does not fit within the
- simulation grid this method will return a -1 to alert the caller that
- this won't come into play in the simulation.
+ This method returns the numerical engine that -simulateWorkspace will
+ use to solve the system of equations for the workspace.
  */
-- (int) getColForXValue:(float)x
+- (SimSolverType) getSolverType
 {
-	int				retval = -1;
+	return _solverType;
+}
 
-	// first, get the limits of this simulation space
-	float			lo = [self getWorkspaceOrigin].x;
-	float			hi = lo + [self getWorkspaceSize].width;
 
-	// now let's see if the point lies in this space
-	if ((lo <= x) && (x <= hi) && (lo < hi) && ([self getColCount] > 0)) {
-		// do the simple tests first to avoid rounding
-		if (x == lo) {
-			retval = 0;
-		} else if (x == hi) {
-			retval = [self getColCount] - 1;
-		} else {
-			retval = (x - lo) * [self getColCount] / (hi - lo);
-		}
+/*!
+ This method sets the numerical engine - and the cycle, preconditioner
+ or coarse correction that goes with it - by the name it has in the
+ input deck: LU, LU32, CHOL, SPARSE, FPS, MGV, MGW, PCGJ, PCGSSOR,
+ PCGIC, SOR, SCHWARZ, SCHWARZ1 or AUTO. It returns NO, and changes
+ nothing, if the name isn't one of these.
+ */
+- (BOOL) setSolverByName:(NSString*)name
+{
+	BOOL		error = NO;
+
+	name = [name uppercaseString];
+	if ([name isEqualToString:@"LU"]) {
+		[self setSolverType:kBandedLUSolver];
+	} else if ([name isEqualToString:@"LU32"]) {
+		[self setSolverType:kMixedPrecisionLUSolver];
+	} else if ([name isEqualToString:@"CHOL"]) {
+		[self setSolverType:kBandedCholeskySolver];
+	} else if ([name isEqualToString:@"SPARSE"]) {
+		[self setSolverType:kSparseCholeskySolver];
+	} else if ([name isEqualToString:@"FPS"]) {
+		[self setSolverType:kFastPoissonSolver];
+	} else if ([name isEqualToString:@"MGV"]) {
+		[self setSolverType:kMultigridSolver];
+		[self setMultigridCycle:kVCycle];
+	} else if ([name isEqualToString:@"MGW"]) {
+		[self setSolverType:kMultigridSolver];
+		[self setMultigridCycle:kWCycle];
+	} else if ([name isEqualToString:@"PCGJ"]) {
+		[self setSolverType:kConjugateGradientSolver];
+		[self setPreconditioner:kJacobiPreconditioner];
+	} else if ([name isEqualToString:@"PCGSSOR"]) {
+		[self setSolverType:kConjugateGradientSolver];
+		[self setPreconditioner:kSSORPreconditioner];
+	} else if ([name isEqualToString:@"PCGIC"]) {
+		[self setSolverType:kConjugateGradientSolver];
+		[self setPreconditioner:kIncompleteCholeskyPreconditioner];
+	} else if ([name isEqualToString:@"SOR"]) {
+		[self setSolverType:kSORSolver];
+	} else if ([name isEqualToString:@"SCHWARZ"]) {
+		[self setSolverType:kSchwarzSolver];
+		[self setSchwarzCoarseCorrection:YES];
+	} else if ([name isEqualToString:@"SCHWARZ1"]) {
+		[self setSolverType:kSchwarzSolver];
+		[self setSchwarzCoarseCorrection:NO];
+	} else if ([name isEqualToString:@"AUTO"]) {
+		[self setSolverType:kAutomaticSolver];
+	} else {
+		error = YES;
 	}
-	return retval;
+
+	return !error;
 }
 
 
 /*!
- This method returns the real-space x-axis coordinate for the
- simulation grid coordinate passed in. If this value does not fit within
- the simulation grid this method will return NAN to alert the caller that
- this won't come into play in the simulation. You can test this with
- isnan() to see if an error occurred.
+ This method returns the name - as it would be in the input deck - of
+ the numerical engine that -simulateWorkspace will use.
  */
-- (float) getXValueForCol:(int)c
+- (NSString*) getSolverName
 {
-	float			retval = NAN;
-
-	if ((c >= 0) && (c < [self getColCount])) {
-		retval = [self getWorkspaceOrigin].x + (c / ([self getColCount] - 1.0)) * [self getWorkspaceSize].width;
+	NSString*		retval = nil;
+
+	switch ([self getSolverType]) {
+		case kMultigridSolver:
+			retval = ([self getMultigridCycle] == kWCycle ? @"MGW" : @"MGV");
+			break;
+		case kConjugateGradientSolver:
+			switch ([self getPreconditioner]) {
+				case kSSORPreconditioner:
+					retval = @"PCGSSOR";
+					break;
+				case kIncompleteCholeskyPreconditioner:
+					retval = @"PCGIC";
+					break;
+				case kJacobiPreconditioner:
+				default:
+					retval = @"PCGJ";
+					break;
+			}
+			break;
+		case kSORSolver:
+			retval = @"SOR";
+			break;
+		case kBandedCholeskySolver:
+			retval = @"CHOL";
+			break;
+		case kSparseCholeskySolver:
+			retval = @"SPARSE";
+			break;
+		case kFastPoissonSolver:
+			retval = @"FPS";
+			break;
+		case kMixedPrecisionLUSolver:
+			retval = @"LU32";
+			break;
+		case kSchwarzSolver:
+			retval = ([self getSchwarzCoarseCorrection] ? @"SCHWARZ" : @"SCHWARZ1");
+			break;
+		case kAutomaticSolver:
+			retval = @"AUTO";
+			break;
+		case kBandedLUSolver:
+		default:
+			retval = @"LU";
+			break;
 	}
+
 	return retval;
 }
 
 
 /*!
- This method returns the distance in real-space of each simulation
- node along the x-axis. This is useful in a lot of different ways
- and it's a major convenience method as well. If not enough data
- has been provided to this point to compute this value, NAN will be
- returned to the caller.
+ This method sets the type of cycle the multigrid solver will use - a
+ V-cycle is the cheapest, but a W-cycle can be more robust when there
+ are a lot of thin conductors in the workspace.
  */
-- (float) getDeltaX
+- (void) setMultigridCycle:(MultigridCycle)cycle
 {
-	float		retval = NAN;
+	_multigridCycle = cycle;
+}
 
-	if ([self getColCount] != 0) {
-		retval = [self getWorkspaceSize].width/([self getColCount] - 1.0);
-	}
-	return retval;
+
+/*!
+ This method returns the type of cycle the multigrid solver will use.
+ */
+- (MultigridCycle) getMultigridCycle
+{
+	return _multigridCycle;
 }
 
 
 /*!
- This method returns the simulation grid coordinate for the real-space
- y-axis coordinate passed in. If this value does not fit within the
- simulation grid this method will return a -1 to alert the caller that
- this won't come into play in the simulation.
+ This method sets the preconditioner that the conjugate gradient solver
+ will use. Jacobi is the cheapest per iteration, but SSOR and IC(0) take
+ a lot fewer iterations on the larger grids.
  */
-- (int) getRowForYValue:(float)y
+- (void) setPreconditioner:(CGPreconditioner)type
 {
-	int				retval = -1;
+	_preconditioner = type;
+}
 
-	// first, get the limits of this simulation space
-	float			lo = [self getWorkspaceOrigin].y;
-	float			hi = lo + [self getWorkspaceSize].height;
 
-	// now let's see if the point lies in this space
-	if ((lo <= y) && (y <= hi) && (lo < hi) && ([self getRowCount] > 0)) {
-		// do the simple tests first to avoid rounding
-		if (y == lo) {
-			retval = 0;
-		} else if (y == hi) {
-			retval = [self getRowCount] - 1;
-		} else {
-			retval = (y - lo) * [self getRowCount] / (hi - lo);
-		}
-	}
-	return retval;
+/*!
+ This method returns the preconditioner that the conjugate gradient
+ solver will use.
+ */
+- (CGPreconditioner) getPreconditioner
+{
+	return _preconditioner;
 }
 
 
 /*!
- This method returns the real-space y-axis coordinate for the
- simulation grid coordinate passed in. If this value does not fit within
- the simulation grid this method will return NAN to alert the caller that
- this won't come into play in the simulation. You can test this with
- isnan() to see if an error occurred.
+ This method sets whether the domain decomposition solver follows each
+ sweep over its blocks with a correction on a coarse grid. The blocks
+ only pass the error along to their neighbors a little each sweep, so
+ without it, the sweeps it takes grow with the number of blocks.
  */
-- (float) getYValueForRow:(int)r
+- (void) setSchwarzCoarseCorrection:(BOOL)flag
 {
-	float			retval = NAN;
+	_schwarzCoarseCorrection = flag;
+}
 
-	if ((r >= 0) && (r < [self getRowCount])) {
-		retval = [self getWorkspaceOrigin].y + (r / ([self getRowCount] - 1.0)) * [self getWorkspaceSize].height;
-	}
-	return retval;
+
+/*!
+ This method returns YES if the domain decomposition solver follows
+ each sweep over its blocks with a correction on a coarse grid.
+ */
+- (BOOL) getSchwarzCoarseCorrection
+{
+	return _schwarzCoarseCorrection;
 }
 
 
 /*!
- This method returns the distance in real-space of each simulation
- node along the y-axis. This is useful in a lot of different ways
- and it's a major convenience method as well. If not enough data
- has been provided to this point to compute this value, NAN will be
- returned to the caller.
+ This method sets the tolerance on the relative residual, |b - Ax|/|b|,
+ that the iterative solvers will use to know when they're done. The
+ direct solvers don't need this, as they're as good as it gets.
  */
-- (float) getDeltaY
+- (void) setTolerance:(double)tol
 {
-	float		retval = NAN;
+	_tolerance = tol;
+}
 
-	if ([self getRowCount] != 0) {
-		retval = [self getWorkspaceSize].height/([self getRowCount] - 1.0);
-	}
-	return retval;
+
+/*!
+ This method returns the tolerance on the relative residual that the
+ iterative solvers will use to know when they're done.
+ */
+- (double) getTolerance
+{
+	return _tolerance;
 }
 
 
 /*!
- This method takes a point in real-space and mapps it to the simulation
- grid node that's currently defined for this guy. If a point lies outside
- of the simulation grid it will have a value of -1. While the NSPoint can
- hold float values, the returned values will be ints as they are grid
- locations and therefore need to be integers.
+ This method sets the maximum number of iterations (or cycles) that
+ the iterative solvers will do before giving up on reaching the
+ tolerance and reporting the failure to converge. If this is zero, each
+ solver picks a limit that makes sense for it and the size of the grid.
  */
-- (NSPoint) getNodeInWorkspace:(NSPoint)p
+- (void) setMaxIterations:(int)count
 {
-	return [self getNodeInWorkspaceAtX:p.x Y:p.y];
+	_maxIterations = count;
 }
 
 
 /*!
- This method takes the real-space point specified by the ordinal (x,y)
- and maps it to the currently defined simulation grid for this guy. If
- the point lies outside of the simulation grid then the coordinate
- (-1,-1) will be returned. Make sure to check this before you use it
- as it'll cause nasty array indexing problems if you hand it a -1.
+ This method returns the maximum number of iterations (or cycles) that
+ the iterative solvers will do before giving up.
  */
-- (NSPoint) getNodeInWorkspaceAtX:(float)x Y:(float)y
+- (int) getMaxIterations
 {
-	NSPoint			retval;
-	// first, get the individual compponents
-	retval.x = [self getColForXValue:x];
-	retval.y = [self getRowForYValue:y];
-	// next, make sure neither was out of bounds
-	if ((retval.x < 0) || (retval.y < 0)) {
-		retval.x = -1;
-		retval.y = -1;
+	return _maxIterations;
+}
+
+/*!
+ This method sets the potentials that the iterative solvers start from
+ on the free nodes - a node without a value starts at zero. This is
+ usually the result of the last simulation, so that re-running after a
+ small change to the workspace takes a fraction of the iterations. If
+ there's no initial guess, the iterative solvers start from the last
+ result of this workspace, if there is one.
+ */
+- (void) setInitialGuess:(MaskedMatrix*)guess
+{
+	if (_initialGuess != guess) {
+		[_initialGuess release];
+		_initialGuess = [guess retain];
 	}
-	return retval;
 }
 
 
 /*!
- This method takes the simulation coordinates in the supplied NSPoint
- as grid node rows and columns and converts these to real-world values
- as defined in this workspace instance. It's the inverse of the
- -getNodeInWorkspace: method, and is very useful when doing the reverse
- mapping of the coordinates.
+ This method returns the potentials that the iterative solvers start
+ from, or nil if there aren't any.
  */
-- (NSPoint) getPointInWorkspaceAtNode:(NSPoint)p
+- (MaskedMatrix*) getInitialGuess
 {
-	return [self getPointInWorkspaceAtNodeRow:(int)p.x andCol:(int)p.y];
+	return _initialGuess;
 }
 
 
 /*!
- This method takes supplied the simulation row and column coordinates
- as grid node values and converts these to real-world values
- as defined in this workspace instance. It's the inverse of the
- -getNodeInWorkspaceAtX:Y: method, and is very useful when doing the
- reverse mapping of the coordinates.
+ This method sets the number of extra nodes that the workspace can add
+ in refined patches around the conductor edges and other places where
+ the field changes quickly. If this is zero - the default - the regular
+ grid is all there is.
  */
-- (NSPoint) getPointInWorkspaceAtNodeRow:(int)r andCol:(int)c
+- (void) setRefinementBudget:(int)nodes
 {
-	NSPoint			retval;
-	// first, get the individual compponents
-	retval.x = [self getXValueForCol:c];
-	retval.y = [self getYValueForRow:r];
-	return retval;
+	_refinementBudget = MAX(nodes, 0);
 }
 
 
-//----------------------------------------------------------------------------
-//               Initialization Methods
-//----------------------------------------------------------------------------
-
 /*!
- This initialization method takes the real-space simulation rectangle as well
- as the number of rows and columns that will be used in the simulation grid.
- We'll initialize everything, allocate all the storage for the different
- constants and in general make sure that things are ready for the addition
- of simulation objects on the workspace. After that, it's a simulation call
- and you get the answers.
+ This method returns the number of extra nodes that the workspace can
+ add in refined patches, or zero if there's no refinement.
  */
-- (id) initWithRect:(NSRect)r usingRows:(int)rowCnt andCols:(int)colCnt
+- (int) getRefinementBudget
 {
-	return [self initWithSize:r.size andOrigin:r.origin usingRows:rowCnt andCols:colCnt];
+	return _refinementBudget;
 }
 
 
 /*!
- This initialization method takes the real-space simulation origin and size
- as well as the number of rows and columns that will be used in the
- simulation grid. We'll initialize everything, allocate all the storage for
- the different constants and in general make sure that things are ready for
- the addition of simulation objects on the workspace. After that, it's a
- simulation call and you get the answers.
+ This method sets how much coarser the first preview of a progressive
+ simulation is than the workspace's grid - 4 or 8 are good choices.
+ The workspace is solved on a grid that many times coarser, then on
+ one twice as fine, and so on up to the real grid, with each one
+ starting from the last. Anything that's not a power of two is rounded
+ down to the next lower power of two, and zero - the default - or one
+ turns the previews off.
  */
-- (id) initWithSize:(NSSize)size andOrigin:(NSPoint)p usingRows:(int)rowCnt andCols:(int)colCnt
+- (void) setPreviewFactor:(int)factor
 {
-	BOOL			error = NO;
+	int		f = 0;
+	if (factor >= 2) {
+		f = 2;
+		while ((2 * f) <= factor) {
+			f *= 2;
+		}
+	}
+	_previewFactor = f;
+}
 
-	// first, let's check the arguments for reasonable values
+
+/*!
+ This method returns how much coarser the first preview of a
+ progressive simulation is than the workspace's grid, or zero if the
+ previews are off.
+ */
+- (int) getPreviewFactor
+{
+	return _previewFactor;
+}
+
+
+/*!
+ This method sets whether the workspace is the (r, z) half-plane of a
+ body of revolution - x is the radius and y is the axis - rather than
+ a slice of something that goes on forever in z. Then a circle is a
+ ring around the axis, a rectangle is a cylinder - or a tube, if it's
+ off the axis - and the edge at x = 0 is the axis itself. The origin
+ of the workspace can't be at a negative radius.
+ */
+- (void) setAxisymmetric:(BOOL)flag
+{
+	_axisymmetric = flag;
+}
+
+
+/*!
+ This method returns YES if the workspace is the (r, z) half-plane of
+ a body of revolution, and NO if it's the usual planar slice.
+ */
+- (BOOL) getAxisymmetric
+{
+	return _axisymmetric;
+}
+
+
+/*!
+ This method sets the condition on the edges of the workspace - the
+ mirrors, where no field crosses them, or open, where the field goes
+ out as if the potential fell off as one over the distance from the
+ center of the objects. The open edges are exact only for a potential
+ that falls off radially from that center as 1/d - like a net charge
+ in the axisymmetric geometry. For any other field they're just an
+ approximation, which gets better the further the edges are from the
+ objects.
+ */
+- (void) setBoundaryCondition:(SimBoundaryCondition)condition
+{
+	_boundaryCondition = condition;
+}
+
+
+/*!
+ This method returns the condition on the edges of the workspace, which
+ is kMirrorBoundary unless it's been set otherwise.
+ */
+- (SimBoundaryCondition) getBoundaryCondition
+{
+	return _boundaryCondition;
+}
+
+
+/*!
+ This method sets the point in real space that the open boundary sees
+ the field coming from. If either coordinate is NAN - the default - it
+ is the center of the conductors and charges placed on the workspace,
+ and on an axisymmetric workspace, the x of the center is always the
+ axis.
+ */
+- (void) setOpenBoundaryCenter:(NSPoint)center
+{
+	_openBoundaryCenter = center;
+}
+
+
+/*!
+ This method returns the point in real space that the open boundary
+ sees the field coming from, with NAN coordinates if it's the center of
+ the objects on the workspace.
+ */
+- (NSPoint) getOpenBoundaryCenter
+{
+	return _openBoundaryCenter;
+}
+
+
+/*!
+ This method returns the report of the last -simulateWorkspace: the
+ engine, the times it took to assemble, factor and solve the system,
+ the norm of the final residual - and for the iterative engines, the
+ relative residual at each check along the way - and for the direct
+ ones, the fill, the memory and the ordering of the factors. The keys
+ are the kReport constants, and this is nil before the first solve.
+ */
+- (NSDictionary*) getSolveReport
+{
+	return _lastSolveReport;
+}
+
+
+
+//----------------------------------------------------------------------------
+//               Coordinate Mapping Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the simulation grid coordinate for the real-space
+ x-axis coordinate passed in - the node nearest to it, whether the
+ grid is uniform or graded. If this value does not fit within the
+ simulation grid this method will return a -1 to alert the caller that
+ this won't come into play in the simulation.
+ */
+- (int) getColForXValue:(float)x
+{
+	int				retval = -1;
+
+	// first, get the limits of this simulation space
+	float			lo = [self getWorkspaceOrigin].x;
+	float			hi = lo + [self getWorkspaceSize].width;
+
+	// now let's see if the point lies in this space
+	if ((lo <= x) && (x <= hi) && (lo < hi) && ([self getColCount] > 0)) {
+		// do the simple tests first to avoid rounding
+		if (x == lo) {
+			retval = 0;
+		} else if (x == hi) {
+			retval = [self getColCount] - 1;
+		} else if ([self _getColFractions] != NULL) {
+			retval = nearestNode([self _getColFractions], [self getColCount], (x - lo) / (hi - lo));
+		} else {
+			retval = (int)lround((x - lo) * ([self getColCount] - 1) / (hi - lo));
+		}
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the real-space x-axis coordinate for the
+ simulation grid coordinate passed in. If this value does not fit within
+ the simulation grid this method will return NAN to alert the caller that
+ this won't come into play in the simulation. You can test this with
+ isnan() to see if an error occurred.
+ */
+- (float) getXValueForCol:(int)c
+{
+	float			retval = NAN;
+
+	if ((c >= 0) && (c < [self getColCount])) {
+		double		f = ([self _getColFractions] != NULL ? [self _getColFractions][c] : c / ([self getColCount] - 1.0));
+		retval = [self getWorkspaceOrigin].x + f * [self getWorkspaceSize].width;
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the distance in real-space of each simulation
+ node along the x-axis. This is useful in a lot of different ways
+ and it's a major convenience method as well. If not enough data
+ has been provided to this point to compute this value, NAN will be
+ returned to the caller. On a graded grid, this is the average of the
+ spacings, and -getDeltaXAtCol: has the spacing at a given node.
+ */
+- (float) getDeltaX
+{
+	float		retval = NAN;
+
+	if ([self getColCount] != 0) {
+		retval = [self getWorkspaceSize].width/([self getColCount] - 1.0);
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the real-space distance along the x-axis that the
+ node in column 'c' covers - half the interval on either side of it,
+ or just the one interval at the edges. On a uniform grid this is the
+ same as -getDeltaX. If the column isn't on the grid, NAN is returned.
+ */
+- (float) getDeltaXAtCol:(int)c
+{
+	float		retval = NAN;
+	int			cols = [self getColCount];
+	double*		f = [self _getColFractions];
+
+	if ((f == NULL) || (cols < 2)) {
+		retval = [self getDeltaX];
+	} else if ((c >= 0) && (c < cols)) {
+		double		left = (c > 0) ? (f[c] - f[c - 1]) : (f[1] - f[0]);
+		double		right = (c < (cols - 1)) ? (f[c + 1] - f[c]) : left;
+		retval = 0.5 * (left + right) * [self getWorkspaceSize].width;
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the fractional column - the column of the node at
+ or to the left of 'x', plus how far 'x' is along the interval to the
+ next one - for the real-space x-axis coordinate passed in. This is
+ what's needed to interpolate between the nodes of the grid. If the
+ value isn't within the workspace, NAN is returned.
+ */
+- (float) getColPositionForXValue:(float)x
+{
+	float		retval = NAN;
+	int			cols = [self getColCount];
+	float		lo = [self getWorkspaceOrigin].x;
+	float		width = [self getWorkspaceSize].width;
+
+	if ((lo <= x) && (x <= (lo + width)) && (width > 0) && (cols >= 2)) {
+		if ([self _getColFractions] != NULL) {
+			retval = nodePosition([self _getColFractions], cols, (x - lo) / width);
+		} else {
+			retval = (x - lo) * (cols - 1) / width;
+		}
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the simulation grid coordinate for the real-space
+ y-axis coordinate passed in - the node nearest to it, whether the
+ grid is uniform or graded. If this value does not fit within the
+ simulation grid this method will return a -1 to alert the caller that
+ this won't come into play in the simulation.
+ */
+- (int) getRowForYValue:(float)y
+{
+	int				retval = -1;
+
+	// first, get the limits of this simulation space
+	float			lo = [self getWorkspaceOrigin].y;
+	float			hi = lo + [self getWorkspaceSize].height;
+
+	// now let's see if the point lies in this space
+	if ((lo <= y) && (y <= hi) && (lo < hi) && ([self getRowCount] > 0)) {
+		// do the simple tests first to avoid rounding
+		if (y == lo) {
+			retval = 0;
+		} else if (y == hi) {
+			retval = [self getRowCount] - 1;
+		} else if ([self _getRowFractions] != NULL) {
+			retval = nearestNode([self _getRowFractions], [self getRowCount], (y - lo) / (hi - lo));
+		} else {
+			retval = (int)lround((y - lo) * ([self getRowCount] - 1) / (hi - lo));
+		}
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the real-space y-axis coordinate for the
+ simulation grid coordinate passed in. If this value does not fit within
+ the simulation grid this method will return NAN to alert the caller that
+ this won't come into play in the simulation. You can test this with
+ isnan() to see if an error occurred.
+ */
+- (float) getYValueForRow:(int)r
+{
+	float			retval = NAN;
+
+	if ((r >= 0) && (r < [self getRowCount])) {
+		double		f = ([self _getRowFractions] != NULL ? [self _getRowFractions][r] : r / ([self getRowCount] - 1.0));
+		retval = [self getWorkspaceOrigin].y + f * [self getWorkspaceSize].height;
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the distance in real-space of each simulation
+ node along the y-axis. This is useful in a lot of different ways
+ and it's a major convenience method as well. If not enough data
+ has been provided to this point to compute this value, NAN will be
+ returned to the caller. On a graded grid, this is the average of the
+ spacings, and -getDeltaYAtRow: has the spacing at a given node.
+ */
+- (float) getDeltaY
+{
+	float		retval = NAN;
+
+	if ([self getRowCount] != 0) {
+		retval = [self getWorkspaceSize].height/([self getRowCount] - 1.0);
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the real-space distance along the y-axis that the
+ node in row 'r' covers - half the interval on either side of it, or
+ just the one interval at the edges. On a uniform grid this is the
+ same as -getDeltaY. If the row isn't on the grid, NAN is returned.
+ */
+- (float) getDeltaYAtRow:(int)r
+{
+	float		retval = NAN;
+	int			rows = [self getRowCount];
+	double*		f = [self _getRowFractions];
+
+	if ((f == NULL) || (rows < 2)) {
+		retval = [self getDeltaY];
+	} else if ((r >= 0) && (r < rows)) {
+		double		below = (r > 0) ? (f[r] - f[r - 1]) : (f[1] - f[0]);
+		double		above = (r < (rows - 1)) ? (f[r + 1] - f[r]) : below;
+		retval = 0.5 * (below + above) * [self getWorkspaceSize].height;
+	}
+	return retval;
+}
+
+
+/*!
+ This method returns the fractional row - the row of the node at or
+ below 'y', plus how far 'y' is along the interval to the next one -
+ for the real-space y-axis coordinate passed in. This is what's needed
+ to interpolate between the nodes of the grid. If the value isn't
+ within the workspace, NAN is returned.
+ */
+- (float) getRowPositionForYValue:(float)y
+{
+	float		retval = NAN;
+	int			rows = [self getRowCount];
+	float		lo = [self getWorkspaceOrigin].y;
+	float		height = [self getWorkspaceSize].height;
+
+	if ((lo <= y) && (y <= (lo + height)) && (height > 0) && (rows >= 2)) {
+		if ([self _getRowFractions] != NULL) {
+			retval = nodePosition([self _getRowFractions], rows, (y - lo) / height);
+		} else {
+			retval = (y - lo) * (rows - 1) / height;
+		}
+	}
+	return retval;
+}
+
+
+/*!
+ This method takes a point in real-space and mapps it to the simulation
+ grid node that's currently defined for this guy. If a point lies outside
+ of the simulation grid it will have a value of -1. While the NSPoint can
+ hold float values, the returned values will be ints as they are grid
+ locations and therefore need to be integers.
+ */
+- (NSPoint) getNodeInWorkspace:(NSPoint)p
+{
+	return [self getNodeInWorkspaceAtX:p.x Y:p.y];
+}
+
+
+/*!
+ This method takes the real-space point specified by the ordinal (x,y)
+ and maps it to the currently defined simulation grid for this guy. If
+ the point lies outside of the simulation grid then the coordinate
+ (-1,-1) will be returned. Make sure to check this before you use it
+ as it'll cause nasty array indexing problems if you hand it a -1.
+ */
+- (NSPoint) getNodeInWorkspaceAtX:(float)x Y:(float)y
+{
+	NSPoint			retval;
+	// first, get the individual compponents
+	retval.x = [self getColForXValue:x];
+	retval.y = [self getRowForYValue:y];
+	// next, make sure neither was out of bounds
+	if ((retval.x < 0) || (retval.y < 0)) {
+		retval.x = -1;
+		retval.y = -1;
+	}
+	return retval;
+}
+
+
+/*!
+ This method takes the simulation coordinates in the supplied NSPoint
+ as grid node rows and columns and converts these to real-world values
+ as defined in this workspace instance. It's the inverse of the
+ -getNodeInWorkspace: method, and is very useful when doing the reverse
+ mapping of the coordinates.
+ */
+- (NSPoint) getPointInWorkspaceAtNode:(NSPoint)p
+{
+	return [self getPointInWorkspaceAtNodeRow:(int)p.x andCol:(int)p.y];
+}
+
+
+/*!
+ This method takes supplied the simulation row and column coordinates
+ as grid node values and converts these to real-world values
+ as defined in this workspace instance. It's the inverse of the
+ -getNodeInWorkspaceAtX:Y: method, and is very useful when doing the
+ reverse mapping of the coordinates.
+ */
+- (NSPoint) getPointInWorkspaceAtNodeRow:(int)r andCol:(int)c
+{
+	NSPoint			retval;
+	// first, get the individual compponents
+	retval.x = [self getXValueForCol:c];
+	retval.y = [self getYValueForRow:r];
+	return retval;
+}
+
+
+//----------------------------------------------------------------------------
+//               Grid Grading Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns YES if the nodes of the grid are evenly spaced
+ along both axes - which is the way every workspace starts out - and
+ NO if either axis has been graded.
+ */
+- (BOOL) isUniformGrid
+{
+	return ([self _getColFractions] == NULL) && ([self _getRowFractions] == NULL);
+}
+
+
+/*!
+ This method sets the real-space x-axis coordinates of the columns of
+ nodes. There must be one for each column, they must increase from
+ one to the next, and the first and last must be the left and right
+ edges of the workspace. If 'x' is NULL, the columns go back to being
+ evenly spaced. Since the grid is changing, anything already placed on
+ the workspace needs to be placed again.
+ */
+- (BOOL) setColCoordinates:(double*)x
+{
+	BOOL			error = NO;
+	double*			f = NULL;
+
+	if (x != NULL) {
+		f = createFractions(x, [self getColCount], [self getWorkspaceOrigin].x, [self getWorkspaceSize].width);
+		if (f == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -setColCoordinates:] - the %d column coordinates don't increase from the left edge of the workspace (%f) to the right edge (%f). Please check the coordinates.", [self getColCount], [self getWorkspaceOrigin].x, [self getWorkspaceOrigin].x + [self getWorkspaceSize].width);
+		}
+	}
+
+	if (!error) {
+		[self _setColFractions:f];
+		// ...and what was computed on the old grid is no good now
+		[self _setFactorization:nil];
+		[self clearWorkspace];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method sets the real-space y-axis coordinates of the rows of
+ nodes. There must be one for each row, they must increase from one
+ to the next, and the first and last must be the bottom and top edges
+ of the workspace. If 'y' is NULL, the rows go back to being evenly
+ spaced. Since the grid is changing, anything already placed on the
+ workspace needs to be placed again.
+ */
+- (BOOL) setRowCoordinates:(double*)y
+{
+	BOOL			error = NO;
+	double*			f = NULL;
+
+	if (y != NULL) {
+		f = createFractions(y, [self getRowCount], [self getWorkspaceOrigin].y, [self getWorkspaceSize].height);
+		if (f == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -setRowCoordinates:] - the %d row coordinates don't increase from the bottom edge of the workspace (%f) to the top edge (%f). Please check the coordinates.", [self getRowCount], [self getWorkspaceOrigin].y, [self getWorkspaceOrigin].y + [self getWorkspaceSize].height);
+		}
+	}
+
+	if (!error) {
+		[self _setRowFractions:f];
+		// ...and what was computed on the old grid is no good now
+		[self _setFactorization:nil];
+		[self clearWorkspace];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method grades the columns of nodes toward the 'count' vertical
+ lines at the real-space x-axis coordinates 'xs'. The spacing is the
+ smallest at the lines, and grows by 'ratio' from one interval to the
+ next moving away from them, with the smallest spacing picked so that
+ the columns still span the workspace. A 'ratio' of 1.2 or so puts a
+ good deal of the grid near the lines without the far intervals
+ getting too long.
+ */
+- (BOOL) gradeColsTowardXValues:(double*)xs count:(int)count withRatio:(double)ratio
+{
+	BOOL			error = NO;
+	int				cols = [self getColCount];
+	double			lo = [self getWorkspaceOrigin].x;
+	double			width = [self getWorkspaceSize].width;
+	double*			t = NULL;
+	double*			f = NULL;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((xs == NULL) || (count <= 0) || !(ratio > 1.0) || (cols < 3)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeColsTowardXValues:count:withRatio:] - the grading needs at least one line, a ratio greater than 1 (not %f), and at least 3 columns (not %d). Please check the arguments.", ratio, cols);
+		}
+	}
+
+	// get the lines as fractions of the width, and the storage for the nodes
+	if (!error) {
+		t = (double *) malloc(count * sizeof(double));
+		f = (double *) malloc(cols * sizeof(double));
+		if ((t == NULL) || (f == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeColsTowardXValues:count:withRatio:] - while trying to allocate the %d column positions, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", cols);
+		} else {
+			for (int j = 0; j < count; j++) {
+				t[j] = (xs[j] - lo)/width;
+			}
+		}
+	}
+
+	// ...and let the grading place them
+	if (!error) {
+		if (!gradedFractions(cols, t, count, ratio, f)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeColsTowardXValues:count:withRatio:] - the %d columns could not be graded toward the %d lines. Please check the arguments.", cols, count);
+		} else {
+			[self _setColFractions:f];
+			f = NULL;
+			// ...and what was computed on the old grid is no good now
+			[self _setFactorization:nil];
+			[self clearWorkspace];
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (t != NULL) {
+		free(t);
+	}
+	if (f != NULL) {
+		free(f);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method grades the rows of nodes toward the 'count' horizontal
+ lines at the real-space y-axis coordinates 'ys'. The spacing is the
+ smallest at the lines, and grows by 'ratio' from one interval to the
+ next moving away from them, with the smallest spacing picked so that
+ the rows still span the workspace.
+ */
+- (BOOL) gradeRowsTowardYValues:(double*)ys count:(int)count withRatio:(double)ratio
+{
+	BOOL			error = NO;
+	int				rows = [self getRowCount];
+	double			lo = [self getWorkspaceOrigin].y;
+	double			height = [self getWorkspaceSize].height;
+	double*			t = NULL;
+	double*			f = NULL;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((ys == NULL) || (count <= 0) || !(ratio > 1.0) || (rows < 3)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeRowsTowardYValues:count:withRatio:] - the grading needs at least one line, a ratio greater than 1 (not %f), and at least 3 rows (not %d). Please check the arguments.", ratio, rows);
+		}
+	}
+
+	// get the lines as fractions of the height, and the storage for the nodes
+	if (!error) {
+		t = (double *) malloc(count * sizeof(double));
+		f = (double *) malloc(rows * sizeof(double));
+		if ((t == NULL) || (f == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeRowsTowardYValues:count:withRatio:] - while trying to allocate the %d row positions, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rows);
+		} else {
+			for (int j = 0; j < count; j++) {
+				t[j] = (ys[j] - lo)/height;
+			}
+		}
+	}
+
+	// ...and let the grading place them
+	if (!error) {
+		if (!gradedFractions(rows, t, count, ratio, f)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -gradeRowsTowardYValues:count:withRatio:] - the %d rows could not be graded toward the %d lines. Please check the arguments.", rows, count);
+		} else {
+			[self _setRowFractions:f];
+			f = NULL;
+			// ...and what was computed on the old grid is no good now
+			[self _setFactorization:nil];
+			[self clearWorkspace];
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (t != NULL) {
+		free(t);
+	}
+	if (f != NULL) {
+		free(f);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method gives this workspace the same node coordinates as 'ws',
+ which needs to have the same number of rows and columns, and cover
+ the same real-space area. It's what's needed to make a scratch copy
+ of a graded workspace.
+ */
+- (BOOL) copyGridFromWorkspace:(SimWorkspace*)ws
+{
+	BOOL			error = NO;
+	int				rows = [self getRowCount];
+	int				cols = [self getColCount];
+	double*			fx = NULL;
+	double*			fy = NULL;
+
+	// first, make sure the grids are the same shape
+	if (!error) {
+		if ((ws == nil) || ([ws getRowCount] != rows) || ([ws getColCount] != cols) ||
+			!NSEqualRects([ws getWorkspaceRect], [self getWorkspaceRect])) {
+			error = YES;
+			NSLog(@"[SimWorkspace -copyGridFromWorkspace:] - the other workspace is nil or isn't the same %dx%d grid over the same area as this one. Please check the arguments.", rows, cols);
+		}
+	}
+
+	// copy the positions of the nodes - if they aren't evenly spaced
+	if (!error) {
+		if ([ws _getColFractions] != NULL) {
+			fx = (double *) malloc(cols * sizeof(double));
+		}
+		if ([ws _getRowFractions] != NULL) {
+			fy = (double *) malloc(rows * sizeof(double));
+		}
+		if ((([ws _getColFractions] != NULL) && (fx == NULL)) ||
+			(([ws _getRowFractions] != NULL) && (fy == NULL))) {
+			error = YES;
+			NSLog(@"[SimWorkspace -copyGridFromWorkspace:] - while trying to allocate the node positions, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.");
+		} else {
+			if (fx != NULL) {
+				memcpy(fx, [ws _getColFractions], cols * sizeof(double));
+			}
+			if (fy != NULL) {
+				memcpy(fy, [ws _getRowFractions], rows * sizeof(double));
+			}
+			[self _setColFractions:fx];
+			[self _setRowFractions:fy];
+			fx = NULL;
+			fy = NULL;
+			// ...and what was computed on the old grid is no good now
+			[self _setFactorization:nil];
+			[self clearWorkspace];
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (fx != NULL) {
+		free(fx);
+	}
+	if (fy != NULL) {
+		free(fy);
+	}
+
+	return !error;
+}
+
+
+//----------------------------------------------------------------------------
+//               Initialization Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This initialization method takes the real-space simulation rectangle as well
+ as the number of rows and columns that will be used in the simulation grid.
+ We'll initialize everything, allocate all the storage for the different
+ constants and in general make sure that things are ready for the addition
+ of simulation objects on the workspace. After that, it's a simulation call
+ and you get the answers.
+ */
+- (id) initWithRect:(NSRect)r usingRows:(int)rowCnt andCols:(int)colCnt
+{
+	return [self initWithSize:r.size andOrigin:r.origin usingRows:rowCnt andCols:colCnt];
+}
+
+
+/*!
+ This initialization method takes the real-space simulation origin and size
+ as well as the number of rows and columns that will be used in the
+ simulation grid. We'll initialize everything, allocate all the storage for
+ the different constants and in general make sure that things are ready for
+ the addition of simulation objects on the workspace. After that, it's a
+ simulation call and you get the answers.
+ */
+- (id) initWithSize:(NSSize)size andOrigin:(NSPoint)p usingRows:(int)rowCnt andCols:(int)colCnt
+{
+	BOOL			error = NO;
+
+	// first, let's check the arguments for reasonable values
 	if (!error) {
 		if ((size.width <= 0) || (size.height <= 0)) {
 			error = YES;
@@ -891,6 +1897,16 @@
 		[self _setRho:rho];
 		[self _setEpsilonR:er];
 		[self _setVoltage:v];
+		// start with the original banded solver, and sane iteration limits
+		[self setSolverType:kBandedLUSolver];
+		[self setMultigridCycle:kVCycle];
+		[self setPreconditioner:kSSORPreconditioner];
+		[self setSchwarzCoarseCorrection:YES];
+		[self setTolerance:1.0e-8];
+		[self setMaxIterations:0];
+		// ...with the mirror edges it's always had
+		[self setBoundaryCondition:kMirrorBoundary];
+		[self setOpenBoundaryCenter:NSMakePoint(NAN, NAN)];
 		// don't forget to clear everything out now that it's there
 		[self clearWorkspace];
 	}
@@ -912,6 +1928,14 @@
 	[self _setEpsilonR:nil];
 	[self _setVoltage:nil];
 	[self _setResultantVoltage:nil];
+	[self _setFactorization:nil];
+	[self _setSuperpositionBasis:NULL withCount:0];
+	[self setInitialGuess:nil];
+	[self _setColFractions:NULL];
+	[self _setRowFractions:NULL];
+	[self _setSolveReport:nil];
+	[_lastSolveReport release];
+	_lastSolveReport = nil;
 }
 
 
@@ -933,6 +1957,8 @@
 	[self _setResultantVoltage:nil];
 	[self _setResultantElectricFieldMagnitude:nil];
 	[self _setResultantElectricFieldDirection:nil];
+	// ...and the superposition basis is for what *was* here
+	[self _setSuperpositionBasis:NULL withCount:0];
 }
 
 
@@ -940,7 +1966,12 @@
  This method will take the existing workspace with all the objects placed
  on it and simulate it for the potential at each simulation grid point.
  This needs to be done before you can get any values out of the workspace,
- but that's pretty obvious if you think about it.
+ but that's pretty obvious if you think about it. The solver that's used
+ is the one set with -setSolverType: - or, in the automatic mode, the
+ one that's predicted to be the quickest for this workspace. The banded
+ LU solver holds on to its factorization, and as long as only the
+ potentials and charges change, the next simulation skips right to the
+ substitutions.
  */
 - (BOOL) simulateWorkspace
 {
@@ -956,297 +1987,413 @@
 		}
 	}
 
-	// start the timer on the solution...
+	// ...and a body of revolution can't start inside the axis
+	if (!error) {
+		if ([self getAxisymmetric] && ([self getWorkspaceOrigin].x < 0.0)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateWorkspace] - this workspace is axisymmetric, and so x is the radius, but the origin is at x=%g. Please move the origin of the workspace to x >= 0.", [self getWorkspaceOrigin].x);
+		}
+	}
+
+	// start the timer on the solution, and the report of it...
 	NSTimeInterval begin = [NSDate timeIntervalSinceReferenceDate];
+	if (!error) {
+		[self _beginSolveReport];
+	}
 
 	/*
-	 * Next, determine storage format and allocate space for solution set.
-	 * For a more complete description of the arguments and what they are,
-	 * how big they need to be, etc. please see the docs on DGBSV in LAPACK.
+	 * Next, build up the 5-point stencil for all the nodes in the workspace.
+	 * This has the fixed potentials, the mirror conditions at the edges and
+	 * the RHS of the system, and every solver works off of it.
 	 */
-	__CLPK_integer		n = [self getRowCount] * [self getColCount];
-	__CLPK_integer		kl = MIN([self getRowCount], [self getColCount]);
-	__CLPK_integer		ku = kl;
-	__CLPK_integer		klpku = kl + ku;
-	BOOL				rowMajor = (kl == [self getColCount]);
-	__CLPK_integer		nrhs = 1;
-	__CLPK_integer		ldab = 2*kl + ku + 1;
-	__CLPK_doublereal	*ab = NULL;
+	PoissonStencil*		stencil = nil;
 	if (!error) {
-		ab = (__CLPK_doublereal	*) malloc( ldab*n*sizeof(__CLPK_doublereal) );
-		if (ab == NULL) {
+		stencil = [self _createStencil];
+		if (stencil == nil) {
 			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - while trying to allocate the banded A matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldab, n);
+			NSLog(@"[SimWorkspace -simulateWorkspace] - the stencil for the system of equations could not be created. Please check the logs for a possible cause.");
 		} else {
-			// clear out the array with zeros
-			vDSP_vclrD(ab, 1, ldab*n);
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - begin) forKey:kReportAssemblyTime];
 		}
 	}
-	__CLPK_integer		ldb = n;
-	__CLPK_doublereal	*b = NULL;
+
+	// get the storage for the solution - in row-major order
+	double*			v = NULL;
 	if (!error) {
-		b = (__CLPK_doublereal *) malloc( ldb*nrhs*sizeof(__CLPK_doublereal) );
-		if (b == NULL) {
-			// free up what we've already obtained
-			free(ab);
-			// ...and log the error
+		v = (double *) calloc([stencil getNodeCount], sizeof(double));
+		if (v == NULL) {
 			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - while trying to allocate the RHS b matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldb, nrhs);
+			NSLog(@"[SimWorkspace -simulateWorkspace] - while trying to allocate the solution vector (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", [stencil getNodeCount]);
+		}
+	}
+
+	/*
+	 * In the automatic mode, the cost model picks the engine for this grid
+	 * and sets us up to use it, just for this solve - we go back to the
+	 * automatic mode when it's done, so the next one gets its own pick.
+	 * The pick can change the cycle, the preconditioner and the coarse
+	 * correction, too, and those are the user's, so they go back as well.
+	 */
+	BOOL			automatic = ([self getSolverType] == kAutomaticSolver);
+	MultigridCycle		cycle = [self getMultigridCycle];
+	CGPreconditioner	preconditioner = [self getPreconditioner];
+	BOOL				coarse = [self getSchwarzCoarseCorrection];
+	if (!error && automatic) {
+		[self _pickSolverFor:stencil];
+	}
+
+	// now we can solve the system with the engine the user has picked
+	if (!error) {
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		switch ([self getSolverType]) {
+			case kMultigridSolver:
+				error = ![self _solveUsingMultigrid:stencil into:v];
+				break;
+			case kConjugateGradientSolver:
+				error = ![self _solveUsingConjugateGradient:stencil into:v];
+				break;
+			case kSORSolver:
+				error = ![self _solveUsingSOR:stencil into:v];
+				break;
+			case kBandedCholeskySolver:
+				error = ![self _solveSymmetricBandedStencil:stencil withRHS:[stencil getRHS] into:v];
+				break;
+			case kSparseCholeskySolver:
+				error = ![self _solveSparseStencil:stencil withRHS:[stencil getRHS] into:v];
+				break;
+			case kFastPoissonSolver:
+				error = ![self _solveUsingFastPoisson:stencil into:v];
+				break;
+			case kMixedPrecisionLUSolver:
+				error = ![self _solveMixedPrecisionBandedStencil:stencil withRHS:[stencil getRHS] into:v];
+				break;
+			case kSchwarzSolver:
+				error = ![self _solveUsingSchwarz:stencil into:v];
+				break;
+			case kBandedLUSolver:
+			default:
+				error = ![self _solveFactoredStencil:stencil into:v];
+				break;
+		}
+		// ...and if the pick was an iterative engine that didn't make it
+		if (error && automatic && ([self getSolverType] != kBandedLUSolver)) {
+			NSLog(@"[SimWorkspace -simulateWorkspace] - %@ was picked automatically, but it couldn't solve the system, so it's going to the banded LU.", [self getSolverName]);
+			/*
+			 * None of what it did get done belongs in the report of the LU,
+			 * so that starts over - with just the assembly, and the pick that
+			 * didn't work out, and why.
+			 */
+			NSString*	picked = [self getSolverName];
+			NSNumber*	assembly = [[[_solveReport objectForKey:kReportAssemblyTime] retain] autorelease];
+			[self setSolverType:kBandedLUSolver];
+			[self _beginSolveReport];
+			if (assembly != nil) {
+				[self _setReportValue:assembly forKey:kReportAssemblyTime];
+			}
+			[self _setReportValue:picked forKey:kReportFallbackFrom];
+			[self _setReportValue:@"picked automatically, but couldn't solve the system" forKey:kReportFallbackReason];
+			memset(v, 0, [stencil getNodeCount] * sizeof(double));
+			start = [NSDate timeIntervalSinceReferenceDate];
+			error = ![self _solveFactoredStencil:stencil into:v];
+		}
+		if (error) {
+			NSLog(@"[SimWorkspace -simulateWorkspace] - the solver was unable to solve the system of equations for the workspace. Please check the logs for a possible cause.");
 		} else {
-			// clear out the vector with zeros
-			vDSP_vclrD(b, 1, ldab*nrhs);
+			NSTimeInterval	now = [NSDate timeIntervalSinceReferenceDate];
+			// whatever the solver didn't spend factoring, it spent solving
+			double			factor = [[_solveReport objectForKey:kReportFactorTime] doubleValue];
+			[self _addReportValue:MAX((now - start) - factor, 0.0) forKey:kReportSolveTime];
+			[self _addReportValue:(now - begin) forKey:kReportTotalTime];
+			NSLog(@"[SimWorkspace -simulateWorkspace] - solution took %.3f msec", (now - begin) * 1000);
+			[self _checkSolverPrediction];
 		}
 	}
-	__CLPK_integer		*ipiv = NULL;
+	if (automatic) {
+		[self setSolverType:kAutomaticSolver];
+		[self setMultigridCycle:cycle];
+		[self setPreconditioner:preconditioner];
+		[self setSchwarzCoarseCorrection:coarse];
+	}
+
+	/*
+	 * Whatever the engine, check the answer against the operator itself,
+	 * so that the residuals in the reports of any two engines - or of any
+	 * two releases - mean the same thing.
+	 */
 	if (!error) {
-		ipiv = (__CLPK_integer *) malloc( n*sizeof(__CLPK_integer) );
-		if (ipiv == NULL) {
-			// free up what we've already obtained
-			free(b);
-			free(ab);
-			// ...and log the error
-			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - while trying to allocate the ipivot storage (%dx1) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", n);
+		double*		r = (double *) calloc([stencil getNodeCount], sizeof(double));
+		if (r == NULL) {
+			NSLog(@"[SimWorkspace -simulateWorkspace] - while trying to allocate the residual vector (%dx1), we ran into an allocation problem and couldn't get it, so the report won't have the residual.", [stencil getNodeCount]);
 		} else {
-			// clear out the vector with zeros
-			int		zero = 0;
-			vDSP_vfilli(&zero, ipiv, 1, n);
+			double*		b = [stencil getRHS];
+			double		bnorm = 0.0;
+			for (int i = 0; i < [stencil getNodeCount]; i++) {
+				bnorm += b[i] * b[i];
+			}
+			bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+			double		rnorm = [stencil residualOf:v forRHS:b into:r];
+			[self _setReportValue:[NSNumber numberWithDouble:rnorm] forKey:kReportResidualNorm];
+			[self _setReportValue:[NSNumber numberWithDouble:(rnorm / bnorm)] forKey:kReportRelativeResidual];
+			free(r);
+		}
+	}
+	[self _endSolveReport];
+
+	// ...and don't forget to save it for the user
+	if (!error) {
+		if (![self _saveResultantVoltages:v]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateWorkspace] - the results of the simulation could not be saved. Please check the logs for a possible cause.");
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (v != NULL) {
+		free(v);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method sets the initial guess of this workspace from the result
+ of another one that covers some or all of the same real-space region,
+ possibly with a different grid. The other workspace's potentials are
+ interpolated bilinearly onto the nodes of this one, and the nodes that
+ are outside the other workspace are left to start at zero. If the
+ other workspace has no result, this returns NO.
+ */
+- (BOOL) setInitialGuessFromWorkspace:(SimWorkspace*)ws
+{
+	BOOL			error = NO;
+	MaskedMatrix*	old = nil;
+	MaskedMatrix*	guess = nil;
+
+	// first, make sure we have something to do
+	if (!error) {
+		old = [ws getResultantVoltage];
+		if (old == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -setInitialGuessFromWorkspace:] - the other workspace is nil or has no results, and that means there's nothing to start from. Please make sure it's been simulated before calling this method.");
 		}
 	}
-	
+
+	// next, get the matrix for the guess
+	if (!error) {
+		guess = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
+		if (guess == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -setInitialGuessFromWorkspace:] - the initial guess matrix could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", [self getRowCount], [self getColCount]);
+		}
+	}
+
 	/*
-	 * Now we can populate the matricies with the equations to solve. We
-	 * do this by going through all the nodes and placing the equation for
-	 * that node into the cLAPACK matricies ab[] and b[] based on the
-	 * location of each node, and the physical parameters for that node.
-	 *
-	 * Because cLAPACK uses banded storage and a vector as opposed to a
-	 * two-dimensional array of numbers, we need to be able to convert
-	 * the matrix notation into the actual values placed in the banded
-	 * storage. Here's how it goes:
-	 *
-	 * The banded storage format is given as:
-	 *     ab(kl+ku+1+i-j, j) = a(i, j)
-	 * where i, j are constrained to be in the banded storage "coverage"
-	 * and are both in the range (1,n), i.e. FORTRAN-style. To convert
-	 * this to C-style arrays:
-	 *     ab[kl+ku+i-j][j] = a[i][j]
-	 * where now i and j run from 0..(n-1). The important difference is
-	 * in the loss of the "+1" for the limiting case of kl=ku=0 needs to
-	 * map to row=0 not row=1. The conversion to the row-major storage is,
-	 * in general, accomplished with:
-	 *     ab[col*ldab + row] = ab[row][col]
-	 * for a given row and column, where again, row and col are in the range
-	 * (0,n-1). Therefore, to map a general FORTRAN-style i,j from
-	 * A into the banded storage is:
-	 *     ab[j*ldab + kl+ku+i-j] = a(i, j)
-	 * with the addition of a simple variable for speed:
-	 *     ab[j*ldab + klpku + i-j] = a(i, j)
-	 * and that's what we're implementing. B is implemented in a similar
-	 * manner where:
-	 *     b[rhs*ldb + i] = b(i, rhs)
-	 * or:
-	 *     b[i] = b(i)
-	 * assuming that nrhs = 1, which it does for all our work.
+	 * Now for each node in this workspace, find where it falls on the old
+	 * grid, and interpolate between the four old nodes around it. If the
+	 * grids are the same, this is just a copy of the old results.
 	 */
 	if (!error) {
-		int		row = 0;
-		int		col = 0;
-		int		rows = [self getRowCount];
-		int		cols = [self getColCount];
-		// these will be the node numbers in the simulation
-		int		ijn = 0;
-		int		ln = 0;
-		int		rn = 0;
-		int		tn = 0;
-		int		bn = 0;
-		// these are the components of the coefficients
-		__CLPK_doublereal	invHx2 = 1.0/([self getDeltaX] * [self getDeltaX]);
-		__CLPK_doublereal	invHy2 = 1.0/([self getDeltaY] * [self getDeltaY]);
-		// these are the values of rho and er at the node in the simulation
-		__CLPK_doublereal	rho = 0;
-		__CLPK_doublereal	er = 0;
-		// now loop through all the node in the workspace
-		for (row = 0; row < rows; row++) {
-			for (col = 0; col < cols; col++) {
-				/*
-				 * We need to convert the row and col into a node number based
-				 * on the most efficient banding possible.
-				 */
-				ijn = (rowMajor ? (row * cols + col) : (col * rows + row));
-				
-				// see if there's a fixed potential at this node
-				if ([[self getVoltage] haveValueAtRow:row andCol:col]) {
-					/*
-					 * In this case the equation is simple: v(i,j) = v_fixed
-					 */
-					ab[ijn*ldab + klpku] = 1.0;
-					b[ijn] = [self getVoltageAtNodeRow:row andCol:col];
-				} else {
-					/*
-					 * In this case, we need to build up the entire Poission's Eq.
-					 * for this node.
-					 */
-					// first, do the 'ij' node
-					ab[ijn*ldab + klpku] = -2.0*(invHx2 + invHy2);
-					// next, do the 'top' node
-					if (row == 0) {
-						// due to symmetry, add to the 'bottom' node
-						bn = (rowMajor ? (ijn + cols) : (ijn + 1));
-						ab[bn*ldab + klpku + ijn-bn] += invHy2;
-					} else {
-						tn = (rowMajor ? (ijn - cols) : (ijn - 1));
-						ab[tn*ldab + klpku + ijn-tn] += invHy2;
-					}
-					// next, do the 'bottom' node
-					if (row == (rows - 1)) {
-						// due to symmetry, add to the 'top' node
-						tn = (rowMajor ? (ijn - cols) : (ijn - 1));
-						ab[tn*ldab + klpku + ijn-tn] += invHy2;
-					} else {
-						bn = (rowMajor ? (ijn + cols) : (ijn + 1));
-						ab[bn*ldab + klpku + ijn-bn] += invHy2;
-					}
-					// next, do the 'left' node
-					if (col == 0) {
-						// due to symmetry, add to the 'right' node
-						rn = (rowMajor ? (ijn + 1) : (ijn + rows));
-						ab[rn*ldab + klpku + ijn-rn] += invHx2;
-					} else {
-						ln = (rowMajor ? (ijn - 1) : (ijn - rows));
-						ab[ln*ldab + klpku + ijn-ln] += invHx2;
-					}
-					// finally, do the 'right' node
-					if (col == (cols - 1)) {
-						// due to symmetry, add to the 'left' node
-						ln = (rowMajor ? (ijn - 1) : (ijn - rows));
-						ab[ln*ldab + klpku + ijn-ln] += invHx2;
-					} else {
-						rn = (rowMajor ? (ijn + 1) : (ijn + rows));
-						ab[rn*ldab + klpku + ijn-rn] += invHx2;
-					}
-					
-					/*
-					 * Now let's calculate the RHS of Ax=b...
-					 */
-					rho = [self getRhoAtNodeRow:row andCol:col];
-					er = [self getEpsilonRAtNodeRow:row andCol:col];
-					b[ijn] = -1.0 * rho/(er == 0 ? 1.0 : er);
+		int			oldRows = [ws getRowCount];
+		int			oldCols = [ws getColCount];
+		for (int row = 0; row < [self getRowCount]; row++) {
+			double		fy = [ws getRowPositionForYValue:[self getYValueForRow:row]];
+			if (isnan(fy) || (fy < 0.0) || (fy > (oldRows - 1))) {
+				continue;
+			}
+			int			r = MIN((int)fy, oldRows - 2);
+			double		ty = fy - r;
+			for (int col = 0; col < [self getColCount]; col++) {
+				double		fx = [ws getColPositionForXValue:[self getXValueForCol:col]];
+				if (isnan(fx) || (fx < 0.0) || (fx > (oldCols - 1))) {
+					continue;
 				}
+				int			c = MIN((int)fx, oldCols - 2);
+				double		tx = fx - c;
+				double		v = (1.0 - ty) * ((1.0 - tx) * [old getValueAtRow:r andCol:c] + tx * [old getValueAtRow:r andCol:(c + 1)])
+								+ ty * ((1.0 - tx) * [old getValueAtRow:(r + 1) andCol:c] + tx * [old getValueAtRow:(r + 1) andCol:(c + 1)]);
+				[guess setValue:v atRow:row andCol:col];
 			}
 		}
+		[self setInitialGuess:guess];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method has this workspace take over the banded LU factorization
+ that another one is holding on to, if the grids are the same size. If
+ the operator of this workspace is the same, or only a few rows off, the
+ next simulation with the LU engine won't have to factor it all again.
+ */
+- (void) reuseFactorizationFrom:(SimWorkspace*)ws
+{
+	BandedFactorization*	lu = [ws _getFactorization];
+
+	if ((lu != nil) && (ws != self) && ([ws getRowCount] == [self getRowCount]) &&
+		([ws getColCount] == [self getColCount])) {
+		[self _setFactorization:lu];
 	}
+}
+
+
+/*!
+ This method solves the workspace for a whole batch of scenarios at
+ once. Each scenario is the workspace as it stands, but with its own
+ fixed potentials from 'voltages' and its own charge densities from
+ 'rhos' - arrays of MaskedMatrix objects the size of the workspace -
+ and either array can be nil to use the workspace's own for every
+ scenario. The geometry can't change: each of the voltage matrices has
+ to fix exactly the nodes that the workspace does. That means that the
+ operator is the same for all of them, so the banded LU factorization
+ is done once - or reused from the last simulation - and all the
+ scenarios are solved in one multi-RHS substitution. The result is an
+ array of result sets, one per scenario - each a dictionary with the
+ resultant voltage and electric field matrices under the kScenario
+ keys - or nil if it couldn't be done. The workspace's own results are
+ left alone.
+ */
+- (NSArray*) simulateScenariosWithVoltages:(NSArray*)voltages andRhos:(NSArray*)rhos
+{
+	BOOL			error = NO;
+	int				rows = [self getRowCount];
+	int				cols = [self getColCount];
+	int				count = 0;
 
-	// finally, we can solve the system for the user using dgbsv_ in cLAPACK
+	// first, make sure we're set up for this
 	if (!error) {
-		__CLPK_integer	info = 0;
-		dgbsv_(&n, &kl, &ku, &nrhs, ab, &ldab, ipiv, b, &ldb, &info);
-		if (info < 0) {
+		if ((rows <= 1) || (cols <= 1) || ([self getEpsilonR] == nil) ||
+			([self getRho] == nil) || ([self getVoltage] == nil)) {
 			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - argument #%d had an illegal value to DGBSV in LAPACK. Please check into this.", -1*info);
-		} else if (info > 0) {
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - this workspace is not yet set up properly for a simulation. You need to set reasonable simulation node counts as well as initializing this class for the simulation. Please make sure you call one of the -init methods before calling this method.");
+		}
+	}
+
+	// next, see how many scenarios we have
+	if (!error) {
+		if ((voltages != nil) && (rhos != nil) && ([voltages count] != [rhos count])) {
 			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - diagonal #%d is zero indicating singularity which shouldn't happen.", info);
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - there are %lu voltage matrices and %lu charge density matrices, and there has to be one of each per scenario. Please check the arguments.", (unsigned long)[voltages count], (unsigned long)[rhos count]);
 		} else {
-			NSLog(@"[SimWorkspace -simulateWorkspace] - solution took %.3f msec", ([NSDate timeIntervalSinceReferenceDate] - begin) * 1000);
+			count = (int)(voltages != nil ? [voltages count] : [rhos count]);
+			if (count == 0) {
+				error = YES;
+				NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - there are no scenarios to simulate. Please pass in at least one voltage or charge density matrix.");
+			}
 		}
 	}
 
-	// we need to create the resultant voltage matrix and populate it
-	MaskedMatrix*		rv = nil;
+	// start the timer on the solution...
+	NSTimeInterval begin = [NSDate timeIntervalSinceReferenceDate];
+
+	// the stencil of the workspace has the operator for all the scenarios
+	PoissonStencil*			stencil = nil;
+	BandedFactorization*	lu = nil;
 	if (!error) {
-		rv = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
-		if (rv == nil) {
+		stencil = [self _createStencil];
+		if (stencil == nil) {
 			error = YES;
-			NSLog(@"[SimWorkspace -simulateWorkspace] - the resultant voltage matrix for the simulation could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", [self getRowCount], [self getColCount]);
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - the stencil for the system of equations could not be created. Please check the logs for a possible cause.");
 		} else {
-			// now fill in all the values from the solution set
-			int		ij = 0;
-			for (int row = 0; row < [self getRowCount]; row++) {
-				for (int col = 0; col < [self getColCount]; col++) {
-					/*
-					 * We need to convert the row and col into a node number based
-					 * on the most efficient banding possible.
-					 */
-					ij = (rowMajor ? (row * [self getColCount] + col) : (col * [self getRowCount] + row));
-					// now save it
-					[rv setValue:b[ij] atRow:row andCol:col];
-				}
+			lu = [self _getFactorizationOf:stencil];
+			if (lu == nil) {
+				error = YES;
 			}
 		}
 	}
 
-	// create the storage for the magnitude of the electric field
-	MaskedMatrix*		rem = nil;
-	MaskedMatrix*		red = nil;
-	if (!error && ([self getRowCount] >= 2) && ([self getColCount] >= 2)) {
-		rem = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
-		red = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
-		if ((rem == nil) || (red == nil)) {
+	// get the storage for all the RHS vectors - one after the other
+	size_t			n = (size_t)rows * cols;
+	double*			b = NULL;
+	if (!error) {
+		b = (double *) calloc(n * count, sizeof(double));
+		if (b == NULL) {
 			error = YES;
-			NSLog(@"[SimWorkspace -getResultantElectricFieldMagnitude] - the resultant electric field matrices could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", [self getRowCount], [self getColCount]);
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - while trying to allocate the %d RHS vectors (%lux1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count, (unsigned long)n);
 		}
 	}
 
-	// now do the calculations
+	/*
+	 * Now build the RHS for each scenario just as -_createStencil does for
+	 * the workspace, making sure that each one fixes the same nodes as the
+	 * workspace, as that's what the factorization is based on.
+	 */
 	if (!error) {
-		// get the grid spacings in the x and y directions
-		double	hx = [self getWorkspaceSize].width/[self getColCount];
-		double	hy = [self getWorkspaceSize].height/[self getRowCount];
-		// now run through all the points in the workspace and calc each
-		for (int r = 0; r < [self getRowCount]; r++) {
-			for (int c = 0; c < [self getColCount]; c++) {
-				// get the column and row limits
-				int			cr = c + 1;
-				int			cl = c - 1;
-				int			rb = r + 1;
-				int			rt = r - 1;
-				// assume LOS at each border
-				if (cr >= [self getColCount]) cr = [self getColCount] - 2;
-				if (cl <= 0) cl = 1;
-				if (rb >= [self getRowCount]) rb = [self getRowCount] - 2;
-				if (rt <= 0) rt = 1;
-
-				// now get the voltages at the surrounding nodes
-				double	vr = [rv getValueAtRow:r andCol:cr];
-				double	vl = [rv getValueAtRow:r andCol:cl];
-				double	vb = [rv getValueAtRow:rb andCol:c];
-				double	vt = [rv getValueAtRow:rt andCol:c];
-
-				// now get the components of the electric field
-				double	ex = (vr - vl)/(2.0*hx);
-				double	ey = (vb - vt)/(2.0*hy);
-
-				// now get the answer we're looking for
-				[rem setValue:sqrt(ex*ex + ey*ey) atRow:r andCol:c];
-				if ((ex == 0) && (ey == 0)) {
-					[red setValue:0.0 atRow:r andCol:c];
-				} else {
-					[red setValue:atan2(ey, ex) atRow:r andCol:c];
+		BOOL*		fixed = [stencil getFixedMask];
+		for (int k = 0; !error && (k < count); k++) {
+			MaskedMatrix*	volt = (voltages != nil ? [voltages objectAtIndex:k] : [self getVoltage]);
+			MaskedMatrix*	rho = (rhos != nil ? [rhos objectAtIndex:k] : [self getRho]);
+			if (([volt getRowCount] != rows) || ([volt getColCount] != cols) ||
+				([rho getRowCount] != rows) || ([rho getColCount] != cols)) {
+				error = YES;
+				NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - the matrices for scenario %d are not the same size as the %dx%d workspace. Please check the arguments.", k, rows, cols);
+				break;
+			}
+			double*		bk = b + (size_t)k * n;
+			for (int row = 0; !error && (row < rows); row++) {
+				for (int col = 0; col < cols; col++) {
+					size_t		ij = (size_t)row * cols + col;
+					if ([volt haveValueAtRow:row andCol:col] != fixed[ij]) {
+						error = YES;
+						NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - scenario %d doesn't fix the same nodes as the workspace (row=%d, col=%d), and that changes the geometry, which a scenario can't do. Please check the arguments.", k, row, col);
+						break;
+					}
+					if (fixed[ij]) {
+						bk[ij] = [volt getValueAtRow:row andCol:col];
+					} else {
+						bk[ij] = -1.0 * [rho getValueAtRow:row andCol:col];
+					}
 				}
 			}
 		}
 	}
 
-	// ...and don't forget to save it for the user
+	// now solve them all at once
 	if (!error) {
-		[self _setResultantVoltage:rv];
-		[self _setResultantElectricFieldMagnitude:rem];
-		[self _setResultantElectricFieldDirection:red];
+		if (![lu solve:b count:count into:b]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - the %d scenarios could not be solved. Please check the logs for a possible cause.", count);
+		} else {
+			NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - solution of %d scenarios took %.3f msec", count, ([NSDate timeIntervalSinceReferenceDate] - begin) * 1000);
+		}
 	}
 
-	// in the end, we can release what it is that we don't need
-	if (ipiv != NULL) {
-		free(ipiv);
+	// ...and package up the results for the caller
+	NSMutableArray*		retval = nil;
+	if (!error) {
+		retval = [NSMutableArray arrayWithCapacity:count];
+		for (int k = 0; !error && (k < count); k++) {
+			MaskedMatrix*	rv = [[[MaskedMatrix alloc] initWithRows:rows andCols:cols] autorelease];
+			MaskedMatrix*	rem = [[[MaskedMatrix alloc] initWithRows:rows andCols:cols] autorelease];
+			MaskedMatrix*	red = [[[MaskedMatrix alloc] initWithRows:rows andCols:cols] autorelease];
+			if ((rv == nil) || (rem == nil) || (red == nil)) {
+				error = YES;
+				NSLog(@"[SimWorkspace -simulateScenariosWithVoltages:andRhos:] - the resultant matrices for scenario %d could not be created and this is a serious storage problem. Check into this.", k);
+			} else {
+				double*		bk = b + (size_t)k * n;
+				for (int row = 0; row < rows; row++) {
+					for (int col = 0; col < cols; col++) {
+						[rv setValue:bk[(size_t)row * cols + col] atRow:row andCol:col];
+					}
+				}
+				[self _calculateElectricFieldOf:rv intoMagnitude:rem andDirection:red];
+				[retval addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+									rv, kScenarioVoltage,
+									rem, kScenarioElectricFieldMagnitude,
+									red, kScenarioElectricFieldDirection,
+									nil]];
+			}
+		}
 	}
+
+	// in the end, we can release what it is that we don't need
 	if (b != NULL) {
 		free(b);
 	}
-	if (ab != NULL) {
-		free(ab);
-	}
 
-	return !error;
+	return error ? nil : retval;
 }
 
 
@@ -0,0 +1,131 @@
+//
+//  SimWorkspace_Automatic.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+/*
+ * These are the things about a workspace that the cost of solving it
+ * depends on - the size and shape of the grid, how much of it is fixed,
+ * how much the dielectric varies, how tight the tolerance is and how
+ * many cores there are to do it on. The rest is the calibration of each
+ * engine on this machine.
+ */
+typedef struct {
+	double		rows;
+	double		cols;
+	double		nodes;
+	double		band;
+	double		length;
+	double		freeNodes;
+	double		edgeNodes;
+	double		contrast;
+	double		digits;
+	double		cores;
+	BOOL		transformable;
+	BOOL		factored;
+} SolverCostInputs;
+
+// Public Constants
+/*
+ * This is the key the calibration of the engines is kept under in the
+ * user defaults, and the version of the cost model it was made for. If
+ * the model changes - or the machine has a different number of cores -
+ * the old calibration is thrown out and the benchmark is run again.
+ */
+#define	kSolverCalibrationKey		@"SimWorkspaceSolverCalibration"
+#define	SOLVER_CALIBRATION_VERSION	1
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the automatic solver selection methods on the SimWorkspace.
+ Each engine has a cost model - the time and memory it takes as a
+ function of the size of the grid, the fraction of it that's fixed,
+ the spread of the dielectric, the tolerance and the cores - with the
+ constants in front of each term measured by solving a reference
+ workspace with every engine, once, on this machine. For each solve,
+ the engine with the smallest predicted time that fits in memory is
+ the one that's used, and when it's done, the prediction is checked
+ against what it really took, so the models can be improved.
+ */
+@interface SimWorkspace (Automatic)
+
+//----------------------------------------------------------------------------
+//               Calibration Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the calibration of the engines on this machine -
+ from the user defaults if it's been done before on a machine with the
+ same number of cores, and by running the benchmark of -calibrateSolvers
+ if it hasn't.
+ */
++ (NSDictionary*) getSolverCalibration;
+
+/*!
+ This method solves a reference workspace with each of the engines and
+ fits the constants of its cost model to the time and memory it took.
+ The result is saved in the user defaults, so it's only done once per
+ machine, and returned. It takes a few seconds.
+ */
++ (NSDictionary*) calibrateSolvers;
+
+//----------------------------------------------------------------------------
+//               Selection Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method fills in the inputs to the cost models for the system
+ defined by the stencil of this workspace.
+ */
+- (void) _getCostInputs:(SolverCostInputs*)inputs forStencil:(PoissonStencil*)stencil;
+
+/*!
+ This method predicts the time - in seconds - and memory - in bytes -
+ that the engine named 'engine' would take to solve a system with the
+ inputs 'inputs' using the calibration 'cal'. It returns NO if
+ that engine can't do this system at all, or it hasn't been calibrated.
+ */
+- (BOOL) _predictCostOf:(NSString*)engine withInputs:(SolverCostInputs*)inputs andCalibration:(NSDictionary*)cal time:(double*)time memory:(double*)memory;
+
+/*!
+ This method predicts the time and memory of every engine for the
+ system defined by the stencil, and sets this workspace up to use the
+ quickest one that fits in memory. The decision - and the predictions
+ for the engines that lost - goes to the log, and the prediction for
+ the winner into the report of the solve. It returns the name of the
+ engine, which is LU if nothing else can be predicted.
+ */
+- (NSString*) _pickSolverFor:(PoissonStencil*)stencil;
+
+/*!
+ This method compares the time and memory that the report of the solve
+ says the engine took with what was predicted for it - if the engine
+ was picked automatically - and logs how far off the prediction was.
+ */
+- (void) _checkSolverPrediction;
+
+@end
@@ -0,0 +1,508 @@
+//
+//  SimWorkspace_Automatic.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Automatic.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_FastPoisson.h"
+#import "SimWorkspace_Schwarz.h"
+#import "BandedFactorization.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * These are the keys of the calibration - the version of the model it
+ * was made for, the cores of the machine it was made on, and for each
+ * engine, the seconds per unit of factoring and solving work and the
+ * bytes per unit of storage in its cost model.
+ */
+#define	kCalibrationVersion			@"version"
+#define	kCalibrationCores			@"cores"
+#define	kCalibrationEngines			@"engines"
+#define	kCalibrationFactor			@"factor"
+#define	kCalibrationSolve			@"solve"
+#define	kCalibrationMemory			@"memory"
+
+/*
+ * The reference workspace for the benchmark is this many nodes on a
+ * side - big enough for the strips of the Schwarz solver, and small
+ * enough for the banded LU to do it in a fraction of a second. Each
+ * engine gets the best of a few runs so the first one's page faults
+ * don't count.
+ */
+#define	BENCHMARK_SIZE				129
+#define	BENCHMARK_RUNS				2
+
+/*
+ * No engine is picked if it's predicted to need more than this fraction
+ * of the physical memory - except the banded LU, which goes out of core
+ * instead, and is then this many times slower for all the I/O.
+ */
+#define	MAX_MEMORY_FRACTION			0.5
+#define	OUT_OF_CORE_PENALTY			4.0
+
+// Public Macros
+#define	MEGABYTES(b)				((double)(b) / (1024.0 * 1024.0))
+
+/*
+ * This is the calibration of the engines on this machine, once it's been
+ * loaded from the user defaults or measured, so that it's only done once
+ * no matter how many workspaces are solved.
+ */
+static NSDictionary*	calibration = nil;
+
+
+/*
+ * These are the engines - by their names in the input deck - that the
+ * automatic solver picks from, with the banded LU first so that it wins
+ * any ties.
+ */
+static NSArray* candidateEngines()
+{
+	return [NSArray arrayWithObjects:@"LU", @"LU32", @"CHOL", @"SPARSE", @"FPS",
+				@"MGV", @"MGW", @"PCGJ", @"PCGSSOR", @"PCGIC", @"SOR",
+				@"SCHWARZ", @"SCHWARZ1", nil];
+}
+
+
+/*
+ * This is the shape of the cost model of the engine 'engine' for the
+ * inputs 'in': the work of factoring, the work of solving, and the
+ * storage it needs. The units are whatever makes the calibration
+ * constants in front of them close to constant - the flops of the
+ * direct engines, the node updates of the iterative ones, with the
+ * iterations they take on the Laplacian worked in. Any engine that
+ * doesn't factor anything gets all its time in the solve. It returns
+ * NO if the engine can't do a system like this at all.
+ */
+static BOOL costShape(NSString* engine, const SolverCostInputs* in, double* factor, double* solve, double* space)
+{
+	BOOL		retval = YES;
+	double		n = in->nodes;
+	double		w = in->band;
+	double		m = in->edgeNodes;
+	// the stencil kernels split the rows across the cores
+	double		par = MAX(MIN(in->cores, in->rows), 1.0);
+
+	*factor = 0.0;
+	*solve = 0.0;
+	*space = 0.0;
+	if ([engine isEqualToString:@"LU"] || [engine isEqualToString:@"LU32"] || [engine isEqualToString:@"CHOL"]) {
+		// the band of the factors is the short side of the grid
+		*factor = ((in->factored && [engine isEqualToString:@"LU"]) ? 0.0 : n * w * w);
+		*solve = n * w;
+		*space = n * w;
+	} else if ([engine isEqualToString:@"SPARSE"]) {
+		// nested dissection on a 2D grid
+		double		nf = MAX(in->freeNodes, 2.0);
+		*factor = nf * sqrt(nf);
+		*solve = nf * log2(nf);
+		*space = nf * log2(nf);
+	} else if ([engine isEqualToString:@"FPS"]) {
+		if (!in->transformable || (m < 1.0) || (m > MAX_CAPACITANCE_NODES)) {
+			retval = NO;
+		} else {
+			// the capacitance matrix is built a row of the grid at a time
+			*factor = MIN(in->rows, m) * n + m * m * in->cols + m * m * m;
+			*solve = n * in->cols;
+			*space = in->cols * in->cols + n + m * in->cols + m * m;
+		}
+	} else if ([engine isEqualToString:@"MGV"] || [engine isEqualToString:@"MGW"]) {
+		// a fixed gain per cycle, hurt some by jumps in the dielectric
+		*solve = in->freeNodes * in->digits * in->contrast / par;
+		*space = n;
+	} else if ([engine isEqualToString:@"PCGJ"] || [engine isEqualToString:@"PCGIC"]) {
+		// the iterations go as the square root of the condition number
+		*factor = n / par;
+		*solve = in->freeNodes * in->length * in->digits * sqrt(in->contrast) / par;
+		*space = n;
+	} else if ([engine isEqualToString:@"PCGSSOR"]) {
+		// ...which SSOR takes the square root of again
+		*factor = n / par;
+		*solve = in->freeNodes * sqrt(in->length) * in->digits * sqrt(in->contrast) / par;
+		*space = n;
+	} else if ([engine isEqualToString:@"SOR"]) {
+		// with the optimal relaxation, the sweeps go as the long side
+		*solve = in->freeNodes * in->length * in->digits * in->contrast / par;
+		*space = n;
+	} else if ([engine isEqualToString:@"SCHWARZ"] || [engine isEqualToString:@"SCHWARZ1"]) {
+		// the strips are cut just like the solver cuts them
+		int			cores = (int)in->cores;
+		int			length = (int)w;
+		int			count = MIN(MAX(cores, length / STRIP_WIDTH), length / MIN_STRIP_WIDTH);
+		if (count < 2) {
+			retval = NO;
+		} else {
+			double		width = (double)length / count;
+			double		s = width + 2.0 * MAX((double)MIN_OVERLAP, OVERLAP_FRACTION * width);
+			double		p = MIN(in->cores, (double)count);
+			double		sweeps = in->digits * ([engine isEqualToString:@"SCHWARZ"] ? 1.0 : count);
+			*factor = count * in->length * s * s * s / p;
+			*solve = sweeps * count * in->length * s * s / p;
+			*space = count * in->length * s * s;
+		}
+	} else {
+		retval = NO;
+	}
+
+	return retval;
+}
+
+
+/*
+ * This lays out the reference workspace for the benchmark - a plate
+ * along the bottom and one along the top, a square conductor in the
+ * middle and a little charge off to one side - with a uniform grid and
+ * dielectric, so that every engine, the fast Poisson solver included,
+ * can do it.
+ */
+static void loadReferenceWorkspace(SimWorkspace* ws)
+{
+	int			rows = [ws getRowCount];
+	int			cols = [ws getColCount];
+	for (int c = 0; c < cols; c++) {
+		[ws setVoltage:0.0 atNodeRow:0 andCol:c];
+		[ws setVoltage:1.0 atNodeRow:(rows - 1) andCol:c];
+	}
+	for (int r = (3 * rows) / 8; r < (5 * rows) / 8; r++) {
+		for (int c = (3 * cols) / 8; c < (5 * cols) / 8; c++) {
+			[ws setVoltage:0.5 atNodeRow:r andCol:c];
+		}
+	}
+	for (int r = rows / 4; r < (rows / 4) + 3; r++) {
+		for (int c = cols / 8; c < (cols / 8) + 3; c++) {
+			[ws setRho:1.0e-9 atNodeRow:r andCol:c];
+		}
+	}
+}
+
+
+/*!
+ @class SimWorkspace
+ These are the automatic solver selection methods on the SimWorkspace.
+ Each engine has a cost model - the time and memory it takes as a
+ function of the size of the grid, the fraction of it that's fixed,
+ the spread of the dielectric, the tolerance and the cores - with the
+ constants in front of each term measured by solving a reference
+ workspace with every engine, once, on this machine. For each solve,
+ the engine with the smallest predicted time that fits in memory is
+ the one that's used, and when it's done, the prediction is checked
+ against what it really took, so the models can be improved.
+ */
+@implementation SimWorkspace (Automatic)
+
+//----------------------------------------------------------------------------
+//               Calibration Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the calibration of the engines on this machine -
+ from the user defaults if it's been done before on a machine with the
+ same number of cores, and by running the benchmark of -calibrateSolvers
+ if it hasn't.
+ */
++ (NSDictionary*) getSolverCalibration
+{
+	NSDictionary*		retval = nil;
+
+	@synchronized([SimWorkspace class]) {
+		if (calibration == nil) {
+			NSDictionary*	saved = [[NSUserDefaults standardUserDefaults] dictionaryForKey:kSolverCalibrationKey];
+			int				cores = (int)[[NSProcessInfo processInfo] activeProcessorCount];
+			if ((saved != nil) &&
+				([[saved objectForKey:kCalibrationVersion] intValue] == SOLVER_CALIBRATION_VERSION) &&
+				([[saved objectForKey:kCalibrationCores] intValue] == cores) &&
+				([[saved objectForKey:kCalibrationEngines] count] > 0)) {
+				calibration = [saved retain];
+			} else {
+				NSLog(@"[SimWorkspace +getSolverCalibration] - the engines haven't been calibrated on this machine yet, so the benchmark is being run now. This only has to be done once.");
+				[SimWorkspace calibrateSolvers];
+			}
+		}
+		retval = [[calibration retain] autorelease];
+	}
+
+	return retval;
+}
+
+
+/*!
+ This method solves a reference workspace with each of the engines and
+ fits the constants of its cost model to the time and memory it took.
+ The result is saved in the user defaults, so it's only done once per
+ machine, and returned. It takes a few seconds.
+ */
++ (NSDictionary*) calibrateSolvers
+{
+	NSMutableDictionary*	engines = [NSMutableDictionary dictionary];
+	int						cores = (int)[[NSProcessInfo processInfo] activeProcessorCount];
+	NSDictionary*			retval = nil;
+
+	for (NSString* name in candidateEngines()) {
+		NSDictionary*		best = nil;
+		double				bestTime = 0.0;
+		SolverCostInputs	in;
+		memset(&in, 0, sizeof(in));
+		// solve the reference workspace a few times with this engine
+		for (int run = 0; run < BENCHMARK_RUNS; run++) {
+			SimWorkspace*	ws = [[SimWorkspace alloc] initWithRect:NSMakeRect(0.0, 0.0, 1.0, 1.0) usingRows:BENCHMARK_SIZE andCols:BENCHMARK_SIZE];
+			if (ws != nil) {
+				loadReferenceWorkspace(ws);
+				[ws setSolverByName:name];
+				// ...the inputs are before the solve, when there are no factors
+				if (run == 0) {
+					[ws _getCostInputs:&in forStencil:[ws _createStencil]];
+				}
+				if ([ws simulateWorkspace]) {
+					NSDictionary*	report = [ws getSolveReport];
+					double			t = [[report objectForKey:kReportFactorTime] doubleValue] +
+										[[report objectForKey:kReportSolveTime] doubleValue];
+					if ((best == nil) || (t < bestTime)) {
+						best = [[report retain] autorelease];
+						bestTime = t;
+					}
+				}
+				[ws release];
+			}
+		}
+
+		// ...and fit the constants of its model to the best of them
+		double		factorWork = 0.0;
+		double		solveWork = 0.0;
+		double		space = 0.0;
+		if ((best == nil) || !costShape(name, &in, &factorWork, &solveWork, &space) || (solveWork <= 0.0)) {
+			NSLog(@"[SimWorkspace +calibrateSolvers] - %@ couldn't solve the %dx%d reference workspace, so it won't be picked automatically. Please check the logs for a possible cause.", name, BENCHMARK_SIZE, BENCHMARK_SIZE);
+		} else {
+			double		factorTime = [[best objectForKey:kReportFactorTime] doubleValue];
+			double		solveTime = [[best objectForKey:kReportSolveTime] doubleValue];
+			double		memory = [[best objectForKey:kReportMemory] doubleValue];
+			if (factorWork <= 0.0) {
+				solveTime += factorTime;
+				factorTime = 0.0;
+			}
+			NSDictionary*	fit = [NSDictionary dictionaryWithObjectsAndKeys:
+										[NSNumber numberWithDouble:(factorWork > 0.0 ? factorTime / factorWork : 0.0)], kCalibrationFactor,
+										[NSNumber numberWithDouble:(solveTime / solveWork)], kCalibrationSolve,
+										[NSNumber numberWithDouble:(memory > 0.0 ? memory / space : sizeof(double))], kCalibrationMemory,
+										nil];
+			[engines setObject:fit forKey:name];
+			NSLog(@"[SimWorkspace +calibrateSolvers] - %@ took %.3f msec and %.1f MB on the %dx%d reference workspace", name, bestTime * 1000, MEGABYTES(memory), BENCHMARK_SIZE, BENCHMARK_SIZE);
+		}
+	}
+
+	// save it for the next time, and for the rest of this run
+	retval = [NSDictionary dictionaryWithObjectsAndKeys:
+				[NSNumber numberWithInt:SOLVER_CALIBRATION_VERSION], kCalibrationVersion,
+				[NSNumber numberWithInt:cores], kCalibrationCores,
+				engines, kCalibrationEngines,
+				nil];
+	[[NSUserDefaults standardUserDefaults] setObject:retval forKey:kSolverCalibrationKey];
+	@synchronized([SimWorkspace class]) {
+		[calibration release];
+		calibration = [retval retain];
+	}
+
+	return retval;
+}
+
+
+
+//----------------------------------------------------------------------------
+//               Selection Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method fills in the inputs to the cost models for the system
+ defined by the stencil of this workspace.
+ */
+- (void) _getCostInputs:(SolverCostInputs*)inputs forStencil:(PoissonStencil*)stencil
+{
+	if ((inputs != NULL) && (stencil != nil)) {
+		int			rows = [stencil getRowCount];
+		int			cols = [stencil getColCount];
+		BOOL*		fixed = [stencil getFixedMask];
+		double*		eps = [stencil getDielectric];
+		double		tol = MIN(MAX([self getTolerance], 1.0e-15), 0.5);
+		double		lo = 0.0;
+		double		hi = 0.0;
+		int			freeCnt = 0;
+		int			edgeCnt = 0;
+
+		/*
+		 * Count the free nodes, and the fixed ones with a free neighbor -
+		 * those are what the fast Poisson solver's capacitance matrix is
+		 * made of - and the spread of the dielectric over the free ones.
+		 */
+		for (int r = 0; r < rows; r++) {
+			for (int c = 0; c < cols; c++) {
+				int		ij = r * cols + c;
+				if (!fixed[ij]) {
+					double	er = (eps[ij] > 0.0 ? eps[ij] : 1.0);
+					lo = (freeCnt == 0 ? er : MIN(lo, er));
+					hi = (freeCnt == 0 ? er : MAX(hi, er));
+					freeCnt++;
+				} else if (((c > 0) && !fixed[ij - 1]) || ((c < (cols - 1)) && !fixed[ij + 1]) ||
+						   ((r > 0) && !fixed[ij - cols]) || ((r < (rows - 1)) && !fixed[ij + cols])) {
+					edgeCnt++;
+				}
+			}
+		}
+
+		inputs->rows = rows;
+		inputs->cols = cols;
+		inputs->nodes = (double)rows * cols;
+		inputs->band = MIN(rows, cols);
+		inputs->length = MAX(rows, cols);
+		inputs->freeNodes = freeCnt;
+		inputs->edgeNodes = edgeCnt;
+		inputs->contrast = 1.0 + (lo > 0.0 ? log10(hi / lo) : 0.0);
+		inputs->digits = log(1.0 / tol);
+		inputs->cores = (double)[[NSProcessInfo processInfo] activeProcessorCount];
+		inputs->transformable = [self isUniformGrid] && ![stencil isAxisymmetric] &&
+								![stencil hasOpenBoundary] && ![stencil hasCorners] &&
+								[self _hasUniformEpsilonR];
+		inputs->factored = [[self _getFactorization] isFactorOf:stencil];
+	}
+}
+
+
+/*!
+ This method predicts the time - in seconds - and memory - in bytes -
+ that the engine named 'engine' would take to solve a system with the
+ inputs 'inputs' using the calibration 'cal'. It returns NO if
+ that engine can't do this system at all, or it hasn't been calibrated.
+ */
+- (BOOL) _predictCostOf:(NSString*)engine withInputs:(SolverCostInputs*)inputs andCalibration:(NSDictionary*)cal time:(double*)time memory:(double*)memory
+{
+	BOOL			error = NO;
+	NSDictionary*	fit = nil;
+	double			factorWork = 0.0;
+	double			solveWork = 0.0;
+	double			space = 0.0;
+
+	// first, make sure we have a model for this engine and system
+	if (!error) {
+		if ((engine == nil) || (inputs == NULL) || (time == NULL) || (memory == NULL)) {
+			error = YES;
+		} else {
+			fit = [[cal objectForKey:kCalibrationEngines] objectForKey:engine];
+			if ((fit == nil) || !costShape(engine, inputs, &factorWork, &solveWork, &space)) {
+				error = YES;
+			}
+		}
+	}
+
+	// now put the calibration constants in front of the work and storage
+	if (!error) {
+		double		budget = MAX_MEMORY_FRACTION * [[NSProcessInfo processInfo] physicalMemory];
+		*time = [[fit objectForKey:kCalibrationFactor] doubleValue] * factorWork +
+				[[fit objectForKey:kCalibrationSolve] doubleValue] * solveWork;
+		*memory = [[fit objectForKey:kCalibrationMemory] doubleValue] * space;
+		// ...and see if it'll fit in memory
+		if (*memory > budget) {
+			if ([engine isEqualToString:@"LU"]) {
+				*time *= OUT_OF_CORE_PENALTY;
+				*memory = budget;
+			} else {
+				error = YES;
+			}
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method predicts the time and memory of every engine for the
+ system defined by the stencil, and sets this workspace up to use the
+ quickest one that fits in memory. The decision - and the predictions
+ for the engines that lost - goes to the log, and the prediction for
+ the winner into the report of the solve. It returns the name of the
+ engine, which is LU if nothing else can be predicted.
+ */
+- (NSString*) _pickSolverFor:(PoissonStencil*)stencil
+{
+	NSString*			retval = nil;
+	NSDictionary*		cal = [SimWorkspace getSolverCalibration];
+	SolverCostInputs	in;
+	double				bestTime = 0.0;
+	double				bestMemory = 0.0;
+	NSMutableArray*		others = [NSMutableArray array];
+
+	// predict each of the engines, and keep the quickest
+	[self _getCostInputs:&in forStencil:stencil];
+	for (NSString* name in candidateEngines()) {
+		double		t = 0.0;
+		double		m = 0.0;
+		if (![self _predictCostOf:name withInputs:&in andCalibration:cal time:&t memory:&m]) {
+			[others addObject:[NSString stringWithFormat:@"%@ can't", name]];
+		} else {
+			[others addObject:[NSString stringWithFormat:@"%@ %.1f msec/%.1f MB", name, t * 1000, MEGABYTES(m)]];
+			if ((retval == nil) || (t < bestTime)) {
+				retval = name;
+				bestTime = t;
+				bestMemory = m;
+			}
+		}
+	}
+
+	// ...and set ourselves up to use it
+	if (retval == nil) {
+		retval = @"LU";
+		NSLog(@"[SimWorkspace -_pickSolverFor:] - none of the engines could be predicted for the %dx%d grid, so it's going to the banded LU.", (int)in.rows, (int)in.cols);
+	} else {
+		NSLog(@"[SimWorkspace -_pickSolverFor:] - picked %@ for the %dx%d grid, predicted to take %.1f msec and %.1f MB (%@)", retval, (int)in.rows, (int)in.cols, bestTime * 1000, MEGABYTES(bestMemory), [others componentsJoinedByString:@", "]);
+		[self _setReportValue:[NSNumber numberWithDouble:bestTime] forKey:kReportPredictedTime];
+		[self _setReportValue:[NSNumber numberWithDouble:bestMemory] forKey:kReportPredictedMemory];
+	}
+	[self setSolverByName:retval];
+	[self _setReportValue:retval forKey:kReportSolver];
+
+	return retval;
+}
+
+
+/*!
+ This method compares the time and memory that the report of the solve
+ says the engine took with what was predicted for it - if the engine
+ was picked automatically - and logs how far off the prediction was.
+ */
+- (void) _checkSolverPrediction
+{
+	NSNumber*		predicted = [_solveReport objectForKey:kReportPredictedTime];
+	if (predicted != nil) {
+		double		time = [predicted doubleValue];
+		double		took = [[_solveReport objectForKey:kReportFactorTime] doubleValue] +
+						   [[_solveReport objectForKey:kReportSolveTime] doubleValue];
+		double		memory = [[_solveReport objectForKey:kReportPredictedMemory] doubleValue];
+		double		used = [[_solveReport objectForKey:kReportMemory] doubleValue];
+		NSLog(@"[SimWorkspace -_checkSolverPrediction] - %@ was predicted to take %.1f msec and %.1f MB, and it took %.1f msec (%+.0f%%) and %.1f MB (%+.0f%%)",
+			  [_solveReport objectForKey:kReportSolver],
+			  time * 1000, MEGABYTES(memory),
+			  took * 1000, (took > 0.0 ? 100.0 * (time - took) / took : 0.0),
+			  MEGABYTES(used), (used > 0.0 ? 100.0 * (memory - used) / used : 0.0));
+	}
+}
+
+@end
@@ -0,0 +1,122 @@
+//
+//  SimWorkspace_Banded.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+#import "BandedFactorization.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the banded direct solver methods on the SimWorkspace. This
+ is the original LAPACK solution of the system - assemble the stencil
+ into the banded storage, factor it and solve it - pulled out so that
+ it can be used on any stencil, and not just the one for the complete
+ workspace, as the other solvers need it for their own pieces. The
+ workspace can also hold on to the factorization so that only the RHS
+ has to be redone when the potentials or charges change. There's also
+ a banded Cholesky version for when the fixed nodes are folded into
+ the RHS and the system is symmetric, and a mixed precision version
+ that factors in single precision and refines the solution in double.
+ */
+@interface SimWorkspace (Banded)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method assembles the stencil into the banded storage that LAPACK
+ needs, factors it, and solves it for the RHS 'b' - all in a throw-away
+ BandedFactorization. The solution is then placed in the row-major
+ vector 'x', which can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x;
+
+/*!
+ This method returns the banded LU factorization of the stencil's
+ operator. If the workspace is holding on to one that fits, that's
+ what's returned. If it's only off by a few rows - as it is when a small
+ object is added or moved - it's updated with a low-rank correction.
+ Otherwise the stencil is factored, and the workspace holds on to that
+ one for the next time. If it can't be factored, this returns nil.
+ */
+- (BandedFactorization*) _getFactorizationOf:(PoissonStencil*)stencil;
+
+/*!
+ This method adds the fill and the memory of the factorization to the
+ report of the solve that's being done - they add up, as some of the
+ engines factor several pieces of the grid - along with its ordering.
+ */
+- (void) _reportFactorization:(BandedFactorization*)lu;
+
+/*!
+ This method puts the bytes that an out-of-core factorization has moved
+ to and from its scratch file - since it was factored - in the report
+ of the solve that's being done. One in memory has nothing to report.
+ */
+- (void) _reportIOVolumeOf:(BandedFactorization*)lu;
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the banded LU factorization that the
+ workspace is holding on to, if it's a factorization of this stencil's
+ operator. If not, the stencil is factored, and that factorization is
+ kept by the workspace for the next time. Since only the RHS changes
+ when the fixed potentials or the charges do, that makes each solve
+ after the first just the forward and backward substitutions.
+ */
+- (BOOL) _solveFactoredStencil:(PoissonStencil*)stencil into:(double*)v;
+
+/*!
+ This method solves the same system as -_solveBandedStencil:withRHS:into:
+ but with the fixed nodes folded into the RHS first. What's left, with
+ each row scaled by the area of the node's cell and negated, is
+ symmetric positive definite, and so it can be factored with DPBSV -
+ a banded Cholesky that only needs the kl+1 diagonals on and above the
+ main one, and no pivoting. That's less than half the memory, and less
+ than half the work, of the LU. This only works for the 5-point
+ stencil, so a 9-point one is just handed to the LU.
+ */
+- (BOOL) _solveSymmetricBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x;
+
+/*!
+ This method solves the same system as -_solveBandedStencil:withRHS:into:
+ but factors the banded operator in single precision with SGBTRF - half
+ the memory for the factors, and about twice as fast - and then makes
+ up for it with iterative refinement in double precision: the residual
+ is found with the stencil's own operator, the correction for it comes
+ from the single precision factors, and that repeats until the residual
+ is as small as the double precision LU would have left it. If the
+ refinement stalls, or the single precision factorization fails, the
+ system is handed to the double precision LU, so the answer is always
+ good to double precision. A 9-point stencil goes right to the LU.
+ */
+- (BOOL) _solveMixedPrecisionBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x;
+
+@end
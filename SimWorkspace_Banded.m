@@ -0,0 +1,645 @@
+//
+//  SimWorkspace_Banded.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Accelerate/Accelerate.h>
+
+// System Headers
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Banded.h"
+#import "SimWorkspace_Protected.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The mixed precision solver refines the single precision solution until
+ * the residual is down where the double precision LU would leave it -
+ * the same test as DSGESV in LAPACK - but if it takes more than this many
+ * steps, or any one step doesn't cut the residual by at least this much,
+ * then the single precision factors just aren't good enough for this
+ * operator, and it's handed to the double precision LU.
+ */
+#define	MAX_REFINEMENT_STEPS	30
+#define	MIN_REFINEMENT_GAIN		0.5
+
+// Public Macros
+
+
+/*
+ * This places the 5-point stencil into the single precision banded
+ * storage for SGBTRF, in the same node numbering - and with the same
+ * room for the fill-in - as the double precision factorization, and
+ * returns the largest row sum of the magnitudes of the coefficients, as
+ * that's the norm of the operator the refinement is measured against.
+ */
+static double fillSingleBand(const StencilArrays* a, BOOL rowMajor, __CLPK_integer kl, __CLPK_integer ldab, __CLPK_real* ab)
+{
+	int				rows = a->rows;
+	int				cols = a->cols;
+	__CLPK_integer	klpku = 2*kl;
+	double			norm = 0.0;
+	for (int row = 0; row < rows; row++) {
+		for (int col = 0; col < cols; col++) {
+			size_t			ij = (size_t)row * cols + col;
+			__CLPK_integer	ijn = (rowMajor ? (row * cols + col) : (col * rows + row));
+			__CLPK_integer	nn = 0;
+			ab[(size_t)ijn*ldab + klpku] = a->center[ij];
+			if (a->top[ij] != 0.0) {
+				nn = (rowMajor ? (ijn - cols) : (ijn - 1));
+				ab[(size_t)nn*ldab + klpku + ijn-nn] += a->top[ij];
+			}
+			if (a->bottom[ij] != 0.0) {
+				nn = (rowMajor ? (ijn + cols) : (ijn + 1));
+				ab[(size_t)nn*ldab + klpku + ijn-nn] += a->bottom[ij];
+			}
+			if (a->left[ij] != 0.0) {
+				nn = (rowMajor ? (ijn - 1) : (ijn - rows));
+				ab[(size_t)nn*ldab + klpku + ijn-nn] += a->left[ij];
+			}
+			if (a->right[ij] != 0.0) {
+				nn = (rowMajor ? (ijn + 1) : (ijn + rows));
+				ab[(size_t)nn*ldab + klpku + ijn-nn] += a->right[ij];
+			}
+			double		sum = fabs(a->center[ij]) + fabs(a->top[ij]) + fabs(a->bottom[ij]) +
+							  fabs(a->left[ij]) + fabs(a->right[ij]);
+			norm = MAX(norm, sum);
+		}
+	}
+	return norm;
+}
+
+
+/*!
+ @class SimWorkspace
+ These are the banded direct solver methods on the SimWorkspace. This
+ is the original LAPACK solution of the system - assemble the stencil
+ into the banded storage, factor it and solve it - pulled out so that
+ it can be used on any stencil, and not just the one for the complete
+ workspace, as the other solvers need it for their own pieces. The
+ workspace can also hold on to the factorization so that only the RHS
+ has to be redone when the potentials or charges change. There's also
+ a banded Cholesky version for when the fixed nodes are folded into
+ the RHS and the system is symmetric, and a mixed precision version
+ that factors in single precision and refines the solution in double.
+ */
+@implementation SimWorkspace (Banded)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method assembles the stencil into the banded storage that LAPACK
+ needs, factors it, and solves it for the RHS 'b' - all in a throw-away
+ BandedFactorization. The solution is then placed in the row-major
+ vector 'x', which can be the same as 'b' if the caller wishes.
+ */
+- (BOOL) _solveBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x
+{
+	BOOL					error = NO;
+	BandedFactorization*	lu = nil;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (b == NULL) || (x == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveBandedStencil:withRHS:into:] - the stencil, RHS or solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// factor the system...
+	if (!error) {
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		lu = [[BandedFactorization alloc] initWithStencil:stencil];
+		if (lu == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveBandedStencil:withRHS:into:] - the %dx%d system could not be factored. Please check the logs for a possible cause.", [stencil getRowCount], [stencil getColCount]);
+		} else {
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+			[self _reportFactorization:lu];
+		}
+	}
+
+	// ...and solve it
+	if (!error) {
+		error = ![lu solve:b count:1 into:x];
+		[self _reportIOVolumeOf:lu];
+	}
+
+	// in the end, we can release what it is that we don't need
+	[lu release];
+
+	return !error;
+}
+
+
+/*!
+ This method returns the banded LU factorization of the stencil's
+ operator. If the workspace is holding on to one that fits, that's
+ what's returned. If it's only off by a few rows - as it is when a small
+ object is added or moved - it's updated with a low-rank correction.
+ Otherwise the stencil is factored, and the workspace holds on to that
+ one for the next time. If it can't be factored, this returns nil.
+ */
+- (BandedFactorization*) _getFactorizationOf:(PoissonStencil*)stencil
+{
+	BandedFactorization*	lu = [self _getFactorization];
+	BOOL					reused = YES;
+	NSTimeInterval			start = [NSDate timeIntervalSinceReferenceDate];
+
+	if ((lu != nil) && [lu isFactorOf:stencil]) {
+		NSLog(@"[SimWorkspace -_getFactorizationOf:] - the operator hasn't changed, so we're reusing the existing factorization");
+	} else if ((lu != nil) && [lu updateTo:stencil]) {
+		NSLog(@"[SimWorkspace -_getFactorizationOf:] - the operator has %d changed rows, so we're updating the existing factorization", [lu getUpdateRank]);
+	} else {
+		reused = NO;
+		[self _setFactorization:nil];
+		lu = [[[BandedFactorization alloc] initWithStencil:stencil] autorelease];
+		if (lu == nil) {
+			NSLog(@"[SimWorkspace -_getFactorizationOf:] - the %dx%d system could not be factored. Please check the logs for a possible cause.", [stencil getRowCount], [stencil getColCount]);
+		} else {
+			[self _setFactorization:lu];
+		}
+	}
+
+	// the update is the factoring this time, if there was any at all
+	if (lu != nil) {
+		[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+		[self _setReportValue:[NSNumber numberWithBool:reused] forKey:kReportFactorReused];
+		[self _reportFactorization:lu];
+	}
+
+	return lu;
+}
+
+
+/*!
+ This method adds the fill and the memory of the factorization to the
+ report of the solve that's being done - they add up, as some of the
+ engines factor several pieces of the grid - along with its ordering.
+ */
+- (void) _reportFactorization:(BandedFactorization*)lu
+{
+	if (lu != nil) {
+		[self _addReportValue:(double)[lu getFactorNonZeros] forKey:kReportFill];
+		[self _addReportValue:(double)[lu getFactorSize] forKey:kReportMemory];
+		[self _setReportValue:[lu getOrdering] forKey:kReportOrdering];
+	}
+}
+
+
+/*!
+ This method puts the bytes that an out-of-core factorization has moved
+ to and from its scratch file - since it was factored - in the report
+ of the solve that's being done. One in memory has nothing to report.
+ */
+- (void) _reportIOVolumeOf:(BandedFactorization*)lu
+{
+	if ([lu isOutOfCore]) {
+		[self _setReportValue:[NSNumber numberWithUnsignedLongLong:[lu getIOVolume]] forKey:kReportIOVolume];
+	}
+}
+
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the banded LU factorization that the
+ workspace is holding on to, if it's a factorization of this stencil's
+ operator. If not, the stencil is factored, and that factorization is
+ kept by the workspace for the next time. Since only the RHS changes
+ when the fixed potentials or the charges do, that makes each solve
+ after the first just the forward and backward substitutions.
+ */
+- (BOOL) _solveFactoredStencil:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL					error = NO;
+	BandedFactorization*	lu = nil;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveFactoredStencil:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// get the factorization, reusing the one we have if we can
+	if (!error) {
+		lu = [self _getFactorizationOf:stencil];
+		if (lu == nil) {
+			error = YES;
+		}
+	}
+
+	// ...and solve it
+	if (!error) {
+		error = ![lu solve:[stencil getRHS] count:1 into:v];
+		[self _reportIOVolumeOf:lu];
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method solves the same system as -_solveBandedStencil:withRHS:into:
+ but with the fixed nodes folded into the RHS first. What's left, with
+ each row scaled by the area of the node's cell and negated, is
+ symmetric positive definite, and so it can be factored with DPBSV -
+ a banded Cholesky that only needs the kl+1 diagonals on and above the
+ main one, and no pivoting. That's less than half the memory, and less
+ than half the work, of the LU. This only works for the 5-point
+ stencil, so a 9-point one is just handed to the LU.
+ */
+- (BOOL) _solveSymmetricBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x
+{
+	BOOL			error = NO;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (b == NULL) || (x == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - the stencil, RHS or solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// the corners of a 9-point stencil aren't symmetric with these weights
+	if (!error && [stencil hasCorners]) {
+		return [self _solveBandedStencil:stencil withRHS:b into:x];
+	}
+
+	/*
+	 * Next, determine storage format and allocate space for solution set.
+	 * For a more complete description of the arguments and what they are,
+	 * how big they need to be, etc. please see the docs on DPBSV in LAPACK.
+	 * We store the upper triangle, so there are only the kd diagonals
+	 * above the main one to keep, and there's no pivoting to make room
+	 * for, or to keep track of.
+	 */
+	int					rows = [stencil getRowCount];
+	int					cols = [stencil getColCount];
+	char				uplo = 'U';
+	__CLPK_integer		n = rows * cols;
+	__CLPK_integer		kd = MIN(rows, cols);
+	BOOL				rowMajor = (cols <= rows);
+	__CLPK_integer		nrhs = 1;
+	__CLPK_integer		ldab = kd + 1;
+	__CLPK_doublereal	*ab = NULL;
+	if (!error) {
+		ab = (__CLPK_doublereal *) calloc( (size_t)ldab*n, sizeof(__CLPK_doublereal) );
+		if (ab == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - while trying to allocate the banded A matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldab, n);
+		}
+	}
+	__CLPK_integer		ldb = n;
+	__CLPK_doublereal	*bb = NULL;
+	if (!error) {
+		bb = (__CLPK_doublereal *) calloc( (size_t)ldb*nrhs, sizeof(__CLPK_doublereal) );
+		if (bb == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - while trying to allocate the RHS b matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldb, nrhs);
+		}
+	}
+	double				*wx = NULL;
+	double				*wy = NULL;
+	if (!error) {
+		wx = (double *) calloc(cols, sizeof(double));
+		wy = (double *) calloc(rows, sizeof(double));
+		if ((wx == NULL) || (wy == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - while trying to allocate the cell weights for the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", rows, cols);
+		} else {
+			[stencil getColWeights:wx andRowWeights:wy];
+		}
+	}
+
+	/*
+	 * Now we can populate the matricies. The banded storage for the upper
+	 * triangle is given, in C-style terms, as:
+	 *     ab[j*ldab + kd+i-j] = a(i, j)     for j-kd <= i <= j
+	 * so for each node we only place the diagonal and the coupling to the
+	 * neighbors with smaller node numbers - the rest is the transpose.
+	 *
+	 * A fixed node is just an identity row and column, and its potential
+	 * is moved over to the RHS of each of its free neighbors. A free row
+	 * is then scaled by -wx*wy, the area of its cell, and negated, which
+	 * is what makes the coupling between two free nodes the same in both
+	 * of their rows.
+	 */
+	if (!error) {
+		StencilArrays*	a = [stencil getArrays];
+		BOOL*			fixed = a->fixed;
+		size_t			ij = 0;
+		__CLPK_integer	ijn = 0;
+		__CLPK_integer	nn = 0;
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				ij = (size_t)row * cols + col;
+				ijn = (rowMajor ? (row * cols + col) : (col * rows + row));
+				// the fixed nodes are simply their own potential
+				if (fixed[ij]) {
+					ab[(size_t)ijn*ldab + kd] = 1.0;
+					bb[ijn] = b[ij];
+					continue;
+				}
+				double		w = -wx[col] * wy[row];
+				double		rhs = b[ij];
+				ab[(size_t)ijn*ldab + kd] = w * a->center[ij];
+				// the 'top' node - it always has a smaller node number
+				if (a->top[ij] != 0.0) {
+					if (fixed[ij - cols]) {
+						rhs -= a->top[ij] * b[ij - cols];
+					} else {
+						nn = (rowMajor ? (ijn - cols) : (ijn - 1));
+						ab[(size_t)ijn*ldab + kd + nn-ijn] = w * a->top[ij];
+					}
+				}
+				// the 'left' node - it always has a smaller node number
+				if (a->left[ij] != 0.0) {
+					if (fixed[ij - 1]) {
+						rhs -= a->left[ij] * b[ij - 1];
+					} else {
+						nn = (rowMajor ? (ijn - 1) : (ijn - rows));
+						ab[(size_t)ijn*ldab + kd + nn-ijn] = w * a->left[ij];
+					}
+				}
+				// the 'bottom' and 'right' nodes are in the transpose
+				if ((a->bottom[ij] != 0.0) && fixed[ij + cols]) {
+					rhs -= a->bottom[ij] * b[ij + cols];
+				}
+				if ((a->right[ij] != 0.0) && fixed[ij + 1]) {
+					rhs -= a->right[ij] * b[ij + 1];
+				}
+				// ...and the RHS of Ax=b
+				bb[ijn] = w * rhs;
+			}
+		}
+	}
+
+	/*
+	 * Finally, we can solve the system for the user - this is just what
+	 * dpbsv_ in cLAPACK does, but with the factoring in dpbtrf_ and the
+	 * substitutions in dpbtrs_ done one after the other, so that each can
+	 * be timed on its own.
+	 */
+	if (!error) {
+		__CLPK_integer	info = 0;
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		dpbtrf_(&uplo, &n, &kd, ab, &ldab, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - argument #%d had an illegal value to DPBTRF in LAPACK. Please check into this.", -1*info);
+		} else if (info > 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - the leading minor of order %d is not positive definite which shouldn't happen once the fixed nodes have been folded in.", info);
+		} else {
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+			[self _addReportValue:(double)ldab * n forKey:kReportFill];
+			[self _addReportValue:(double)ldab * n * sizeof(__CLPK_doublereal) forKey:kReportMemory];
+			[self _setReportValue:[NSString stringWithFormat:@"%@, band of %d", (rowMajor ? @"row-major" : @"column-major"), kd] forKey:kReportOrdering];
+		}
+	}
+	if (!error) {
+		__CLPK_integer	info = 0;
+		dpbtrs_(&uplo, &n, &kd, &nrhs, ab, &ldab, bb, &ldb, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSymmetricBandedStencil:withRHS:into:] - argument #%d had an illegal value to DPBTRS in LAPACK. Please check into this.", -1*info);
+		}
+	}
+
+	// put the solution back into the row-major ordering of the caller
+	if (!error) {
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				x[(size_t)row * cols + col] = bb[rowMajor ? (row * cols + col) : (col * rows + row)];
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (wx != NULL) {
+		free(wx);
+	}
+	if (wy != NULL) {
+		free(wy);
+	}
+	if (bb != NULL) {
+		free(bb);
+	}
+	if (ab != NULL) {
+		free(ab);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method solves the same system as -_solveBandedStencil:withRHS:into:
+ but factors the banded operator in single precision with SGBTRF - half
+ the memory for the factors, and about twice as fast - and then makes
+ up for it with iterative refinement in double precision: the residual
+ is found with the stencil's own operator, the correction for it comes
+ from the single precision factors, and that repeats until the residual
+ is as small as the double precision LU would have left it. If the
+ refinement stalls, or the single precision factorization fails, the
+ system is handed to the double precision LU, so the answer is always
+ good to double precision. A 9-point stencil goes right to the LU.
+ */
+- (BOOL) _solveMixedPrecisionBandedStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x
+{
+	BOOL			error = NO;
+	BOOL			fallback = NO;
+	NSString*		reason = nil;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (b == NULL) || (x == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - the stencil, RHS or solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// the single precision band is only placed for the 5-point stencil
+	if (!error && [stencil hasCorners]) {
+		return [self _solveBandedStencil:stencil withRHS:b into:x];
+	}
+
+	/*
+	 * Next, determine storage format and allocate space for the factors.
+	 * This is just like the double precision factorization, but in floats,
+	 * and we need the residual and the correction in both the row-major
+	 * ordering of the stencil and the banded node numbering.
+	 */
+	int					rows = [stencil getRowCount];
+	int					cols = [stencil getColCount];
+	__CLPK_integer		n = rows * cols;
+	__CLPK_integer		kl = MIN(rows, cols);
+	__CLPK_integer		ku = kl;
+	__CLPK_integer		ldab = 2*kl + ku + 1;
+	__CLPK_integer		nrhs = 1;
+	__CLPK_integer		ldb = n;
+	BOOL				rowMajor = (cols <= rows);
+	__CLPK_real			*ab = NULL;
+	__CLPK_integer		*ipiv = NULL;
+	__CLPK_real			*d = NULL;
+	double				*r = NULL;
+	if (!error) {
+		ab = (__CLPK_real *) calloc( (size_t)ldab*n, sizeof(__CLPK_real) );
+		ipiv = (__CLPK_integer *) calloc( n, sizeof(__CLPK_integer) );
+		d = (__CLPK_real *) calloc( ldb, sizeof(__CLPK_real) );
+		r = (double *) calloc( n, sizeof(double) );
+		if ((ab == NULL) || (ipiv == NULL) || (d == NULL) || (r == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - while trying to allocate the single precision banded A matrix storage (%dx%d) for the solution, we ran into an allocation problem and couldn't get it. Please check into this as soon as possilbe.", ldab, n);
+		}
+	}
+
+	// now place the operator in the band and factor it using sgbtrf_
+	double				anorm = 0.0;
+	if (!error) {
+		__CLPK_integer	info = 0;
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		anorm = fillSingleBand([stencil getArrays], rowMajor, kl, ldab, ab);
+		sgbtrf_(&n, &n, &kl, &ku, ab, &ldab, ipiv, &info);
+		[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - argument #%d had an illegal value to SGBTRF in LAPACK. Please check into this.", -1*info);
+		} else if (info > 0) {
+			fallback = YES;
+			reason = [NSString stringWithFormat:@"diagonal #%d is zero in single precision", info];
+			NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - diagonal #%d is zero in single precision, so it's going to the double precision LU.", info);
+		} else {
+			[self _addReportValue:(double)ldab * n forKey:kReportFill];
+			[self _addReportValue:(double)ldab * n * sizeof(__CLPK_real) + (double)n * sizeof(__CLPK_integer) forKey:kReportMemory];
+			[self _setReportValue:[NSString stringWithFormat:@"%@, band of %d", (rowMajor ? @"row-major" : @"column-major"), kl] forKey:kReportOrdering];
+		}
+	}
+
+	/*
+	 * Now we can refine the solution. Starting from zero, the residual is
+	 * just 'b', and each step solves for the correction in single precision
+	 * and adds it in double. We're done when the residual is down to what
+	 * the rounding in double precision would leave - eps * |A| * |x| in the
+	 * max norms. If it stalls short of that, but within the sqrt(n) of it
+	 * that DSGESV in LAPACK settles for, that's still as good as the LU.
+	 */
+	int					steps = 0;
+	if (!error && !fallback) {
+		char			trans = 'N';
+		double			cte = anorm * DBL_EPSILON;
+		double			last = 0.0;
+		double			bnorm = 0.0;
+		memcpy(r, b, n * sizeof(double));
+		memset(x, 0, n * sizeof(double));
+		for (steps = 0; !error && !fallback; steps++) {
+			// see how big the residual is...
+			double		rnorm = 0.0;
+			double		xnorm = 0.0;
+			for (int i = 0; i < n; i++) {
+				rnorm = MAX(rnorm, fabs(r[i]));
+				xnorm = MAX(xnorm, fabs(x[i]));
+			}
+			// the first residual is just 'b', and the rest are relative to it
+			if (steps == 0) {
+				bnorm = (rnorm > 0.0 ? rnorm : 1.0);
+			}
+			[self _addResidualToReport:(rnorm / bnorm)];
+			if ((steps > 0) && (rnorm <= cte * xnorm)) {
+				break;
+			}
+			// ...and if it isn't going down fast enough, it's time to stop
+			if ((steps > MAX_REFINEMENT_STEPS) ||
+				((steps > 1) && (rnorm > MIN_REFINEMENT_GAIN * last))) {
+				if (rnorm <= sqrt((double)n) * cte * xnorm) {
+					break;
+				}
+				fallback = YES;
+				reason = [NSString stringWithFormat:@"the refinement stalled after %d steps", steps];
+				NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - the refinement stalled after %d steps with a residual of %g, so it's going to the double precision LU.", steps, rnorm);
+				break;
+			}
+			last = rnorm;
+			// solve for the correction in the banded node numbering...
+			for (int row = 0; row < rows; row++) {
+				for (int col = 0; col < cols; col++) {
+					d[rowMajor ? (row * cols + col) : (col * rows + row)] = r[(size_t)row * cols + col];
+				}
+			}
+			__CLPK_integer	info = 0;
+			sgbtrs_(&trans, &n, &kl, &ku, &nrhs, ab, &ldab, ipiv, d, &ldb, &info);
+			if (info < 0) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - argument #%d had an illegal value to SGBTRS in LAPACK. Please check into this.", -1*info);
+			} else {
+				// ...add it in, and get the new residual with the real operator
+				for (int row = 0; row < rows; row++) {
+					for (int col = 0; col < cols; col++) {
+						x[(size_t)row * cols + col] += d[rowMajor ? (row * cols + col) : (col * rows + row)];
+					}
+				}
+				[stencil residualOf:x forRHS:b into:r];
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (r != NULL) {
+		free(r);
+	}
+	if (d != NULL) {
+		free(d);
+	}
+	if (ipiv != NULL) {
+		free(ipiv);
+	}
+	if (ab != NULL) {
+		free(ab);
+	}
+
+	// if single precision wasn't good enough, then go to the full LU
+	if (!error && fallback) {
+		/*
+		 * None of what the single precision factors did is part of the
+		 * answer now, so it comes out of the report before the LU adds
+		 * its own, and the report says what it fell back from, and why.
+		 */
+		[self _removeReportValueForKey:kReportResidualHistory];
+		[self _removeReportValueForKey:kReportFactorTime];
+		[self _removeReportValueForKey:kReportFill];
+		[self _removeReportValueForKey:kReportMemory];
+		[self _removeReportValueForKey:kReportOrdering];
+		[self _setReportValue:@"LU" forKey:kReportSolver];
+		[self _setReportValue:@"LU32" forKey:kReportFallbackFrom];
+		[self _setReportValue:reason forKey:kReportFallbackReason];
+		error = ![self _solveBandedStencil:stencil withRHS:b into:x];
+	} else if (!error) {
+		[self _setReportValue:[NSNumber numberWithInt:steps] forKey:kReportIterations];
+		NSLog(@"[SimWorkspace -_solveMixedPrecisionBandedStencil:withRHS:into:] - the single precision factors took %d refinement steps", steps);
+	}
+
+	return !error;
+}
+
+@end
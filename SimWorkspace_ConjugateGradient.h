@@ -0,0 +1,57 @@
+//
+//  SimWorkspace_ConjugateGradient.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the preconditioned conjugate gradient methods on the
+ SimWorkspace. They never build a matrix at all - the 5-point stencil
+ is applied directly, scaled so that it's symmetric on the free nodes -
+ and so the memory needed is a handful of vectors the size of the grid,
+ no matter how wide the band would have been.
+ */
+@interface SimWorkspace (ConjugateGradient)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the preconditioned conjugate gradient
+ method with the workspace's preconditioner, until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The solution is placed in the row-major
+ vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingConjugateGradient:(PoissonStencil*)stencil into:(double*)v;
+
+@end
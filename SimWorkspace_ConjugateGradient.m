@@ -0,0 +1,426 @@
+//
+//  SimWorkspace_ConjugateGradient.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_ConjugateGradient.h"
+#import "SimWorkspace_Protected.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * Preconditioned CG takes on the order of the number of nodes along the
+ * longest side of the grid to converge, so unless the user has told us
+ * otherwise, we give it this many times that before giving up.
+ */
+#define	DEFAULT_ITERATION_FACTOR	10
+
+/*
+ * When the recurrence says we're there but the real residual says we're
+ * not, we start over from where we are this many times before giving up.
+ */
+#define	MAX_RESTARTS				3
+
+// Public Macros
+
+
+/*
+ * This is the symmetric form of the operator on the free nodes: each row
+ * is scaled by the area of the node's cell and negated, which makes it
+ * symmetric and positive definite. The fixed nodes are left out - they
+ * are zero in every vector the iteration sees - and the return value is
+ * the dot product x.y as CG needs that right away.
+ */
+static double weightedMultiply(const StencilArrays* a, const double* wx, const double* wy, const double* x, double* y)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	double		dot = 0.0;
+	for (int r = 0; r < rows; r++) {
+		size_t			o = (size_t)r * cols;
+		const double*	xr = x + o;
+		const double*	xt = (r > 0) ? (xr - cols) : NULL;
+		const double*	xb = (r < (rows - 1)) ? (xr + cols) : NULL;
+		for (int c = 0; c < cols; c++) {
+			if (a->fixed[o + c]) {
+				y[o + c] = 0.0;
+				continue;
+			}
+			double		s = a->center[o + c] * xr[c];
+			if (c > 0) {
+				s += a->left[o + c] * xr[c - 1];
+			}
+			if (c < (cols - 1)) {
+				s += a->right[o + c] * xr[c + 1];
+			}
+			if (xt != NULL) {
+				s += a->top[o + c] * xt[c];
+			}
+			if (xb != NULL) {
+				s += a->bottom[o + c] * xb[c];
+			}
+			y[o + c] = -wy[r] * wx[c] * s;
+			dot += xr[c] * y[o + c];
+		}
+	}
+	return dot;
+}
+
+
+/*
+ * This sets up the diagonal 'd' that the preconditioner needs. For
+ * Jacobi it's just the diagonal of the operator, and for SSOR and IC(0)
+ * it's the diagonal of the (D + L) D^-1 (D + L^T) factorization, where
+ * L is the strictly lower part of the symmetric operator. For SSOR, D is
+ * the operator's diagonal over omega, and for IC(0), D is what makes the
+ * product match the operator on its own sparsity pattern.
+ */
+static void factorPreconditioner(const StencilArrays* a, const double* wx, const double* wy, CGPreconditioner type, double omega, double* d)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			double		w = wy[r] * wx[c];
+			if (a->fixed[ij]) {
+				d[ij] = 1.0;
+				continue;
+			}
+			d[ij] = -w * a->center[ij];
+			if (type == kSSORPreconditioner) {
+				d[ij] /= omega;
+			} else if (type == kIncompleteCholeskyPreconditioner) {
+				if ((c > 0) && !a->fixed[ij - 1]) {
+					double		l = w * a->left[ij];
+					d[ij] -= l * l / d[ij - 1];
+				}
+				if ((r > 0) && !a->fixed[ij - cols]) {
+					double		l = w * a->top[ij];
+					d[ij] -= l * l / d[ij - cols];
+				}
+			}
+		}
+	}
+}
+
+
+/*
+ * This applies the preconditioner to the residual 'res' and places the
+ * result in 'z'. For SSOR and IC(0) it's a forward sweep with (D + L)
+ * and then a backward one with (D + L^T), and the only difference
+ * between the two is the diagonal that was set up for them. The overall
+ * scaling of the preconditioner doesn't matter to CG, so we don't bother
+ * with the usual omega(2 - omega) factor on SSOR.
+ */
+static void applyPreconditioner(const StencilArrays* a, const double* wx, const double* wy, CGPreconditioner type, const double* d, const double* res, double* z)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	size_t		n = (size_t)rows * cols;
+
+	if (type == kJacobiPreconditioner) {
+		for (size_t i = 0; i < n; i++) {
+			z[i] = a->fixed[i] ? 0.0 : res[i] / d[i];
+		}
+		return;
+	}
+
+	// the forward sweep: (D + L) y = r
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			if (a->fixed[ij]) {
+				z[ij] = 0.0;
+				continue;
+			}
+			double		w = wy[r] * wx[c];
+			double		s = res[ij];
+			if (c > 0) {
+				s += w * a->left[ij] * z[ij - 1];
+			}
+			if (r > 0) {
+				s += w * a->top[ij] * z[ij - cols];
+			}
+			z[ij] = s / d[ij];
+		}
+	}
+	// ...and the backward sweep: (D + L^T) z = D y
+	for (int r = rows - 1; r >= 0; r--) {
+		for (int c = cols - 1; c >= 0; c--) {
+			size_t		ij = (size_t)r * cols + c;
+			if (a->fixed[ij]) {
+				continue;
+			}
+			double		w = wy[r] * wx[c];
+			double		s = 0.0;
+			if (c < (cols - 1)) {
+				s += w * a->right[ij] * z[ij + 1];
+			}
+			if (r < (rows - 1)) {
+				s += w * a->bottom[ij] * z[ij + cols];
+			}
+			z[ij] += s / d[ij];
+		}
+	}
+}
+
+
+/*
+ * This takes the residual of the stencil - b - Ax - and turns it into
+ * the one of the symmetric form that CG works with, in place: zero on
+ * the fixed nodes, and scaled by the area of the cell and negated on
+ * the free ones.
+ */
+static void weightResidual(const StencilArrays* a, const double* wx, const double* wy, double* res)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			res[ij] = (a->fixed[ij] ? 0.0 : -wy[r] * wx[c] * res[ij]);
+		}
+	}
+}
+
+
+/*
+ * The residual CG works with is the weighted one, so to compare it to
+ * the tolerance like all the other solvers do, we need to take the
+ * weights back out of it before taking the norm.
+ */
+static double unweightedNorm(const StencilArrays* a, const double* wx, const double* wy, const double* res)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	double		sum = 0.0;
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			double		t = res[(size_t)r * cols + c] / (wy[r] * wx[c]);
+			sum += t * t;
+		}
+	}
+	return sqrt(sum);
+}
+
+
+/*!
+ @class SimWorkspace
+ These are the preconditioned conjugate gradient methods on the
+ SimWorkspace. They never build a matrix at all - the 5-point stencil
+ is applied directly, scaled so that it's symmetric on the free nodes -
+ and so the memory needed is a handful of vectors the size of the grid,
+ no matter how wide the band would have been.
+ */
+@implementation SimWorkspace (ConjugateGradient)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the preconditioned conjugate gradient
+ method with the workspace's preconditioner, until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The solution is placed in the row-major
+ vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingConjugateGradient:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL				error = NO;
+	StencilArrays*		a = NULL;
+	int					rows = 0;
+	int					cols = 0;
+	size_t				n = 0;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		} else {
+			a = [stencil getArrays];
+			rows = [stencil getRowCount];
+			cols = [stencil getColCount];
+			n = (size_t)rows * cols;
+		}
+	}
+
+	// next, get the handful of vectors that CG needs
+	double*		r = NULL;
+	double*		z = NULL;
+	double*		p = NULL;
+	double*		q = NULL;
+	double*		d = NULL;
+	double*		wx = NULL;
+	double*		wy = NULL;
+	if (!error) {
+		r = (double *) calloc(n, sizeof(double));
+		z = (double *) calloc(n, sizeof(double));
+		p = (double *) calloc(n, sizeof(double));
+		q = (double *) calloc(n, sizeof(double));
+		d = (double *) calloc(n, sizeof(double));
+		wx = (double *) calloc(cols, sizeof(double));
+		wy = (double *) calloc(rows, sizeof(double));
+		if ((r == NULL) || (z == NULL) || (p == NULL) || (q == NULL) ||
+			(d == NULL) || (wx == NULL) || (wy == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - while trying to allocate the vectors for the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rows, cols);
+		}
+	}
+
+	/*
+	 * Start with the fixed potentials, and the last solution - if any -
+	 * everywhere else. Then the correction we're after is zero on the
+	 * fixed nodes, and the system on the free nodes - scaled by the cell
+	 * areas - is symmetric.
+	 */
+	double		bnorm = 0.0;
+	double		rnorm = 0.0;
+	BOOL		warm = NO;
+	if (!error) {
+		double*		b = [stencil getRHS];
+		warm = [self _seedSolution:v forStencil:stencil];
+		for (size_t i = 0; i < n; i++) {
+			bnorm += b[i] * b[i];
+		}
+		bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+		rnorm = [stencil residualOf:v forRHS:b into:r];
+		[stencil getColWeights:wx andRowWeights:wy];
+		weightResidual(a, wx, wy, r);
+	}
+
+	// now run the iteration until we're there, or we've run out of patience
+	if (!error) {
+		CGPreconditioner	type = [self getPreconditioner];
+		// this is a reasonable SSOR relaxation factor for the Laplacian
+		double				omega = 2.0/(1.0 + 2.0*M_PI/MAX(rows, cols));
+		int					maxIter = [self getMaxIterations];
+		if (maxIter <= 0) {
+			maxIter = DEFAULT_ITERATION_FACTOR * MAX(rows, cols);
+		}
+		NSTimeInterval		start = [NSDate timeIntervalSinceReferenceDate];
+		factorPreconditioner(a, wx, wy, type, omega, d);
+		[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+		[self _addReportValue:(5.0 * n + rows + cols) * sizeof(double) forKey:kReportMemory];
+		if (type == kIncompleteCholeskyPreconditioner) {
+			[self _setReportValue:@"row-major, no fill" forKey:kReportOrdering];
+		}
+		applyPreconditioner(a, wx, wy, type, d, r, z);
+		memcpy(p, z, n * sizeof(double));
+		double		rz = 0.0;
+		for (size_t i = 0; i < n; i++) {
+			rz += r[i] * z[i];
+		}
+		int			iter = 0;
+		int			restarts = 0;
+		BOOL		checked = NO;
+		[self _addResidualToReport:(rnorm / bnorm)];
+		while (!error && !checked) {
+			while (!error && (rnorm > [self getTolerance] * bnorm) && (iter < maxIter)) {
+				double		pq = weightedMultiply(a, wx, wy, p, q);
+				if (pq <= 0.0) {
+					error = YES;
+					NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - on iteration %d the search direction had a non-positive curvature (%g), which means the system isn't positive definite. This shouldn't happen, so please check into this.", (iter + 1), pq);
+					break;
+				}
+				double		alpha = rz / pq;
+				for (size_t i = 0; i < n; i++) {
+					v[i] += alpha * p[i];
+					r[i] -= alpha * q[i];
+				}
+				rnorm = unweightedNorm(a, wx, wy, r);
+				applyPreconditioner(a, wx, wy, type, d, r, z);
+				double		rzNew = 0.0;
+				for (size_t i = 0; i < n; i++) {
+					rzNew += r[i] * z[i];
+				}
+				double		beta = rzNew / rz;
+				rz = rzNew;
+				for (size_t i = 0; i < n; i++) {
+					p[i] = z[i] + beta * p[i];
+				}
+				iter++;
+				[self _addResidualToReport:(rnorm / bnorm)];
+			}
+			/*
+			 * The recurrence for the residual drifts from the real one, so
+			 * when it says we're there, check it against the operator. If
+			 * that's not there yet, start over from here with the real one.
+			 */
+			checked = YES;
+			if (!error && (rnorm <= [self getTolerance] * bnorm)) {
+				rnorm = [stencil residualOf:v forRHS:[stencil getRHS] into:r];
+				if ((rnorm > [self getTolerance] * bnorm) && (iter < maxIter) && (restarts < MAX_RESTARTS)) {
+					restarts++;
+					checked = NO;
+					NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - after %d iterations the real relative residual is %g, which is above the tolerance of %g, so it's starting over from there.", iter, rnorm/bnorm, [self getTolerance]);
+					weightResidual(a, wx, wy, r);
+					applyPreconditioner(a, wx, wy, type, d, r, z);
+					memcpy(p, z, n * sizeof(double));
+					rz = 0.0;
+					for (size_t i = 0; i < n; i++) {
+						rz += r[i] * z[i];
+					}
+				}
+			}
+		}
+		[self _setReportValue:[NSNumber numberWithInt:iter] forKey:kReportIterations];
+		if (!error) {
+			if (rnorm > [self getTolerance] * bnorm) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - after %d iterations from a %@ start the relative residual is still %g which is above the tolerance of %g. You might want to raise the maximum iterations.", iter, (warm ? @"warm" : @"cold"), rnorm/bnorm, [self getTolerance]);
+			} else {
+				NSLog(@"[SimWorkspace -_solveUsingConjugateGradient:into:] - %d iterations from a %@ start brought the relative residual to %g", iter, (warm ? @"warm" : @"cold"), rnorm/bnorm);
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (r != NULL) {
+		free(r);
+	}
+	if (z != NULL) {
+		free(z);
+	}
+	if (p != NULL) {
+		free(p);
+	}
+	if (q != NULL) {
+		free(q);
+	}
+	if (d != NULL) {
+		free(d);
+	}
+	if (wx != NULL) {
+		free(wx);
+	}
+	if (wy != NULL) {
+		free(wy);
+	}
+
+	return !error;
+}
+
+@end
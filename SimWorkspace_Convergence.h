@@ -0,0 +1,99 @@
+//
+//  SimWorkspace_Convergence.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The study solves the workspace on this many grids - its own, and then
+ * each one twice as fine as the last - which is the fewest that the
+ * order of convergence can be measured from.
+ */
+#define	CONVERGENCE_LEVELS			3
+
+/*
+ * These are the keys of the study that -simulateConvergenceWithObjects:
+ * returns. The rows, cols, times and errors are arrays with one entry
+ * for each grid, from the workspace's own to the finest, and the errors
+ * are the estimates against the extrapolated potentials, in volts, on
+ * the nodes of the workspace's grid. The observed order is left out if
+ * the differences between the grids couldn't give one, and the
+ * recommended grid is only there if there was a target to meet.
+ */
+#define kConvergenceRows			@"rows"
+#define kConvergenceCols			@"cols"
+#define kConvergenceSolveTime		@"solveTime"
+#define kConvergenceObservedOrder	@"observedOrder"
+#define kConvergenceOrder			@"extrapolationOrder"
+#define kConvergenceMaxError		@"maxError"
+#define kConvergenceRMSError		@"rmsError"
+#define kConvergenceTarget			@"target"
+#define kConvergenceRecommendedRows	@"recommendedRows"
+#define kConvergenceRecommendedCols	@"recommendedCols"
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the grid convergence methods on the SimWorkspace. There's no
+ telling from one solve whether the grid is fine enough, so the study
+ solves the workspace on its own grid, and on grids two and four times
+ as fine - all at once, each on its own core - with the objects placed
+ on each of them. The nodes of the workspace's grid are on all three,
+ so the differences between them there give the order the solution is
+ really converging at, and with it, the Richardson extrapolation of the
+ finest grid to zero spacing. Against that, the error of each grid can
+ be estimated node by node, and the grid that just meets an accuracy
+ target can be predicted.
+ */
+@interface SimWorkspace (Convergence)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the workspace, and the finer grids of the study,
+ and returns the study - the keys are the kConvergence constants - or
+ nil if any of the grids can't be solved. The 'objects' are the
+ BaseSimObj instances that were added to this workspace, as they need
+ to be placed on the finer grids as well. If 'target' is more than
+ zero, it's the largest error, in volts, the grid can have, and the
+ study has the smallest grid predicted to meet it. If 'fine' isn't
+ NULL, it gets the finest grid with the extrapolated potentials as its
+ results, and if 'errors' isn't NULL, it gets the estimated error at
+ each node of this workspace's grid. Both of those are autoreleased.
+ */
+- (NSDictionary*) simulateConvergenceWithObjects:(NSArray*)objects target:(double)target extrapolated:(SimWorkspace**)fine errors:(MaskedMatrix**)errors;
+
+/*!
+ This method creates the workspace for a grid 'factor' times finer
+ than this one - over the same region, with the same engine, and each
+ interval of this grid split evenly - with the objects placed on it,
+ but not yet solved. The returned workspace is autoreleased.
+ */
+- (SimWorkspace*) _createFinerWithFactor:(int)factor andObjects:(NSArray*)objects;
+
+@end
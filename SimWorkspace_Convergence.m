@@ -0,0 +1,379 @@
+//
+//  SimWorkspace_Convergence.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <dispatch/dispatch.h>
+
+// System Headers
+#include <math.h>
+#include <stdlib.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Convergence.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Automatic.h"
+#import "BaseSimObj.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The 5-point stencil is second order, but around the corners of the
+ * conductors - and with too coarse a grid - the solution converges
+ * slower than that. An observed order outside of these limits means
+ * the grids aren't close enough to the limit for it to mean anything,
+ * and then the extrapolation uses the formal order of the stencil.
+ */
+#define	MIN_OBSERVED_ORDER			0.5
+#define	MAX_OBSERVED_ORDER			4.0
+#define	FORMAL_ORDER				2.0
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the grid convergence methods on the SimWorkspace. There's no
+ telling from one solve whether the grid is fine enough, so the study
+ solves the workspace on its own grid, and on grids two and four times
+ as fine - all at once, each on its own core - with the objects placed
+ on each of them. The nodes of the workspace's grid are on all three,
+ so the differences between them there give the order the solution is
+ really converging at, and with it, the Richardson extrapolation of the
+ finest grid to zero spacing. Against that, the error of each grid can
+ be estimated node by node, and the grid that just meets an accuracy
+ target can be predicted.
+ */
+@implementation SimWorkspace (Convergence)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the workspace, and the finer grids of the study,
+ and returns the study - the keys are the kConvergence constants - or
+ nil if any of the grids can't be solved. The 'objects' are the
+ BaseSimObj instances that were added to this workspace, as they need
+ to be placed on the finer grids as well. If 'target' is more than
+ zero, it's the largest error, in volts, the grid can have, and the
+ study has the smallest grid predicted to meet it. If 'fine' isn't
+ NULL, it gets the finest grid with the extrapolated potentials as its
+ results, and if 'errors' isn't NULL, it gets the estimated error at
+ each node of this workspace's grid. Both of those are autoreleased.
+ */
+- (NSDictionary*) simulateConvergenceWithObjects:(NSArray*)objects target:(double)target extrapolated:(SimWorkspace**)fine errors:(MaskedMatrix**)errors
+{
+	BOOL				error = NO;
+	NSMutableArray*		grids = [NSMutableArray arrayWithObject:self];
+	NSMutableDictionary*	retval = [NSMutableDictionary dictionary];
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	int					top = 1 << (CONVERGENCE_LEVELS - 1);
+	double				p = FORMAL_ORDER;
+	double*				ext = NULL;
+	MaskedMatrix*		err = nil;
+
+	// first, make each of the finer grids, set up just like this one
+	if (!error) {
+		for (int k = 1; k < CONVERGENCE_LEVELS; k++) {
+			SimWorkspace*	ws = [self _createFinerWithFactor:(1 << k) andObjects:objects];
+			if (ws == nil) {
+				error = YES;
+				NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - the grid %d times finer than the %dx%d workspace could not be made. Please check the logs for a possible cause.", (1 << k), rows, cols);
+				break;
+			}
+			[grids addObject:ws];
+		}
+	}
+
+	/*
+	 * Now solve them all at once. They're completely independent, but if
+	 * the engine is picked automatically, the calibration has to be done
+	 * here first, or each of them would go off and run it on its own.
+	 */
+	if (!error) {
+		__block BOOL	failed = NO;
+		if ([self getSolverType] == kAutomaticSolver) {
+			[SimWorkspace getSolverCalibration];
+		}
+		dispatch_apply([grids count], dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t k) {
+			@autoreleasepool {
+				if (![[grids objectAtIndex:k] simulateWorkspace]) {
+					failed = YES;
+				}
+			}
+		});
+		if (failed) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - one or more of the %d grids of the study could not be simulated. Please check the logs for a possible cause.", CONVERGENCE_LEVELS);
+		} else {
+			NSMutableArray*		r = [NSMutableArray array];
+			NSMutableArray*		c = [NSMutableArray array];
+			NSMutableArray*		t = [NSMutableArray array];
+			for (SimWorkspace* ws in grids) {
+				[r addObject:[NSNumber numberWithInt:[ws getRowCount]]];
+				[c addObject:[NSNumber numberWithInt:[ws getColCount]]];
+				NSNumber*	time = [[ws getSolveReport] objectForKey:kReportTotalTime];
+				[t addObject:(time != nil ? time : [NSNumber numberWithDouble:0.0])];
+			}
+			[retval setObject:r forKey:kConvergenceRows];
+			[retval setObject:c forKey:kConvergenceCols];
+			[retval setObject:t forKey:kConvergenceSolveTime];
+		}
+	}
+
+	/*
+	 * The observed order comes from how much smaller the change from the
+	 * middle grid to the finest is than the change from this grid to the
+	 * middle one, on the nodes of this grid that none of them hold fixed.
+	 */
+	if (!error) {
+		SimWorkspace*	mid = [grids objectAtIndex:1];
+		SimWorkspace*	fin = [grids objectAtIndex:2];
+		double			coarse = 0.0;
+		double			finer = 0.0;
+		for (int r = 0; r < rows; r++) {
+			for (int c = 0; c < cols; c++) {
+				if ([[self getVoltage] haveValueAtRow:r andCol:c] ||
+					[[mid getVoltage] haveValueAtRow:(2 * r) andCol:(2 * c)] ||
+					[[fin getVoltage] haveValueAtRow:(4 * r) andCol:(4 * c)]) {
+					continue;
+				}
+				double		v0 = [self getResultantVoltageAtNodeRow:r andCol:c];
+				double		v1 = [mid getResultantVoltageAtNodeRow:(2 * r) andCol:(2 * c)];
+				double		v2 = [fin getResultantVoltageAtNodeRow:(4 * r) andCol:(4 * c)];
+				coarse += (v0 - v1) * (v0 - v1);
+				finer += (v1 - v2) * (v1 - v2);
+			}
+		}
+		double		observed = ((coarse > 0.0) && (finer > 0.0)) ? 0.5 * log2(coarse / finer) : NAN;
+		if (isfinite(observed)) {
+			[retval setObject:[NSNumber numberWithDouble:observed] forKey:kConvergenceObservedOrder];
+		}
+		if (isfinite(observed) && (observed >= MIN_OBSERVED_ORDER) && (observed <= MAX_OBSERVED_ORDER)) {
+			p = observed;
+		} else {
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - the observed order of convergence (%g) isn't between %g and %g, so the grids aren't fine enough for it to mean much. The extrapolation will use the order of the stencil, %g, instead.", observed, MIN_OBSERVED_ORDER, MAX_OBSERVED_ORDER, FORMAL_ORDER);
+		}
+		[retval setObject:[NSNumber numberWithDouble:p] forKey:kConvergenceOrder];
+	}
+
+	/*
+	 * The extrapolation is the finest grid plus the change from the
+	 * middle grid to it over 2^p - 1. That's only known on the nodes the
+	 * two share - every other one - and the rest get it interpolated
+	 * between those, as it's a lot smoother than the potential itself.
+	 * The nodes held fixed on either grid aren't changed at all.
+	 */
+	if (!error) {
+		SimWorkspace*	mid = [grids objectAtIndex:1];
+		SimWorkspace*	fin = [grids objectAtIndex:2];
+		int				frows = [fin getRowCount];
+		int				fcols = [fin getColCount];
+		double			scale = 1.0 / (pow(2.0, p) - 1.0);
+		ext = (double *) malloc((size_t)frows * fcols * sizeof(double));
+		if (ext == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - while trying to allocate the extrapolated potentials for the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", frows, fcols);
+		} else {
+			// first, the correction on the nodes the two grids share
+			for (int r = 0; r < frows; r += 2) {
+				for (int c = 0; c < fcols; c += 2) {
+					double		d = 0.0;
+					if (![[fin getVoltage] haveValueAtRow:r andCol:c] &&
+						![[mid getVoltage] haveValueAtRow:(r / 2) andCol:(c / 2)]) {
+						d = scale * ([fin getResultantVoltageAtNodeRow:r andCol:c] - [mid getResultantVoltageAtNodeRow:(r / 2) andCol:(c / 2)]);
+					}
+					ext[(size_t)r * fcols + c] = d;
+				}
+			}
+			// ...then in between them - along the rows and then the columns
+			for (int r = 0; r < frows; r += 2) {
+				for (int c = 1; c < fcols; c += 2) {
+					ext[(size_t)r * fcols + c] = 0.5 * (ext[(size_t)r * fcols + c - 1] + ext[(size_t)r * fcols + c + 1]);
+				}
+			}
+			for (int r = 1; r < frows; r += 2) {
+				for (int c = 0; c < fcols; c++) {
+					ext[(size_t)r * fcols + c] = 0.5 * (ext[(size_t)(r - 1) * fcols + c] + ext[(size_t)(r + 1) * fcols + c]);
+				}
+			}
+			// ...and add it to the finest grid's own solution
+			for (int r = 0; r < frows; r++) {
+				for (int c = 0; c < fcols; c++) {
+					size_t		ij = (size_t)r * fcols + c;
+					if ([[fin getVoltage] haveValueAtRow:r andCol:c]) {
+						ext[ij] = 0.0;
+					}
+					ext[ij] += [fin getResultantVoltageAtNodeRow:r andCol:c];
+				}
+			}
+		}
+	}
+
+	// now the error of each grid, against the extrapolation, on this grid's nodes
+	if (!error) {
+		err = [[[MaskedMatrix alloc] initWithRows:rows andCols:cols] autorelease];
+		if (err == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - the matrix for the estimated errors could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", rows, cols);
+		} else {
+			NSMutableArray*		peak = [NSMutableArray array];
+			NSMutableArray*		rms = [NSMutableArray array];
+			int					fcols = [[grids lastObject] getColCount];
+			for (int k = 0; k < CONVERGENCE_LEVELS; k++) {
+				SimWorkspace*	ws = [grids objectAtIndex:k];
+				int				f = 1 << k;
+				double			emax = 0.0;
+				double			esum = 0.0;
+				for (int r = 0; r < rows; r++) {
+					for (int c = 0; c < cols; c++) {
+						double		e = [ws getResultantVoltageAtNodeRow:(f * r) andCol:(f * c)] - ext[(size_t)(top * r) * fcols + (top * c)];
+						emax = MAX(emax, fabs(e));
+						esum += e * e;
+						if (k == 0) {
+							[err setValue:e atRow:r andCol:c];
+						}
+					}
+				}
+				[peak addObject:[NSNumber numberWithDouble:emax]];
+				[rms addObject:[NSNumber numberWithDouble:sqrt(esum / ((double)rows * cols))]];
+			}
+			[retval setObject:peak forKey:kConvergenceMaxError];
+			[retval setObject:rms forKey:kConvergenceRMSError];
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - the %dx%d grid converges at order %g, with an estimated error of %g V (max) and %g V (rms)", rows, cols, p, [[peak objectAtIndex:0] doubleValue], [[rms objectAtIndex:0] doubleValue]);
+		}
+	}
+
+	/*
+	 * If there's a target, the error falls off as the spacing to the p,
+	 * so the grid that just meets it - finer or coarser than this one -
+	 * has the intervals of this one times (error/target)^(1/p).
+	 */
+	if (!error && (target > 0.0)) {
+		double		e0 = [[[retval objectForKey:kConvergenceMaxError] objectAtIndex:0] doubleValue];
+		double		s = pow(e0 / target, 1.0 / p);
+		int			rr = MAX((int)ceil((rows - 1) * s), 1) + 1;
+		int			rc = MAX((int)ceil((cols - 1) * s), 1) + 1;
+		[retval setObject:[NSNumber numberWithDouble:target] forKey:kConvergenceTarget];
+		[retval setObject:[NSNumber numberWithInt:rr] forKey:kConvergenceRecommendedRows];
+		[retval setObject:[NSNumber numberWithInt:rc] forKey:kConvergenceRecommendedCols];
+		NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - to get within %g V, the grid needs to be about %dx%d", target, rr, rc);
+	}
+
+	// ...and give the finest grid the extrapolated potentials, if it's wanted
+	if (!error && (fine != NULL)) {
+		SimWorkspace*	fin = [grids lastObject];
+		if (![fin _saveResultantVoltages:ext]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateConvergenceWithObjects:target:extrapolated:errors:] - the extrapolated potentials could not be saved on the %dx%d grid. Please check the logs for a possible cause.", [fin getRowCount], [fin getColCount]);
+		} else {
+			*fine = fin;
+		}
+	}
+	if (!error && (errors != NULL)) {
+		*errors = err;
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (ext != NULL) {
+		free(ext);
+	}
+
+	return error ? nil : retval;
+}
+
+
+/*!
+ This method creates the workspace for a grid 'factor' times finer
+ than this one - over the same region, with the same engine, and each
+ interval of this grid split evenly - with the objects placed on it,
+ but not yet solved. The returned workspace is autoreleased.
+ */
+- (SimWorkspace*) _createFinerWithFactor:(int)factor andObjects:(NSArray*)objects
+{
+	BOOL				error = NO;
+	SimWorkspace*		finer = nil;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	int					frows = (rows - 1) * factor + 1;
+	int					fcols = (cols - 1) * factor + 1;
+
+	// first, make the finer workspace over the same region, set up like this one
+	if (!error) {
+		finer = [[[SimWorkspace alloc] initWithRect:[self getWorkspaceRect] usingRows:frows andCols:fcols] autorelease];
+		if (finer == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createFinerWithFactor:andObjects:] - the %dx%d workspace for the finer grid could not be created and this is a serious storage problem. Check into this.", frows, fcols);
+		} else {
+			[finer setSolverType:[self getSolverType]];
+			[finer setMultigridCycle:[self getMultigridCycle]];
+			[finer setPreconditioner:[self getPreconditioner]];
+			[finer setSchwarzCoarseCorrection:[self getSchwarzCoarseCorrection]];
+			[finer setTolerance:[self getTolerance]];
+			[finer setMaxIterations:[self getMaxIterations]];
+			[finer setAxisymmetric:[self getAxisymmetric]];
+			[finer setBoundaryCondition:[self getBoundaryCondition]];
+			[finer setOpenBoundaryCenter:[self _findOpenBoundaryCenter]];
+		}
+	}
+
+	/*
+	 * If this grid is graded, each of its intervals is split evenly, so
+	 * that every node of this grid is a node of the finer one as well.
+	 */
+	if (!error && ![self isUniformGrid]) {
+		double*		x = (double *) malloc(fcols * sizeof(double));
+		double*		y = (double *) malloc(frows * sizeof(double));
+		if ((x == NULL) || (y == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createFinerWithFactor:andObjects:] - while trying to allocate the node coordinates of the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", frows, fcols);
+		} else {
+			for (int j = 0; j < fcols; j++) {
+				int			c = j / factor;
+				double		t = (double)(j % factor) / factor;
+				x[j] = (t == 0.0 ? [self getXValueForCol:c] : (1.0 - t) * [self getXValueForCol:c] + t * [self getXValueForCol:(c + 1)]);
+			}
+			for (int i = 0; i < frows; i++) {
+				int			r = i / factor;
+				double		t = (double)(i % factor) / factor;
+				y[i] = (t == 0.0 ? [self getYValueForRow:r] : (1.0 - t) * [self getYValueForRow:r] + t * [self getYValueForRow:(r + 1)]);
+			}
+			if (![finer setColCoordinates:x] || ![finer setRowCoordinates:y]) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_createFinerWithFactor:andObjects:] - the graded coordinates of the %dx%d grid could not be set. Please check the logs for a possible cause.", frows, fcols);
+			}
+		}
+		if (x != NULL) {
+			free(x);
+		}
+		if (y != NULL) {
+			free(y);
+		}
+	}
+
+	// ...and place all the objects on it at the finer resolution
+	if (!error) {
+		for (BaseSimObj* obj in objects) {
+			[obj addToWorkspace:finer];
+		}
+	}
+
+	return error ? nil : finer;
+}
+
+@end
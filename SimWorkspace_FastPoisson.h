@@ -0,0 +1,74 @@
+//
+//  SimWorkspace_FastPoisson.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The capacitance matrix is dense, so past this many fixed nodes on the
+ * edges of the conductors, building and factoring it costs more than
+ * the banded solver would, and we just hand the problem over to that.
+ */
+#define	MAX_CAPACITANCE_NODES		2000
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the fast Poisson solver methods on the SimWorkspace. On a
+ uniform grid with a uniform dielectric, the operator with the mirrored
+ edges is diagonalized by the cosine transform across the columns, and
+ what's left for each mode is a tridiagonal system down the rows. That
+ solves the empty workspace directly, and the conductors are then put
+ back with a capacitance matrix correction over just the fixed nodes
+ on their edges. Anything else is handed to the banded Cholesky.
+ */
+@interface SimWorkspace (FastPoisson)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the cosine transform across the columns
+ and a tridiagonal solve for each mode, with a capacitance matrix
+ correction to hold the fixed nodes at their potentials. If the grid
+ spacing or the dielectric isn't uniform, or there are too many fixed
+ nodes on the edges of the conductors to make the correction pay, it
+ falls back to the banded Cholesky. The solution is placed in the
+ row-major vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingFastPoisson:(PoissonStencil*)stencil into:(double*)v;
+
+/*!
+ This method returns YES if the relative dielectric constant is the
+ same at every node in the workspace that isn't a fixed potential. An
+ unset value counts as 1, just as it does in the stencil.
+ */
+- (BOOL) _hasUniformEpsilonR;
+
+@end
@@ -0,0 +1,512 @@
+//
+//  SimWorkspace_FastPoisson.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Accelerate/Accelerate.h>
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_FastPoisson.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The stencil has to match the uniform Laplacian to this relative
+ * accuracy for the transform to really be the inverse of the operator.
+ */
+#define	UNIFORM_TOLERANCE			1.0e-10
+
+// Public Macros
+
+
+/*
+ * This checks that every free node of the stencil has the coefficients
+ * of the uniform Laplacian with the spacings 'hx' and 'hy' and mirrored
+ * edges - times the uniform dielectric constant 'er' - as that's the
+ * operator that the transform diagonalizes.
+ */
+static BOOL isUniformLaplacian(const StencilArrays* a, double hx, double hy, double er)
+{
+	int			rows = a->rows;
+	int			cols = a->cols;
+	double		cx = er/(hx * hx);
+	double		cy = er/(hy * hy);
+	double		tol = UNIFORM_TOLERANCE * (cx + cy);
+	if (a->topLeft != NULL) {
+		return NO;
+	}
+	for (int r = 0; r < rows; r++) {
+		double		top = (r == 0) ? 0.0 : ((r == (rows - 1)) ? 2.0*cy : cy);
+		double		bottom = (r == (rows - 1)) ? 0.0 : ((r == 0) ? 2.0*cy : cy);
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			if (a->fixed[ij]) {
+				continue;
+			}
+			double		left = (c == 0) ? 0.0 : ((c == (cols - 1)) ? 2.0*cx : cx);
+			double		right = (c == (cols - 1)) ? 0.0 : ((c == 0) ? 2.0*cx : cx);
+			if ((fabs(a->center[ij] + 2.0*(cx + cy)) > tol) ||
+				(fabs(a->left[ij] - left) > tol) || (fabs(a->right[ij] - right) > tol) ||
+				(fabs(a->top[ij] - top) > tol) || (fabs(a->bottom[ij] - bottom) > tol)) {
+				return NO;
+			}
+		}
+	}
+	return YES;
+}
+
+
+/*
+ * These are the cosine modes across the 'cols' columns - the eigenvectors
+ * of the second difference with mirrored edges. phi[c*cols + k] is mode
+ * 'k' at column 'c', and phiInv[k*cols + c] is the inverse transform -
+ * the trapezoidal weights over the norm of the mode. The eigenvalue for
+ * mode 'k' goes in nu[k].
+ */
+static void buildModes(int cols, double hx, double* phi, double* phiInv, double* nu)
+{
+	int			n = cols - 1;
+	for (int k = 0; k < cols; k++) {
+		double		norm = ((k == 0) || (k == n)) ? n : 0.5 * n;
+		nu[k] = (2.0 * cos(M_PI * k / n) - 2.0) / (hx * hx);
+		for (int c = 0; c < cols; c++) {
+			double		w = ((c == 0) || (c == n)) ? 0.5 : 1.0;
+			double		f = cos(M_PI * (((long)k * c) % (2 * n)) / n);
+			phi[(size_t)c * cols + k] = f;
+			phiInv[(size_t)k * cols + c] = w * f / norm;
+		}
+	}
+}
+
+
+/*
+ * This factors the tridiagonal systems down the rows for all the modes
+ * at once with the Thomas algorithm, keeping the modified super-diagonal
+ * in 'cp' and the reciprocal pivots in 'mi' - both laid out like the grid
+ * with the modes across the columns. Mode 0 is singular, as the potential
+ * of the empty workspace is only defined up to a constant, so its first
+ * row is grounded instead.
+ */
+static void factorModes(int rows, int cols, double hy, const double* nu, double* cp, double* mi)
+{
+	double		cy = 1.0/(hy * hy);
+	for (int r = 0; r < rows; r++) {
+		double		lower = (r == 0) ? 0.0 : ((r == (rows - 1)) ? 2.0*cy : cy);
+		double		upper = (r == (rows - 1)) ? 0.0 : ((r == 0) ? 2.0*cy : cy);
+		size_t		o = (size_t)r * cols;
+		for (int k = 0; k < cols; k++) {
+			double		diag = nu[k] - 2.0*cy;
+			double		sup = upper;
+			if ((k == 0) && (r == 0)) {
+				diag = 1.0;
+				sup = 0.0;
+			}
+			double		m = diag - ((r > 0) ? lower * cp[o - cols + k] : 0.0);
+			mi[o + k] = 1.0/m;
+			cp[o + k] = sup * mi[o + k];
+		}
+	}
+}
+
+
+/*
+ * This solves the factored tridiagonal systems for all the modes in 's'
+ * in place, grounding mode 0 in the first row.
+ */
+static void solveModes(int rows, int cols, double hy, const double* cp, const double* mi, double* s)
+{
+	double		cy = 1.0/(hy * hy);
+	s[0] = 0.0;
+	for (int r = 0; r < rows; r++) {
+		double		lower = (r == 0) ? 0.0 : ((r == (rows - 1)) ? 2.0*cy : cy);
+		size_t		o = (size_t)r * cols;
+		for (int k = 0; k < cols; k++) {
+			s[o + k] = (s[o + k] - ((r > 0) ? lower * s[o - cols + k] : 0.0)) * mi[o + k];
+		}
+	}
+	for (int r = rows - 2; r >= 0; r--) {
+		size_t		o = (size_t)r * cols;
+		for (int k = 0; k < cols; k++) {
+			s[o + k] -= cp[o + k] * s[o + cols + k];
+		}
+	}
+}
+
+
+/*
+ * This applies the inverse of the operator of the empty workspace - with
+ * its constant grounded - to the grid 'u' in place: transform across the
+ * columns, solve down the rows, and transform back. The 'work' vector
+ * needs to be the size of the grid.
+ */
+static void applyInverse(int rows, int cols, double hy, const double* phi, const double* phiInv, const double* cp, const double* mi, double* u, double* work)
+{
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, rows, cols, cols,
+				1.0, u, cols, phiInv, cols, 0.0, work, cols);
+	solveModes(rows, cols, hy, cp, mi, work);
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, rows, cols, cols,
+				1.0, work, cols, phi, cols, 0.0, u, cols);
+}
+
+
+/*!
+ @class SimWorkspace
+ These are the fast Poisson solver methods on the SimWorkspace. On a
+ uniform grid with a uniform dielectric, the operator with the mirrored
+ edges is diagonalized by the cosine transform across the columns, and
+ what's left for each mode is a tridiagonal system down the rows. That
+ solves the empty workspace directly, and the conductors are then put
+ back with a capacitance matrix correction over just the fixed nodes
+ on their edges. Anything else is handed to the banded Cholesky.
+ */
+@implementation SimWorkspace (FastPoisson)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using the cosine transform across the columns
+ and a tridiagonal solve for each mode, with a capacitance matrix
+ correction to hold the fixed nodes at their potentials. If the grid
+ spacing or the dielectric isn't uniform, or there are too many fixed
+ nodes on the edges of the conductors to make the correction pay, it
+ falls back to the banded Cholesky. The solution is placed in the
+ row-major vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingFastPoisson:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL				error = NO;
+	BOOL				fallback = NO;
+	StencilArrays*		a = NULL;
+	int					rows = 0;
+	int					cols = 0;
+	size_t				n = 0;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		} else {
+			a = [stencil getArrays];
+			rows = [stencil getRowCount];
+			cols = [stencil getColCount];
+			n = (size_t)rows * cols;
+		}
+	}
+
+	// next, see if the transform really is the inverse of this operator
+	double		hx = 0.0;
+	double		hy = 0.0;
+	double		er = 1.0;
+	if (!error) {
+		if ((rows < 2) || (cols < 2)) {
+			fallback = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the %dx%d grid is too small to transform, so it's going to the banded Cholesky.", rows, cols);
+		} else if ([stencil isAxisymmetric]) {
+			fallback = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the workspace is axisymmetric, and the transform is only for the planar Laplacian, so it's going to the banded Cholesky.");
+		} else if ([stencil hasOpenBoundary]) {
+			fallback = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the workspace has open edges, and the cosine modes are only for the mirrored ones, so it's going to the banded Cholesky.");
+		} else if (![self _hasUniformEpsilonR]) {
+			fallback = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the dielectric isn't uniform across the workspace, so it's going to the banded Cholesky.");
+		} else {
+			hx = [stencil getColSpacing][0];
+			hy = [stencil getRowSpacing][0];
+			// the operator is the Laplacian times the one dielectric constant
+			double*		eps = [stencil getDielectric];
+			for (size_t i = 0; i < n; i++) {
+				if (!a->fixed[i]) {
+					er = (eps[i] > 0.0 ? eps[i] : 1.0);
+					break;
+				}
+			}
+			if (!isUniformLaplacian(a, hx, hy, er)) {
+				fallback = YES;
+				NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the stencil isn't the uniform Laplacian - most likely the grid spacing varies - so it's going to the banded Cholesky.");
+			}
+		}
+	}
+
+	/*
+	 * Only the fixed nodes with a free neighbor are coupled to the rest
+	 * of the system - the insides of the conductors don't matter - and
+	 * these are the ones the capacitance matrix needs to hold in place.
+	 * They come out in row-major order, so the ones on the same row are
+	 * all together, and that's important when we build the matrix.
+	 */
+	int*		active = NULL;
+	int			m = 0;
+	if (!error && !fallback) {
+		active = (int *) calloc(n, sizeof(int));
+		if (active == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - while trying to allocate the list of fixed nodes for the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rows, cols);
+		} else {
+			BOOL*		fixed = a->fixed;
+			for (int r = 0; r < rows; r++) {
+				for (int c = 0; c < cols; c++) {
+					int		ij = r * cols + c;
+					if (fixed[ij] &&
+						(((c > 0) && !fixed[ij - 1]) || ((c < (cols - 1)) && !fixed[ij + 1]) ||
+						 ((r > 0) && !fixed[ij - cols]) || ((r < (rows - 1)) && !fixed[ij + cols]))) {
+						active[m++] = ij;
+					}
+				}
+			}
+			if (m == 0) {
+				fallback = YES;
+				NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - there are no fixed potentials next to a free node, so the transform has nothing to hold the solution in place, and it's going to the banded Cholesky.");
+			} else if (m > MAX_CAPACITANCE_NODES) {
+				fallback = YES;
+				NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - there are %d fixed nodes on the edges of the conductors, and that's more than the %d that the capacitance matrix can do efficiently, so it's going to the banded Cholesky.", m, MAX_CAPACITANCE_NODES);
+			}
+		}
+	}
+
+	// if we can't do it, then let the banded Cholesky have it
+	if (!error && fallback) {
+		error = ![self _solveSymmetricBandedStencil:stencil withRHS:[stencil getRHS] into:v];
+	}
+
+	// now get the storage for the transform and the capacitance matrix
+	double*				phi = NULL;
+	double*				phiInv = NULL;
+	double*				nu = NULL;
+	double*				cp = NULL;
+	double*				mi = NULL;
+	double*				work = NULL;
+	double*				z = NULL;
+	__CLPK_integer		nc = m + 1;
+	__CLPK_doublereal*	cap = NULL;
+	__CLPK_doublereal*	rhs = NULL;
+	__CLPK_integer*		ipiv = NULL;
+	if (!error && !fallback) {
+		phi = (double *) calloc((size_t)cols * cols, sizeof(double));
+		phiInv = (double *) calloc((size_t)cols * cols, sizeof(double));
+		nu = (double *) calloc(cols, sizeof(double));
+		cp = (double *) calloc(n, sizeof(double));
+		mi = (double *) calloc(n, sizeof(double));
+		work = (double *) calloc(n, sizeof(double));
+		z = (double *) calloc((size_t)m * cols, sizeof(double));
+		cap = (__CLPK_doublereal *) calloc((size_t)nc * nc, sizeof(__CLPK_doublereal));
+		rhs = (__CLPK_doublereal *) calloc(nc, sizeof(__CLPK_doublereal));
+		ipiv = (__CLPK_integer *) calloc(nc, sizeof(__CLPK_integer));
+		if ((phi == NULL) || (phiInv == NULL) || (nu == NULL) || (cp == NULL) || (mi == NULL) ||
+			(work == NULL) || (z == NULL) || (cap == NULL) || (rhs == NULL) || (ipiv == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - while trying to allocate the transform and the %dx%d capacitance matrix for the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", nc, nc, rows, cols);
+		}
+	}
+
+	/*
+	 * Solve the empty workspace - the charges on the free nodes and nothing
+	 * on the fixed ones - and see how far off the fixed potentials that
+	 * leaves us. The potential of the empty workspace is only defined up
+	 * to a constant, and it's only solvable if the charges, weighted by the
+	 * area of their cells, add up to zero. Both are taken care of by
+	 * adding a constant 'c' to the unknowns, and that total charge to the
+	 * equations.
+	 */
+	NSTimeInterval		start = [NSDate timeIntervalSinceReferenceDate];
+	if (!error && !fallback) {
+		double*		b = [stencil getRHS];
+		buildModes(cols, hx, phi, phiInv, nu);
+		factorModes(rows, cols, hy, nu, cp, mi);
+		double		total = 0.0;
+		for (int r = 0; r < rows; r++) {
+			double		wy = ((r == 0) || (r == (rows - 1))) ? 0.5 : 1.0;
+			for (int c = 0; c < cols; c++) {
+				size_t		ij = (size_t)r * cols + c;
+				double		wx = ((c == 0) || (c == (cols - 1))) ? 0.5 : 1.0;
+				v[ij] = (a->fixed[ij] ? 0.0 : b[ij]/er);
+				total += wx * wy * v[ij];
+			}
+		}
+		applyInverse(rows, cols, hy, phi, phiInv, cp, mi, v, work);
+		for (int i = 0; i < m; i++) {
+			rhs[i] = b[active[i]] - v[active[i]];
+		}
+		rhs[m] = -total;
+	}
+
+	/*
+	 * Now build the capacitance matrix: column 'j' is the potential at the
+	 * active nodes from a unit charge at active node 'j', and then there's
+	 * the constant and the total charge. All the charges on one row share
+	 * the same tridiagonal solutions down the rows - they just have
+	 * different weights on the modes - so we solve once per row, and then
+	 * each column is just a matrix-vector product.
+	 */
+	if (!error && !fallback) {
+		int		first = 0;
+		while (first < m) {
+			int		row = active[first] / cols;
+			int		end = first;
+			while ((end < m) && ((active[end] / cols) == row)) {
+				end++;
+			}
+			// the response of every mode to a unit source on this row
+			memset(work, 0, n * sizeof(double));
+			for (int k = 0; k < cols; k++) {
+				work[(size_t)row * cols + k] = 1.0;
+			}
+			solveModes(rows, cols, hy, cp, mi, work);
+			// ...seen through the modes at each of the active nodes
+			for (int i = 0; i < m; i++) {
+				int		ri = active[i] / cols;
+				int		ci = active[i] % cols;
+				for (int k = 0; k < cols; k++) {
+					z[(size_t)i * cols + k] = phi[(size_t)ci * cols + k] * work[(size_t)ri * cols + k];
+				}
+			}
+			// ...and then weighted by the modes of each source
+			for (int j = first; j < end; j++) {
+				int		cj = active[j] % cols;
+				cblas_dgemv(CblasRowMajor, CblasNoTrans, m, cols, 1.0, z, cols,
+							phiInv + cj, cols, 0.0, cap + (size_t)j * nc, 1);
+				cap[(size_t)j * nc + m] = (((cj == 0) || (cj == (cols - 1))) ? 0.5 : 1.0) *
+										  (((row == 0) || (row == (rows - 1))) ? 0.5 : 1.0);
+			}
+			first = end;
+		}
+		for (int i = 0; i < m; i++) {
+			cap[(size_t)m * nc + i] = 1.0;
+		}
+		cap[(size_t)m * nc + m] = 0.0;
+	}
+
+	// solve for the charges on the active nodes and the constant
+	if (!error && !fallback) {
+		__CLPK_integer	nrhs = 1;
+		__CLPK_integer	info = 0;
+		dgesv_(&nc, &nrhs, cap, &nc, ipiv, rhs, &nc, &info);
+		if (info < 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - argument #%d had an illegal value to DGESV in LAPACK. Please check into this.", -1*info);
+		} else if (info > 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the capacitance matrix is singular at diagonal #%d which shouldn't happen.", info);
+		} else {
+			// the modes and the capacitance matrix are what's factored here
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+			[self _addReportValue:(double)nc * nc forKey:kReportFill];
+			[self _addReportValue:((2.0 * cols + 1.0) * cols + 3.0 * n + (double)m * cols + (double)nc * (nc + 1)) * sizeof(double) + (double)nc * sizeof(__CLPK_integer) forKey:kReportMemory];
+			[self _setReportValue:[NSString stringWithFormat:@"cosine modes across the columns, %d capacitance nodes", m] forKey:kReportOrdering];
+		}
+	}
+
+	// ...and with those charges in place, solve the empty workspace again
+	if (!error && !fallback) {
+		double*		b = [stencil getRHS];
+		for (size_t i = 0; i < n; i++) {
+			v[i] = (a->fixed[i] ? 0.0 : b[i]/er);
+		}
+		for (int i = 0; i < m; i++) {
+			v[active[i]] += rhs[i];
+		}
+		applyInverse(rows, cols, hy, phi, phiInv, cp, mi, v, work);
+		for (size_t i = 0; i < n; i++) {
+			v[i] = (a->fixed[i] ? b[i] : v[i] + rhs[m]);
+		}
+		double		bnorm = 0.0;
+		for (size_t i = 0; i < n; i++) {
+			bnorm += b[i] * b[i];
+		}
+		bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+		double		rnorm = [stencil residualOf:v forRHS:b into:work];
+		NSLog(@"[SimWorkspace -_solveUsingFastPoisson:into:] - the transform with %d capacitance nodes brought the relative residual to %g", m, rnorm/bnorm);
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (active != NULL) {
+		free(active);
+	}
+	if (phi != NULL) {
+		free(phi);
+	}
+	if (phiInv != NULL) {
+		free(phiInv);
+	}
+	if (nu != NULL) {
+		free(nu);
+	}
+	if (cp != NULL) {
+		free(cp);
+	}
+	if (mi != NULL) {
+		free(mi);
+	}
+	if (work != NULL) {
+		free(work);
+	}
+	if (z != NULL) {
+		free(z);
+	}
+	if (cap != NULL) {
+		free(cap);
+	}
+	if (rhs != NULL) {
+		free(rhs);
+	}
+	if (ipiv != NULL) {
+		free(ipiv);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method returns YES if the relative dielectric constant is the
+ same at every node in the workspace that isn't a fixed potential. An
+ unset value counts as 1, just as it does in the stencil.
+ */
+- (BOOL) _hasUniformEpsilonR
+{
+	BOOL		uniform = YES;
+	BOOL		first = YES;
+	double		value = 0.0;
+	int			rows = [self getRowCount];
+	int			cols = [self getColCount];
+	for (int r = 0; uniform && (r < rows); r++) {
+		for (int c = 0; uniform && (c < cols); c++) {
+			if (![[self getVoltage] haveValueAtRow:r andCol:c]) {
+				double		er = [self getEpsilonRAtNodeRow:r andCol:c];
+				er = (er == 0 ? 1.0 : er);
+				if (first) {
+					value = er;
+					first = NO;
+				} else if (er != value) {
+					uniform = NO;
+				}
+			}
+		}
+	}
+	return uniform;
+}
+
+@end
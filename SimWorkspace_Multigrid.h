@@ -0,0 +1,82 @@
+//
+//  SimWorkspace_Multigrid.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+#import "BandedFactorization.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+/*
+ * Each level of the multigrid hierarchy has its own stencil as well as
+ * the solution, RHS and residual vectors for that level. The finest
+ * level uses the caller's solution vector and the stencil's own RHS.
+ * The coarsest level also holds the factorization of its stencil, as
+ * it's factored once for the solve and used on every cycle.
+ */
+typedef struct {
+	PoissonStencil*			stencil;
+	BandedFactorization*	lu;
+	double*					x;
+	double*					b;
+	double*					r;
+} MultigridLevel;
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the geometric multigrid methods on the SimWorkspace. They
+ work directly on the 5-point stencil, coarsening the grid by a factor
+ of two in each direction until it's small enough to hand to the banded
+ solver, and then using V or W-cycles with red-black Gauss-Seidel
+ smoothing to solve the system in O(n) time and memory. The coarse grid
+ operators are the Galerkin ones the stencil builds, so the conductors
+ are honored on every level even when they're thinner than the coarse
+ grid spacing.
+ */
+@interface SimWorkspace (Multigrid)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using multigrid cycles until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The solution is placed in the row-major
+ vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingMultigrid:(PoissonStencil*)stencil into:(double*)v;
+
+/*!
+ This method does one multigrid cycle starting at level 'l' of the
+ 'count' levels in the hierarchy. The 'gamma' is the number of times
+ the next coarser level is visited - 1 for a V-cycle, 2 for a W-cycle.
+ The coarsest level is solved directly with its banded factors.
+ */
+- (BOOL) _cycleMultigrid:(MultigridLevel*)levels atLevel:(int)l of:(int)count withGamma:(int)gamma;
+
+@end
@@ -0,0 +1,258 @@
+//
+//  SimWorkspace_Multigrid.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Multigrid.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * We coarsen the grid as long as both dimensions are at least this big,
+ * and the number of red-black Gauss-Seidel sweeps before and after the
+ * coarse grid correction on each level.
+ */
+#define	MIN_COARSENING_DIMENSION	5
+#define	SMOOTHING_SWEEPS			2
+
+/*
+ * A healthy multigrid solver gains about an order of magnitude a cycle,
+ * so if we haven't gotten there in this many cycles, we aren't going to.
+ */
+#define	DEFAULT_MAX_CYCLES			200
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the geometric multigrid methods on the SimWorkspace. They
+ work directly on the 5-point stencil, coarsening the grid by a factor
+ of two in each direction until it's small enough to hand to the banded
+ solver, and then using V or W-cycles with red-black Gauss-Seidel
+ smoothing to solve the system in O(n) time and memory. The coarse grid
+ operators are the Galerkin ones the stencil builds, so the conductors
+ are honored on every level even when they're thinner than the coarse
+ grid spacing.
+ */
+@implementation SimWorkspace (Multigrid)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using multigrid cycles until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The solution is placed in the row-major
+ vector 'v' which needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingMultigrid:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL				error = NO;
+	NSMutableArray*		stencils = nil;
+	MultigridLevel*		levels = NULL;
+	int					count = 0;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// next, build up the hierarchy of coarser and coarser stencils
+	if (!error) {
+		stencils = [NSMutableArray arrayWithObject:stencil];
+		PoissonStencil*		s = stencil;
+		while (!error && (MIN([s getRowCount], [s getColCount]) >= MIN_COARSENING_DIMENSION)) {
+			s = [s createCoarseStencil];
+			if (s == nil) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - the coarse stencil for level %lu could not be created. Please check the logs for a possible cause.", (unsigned long)[stencils count]);
+			} else {
+				[stencils addObject:s];
+			}
+		}
+		count = (int)[stencils count];
+	}
+
+	// now allocate the vectors for each of the levels
+	if (!error) {
+		levels = (MultigridLevel *) calloc(count, sizeof(MultigridLevel));
+		if (levels == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - while trying to allocate the %d multigrid levels, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count);
+		} else {
+			for (int l = 0; !error && (l < count); l++) {
+				PoissonStencil*		s = [stencils objectAtIndex:l];
+				size_t				n = [s getNodeCount];
+				levels[l].stencil = s;
+				levels[l].x = (l == 0) ? v : (double *) calloc(n, sizeof(double));
+				levels[l].b = (l == 0) ? [s getRHS] : (double *) calloc(n, sizeof(double));
+				levels[l].r = (double *) calloc(n, sizeof(double));
+				if ((levels[l].x == NULL) || (levels[l].b == NULL) || (levels[l].r == NULL)) {
+					error = YES;
+					NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - while trying to allocate the vectors for the %dx%d multigrid level, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", [s getRowCount], [s getColCount]);
+				}
+			}
+		}
+	}
+
+	/*
+	 * The coarsest level is solved exactly on every cycle, and its
+	 * operator doesn't change during the solve, so it's factored just
+	 * the once here, and the cycles only do the substitutions.
+	 */
+	if (!error) {
+		MultigridLevel*		coarsest = &levels[count - 1];
+		NSTimeInterval		start = [NSDate timeIntervalSinceReferenceDate];
+		coarsest->lu = [[BandedFactorization alloc] initWithStencil:coarsest->stencil];
+		if (coarsest->lu == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - the coarsest %dx%d level could not be factored. Please check the logs for a possible cause.", [coarsest->stencil getRowCount], [coarsest->stencil getColCount]);
+		} else {
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+			[self _reportFactorization:coarsest->lu];
+		}
+	}
+
+	// start with the fixed potentials, and the last solution - if any
+	BOOL		warm = NO;
+	if (!error) {
+		warm = [self _seedSolution:v forStencil:stencil];
+	}
+
+	// now cycle until we're there, or we've run out of patience
+	if (!error) {
+		double*		b = [stencil getRHS];
+		int			n = [stencil getNodeCount];
+		double		bnorm = 0.0;
+		for (int i = 0; i < n; i++) {
+			bnorm += b[i] * b[i];
+		}
+		bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+		double		rnorm = [stencil residualOf:v forRHS:b into:levels[0].r];
+		int			gamma = [self getMultigridCycle];
+		int			maxIter = ([self getMaxIterations] > 0 ? [self getMaxIterations] : DEFAULT_MAX_CYCLES);
+		int			iter = 0;
+		[self _addResidualToReport:(rnorm / bnorm)];
+		while (!error && (rnorm > [self getTolerance] * bnorm) && (iter < maxIter)) {
+			if (![self _cycleMultigrid:levels atLevel:0 of:count withGamma:gamma]) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - multigrid cycle %d failed. Please check the logs for a possible cause.", (iter + 1));
+			} else {
+				rnorm = [stencil residualOf:v forRHS:b into:levels[0].r];
+				iter++;
+				[self _addResidualToReport:(rnorm / bnorm)];
+			}
+		}
+		[self _setReportValue:[NSNumber numberWithInt:iter] forKey:kReportIterations];
+		/*
+		 * On top of the factors of the coarsest level, each coarse level
+		 * has its stencil - the coefficients, the RHS and the dielectric
+		 * constants - and the vectors for the cycles, while the finest
+		 * level is the workspace's, and just needs its residual.
+		 */
+		double		bytes = 0.0;
+		for (int l = 0; l < count; l++) {
+			PoissonStencil*		s = levels[l].stencil;
+			int					perNode = (l == 0 ? 1 : ([s hasCorners] ? 9 : 5) + 2 + 3);
+			bytes += (double)[s getNodeCount] * perNode * sizeof(double);
+		}
+		[self _addReportValue:bytes forKey:kReportMemory];
+		if (!error) {
+			if (rnorm > [self getTolerance] * bnorm) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - after %d %c-cycles from a %@ start the relative residual is still %g which is above the tolerance of %g. You might want to raise the maximum iterations.", iter, (gamma == kWCycle ? 'W' : 'V'), (warm ? @"warm" : @"cold"), rnorm/bnorm, [self getTolerance]);
+			} else {
+				NSLog(@"[SimWorkspace -_solveUsingMultigrid:into:] - %d %c-cycles on %d levels from a %@ start brought the relative residual to %g", iter, (gamma == kWCycle ? 'W' : 'V'), count, (warm ? @"warm" : @"cold"), rnorm/bnorm);
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (levels != NULL) {
+		for (int l = 0; l < count; l++) {
+			if ((l > 0) && (levels[l].x != NULL)) {
+				free(levels[l].x);
+			}
+			if ((l > 0) && (levels[l].b != NULL)) {
+				free(levels[l].b);
+			}
+			if (levels[l].r != NULL) {
+				free(levels[l].r);
+			}
+			[levels[l].lu release];
+		}
+		free(levels);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method does one multigrid cycle starting at level 'l' of the
+ 'count' levels in the hierarchy. The 'gamma' is the number of times
+ the next coarser level is visited - 1 for a V-cycle, 2 for a W-cycle.
+ The coarsest level is solved directly with its banded factors.
+ */
+- (BOOL) _cycleMultigrid:(MultigridLevel*)levels atLevel:(int)l of:(int)count withGamma:(int)gamma
+{
+	BOOL				error = NO;
+	MultigridLevel*		fine = &levels[l];
+
+	if (l == (count - 1)) {
+		// the coarsest level is small enough to solve exactly
+		if (![fine->lu solve:fine->b count:1 into:fine->x]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_cycleMultigrid:atLevel:of:withGamma:] - the direct solve of the coarsest %dx%d level failed. Please check the logs for a possible cause.", [fine->stencil getRowCount], [fine->stencil getColCount]);
+		}
+	} else {
+		MultigridLevel*		coarse = &levels[l + 1];
+		// pre-smooth the error on this level
+		[fine->stencil relax:fine->x forRHS:fine->b withOmega:1.0 sweeps:SMOOTHING_SWEEPS];
+		// move the residual down to the coarse grid and solve for the correction
+		[fine->stencil residualOf:fine->x forRHS:fine->b into:fine->r];
+		[fine->stencil restrictResidual:fine->r toCoarse:coarse->stencil into:coarse->b];
+		memset(coarse->x, 0, [coarse->stencil getNodeCount] * sizeof(double));
+		// the coarsest level is exact, so there's no point in visiting it twice
+		int		visits = ((l + 1) == (count - 1)) ? 1 : gamma;
+		for (int g = 0; !error && (g < visits); g++) {
+			error = ![self _cycleMultigrid:levels atLevel:(l + 1) of:count withGamma:gamma];
+		}
+		// bring the correction back up and smooth out what it's left behind
+		if (!error) {
+			[fine->stencil addCorrection:coarse->x fromCoarse:coarse->stencil into:fine->x];
+			[fine->stencil relax:fine->x forRHS:fine->b withOmega:1.0 sweeps:SMOOTHING_SWEEPS];
+		}
+	}
+
+	return !error;
+}
+
+@end
@@ -0,0 +1,69 @@
+//
+//  SimWorkspace_Progressive.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the progressive simulation methods on the SimWorkspace. A
+ big workspace can take a good while to solve, and there's nothing to
+ look at until it's done. So the workspace is first solved on a grid a
+ few times coarser - which takes next to no time - and that's handed
+ back to be shown right away. Then each grid twice as fine as the last
+ starts from the last one's potentials, interpolated onto it, until the
+ workspace's own grid is solved. Each preview is a workspace of its
+ own, over the same region and with the same objects placed on it.
+ */
+@interface SimWorkspace (Progressive)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method simulates the workspace - with its refinement, if it has
+ a budget for it - after solving the previews on the coarser grids set
+ up by -setPreviewFactor:. The 'objects' are the BaseSimObj instances
+ that were added to this workspace, as they need to be placed on each
+ of the previews as well. As each preview is solved, 'selector' is
+ sent to 'observer' with the preview's workspace, so it can be shown
+ while the finer ones are being done. With no preview factor, this is
+ just -simulateWorkspaceWithObjects:.
+ */
+- (BOOL) simulateWorkspaceWithObjects:(NSArray*)objects notifying:(id)observer selector:(SEL)selector;
+
+/*!
+ This method creates the workspace for a preview 'factor' times coarser
+ than this one - over the same region, with the same engine and grid
+ grading, and with the objects placed on it - but not yet solved. The
+ returned workspace is autoreleased.
+ */
+- (SimWorkspace*) _createPreviewWithFactor:(int)factor andObjects:(NSArray*)objects;
+
+@end
@@ -0,0 +1,203 @@
+//
+//  SimWorkspace_Progressive.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+#include <stdlib.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Progressive.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Refinement.h"
+#import "BaseSimObj.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * A preview is never smaller than this many nodes on a side, as there'd
+ * be nothing worth looking at on anything smaller.
+ */
+#define	MIN_PREVIEW_DIMENSION		5
+
+/*
+ * The previews are only a starting point for the next grid, and their
+ * error is mostly in the coarseness of the grid, so there's no use in
+ * the iterative engines going any further than this on them.
+ */
+#define	PREVIEW_TOLERANCE			1.0e-4
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the progressive simulation methods on the SimWorkspace. A
+ big workspace can take a good while to solve, and there's nothing to
+ look at until it's done. So the workspace is first solved on a grid a
+ few times coarser - which takes next to no time - and that's handed
+ back to be shown right away. Then each grid twice as fine as the last
+ starts from the last one's potentials, interpolated onto it, until the
+ workspace's own grid is solved. Each preview is a workspace of its
+ own, over the same region and with the same objects placed on it.
+ */
+@implementation SimWorkspace (Progressive)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method simulates the workspace - with its refinement, if it has
+ a budget for it - after solving the previews on the coarser grids set
+ up by -setPreviewFactor:. The 'objects' are the BaseSimObj instances
+ that were added to this workspace, as they need to be placed on each
+ of the previews as well. As each preview is solved, 'selector' is
+ sent to 'observer' with the preview's workspace, so it can be shown
+ while the finer ones are being done. With no preview factor, this is
+ just -simulateWorkspaceWithObjects:.
+ */
+- (BOOL) simulateWorkspaceWithObjects:(NSArray*)objects notifying:(id)observer selector:(SEL)selector
+{
+	BOOL				error = NO;
+	SimWorkspace*		last = nil;
+
+	/*
+	 * Solve each of the previews, from the coarsest on up, each starting
+	 * from the one before it. A preview that can't be done isn't the end
+	 * of the world - we just go on to the next one without it.
+	 */
+	for (int factor = [self getPreviewFactor]; factor >= 2; factor /= 2) {
+		SimWorkspace*	preview = [self _createPreviewWithFactor:factor andObjects:objects];
+		if (preview == nil) {
+			continue;
+		}
+		if (last != nil) {
+			[preview setInitialGuessFromWorkspace:last];
+		}
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		if (![preview simulateWorkspace]) {
+			NSLog(@"[SimWorkspace -simulateWorkspaceWithObjects:notifying:selector:] - the %dx%d preview could not be simulated, so we're going on without it. Please check the logs for a possible cause.", [preview getRowCount], [preview getColCount]);
+			continue;
+		}
+		NSLog(@"[SimWorkspace -simulateWorkspaceWithObjects:notifying:selector:] - the %dx%d preview took %.3f msec", [preview getRowCount], [preview getColCount], ([NSDate timeIntervalSinceReferenceDate] - start) * 1000);
+		last = preview;
+		// ...and let the observer show it while we do the next one
+		if ((observer != nil) && (selector != NULL) && [observer respondsToSelector:selector]) {
+			[observer performSelector:selector withObject:preview];
+		}
+	}
+
+	// now the real grid, starting from the finest of the previews
+	if (!error) {
+		if (last != nil) {
+			[self setInitialGuessFromWorkspace:last];
+		}
+		if (![self simulateWorkspaceWithObjects:objects]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -simulateWorkspaceWithObjects:notifying:selector:] - the %dx%d grid of the workspace could not be simulated. Please check the logs for a possible cause.", [self getRowCount], [self getColCount]);
+		}
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method creates the workspace for a preview 'factor' times coarser
+ than this one - over the same region, with the same engine and grid
+ grading, and with the objects placed on it - but not yet solved. The
+ returned workspace is autoreleased.
+ */
+- (SimWorkspace*) _createPreviewWithFactor:(int)factor andObjects:(NSArray*)objects
+{
+	BOOL				error = NO;
+	SimWorkspace*		preview = nil;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	int					prows = MAX((rows - 1) / MAX(factor, 1) + 1, MIN_PREVIEW_DIMENSION);
+	int					pcols = MAX((cols - 1) / MAX(factor, 1) + 1, MIN_PREVIEW_DIMENSION);
+
+	// first, make sure it's really a preview at all
+	if (!error) {
+		if ((prows >= rows) || (pcols >= cols)) {
+			error = YES;
+		}
+	}
+
+	// next, make the coarser workspace over the same region, set up like this one
+	if (!error) {
+		preview = [[[SimWorkspace alloc] initWithRect:[self getWorkspaceRect] usingRows:prows andCols:pcols] autorelease];
+		if (preview == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createPreviewWithFactor:andObjects:] - the %dx%d workspace for the preview could not be created and this is a serious storage problem. Check into this.", prows, pcols);
+		} else {
+			[preview setSolverType:[self getSolverType]];
+			[preview setMultigridCycle:[self getMultigridCycle]];
+			[preview setPreconditioner:[self getPreconditioner]];
+			[preview setSchwarzCoarseCorrection:[self getSchwarzCoarseCorrection]];
+			[preview setTolerance:MAX([self getTolerance], PREVIEW_TOLERANCE)];
+			[preview setMaxIterations:[self getMaxIterations]];
+			[preview setAxisymmetric:[self getAxisymmetric]];
+			[preview setBoundaryCondition:[self getBoundaryCondition]];
+			[preview setOpenBoundaryCenter:[self _findOpenBoundaryCenter]];
+		}
+	}
+
+	/*
+	 * If this grid is graded, the preview is too - its nodes are every
+	 * so many nodes of this grid - so that the resolution is still where
+	 * the user put it.
+	 */
+	if (!error && ![self isUniformGrid]) {
+		double*		x = (double *) malloc(pcols * sizeof(double));
+		double*		y = (double *) malloc(prows * sizeof(double));
+		if ((x == NULL) || (y == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createPreviewWithFactor:andObjects:] - while trying to allocate the node coordinates of the %dx%d preview, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", prows, pcols);
+		} else {
+			for (int j = 0; j < pcols; j++) {
+				x[j] = [self getXValueForCol:(int)lround((double)j * (cols - 1) / (pcols - 1))];
+			}
+			for (int i = 0; i < prows; i++) {
+				y[i] = [self getYValueForRow:(int)lround((double)i * (rows - 1) / (prows - 1))];
+			}
+			if (![preview setColCoordinates:x] || ![preview setRowCoordinates:y]) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_createPreviewWithFactor:andObjects:] - the graded coordinates of the %dx%d preview could not be set. Please check the logs for a possible cause.", prows, pcols);
+			}
+		}
+		if (x != NULL) {
+			free(x);
+		}
+		if (y != NULL) {
+			free(y);
+		}
+	}
+
+	// ...and place all the objects on it at the coarser resolution
+	if (!error) {
+		for (BaseSimObj* obj in objects) {
+			[obj addToWorkspace:preview];
+		}
+	}
+
+	return error ? nil : preview;
+}
+
+@end
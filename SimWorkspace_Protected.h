@@ -17,6 +17,8 @@
 
 // Class Headers
 #import "SimWorkspace.h"
+#import "PoissonStencil.h"
+#import "BandedFactorization.h"
 
 // Superclass Headers
 
@@ -115,4 +117,168 @@
  */
 - (void) _setResultantElectricFieldDirection:(MaskedMatrix*)results;
 
+/*!
+ This method sets the positions of the columns of nodes as fractions of
+ the width of the workspace - 0 at the left edge and 1 at the right -
+ or NULL for evenly spaced columns. The workspace takes ownership of
+ the storage and frees the old array.
+ */
+- (void) _setColFractions:(double*)f;
+
+/*!
+ This method returns the positions of the columns of nodes as fractions
+ of the width of the workspace, or NULL if they're evenly spaced.
+ */
+- (double*) _getColFractions;
+
+/*!
+ This method sets the positions of the rows of nodes as fractions of
+ the height of the workspace - 0 at the bottom edge and 1 at the top -
+ or NULL for evenly spaced rows. The workspace takes ownership of the
+ storage and frees the old array.
+ */
+- (void) _setRowFractions:(double*)f;
+
+/*!
+ This method returns the positions of the rows of nodes as fractions
+ of the height of the workspace, or NULL if they're evenly spaced.
+ */
+- (double*) _getRowFractions;
+
+/*!
+ This method sets the banded LU factorization that the workspace holds
+ on to between simulations, so that it can be reused as long as the
+ operator doesn't change. Setting it to nil drops the one we have.
+ */
+- (void) _setFactorization:(BandedFactorization*)lu;
+
+/*!
+ This method returns the banded LU factorization that the workspace is
+ holding on to, or nil if there isn't one yet.
+ */
+- (BandedFactorization*) _getFactorization;
+
+/*!
+ This method sets the superposition basis of the workspace - 'count'
+ row-major solutions, one after the other, the first being the charges
+ alone and the rest being each conductor at 1 V. The workspace takes
+ ownership of the storage and frees the old basis, so setting it to
+ NULL simply drops the one we have.
+ */
+- (void) _setSuperpositionBasis:(double*)basis withCount:(int)count;
+
+/*!
+ This method returns the superposition basis that the workspace is
+ holding on to, or NULL if there isn't one.
+ */
+- (double*) _getSuperpositionBasis;
+
+/*!
+ This method returns the number of solutions in the superposition
+ basis - one more than the number of conductors - or 0 if there isn't
+ a basis.
+ */
+- (int) _getSuperpositionCount;
+
+/*!
+ This method sets the report of the solve that's being done by the
+ workspace. Setting it to nil drops the one we have.
+ */
+- (void) _setSolveReport:(NSMutableDictionary*)report;
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the point in real space that the open boundary
+ sees the field coming from - the one that's been set, or if it's been
+ left to the workspace, the center of the box around the conductors
+ and charges on it, or of the workspace itself if there aren't any.
+ On an axisymmetric workspace, the x of it is always the axis.
+ */
+- (NSPoint) _findOpenBoundaryCenter;
+
+/*!
+ This method creates the 5-point stencil for the workspace as it sits
+ now - the fixed potentials, charge densities and dielectric constants
+ that have been placed on it - so that any of the solvers can use it.
+ The returned stencil is autoreleased, and holds the RHS of the system
+ as well as the operator.
+ */
+- (PoissonStencil*) _createStencil;
+
+/*!
+ This method sets up the starting point 'v' for the iterative solvers:
+ the fixed nodes get their potentials from the stencil's RHS, and the
+ free nodes start from the initial guess, or the last result of this
+ workspace if there's no guess, or zero if there's neither. It returns
+ YES if the start was a warm one - from a previous solution - so that
+ the solvers can report it along with their iteration counts.
+ */
+- (BOOL) _seedSolution:(double*)v forStencil:(PoissonStencil*)stencil;
+
+/*!
+ This method calculates the magnitude and direction of the electric
+ field from the resultant voltage matrix 'rv' with central differences,
+ and puts them into 'rem' and 'red' - which have to be the size of the
+ workspace. It's used for the workspace's own results as well as for
+ each scenario that's solved with it.
+ */
+- (void) _calculateElectricFieldOf:(MaskedMatrix*)rv intoMagnitude:(MaskedMatrix*)rem andDirection:(MaskedMatrix*)red;
+
+/*!
+ This method takes the row-major vector of solved potentials, 'v', and
+ creates the resultant voltage matrix as well as the electric field
+ magnitude and direction matrices from it, and saves them all in this
+ workspace for the user. This is the common tail end of all the solvers.
+ */
+- (BOOL) _saveResultantVoltages:(double*)v;
+
+//----------------------------------------------------------------------------
+//               Solve Report Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method starts a new report for the solve that's about to be done,
+ with the engine and the size of the grid. The solvers then add what
+ they know to it as they go.
+ */
+- (void) _beginSolveReport;
+
+/*!
+ This method sets the value of 'key' in the report of the solve that's
+ being done. If there's no report - the solver is being used for some
+ other purpose than -simulateWorkspace - this does nothing.
+ */
+- (void) _setReportValue:(id)value forKey:(NSString*)key;
+
+/*!
+ This method adds 'value' to the number for 'key' in the report of the
+ solve that's being done, as the factoring, for one, can be done in
+ several pieces, and the time and memory for each one adds up.
+ */
+- (void) _addReportValue:(double)value forKey:(NSString*)key;
+
+/*!
+ This method adds the relative residual 'r' to the history of them in
+ the report of the solve that's being done. The iterative engines call
+ this each time they check the residual, starting with the first one.
+ */
+- (void) _addResidualToReport:(double)r;
+
+/*!
+ This method takes 'key' out of the report of the solve that's being
+ done, for when what an engine put there no longer applies - like the
+ factors of one that had to hand the system off to another.
+ */
+- (void) _removeReportValueForKey:(NSString*)key;
+
+/*!
+ This method finishes the report of the solve that's been done, so that
+ it's what -getSolveReport returns, and nothing more is added to it by
+ the solvers until the next one is started.
+ */
+- (void) _endSolveReport;
+
 @end
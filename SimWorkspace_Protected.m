@@ -9,6 +9,7 @@
 // Apple Headers
 
 // System Headers
+#import <math.h>
 
 // Third Party Headers
 
@@ -163,4 +164,515 @@
 	}
 }
 
+
+/*!
+ This method sets the positions of the columns of nodes as fractions of
+ the width of the workspace - 0 at the left edge and 1 at the right -
+ or NULL for evenly spaced columns. The workspace takes ownership of
+ the storage and frees the old array.
+ */
+- (void) _setColFractions:(double*)f
+{
+	if (_colFractions != f) {
+		if (_colFractions != NULL) {
+			free(_colFractions);
+		}
+		_colFractions = f;
+	}
+}
+
+
+/*!
+ This method returns the positions of the columns of nodes as fractions
+ of the width of the workspace, or NULL if they're evenly spaced.
+ */
+- (double*) _getColFractions
+{
+	return _colFractions;
+}
+
+
+/*!
+ This method sets the positions of the rows of nodes as fractions of
+ the height of the workspace - 0 at the bottom edge and 1 at the top -
+ or NULL for evenly spaced rows. The workspace takes ownership of the
+ storage and frees the old array.
+ */
+- (void) _setRowFractions:(double*)f
+{
+	if (_rowFractions != f) {
+		if (_rowFractions != NULL) {
+			free(_rowFractions);
+		}
+		_rowFractions = f;
+	}
+}
+
+
+/*!
+ This method returns the positions of the rows of nodes as fractions
+ of the height of the workspace, or NULL if they're evenly spaced.
+ */
+- (double*) _getRowFractions
+{
+	return _rowFractions;
+}
+
+
+/*!
+ This method sets the banded LU factorization that the workspace holds
+ on to between simulations, so that it can be reused as long as the
+ operator doesn't change. Setting it to nil drops the one we have.
+ */
+- (void) _setFactorization:(BandedFactorization*)lu
+{
+	if (_factorization != lu) {
+		[_factorization release];
+		_factorization = [lu retain];
+	}
+}
+
+
+/*!
+ This method returns the banded LU factorization that the workspace is
+ holding on to, or nil if there isn't one yet.
+ */
+- (BandedFactorization*) _getFactorization
+{
+	return _factorization;
+}
+
+
+/*!
+ This method sets the superposition basis of the workspace - 'count'
+ row-major solutions, one after the other, the first being the charges
+ alone and the rest being each conductor at 1 V. The workspace takes
+ ownership of the storage and frees the old basis, so setting it to
+ NULL simply drops the one we have.
+ */
+- (void) _setSuperpositionBasis:(double*)basis withCount:(int)count
+{
+	if (_superpositionBasis != basis) {
+		if (_superpositionBasis != NULL) {
+			free(_superpositionBasis);
+		}
+		_superpositionBasis = basis;
+	}
+	_superpositionCount = (basis == NULL ? 0 : count);
+}
+
+
+/*!
+ This method returns the superposition basis that the workspace is
+ holding on to, or NULL if there isn't one.
+ */
+- (double*) _getSuperpositionBasis
+{
+	return _superpositionBasis;
+}
+
+
+/*!
+ This method returns the number of solutions in the superposition
+ basis - one more than the number of conductors - or 0 if there isn't
+ a basis.
+ */
+- (int) _getSuperpositionCount
+{
+	return _superpositionCount;
+}
+
+
+/*!
+ This method sets the report of the solve that's being done by the
+ workspace. Setting it to nil drops the one we have.
+ */
+- (void) _setSolveReport:(NSMutableDictionary*)report
+{
+	if (_solveReport != report) {
+		[_solveReport release];
+		_solveReport = [report retain];
+	}
+}
+
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the point in real space that the open boundary
+ sees the field coming from - the one that's been set, or if it's been
+ left to the workspace, the center of the box around the conductors
+ and charges on it, or of the workspace itself if there aren't any.
+ On an axisymmetric workspace, the x of it is always the axis.
+ */
+- (NSPoint) _findOpenBoundaryCenter
+{
+	NSPoint		retval = [self getOpenBoundaryCenter];
+
+	// if it's been left to us, box in everything that makes a field
+	if (isnan(retval.x) || isnan(retval.y)) {
+		int			rows = [self getRowCount];
+		int			cols = [self getColCount];
+		int			r0 = rows;
+		int			r1 = -1;
+		int			c0 = cols;
+		int			c1 = -1;
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				if ([[self getVoltage] haveValueAtRow:row andCol:col] ||
+					[[self getRho] haveValueAtRow:row andCol:col]) {
+					r0 = MIN(r0, row);
+					r1 = MAX(r1, row);
+					c0 = MIN(c0, col);
+					c1 = MAX(c1, col);
+				}
+			}
+		}
+		// ...and with nothing on it, the middle of the workspace will do
+		if (r1 < 0) {
+			r0 = 0;
+			r1 = rows - 1;
+			c0 = 0;
+			c1 = cols - 1;
+		}
+		if (isnan(retval.x)) {
+			retval.x = 0.5 * ([self getXValueForCol:c0] + [self getXValueForCol:c1]);
+		}
+		if (isnan(retval.y)) {
+			retval.y = 0.5 * ([self getYValueForRow:r0] + [self getYValueForRow:r1]);
+		}
+	}
+	// a body of revolution is centered on its axis
+	if ([self getAxisymmetric]) {
+		retval.x = 0.0;
+	}
+
+	return retval;
+}
+
+
+/*!
+ This method creates the 5-point stencil for the workspace as it sits
+ now - the fixed potentials, charge densities and dielectric constants
+ that have been placed on it - so that any of the solvers can use it.
+ The returned stencil is autoreleased, and holds the RHS of the system
+ as well as the operator.
+ */
+- (PoissonStencil*) _createStencil
+{
+	BOOL				error = NO;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	PoissonStencil*		retval = nil;
+
+	// first, get the storage for the stencil
+	if (!error) {
+		retval = [[[PoissonStencil alloc] initWithRows:rows andCols:cols] autorelease];
+		if (retval == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createStencil] - the stencil for the %dx%d workspace could not be created and this is a serious storage problem. Check into this.", rows, cols);
+		}
+	}
+
+	/*
+	 * Now run through all the nodes and see if it's a fixed potential, or
+	 * if we need to use Poisson's Eq. for this node. The stencil will take
+	 * care of the coefficients, we just need the fixed nodes, the RHS and
+	 * the dielectric constants - as it's div(er grad V) = -rho that we're
+	 * solving, so that the interfaces between dielectrics come out right.
+	 */
+	if (!error) {
+		BOOL*		fixed = [retval getFixedMask];
+		double*		b = [retval getRHS];
+		double*		eps = [retval getDielectric];
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				size_t		ij = (size_t)row * cols + col;
+				eps[ij] = [self getEpsilonRAtNodeRow:row andCol:col];
+				if ([[self getVoltage] haveValueAtRow:row andCol:col]) {
+					fixed[ij] = YES;
+					b[ij] = [self getVoltageAtNodeRow:row andCol:col];
+				} else {
+					fixed[ij] = NO;
+					b[ij] = -1.0 * [self getRhoAtNodeRow:row andCol:col];
+				}
+			}
+		}
+		[retval setDeltaX:[self getDeltaX] andDeltaY:[self getDeltaY]];
+		// a graded axis has its own spacing between each pair of nodes
+		if ([self _getColFractions] != NULL) {
+			double*		f = [self _getColFractions];
+			double*		hx = [retval getColSpacing];
+			for (int col = 0; col < (cols - 1); col++) {
+				hx[col] = (f[col + 1] - f[col]) * [self getWorkspaceSize].width;
+			}
+		}
+		if ([self _getRowFractions] != NULL) {
+			double*		f = [self _getRowFractions];
+			double*		hy = [retval getRowSpacing];
+			for (int row = 0; row < (rows - 1); row++) {
+				hy[row] = (f[row + 1] - f[row]) * [self getWorkspaceSize].height;
+			}
+		}
+		// a body of revolution has x as the radius, out from the origin's x
+		[retval setAxisymmetric:[self getAxisymmetric] withInnerRadius:[self getWorkspaceOrigin].x];
+		// the open edges are measured from the first node of the grid
+		if ([self getBoundaryCondition] == kOpenBoundary) {
+			NSPoint		center = [self _findOpenBoundaryCenter];
+			[retval setOpenBoundary:YES withCenterX:(center.x - [self getXValueForCol:0]) andY:(center.y - [self getYValueForRow:0])];
+		}
+		[retval assemble];
+	}
+
+	return error ? nil : retval;
+}
+
+/*!
+ This method sets up the starting point 'v' for the iterative solvers:
+ the fixed nodes get their potentials from the stencil's RHS, and the
+ free nodes start from the initial guess, or the last result of this
+ workspace if there's no guess, or zero if there's neither. It returns
+ YES if the start was a warm one - from a previous solution - so that
+ the solvers can report it along with their iteration counts.
+ */
+- (BOOL) _seedSolution:(double*)v forStencil:(PoissonStencil*)stencil
+{
+	int				rows = [stencil getRowCount];
+	int				cols = [stencil getColCount];
+	BOOL*			fixed = [stencil getFixedMask];
+	double*			b = [stencil getRHS];
+
+	// see if we have a previous solution that fits this grid
+	MaskedMatrix*	guess = [self getInitialGuess];
+	if (guess == nil) {
+		guess = [self getResultantVoltage];
+	}
+	if ((guess != nil) && (([guess getRowCount] != rows) || ([guess getColCount] != cols))) {
+		guess = nil;
+	}
+
+	// ...and start from that, or zero, on the free nodes
+	for (int row = 0; row < rows; row++) {
+		for (int col = 0; col < cols; col++) {
+			size_t		ij = (size_t)row * cols + col;
+			if (fixed[ij]) {
+				v[ij] = b[ij];
+			} else if ((guess != nil) && [guess haveValueAtRow:row andCol:col]) {
+				v[ij] = [guess getValueAtRow:row andCol:col];
+			} else {
+				v[ij] = 0.0;
+			}
+		}
+	}
+
+	return (guess != nil);
+}
+
+
+
+/*!
+ This method calculates the magnitude and direction of the electric
+ field from the resultant voltage matrix 'rv' with central differences,
+ and puts them into 'rem' and 'red' - which have to be the size of the
+ workspace. It's used for the workspace's own results as well as for
+ each scenario that's solved with it.
+ */
+- (void) _calculateElectricFieldOf:(MaskedMatrix*)rv intoMagnitude:(MaskedMatrix*)rem andDirection:(MaskedMatrix*)red
+{
+	// now run through all the points in the workspace and calc each
+	for (int r = 0; r < [self getRowCount]; r++) {
+		for (int c = 0; c < [self getColCount]; c++) {
+			// get the column and row limits
+			int			cr = c + 1;
+			int			cl = c - 1;
+			int			rb = r + 1;
+			int			rt = r - 1;
+			// assume LOS at each border
+			if (cr >= [self getColCount]) cr = [self getColCount] - 2;
+			if (cl < 0) cl = 1;
+			if (rb >= [self getRowCount]) rb = [self getRowCount] - 2;
+			if (rt < 0) rt = 1;
+
+			// now get the voltages at the surrounding nodes
+			double	vr = [rv getValueAtRow:r andCol:cr];
+			double	vl = [rv getValueAtRow:r andCol:cl];
+			double	vb = [rv getValueAtRow:rb andCol:c];
+			double	vt = [rv getValueAtRow:rt andCol:c];
+
+			/*
+			 * The grid isn't always uniform, so the difference is over
+			 * the real distance between the neighbors. At the borders
+			 * they're the same node - mirrored - and there's no field
+			 * across the edge.
+			 */
+			double	dx = [self getXValueForCol:cr] - [self getXValueForCol:cl];
+			double	dy = [self getYValueForRow:rb] - [self getYValueForRow:rt];
+
+			// now get the components of the electric field
+			double	ex = (dx != 0.0 ? (vr - vl)/dx : 0.0);
+			double	ey = (dy != 0.0 ? (vb - vt)/dy : 0.0);
+
+			// now get the answer we're looking for
+			[rem setValue:sqrt(ex*ex + ey*ey) atRow:r andCol:c];
+			if ((ex == 0) && (ey == 0)) {
+				[red setValue:0.0 atRow:r andCol:c];
+			} else {
+				[red setValue:atan2(ey, ex) atRow:r andCol:c];
+			}
+		}
+	}
+}
+
+
+/*!
+ This method takes the row-major vector of solved potentials, 'v', and
+ creates the resultant voltage matrix as well as the electric field
+ magnitude and direction matrices from it, and saves them all in this
+ workspace for the user. This is the common tail end of all the solvers.
+ */
+- (BOOL) _saveResultantVoltages:(double*)v
+{
+	BOOL			error = NO;
+
+	// we need to create the resultant voltage matrix and populate it
+	MaskedMatrix*		rv = nil;
+	if (!error) {
+		rv = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
+		if (rv == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_saveResultantVoltages:] - the resultant voltage matrix for the simulation could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", [self getRowCount], [self getColCount]);
+		} else {
+			// now fill in all the values from the solution set
+			for (int row = 0; row < [self getRowCount]; row++) {
+				for (int col = 0; col < [self getColCount]; col++) {
+					[rv setValue:v[(size_t)row * [self getColCount] + col] atRow:row andCol:col];
+				}
+			}
+		}
+	}
+
+	// create the storage for the magnitude of the electric field
+	MaskedMatrix*		rem = nil;
+	MaskedMatrix*		red = nil;
+	if (!error && ([self getRowCount] >= 2) && ([self getColCount] >= 2)) {
+		rem = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
+		red = [[[MaskedMatrix alloc] initWithRows:[self getRowCount] andCols:[self getColCount]] autorelease];
+		if ((rem == nil) || (red == nil)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_saveResultantVoltages:] - the resultant electric field matrices could not be created and this is a serious storage problem. The request was made for a %dx%d sized matrix, and that seems to be too much. Check into this.", [self getRowCount], [self getColCount]);
+		}
+	}
+
+	// now do the calculations
+	if (!error) {
+		[self _calculateElectricFieldOf:rv intoMagnitude:rem andDirection:red];
+	}
+
+	// ...and don't forget to save it for the user
+	if (!error) {
+		[self _setResultantVoltage:rv];
+		[self _setResultantElectricFieldMagnitude:rem];
+		[self _setResultantElectricFieldDirection:red];
+	}
+
+	return !error;
+}
+
+
+
+//----------------------------------------------------------------------------
+//               Solve Report Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method starts a new report for the solve that's about to be done,
+ with the engine and the size of the grid. The solvers then add what
+ they know to it as they go.
+ */
+- (void) _beginSolveReport
+{
+	NSMutableDictionary*	report = [NSMutableDictionary dictionary];
+
+	// the engine goes by the same name as it has in the input deck
+	[report setObject:[self getSolverName] forKey:kReportSolver];
+	[report setObject:[NSNumber numberWithInt:[self getRowCount]] forKey:kReportRows];
+	[report setObject:[NSNumber numberWithInt:[self getColCount]] forKey:kReportCols];
+	[self _setSolveReport:report];
+}
+
+
+/*!
+ This method sets the value of 'key' in the report of the solve that's
+ being done. If there's no report - the solver is being used for some
+ other purpose than -simulateWorkspace - this does nothing.
+ */
+- (void) _setReportValue:(id)value forKey:(NSString*)key
+{
+	if ((_solveReport != nil) && (value != nil) && (key != nil)) {
+		[_solveReport setObject:value forKey:key];
+	}
+}
+
+
+/*!
+ This method adds 'value' to the number for 'key' in the report of the
+ solve that's being done, as the factoring, for one, can be done in
+ several pieces, and the time and memory for each one adds up.
+ */
+- (void) _addReportValue:(double)value forKey:(NSString*)key
+{
+	if ((_solveReport != nil) && (key != nil)) {
+		double		sum = [[_solveReport objectForKey:key] doubleValue] + value;
+		[_solveReport setObject:[NSNumber numberWithDouble:sum] forKey:key];
+	}
+}
+
+
+/*!
+ This method adds the relative residual 'r' to the history of them in
+ the report of the solve that's being done. The iterative engines call
+ this each time they check the residual, starting with the first one.
+ */
+- (void) _addResidualToReport:(double)r
+{
+	if (_solveReport != nil) {
+		NSMutableArray*		history = [_solveReport objectForKey:kReportResidualHistory];
+		if (history == nil) {
+			history = [NSMutableArray array];
+			[_solveReport setObject:history forKey:kReportResidualHistory];
+		}
+		[history addObject:[NSNumber numberWithDouble:r]];
+	}
+}
+
+
+/*!
+ This method takes 'key' out of the report of the solve that's being
+ done, for when what an engine put there no longer applies - like the
+ factors of one that had to hand the system off to another.
+ */
+- (void) _removeReportValueForKey:(NSString*)key
+{
+	if ((_solveReport != nil) && (key != nil)) {
+		[_solveReport removeObjectForKey:key];
+	}
+}
+
+
+/*!
+ This method finishes the report of the solve that's been done, so that
+ it's what -getSolveReport returns, and nothing more is added to it by
+ the solvers until the next one is started.
+ */
+- (void) _endSolveReport
+{
+	if (_solveReport != nil) {
+		[_lastSolveReport release];
+		_lastSolveReport = [_solveReport copy];
+		[self _setSolveReport:nil];
+	}
+}
+
 @end
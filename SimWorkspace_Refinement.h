@@ -0,0 +1,101 @@
+//
+//  SimWorkspace_Refinement.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+/*
+ * A refinement patch is a rectangle of the workspace's grid - from node
+ * (r0,c0) to node (r1,c1), inclusive - that's going to be solved again
+ * on a finer grid. The peak is the largest error indicator in it, so the
+ * patches that need it the most can be done first.
+ */
+typedef struct {
+	int			r0;
+	int			r1;
+	int			c0;
+	int			c1;
+	double		peak;
+} RefinementPatch;
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the adaptive refinement methods on the SimWorkspace. After
+ the regular grid is solved, the nodes where the field changes the most
+ from one node to the next - the edges and corners of thin conductors,
+ mostly - are grouped into rectangular patches, and each patch is solved
+ again on a grid twice as fine, with the objects placed on it at that
+ resolution and its edges held at the potentials of the coarser grid.
+ Each patch can be refined the same way, a few levels deep, so the fine
+ grids end up nested like a quadtree around the places that need them.
+ The fine solutions are then put back on the nodes of the coarser grid
+ they share, so the results are still on the regular grid for plotting
+ and writing out. The extra nodes are limited by the workspace's
+ refinement budget.
+ */
+@interface SimWorkspace (Refinement)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method simulates the workspace just as -simulateWorkspace does,
+ and then refines it within the workspace's refinement budget. The
+ 'objects' are the BaseSimObj instances that were added to this
+ workspace, as they need to be placed on each of the finer patches as
+ well. With no budget, this is just -simulateWorkspace.
+ */
+- (BOOL) simulateWorkspaceWithObjects:(NSArray*)objects;
+
+/*!
+ This method simulates the workspace and then refines it with at most
+ 'budget' extra nodes. The 'level' is how deep in the nesting of the
+ patches this workspace is, as the refinement stops after a few levels.
+ */
+- (BOOL) _refineWithObjects:(NSArray*)objects budget:(int)budget atLevel:(int)level;
+
+/*!
+ This method looks at the solution 'v' on this workspace's grid and
+ returns the patches that need refinement - the nodes where the second
+ difference of the potential is a good fraction of its largest value,
+ with a buffer around them, merged until none of them touch. The number
+ of patches is placed in 'count', and the returned array needs to be
+ freed by the caller.
+ */
+- (RefinementPatch*) _createRefinementPatchesFor:(double*)v count:(int*)count;
+
+/*!
+ This method solves the patch of this workspace on a grid twice as fine,
+ with the objects placed on it, its edges inside the workspace held at
+ the potentials from 'v', and up to 'budget' more nodes for its own
+ refinement. The fine solution is then put back into 'v' on the nodes
+ the two grids share.
+ */
+- (BOOL) _solvePatch:(RefinementPatch*)patch withObjects:(NSArray*)objects budget:(int)budget atLevel:(int)level into:(double*)v;
+
+@end
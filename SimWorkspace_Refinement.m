@@ -0,0 +1,541 @@
+//
+//  SimWorkspace_Refinement.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Refinement.h"
+#import "SimWorkspace_Protected.h"
+#import "BaseSimObj.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * Each level of refinement halves the spacing of the grid, and after
+ * this many levels, we've done all we're going to do.
+ */
+#define	REFINEMENT_FACTOR			2
+#define	MAX_REFINEMENT_LEVELS		3
+
+/*
+ * A node is marked for refinement if its error indicator is at least
+ * this fraction of the largest one on the grid, and the patches have a
+ * buffer of this many nodes around the marked nodes, so that the edges
+ * of the patch - held at the coarse solution - are away from the worst
+ * of it.
+ */
+#define	REFINE_FRACTION				0.1
+#define	PATCH_BUFFER				2
+
+// Public Macros
+
+
+/*
+ * These are the C-level helpers for picking the patches. The indicator
+ * of a node is the larger of the second differences of the potential
+ * along the rows and columns - the change in the field from one side of
+ * the node to the other, times the spacing - which is also the leading
+ * term of the local error of the 5-point stencil. The mirror conditions
+ * at the edges of the grid are used for the missing neighbors.
+ */
+static int comparePatches(const void* a, const void* b)
+{
+	double		pa = ((const RefinementPatch*)a)->peak;
+	double		pb = ((const RefinementPatch*)b)->peak;
+	return (pa > pb) ? -1 : ((pa < pb) ? 1 : 0);
+}
+
+
+static int patchNodeCount(const RefinementPatch* p)
+{
+	return ((p->r1 - p->r0) * REFINEMENT_FACTOR + 1) * ((p->c1 - p->c0) * REFINEMENT_FACTOR + 1);
+}
+
+
+static RefinementPatch* findPatches(const double* v, const BOOL* fixed, int rows, int cols, int* count)
+{
+	size_t				n = (size_t)rows * cols;
+	double*				ind = (double *) calloc(n, sizeof(double));
+	int*				label = (int *) malloc(n * sizeof(int));
+	int*				stack = (int *) malloc(n * sizeof(int));
+	RefinementPatch*	patches = NULL;
+	int					cnt = 0;
+	int					cap = 0;
+	double				peak = 0.0;
+
+	*count = 0;
+	if ((ind == NULL) || (label == NULL) || (stack == NULL)) {
+		if (ind != NULL) {
+			free(ind);
+		}
+		if (label != NULL) {
+			free(label);
+		}
+		if (stack != NULL) {
+			free(stack);
+		}
+		return NULL;
+	}
+
+	// get the indicator on all the free nodes
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			size_t		ij = (size_t)r * cols + c;
+			if (fixed[ij]) {
+				continue;
+			}
+			double		vl = (c > 0) ? v[ij - 1] : v[ij + 1];
+			double		vr = (c < (cols - 1)) ? v[ij + 1] : v[ij - 1];
+			double		vt = (r > 0) ? v[ij - cols] : v[ij + cols];
+			double		vb = (r < (rows - 1)) ? v[ij + cols] : v[ij - cols];
+			ind[ij] = MAX(fabs(vl - 2.0*v[ij] + vr), fabs(vt - 2.0*v[ij] + vb));
+			peak = MAX(peak, ind[ij]);
+		}
+	}
+
+	// mark the nodes that need it - with the buffer - as unvisited
+	for (size_t i = 0; i < n; i++) {
+		label[i] = -2;
+	}
+	if (peak > 0.0) {
+		for (int r = 0; r < rows; r++) {
+			for (int c = 0; c < cols; c++) {
+				if (ind[(size_t)r * cols + c] < REFINE_FRACTION * peak) {
+					continue;
+				}
+				for (int i = MAX(r - PATCH_BUFFER, 0); i <= MIN(r + PATCH_BUFFER, rows - 1); i++) {
+					for (int j = MAX(c - PATCH_BUFFER, 0); j <= MIN(c + PATCH_BUFFER, cols - 1); j++) {
+						label[(size_t)i * cols + j] = -1;
+					}
+				}
+			}
+		}
+	}
+
+	// each connected group of marked nodes is a patch - its bounding box
+	for (size_t seed = 0; seed < n; seed++) {
+		if (label[seed] != -1) {
+			continue;
+		}
+		if (cnt == cap) {
+			cap = (cap == 0 ? 16 : 2 * cap);
+			RefinementPatch*	more = (RefinementPatch *) realloc(patches, cap * sizeof(RefinementPatch));
+			if (more == NULL) {
+				break;
+			}
+			patches = more;
+		}
+		RefinementPatch*	p = &patches[cnt];
+		p->r0 = p->r1 = (int)(seed / cols);
+		p->c0 = p->c1 = (int)(seed % cols);
+		p->peak = 0.0;
+		int			top = 0;
+		stack[top++] = (int)seed;
+		label[seed] = cnt;
+		while (top > 0) {
+			int		ij = stack[--top];
+			int		r = ij / cols;
+			int		c = ij % cols;
+			p->r0 = MIN(p->r0, r);
+			p->r1 = MAX(p->r1, r);
+			p->c0 = MIN(p->c0, c);
+			p->c1 = MAX(p->c1, c);
+			p->peak = MAX(p->peak, ind[ij]);
+			int		nbr[4] = { (c > 0) ? ij - 1 : -1, (c < (cols - 1)) ? ij + 1 : -1,
+							   (r > 0) ? ij - cols : -1, (r < (rows - 1)) ? ij + cols : -1 };
+			for (int k = 0; k < 4; k++) {
+				if ((nbr[k] >= 0) && (label[nbr[k]] == -1)) {
+					label[nbr[k]] = cnt;
+					stack[top++] = nbr[k];
+				}
+			}
+		}
+		cnt++;
+	}
+
+	/*
+	 * The bounding boxes of different groups can still overlap, or touch,
+	 * and then the fine solutions would fight over the nodes they share,
+	 * so merge them until none of them do.
+	 */
+	BOOL		merged = YES;
+	while (merged) {
+		merged = NO;
+		for (int a = 0; a < cnt; a++) {
+			for (int b = a + 1; b < cnt; b++) {
+				RefinementPatch*	p = &patches[a];
+				RefinementPatch*	q = &patches[b];
+				if ((p->r0 <= q->r1) && (q->r0 <= p->r1) && (p->c0 <= q->c1) && (q->c0 <= p->c1)) {
+					p->r0 = MIN(p->r0, q->r0);
+					p->r1 = MAX(p->r1, q->r1);
+					p->c0 = MIN(p->c0, q->c0);
+					p->c1 = MAX(p->c1, q->c1);
+					p->peak = MAX(p->peak, q->peak);
+					patches[b] = patches[--cnt];
+					merged = YES;
+					b--;
+				}
+			}
+		}
+	}
+
+	// a patch has to be at least one cell in each direction
+	for (int a = 0; a < cnt; a++) {
+		RefinementPatch*	p = &patches[a];
+		if (p->r1 == p->r0) {
+			if (p->r1 < (rows - 1)) {
+				p->r1++;
+			} else {
+				p->r0--;
+			}
+		}
+		if (p->c1 == p->c0) {
+			if (p->c1 < (cols - 1)) {
+				p->c1++;
+			} else {
+				p->c0--;
+			}
+		}
+	}
+
+	free(ind);
+	free(label);
+	free(stack);
+	*count = cnt;
+	return patches;
+}
+
+
+/*!
+ @class SimWorkspace
+ These are the adaptive refinement methods on the SimWorkspace. After
+ the regular grid is solved, the nodes where the field changes the most
+ from one node to the next - the edges and corners of thin conductors,
+ mostly - are grouped into rectangular patches, and each patch is solved
+ again on a grid twice as fine, with the objects placed on it at that
+ resolution and its edges held at the potentials of the coarser grid.
+ Each patch can be refined the same way, a few levels deep, so the fine
+ grids end up nested like a quadtree around the places that need them.
+ The fine solutions are then put back on the nodes of the coarser grid
+ they share, so the results are still on the regular grid for plotting
+ and writing out. The extra nodes are limited by the workspace's
+ refinement budget.
+ */
+@implementation SimWorkspace (Refinement)
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method simulates the workspace just as -simulateWorkspace does,
+ and then refines it within the workspace's refinement budget. The
+ 'objects' are the BaseSimObj instances that were added to this
+ workspace, as they need to be placed on each of the finer patches as
+ well. With no budget, this is just -simulateWorkspace.
+ */
+- (BOOL) simulateWorkspaceWithObjects:(NSArray*)objects
+{
+	return [self _refineWithObjects:objects budget:[self getRefinementBudget] atLevel:0];
+}
+
+
+/*!
+ This method simulates the workspace and then refines it with at most
+ 'budget' extra nodes. The 'level' is how deep in the nesting of the
+ patches this workspace is, as the refinement stops after a few levels.
+ */
+- (BOOL) _refineWithObjects:(NSArray*)objects budget:(int)budget atLevel:(int)level
+{
+	BOOL				error = NO;
+	BOOL				allDone = NO;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	double*				v = NULL;
+	RefinementPatch*	patches = NULL;
+	int					count = 0;
+
+	// first, solve the regular grid of this workspace
+	if (!error && !allDone) {
+		if (![self simulateWorkspace]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_refineWithObjects:budget:atLevel:] - the %dx%d grid at level %d could not be simulated. Please check the logs for a possible cause.", rows, cols, level);
+		} else if ((budget <= 0) || (level >= MAX_REFINEMENT_LEVELS) || (objects == nil)) {
+			allDone = YES;
+		}
+	}
+
+	// get the solution in a vector we can work with
+	if (!error && !allDone) {
+		v = (double *) malloc((size_t)rows * cols * sizeof(double));
+		if (v == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_refineWithObjects:budget:atLevel:] - while trying to allocate the solution vector (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rows * cols);
+		} else {
+			for (int row = 0; row < rows; row++) {
+				for (int col = 0; col < cols; col++) {
+					v[(size_t)row * cols + col] = [self getResultantVoltageAtNodeRow:row andCol:col];
+				}
+			}
+		}
+	}
+
+	// now find the places that need refining...
+	if (!error && !allDone) {
+		patches = [self _createRefinementPatchesFor:v count:&count];
+		if (count == 0) {
+			allDone = YES;
+		}
+	}
+
+	/*
+	 * ...and take the patches that need it most, as long as they fit in
+	 * the budget. What's left over of the budget is then shared by those
+	 * patches - in proportion to their size - for their own refinement.
+	 */
+	int		taken = 0;
+	int		used = 0;
+	if (!error && !allDone) {
+		qsort(patches, count, sizeof(RefinementPatch), comparePatches);
+		for (int k = 0; k < count; k++) {
+			int		nodes = patchNodeCount(&patches[k]);
+			if ((used + nodes) <= budget) {
+				patches[taken++] = patches[k];
+				used += nodes;
+			}
+		}
+		if (taken == 0) {
+			allDone = YES;
+		}
+	}
+
+	// solve each of the patches we've taken, putting them back into 'v'
+	if (!error && !allDone) {
+		int		leftover = budget - used;
+		for (int k = 0; !error && (k < taken); k++) {
+			int		share = (int)(((double)leftover * patchNodeCount(&patches[k])) / used);
+			error = ![self _solvePatch:&patches[k] withObjects:objects budget:share atLevel:level into:v];
+		}
+		if (!error) {
+			NSLog(@"[SimWorkspace -_refineWithObjects:budget:atLevel:] - %d patches with %d nodes refined the %dx%d grid at level %d", taken, used, rows, cols, level);
+		}
+	}
+
+	// ...and save the refined solution in the workspace
+	if (!error && !allDone) {
+		if (![self _saveResultantVoltages:v]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_refineWithObjects:budget:atLevel:] - the refined solution could not be saved in the workspace. Please check the logs for a possible cause.");
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (patches != NULL) {
+		free(patches);
+	}
+	if (v != NULL) {
+		free(v);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method looks at the solution 'v' on this workspace's grid and
+ returns the patches that need refinement - the nodes where the second
+ difference of the potential is a good fraction of its largest value,
+ with a buffer around them, merged until none of them touch. The number
+ of patches is placed in 'count', and the returned array needs to be
+ freed by the caller.
+ */
+- (RefinementPatch*) _createRefinementPatchesFor:(double*)v count:(int*)count
+{
+	BOOL				error = NO;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	BOOL*				fixed = NULL;
+	RefinementPatch*	retval = NULL;
+
+	*count = 0;
+	// first, get the nodes with fixed potentials
+	if (!error) {
+		fixed = (BOOL *) calloc((size_t)rows * cols, sizeof(BOOL));
+		if (fixed == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_createRefinementPatchesFor:count:] - while trying to allocate the fixed node mask (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", rows * cols);
+		} else {
+			for (int row = 0; row < rows; row++) {
+				for (int col = 0; col < cols; col++) {
+					fixed[(size_t)row * cols + col] = [[self getVoltage] haveValueAtRow:row andCol:col];
+				}
+			}
+		}
+	}
+
+	// ...and then let the indicator pick out the patches
+	if (!error) {
+		retval = findPatches(v, fixed, rows, cols, count);
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (fixed != NULL) {
+		free(fixed);
+	}
+
+	return retval;
+}
+
+
+/*!
+ This method solves the patch of this workspace on a grid twice as fine,
+ with the objects placed on it, its edges inside the workspace held at
+ the potentials from 'v', and up to 'budget' more nodes for its own
+ refinement. The fine solution is then put back into 'v' on the nodes
+ the two grids share.
+ */
+- (BOOL) _solvePatch:(RefinementPatch*)patch withObjects:(NSArray*)objects budget:(int)budget atLevel:(int)level into:(double*)v
+{
+	BOOL				error = NO;
+	int					rows = [self getRowCount];
+	int					cols = [self getColCount];
+	int					prows = (patch->r1 - patch->r0) * REFINEMENT_FACTOR + 1;
+	int					pcols = (patch->c1 - patch->c0) * REFINEMENT_FACTOR + 1;
+	SimWorkspace*		fine = nil;
+
+	// first, make the finer workspace over the patch, set up like this one
+	if (!error) {
+		float		x0 = [self getXValueForCol:patch->c0];
+		float		y0 = [self getYValueForRow:patch->r0];
+		NSRect		rect = NSMakeRect(x0, y0, [self getXValueForCol:patch->c1] - x0, [self getYValueForRow:patch->r1] - y0);
+		fine = [[[SimWorkspace alloc] initWithRect:rect usingRows:prows andCols:pcols] autorelease];
+		if (fine == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solvePatch:withObjects:budget:atLevel:into:] - the %dx%d workspace for the patch could not be created and this is a serious storage problem. Check into this.", prows, pcols);
+		} else {
+			[fine setSolverType:[self getSolverType]];
+			[fine setMultigridCycle:[self getMultigridCycle]];
+			[fine setPreconditioner:[self getPreconditioner]];
+			[fine setTolerance:[self getTolerance]];
+			[fine setMaxIterations:[self getMaxIterations]];
+			[fine setAxisymmetric:[self getAxisymmetric]];
+			[fine setBoundaryCondition:[self getBoundaryCondition]];
+			[fine setOpenBoundaryCenter:[self _findOpenBoundaryCenter]];
+		}
+	}
+
+	/*
+	 * If this grid is graded, the patch is too - each interval of this
+	 * grid is split evenly - so that the nodes the two grids share are
+	 * in the same places.
+	 */
+	if (!error && ![self isUniformGrid]) {
+		double*		x = (double *) malloc(pcols * sizeof(double));
+		double*		y = (double *) malloc(prows * sizeof(double));
+		if ((x == NULL) || (y == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solvePatch:withObjects:budget:atLevel:into:] - while trying to allocate the node coordinates of the %dx%d patch, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", prows, pcols);
+		} else {
+			for (int j = 0; j < pcols; j++) {
+				int			c = patch->c0 + j / REFINEMENT_FACTOR;
+				double		t = (double)(j % REFINEMENT_FACTOR) / REFINEMENT_FACTOR;
+				x[j] = (t == 0.0 ? [self getXValueForCol:c] : (1.0 - t) * [self getXValueForCol:c] + t * [self getXValueForCol:(c + 1)]);
+			}
+			for (int i = 0; i < prows; i++) {
+				int			r = patch->r0 + i / REFINEMENT_FACTOR;
+				double		t = (double)(i % REFINEMENT_FACTOR) / REFINEMENT_FACTOR;
+				y[i] = (t == 0.0 ? [self getYValueForRow:r] : (1.0 - t) * [self getYValueForRow:r] + t * [self getYValueForRow:(r + 1)]);
+			}
+			if (![fine setColCoordinates:x] || ![fine setRowCoordinates:y]) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solvePatch:withObjects:budget:atLevel:into:] - the graded coordinates of the %dx%d patch could not be set. Please check the logs for a possible cause.", prows, pcols);
+			}
+		}
+		if (x != NULL) {
+			free(x);
+		}
+		if (y != NULL) {
+			free(y);
+		}
+	}
+
+	// place all the objects on it at the finer resolution
+	if (!error) {
+		for (BaseSimObj* obj in objects) {
+			[obj addToWorkspace:fine];
+		}
+	}
+
+	/*
+	 * The edges of the patch that are inside this workspace are held at
+	 * the potentials of this grid - interpolated between the nodes - but
+	 * the ones on the edges of this workspace keep the mirror - or open -
+	 * conditions of the workspace itself.
+	 */
+	if (!error) {
+		for (int i = 0; i < prows; i++) {
+			for (int j = 0; j < pcols; j++) {
+				BOOL		edge = ((i == 0) && (patch->r0 > 0)) ||
+								   ((i == (prows - 1)) && (patch->r1 < (rows - 1))) ||
+								   ((j == 0) && (patch->c0 > 0)) ||
+								   ((j == (pcols - 1)) && (patch->c1 < (cols - 1)));
+				if (!edge || [[fine getVoltage] haveValueAtRow:i andCol:j]) {
+					continue;
+				}
+				int			r = patch->r0 + i / REFINEMENT_FACTOR;
+				int			c = patch->c0 + j / REFINEMENT_FACTOR;
+				double		ty = (double)(i % REFINEMENT_FACTOR) / REFINEMENT_FACTOR;
+				double		tx = (double)(j % REFINEMENT_FACTOR) / REFINEMENT_FACTOR;
+				int			r1 = MIN(r + 1, rows - 1);
+				int			c1 = MIN(c + 1, cols - 1);
+				double		val = (1.0 - ty) * ((1.0 - tx) * v[(size_t)r * cols + c] + tx * v[(size_t)r * cols + c1])
+								  + ty * ((1.0 - tx) * v[(size_t)r1 * cols + c] + tx * v[(size_t)r1 * cols + c1]);
+				[fine setVoltage:val atNodeRow:i andCol:j];
+			}
+		}
+		// the iterative engines can start from this grid's solution
+		[fine setInitialGuessFromWorkspace:self];
+	}
+
+	// now solve it - and refine it, if there's budget for that
+	if (!error) {
+		if (![fine _refineWithObjects:objects budget:budget atLevel:(level + 1)]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solvePatch:withObjects:budget:atLevel:into:] - the %dx%d patch at level %d could not be solved. Please check the logs for a possible cause.", prows, pcols, (level + 1));
+		}
+	}
+
+	// ...and put the fine solution back on the nodes we share
+	if (!error) {
+		for (int r = patch->r0; r <= patch->r1; r++) {
+			for (int c = patch->c0; c <= patch->c1; c++) {
+				if (![[self getVoltage] haveValueAtRow:r andCol:c]) {
+					v[(size_t)r * cols + c] = [fine getResultantVoltageAtNodeRow:((r - patch->r0) * REFINEMENT_FACTOR) andCol:((c - patch->c0) * REFINEMENT_FACTOR)];
+				}
+			}
+		}
+	}
+
+	return !error;
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  SimWorkspace_SOR.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the successive over-relaxation methods on the SimWorkspace.
+ The sweeps are red-black ordered so that each color can be split up
+ across all the cores, and the relaxation factor is estimated from how
+ fast the sweeps are converging, so there's nothing for the user to
+ tune. It's not the fastest way to an exact answer, but with a loose
+ tolerance it's a very quick way to a rough one.
+ */
+@interface SimWorkspace (SOR)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using red-black SOR sweeps until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The relaxation factor starts at 1 and is
+ raised towards the optimum as the sweeps show how fast the error is
+ falling. The solution is placed in the row-major vector 'v' which
+ needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingSOR:(PoissonStencil*)stencil into:(double*)v;
+
+@end
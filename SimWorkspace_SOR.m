@@ -0,0 +1,216 @@
+//
+//  SimWorkspace_SOR.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+
+// System Headers
+#include <math.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_SOR.h"
+#import "SimWorkspace_Protected.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * SOR with a good relaxation factor takes a few times the number of
+ * nodes along the longest side of the grid to converge, so unless the
+ * user has told us otherwise, we give it this many times that.
+ */
+#define	DEFAULT_ITERATION_FACTOR	20
+
+/*
+ * The residual costs as much as a sweep, so we only look at it every
+ * so many sweeps to see if we're done.
+ */
+#define	RESIDUAL_CHECK_INTERVAL		5
+
+/*
+ * The convergence rate is measured over a window of this many sweeps,
+ * and is only believed when two windows in a row agree to within this
+ * fraction of the distance it has to go to 1.
+ */
+#define	ESTIMATE_WINDOW				10
+#define	ESTIMATE_AGREEMENT			0.1
+
+/*
+ * Past the optimal relaxation factor the sweeps converge at the rate
+ * (omega - 1) no matter what the operator is, and that tells us nothing.
+ * So we only trust a rate that's at least this far from (omega - 1),
+ * as a fraction of the room left between it and 1.
+ */
+#define	ESTIMATE_GUARD				0.5
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the successive over-relaxation methods on the SimWorkspace.
+ The sweeps are red-black ordered so that each color can be split up
+ across all the cores, and the relaxation factor is estimated from how
+ fast the sweeps are converging, so there's nothing for the user to
+ tune. It's not the fastest way to an exact answer, but with a loose
+ tolerance it's a very quick way to a rough one.
+ */
+@implementation SimWorkspace (SOR)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using red-black SOR sweeps until the relative
+ residual drops below the workspace's tolerance, or the maximum number
+ of iterations is reached. The relaxation factor starts at 1 and is
+ raised towards the optimum as the sweeps show how fast the error is
+ falling. The solution is placed in the row-major vector 'v' which
+ needs to be the size of the grid.
+ */
+- (BOOL) _solveUsingSOR:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL			error = NO;
+	double*			r = NULL;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSOR:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// the only storage we need beyond the solution is for the residual
+	if (!error) {
+		r = (double *) calloc([stencil getNodeCount], sizeof(double));
+		if (r == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSOR:into:] - while trying to allocate the residual vector (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", [stencil getNodeCount]);
+		}
+	}
+
+	// start with the fixed potentials, and the last solution - if any
+	BOOL		warm = NO;
+	if (!error) {
+		warm = [self _seedSolution:v forStencil:stencil];
+	}
+
+	/*
+	 * Now sweep until we're there, or we've run out of patience. The
+	 * relaxation factor is adapted as we go: the size of the change in
+	 * each sweep falls by the spectral radius 'lambda' of the SOR
+	 * iteration, and for a consistently ordered matrix - which red-black
+	 * ordering gives us - that's related to the spectral radius 'mu' of
+	 * the Jacobi iteration by:
+	 *
+	 *     (lambda + omega - 1)^2 = lambda omega^2 mu^2
+	 *
+	 * and the optimal factor is then 2/(1 + sqrt(1 - mu^2)). While omega
+	 * is below the optimum, lambda is real and this estimate approaches
+	 * mu from below, so omega only ever creeps up to the optimum. Once
+	 * the rate can't be trusted, we stop adapting and just sweep.
+	 */
+	if (!error) {
+		double*		b = [stencil getRHS];
+		int			n = [stencil getNodeCount];
+		double		bnorm = 0.0;
+		for (int i = 0; i < n; i++) {
+			bnorm += b[i] * b[i];
+		}
+		bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+		double		rnorm = [stencil residualConcurrentlyOf:v forRHS:b into:r];
+		int			maxIter = [self getMaxIterations];
+		if (maxIter <= 0) {
+			maxIter = DEFAULT_ITERATION_FACTOR * MAX([stencil getRowCount], [stencil getColCount]);
+		}
+		double		omega = 1.0;
+		BOOL		adapting = YES;
+		double		windowStart = 0.0;
+		double		lastRate = 0.0;
+		int			windowSweeps = 0;
+		int			iter = 0;
+		[self _addResidualToReport:(rnorm / bnorm)];
+		while ((rnorm > [self getTolerance] * bnorm) && (iter < maxIter)) {
+			/*
+			 * While the factor is being adapted we need the change of every
+			 * sweep, but after that, all the sweeps up to the next residual
+			 * check can be done in one go - and on a big grid, that lets
+			 * them be blocked so that each row is relaxed several times on
+			 * one trip through the cache.
+			 */
+			int			sweeps = 1;
+			if (!adapting) {
+				sweeps = MIN(RESIDUAL_CHECK_INTERVAL - (iter % RESIDUAL_CHECK_INTERVAL), maxIter - iter);
+			}
+			double		change = [stencil relax:v forRHS:b withOmega:omega sweeps:sweeps];
+			iter += sweeps;
+			// see if we have a new estimate of the convergence rate
+			if (adapting) {
+				if (windowSweeps == 0) {
+					windowStart = change;
+				} else if ((windowSweeps == ESTIMATE_WINDOW) && (windowStart > 0.0)) {
+					double		rate = pow(change / windowStart, 1.0/ESTIMATE_WINDOW);
+					if ((rate < 1.0) && (lastRate > 0.0) &&
+						(fabs(rate - lastRate) < ESTIMATE_AGREEMENT * (1.0 - rate))) {
+						double		mu2 = (rate + omega - 1.0) * (rate + omega - 1.0) / (rate * omega * omega);
+						double		optimal = 2.0/(1.0 + sqrt(1.0 - MIN(mu2, 1.0)));
+						if ((rate > (omega - 1.0) + ESTIMATE_GUARD * (2.0 - omega)) && (optimal > omega)) {
+							omega = optimal;
+						} else {
+							adapting = NO;
+						}
+						// the old rate doesn't apply to the new factor
+						lastRate = 0.0;
+					} else {
+						lastRate = rate;
+					}
+					windowStart = change;
+					windowSweeps = 0;
+				}
+				windowSweeps++;
+			}
+			// ...and every now and then, see if we're there
+			if ((iter % RESIDUAL_CHECK_INTERVAL) == 0) {
+				rnorm = [stencil residualConcurrentlyOf:v forRHS:b into:r];
+				[self _addResidualToReport:(rnorm / bnorm)];
+			}
+		}
+		// the last batch can stop short of a check, so the residual is stale
+		if ((iter % RESIDUAL_CHECK_INTERVAL) != 0) {
+			rnorm = [stencil residualConcurrentlyOf:v forRHS:b into:r];
+			[self _addResidualToReport:(rnorm / bnorm)];
+		}
+		[self _setReportValue:[NSNumber numberWithInt:iter] forKey:kReportIterations];
+		[self _addReportValue:(double)n * sizeof(double) forKey:kReportMemory];
+		if (rnorm > [self getTolerance] * bnorm) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSOR:into:] - after %d sweeps from a %@ start the relative residual is still %g which is above the tolerance of %g. You might want to raise the maximum iterations.", iter, (warm ? @"warm" : @"cold"), rnorm/bnorm, [self getTolerance]);
+		} else {
+			NSLog(@"[SimWorkspace -_solveUsingSOR:into:] - %d sweeps from a %@ start with a final omega of %.4f brought the relative residual to %g", iter, (warm ? @"warm" : @"cold"), omega, rnorm/bnorm);
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (r != NULL) {
+		free(r);
+	}
+
+	return !error;
+}
+
+@end
@@ -0,0 +1,101 @@
+//
+//  SimWorkspace_Schwarz.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+#import "BandedFactorization.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+/*
+ * Each block of the domain decomposition is a strip of the grid with its
+ * own stencil and the banded LU factorization of it, along with where it
+ * starts on the grid and the vector that its RHS is built in and solved.
+ */
+typedef struct {
+	PoissonStencil*			stencil;
+	BandedFactorization*	lu;
+	int						r0;
+	int						c0;
+	double*					x;
+} SchwarzBlock;
+
+// Public Constants
+/*
+ * The cost of factoring a strip goes as the square of its width, so we
+ * make them about this wide - or narrower, if it takes more than that
+ * to keep all the cores busy - but never narrower than the minimum, as
+ * the overlaps would then be most of the strip.
+ */
+#define	STRIP_WIDTH					16
+#define	MIN_STRIP_WIDTH				8
+
+/*
+ * Each strip reaches into its neighbors by this fraction of its width,
+ * but never less than the minimum number of nodes.
+ */
+#define	OVERLAP_FRACTION			0.125
+#define	MIN_OVERLAP					2
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the overlapping Schwarz domain decomposition methods on the
+ SimWorkspace. The grid is cut into overlapping strips across its
+ shorter side, so each one has a band that's only as wide as the strip,
+ and they're factored with the banded LU all at the same time on all
+ the cores. Each sweep then solves every other strip at once with the
+ potentials of its neighbors on its edges, and then the rest of them
+ the same way. That only moves the error along a strip or two each
+ sweep, so each sweep is followed by a correction from a coarse grid -
+ the same Galerkin coarse grids as the multigrid solver uses - that
+ takes care of the smooth part of the error all at once.
+ */
+@interface SimWorkspace (Schwarz)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using overlapping Schwarz sweeps over strips of
+ the grid until the relative residual drops below the workspace's
+ tolerance, or the maximum number of iterations is reached. The strips
+ are solved on as many cores as the machine has, and the coarse grid
+ correction is done if the workspace is set up for it. The solution is
+ placed in the row-major vector 'v' which needs to be the size of the
+ grid.
+ */
+- (BOOL) _solveUsingSchwarz:(PoissonStencil*)stencil into:(double*)v;
+
+/*!
+ This method does one sweep over the 'count' blocks of the stencil -
+ first the even ones and then the odd ones, each set all at once on all
+ the cores. The inner edges of each block are filled in from 'v', the
+ RHS of the rest from the stencil, and the solution of each block is
+ put back into 'v' for all the nodes it doesn't hold fixed.
+ */
+- (BOOL) _sweepSchwarzBlocks:(SchwarzBlock*)blocks count:(int)count of:(PoissonStencil*)stencil into:(double*)v;
+
+@end
@@ -0,0 +1,370 @@
+//
+//  SimWorkspace_Schwarz.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <dispatch/dispatch.h>
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Schwarz.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * The coarse grids are made the same way the multigrid solver makes
+ * them, until there are few enough nodes to factor in no time at all.
+ */
+#define	MAX_COARSE_NODES			4096
+#define	MIN_COARSENING_DIMENSION	5
+
+/*
+ * With the coarse grid correction, each sweep gains about an order of
+ * magnitude, so if we haven't gotten there in this many, we won't.
+ */
+#define	DEFAULT_MAX_SWEEPS			200
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the overlapping Schwarz domain decomposition methods on the
+ SimWorkspace. The grid is cut into overlapping strips across its
+ shorter side, so each one has a band that's only as wide as the strip,
+ and they're factored with the banded LU all at the same time on all
+ the cores. Each sweep then solves every other strip at once with the
+ potentials of its neighbors on its edges, and then the rest of them
+ the same way. That only moves the error along a strip or two each
+ sweep, so each sweep is followed by a correction from a coarse grid -
+ the same Galerkin coarse grids as the multigrid solver uses - that
+ takes care of the smooth part of the error all at once.
+ */
+@implementation SimWorkspace (Schwarz)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method solves the system defined by the stencil - with the RHS
+ held in the stencil - using overlapping Schwarz sweeps over strips of
+ the grid until the relative residual drops below the workspace's
+ tolerance, or the maximum number of iterations is reached. The strips
+ are solved on as many cores as the machine has, and the coarse grid
+ correction is done if the workspace is set up for it. The solution is
+ placed in the row-major vector 'v' which needs to be the size of the
+ grid.
+ */
+- (BOOL) _solveUsingSchwarz:(PoissonStencil*)stencil into:(double*)v
+{
+	BOOL				error = NO;
+	SchwarzBlock*		blocks = NULL;
+	int					count = 0;
+	NSMutableArray*		levels = nil;
+	double**			cb = NULL;
+	double**			cx = NULL;
+	int					depth = 0;
+	BandedFactorization*	coarse = nil;
+	double*				r = NULL;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (v == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the stencil or the solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	/*
+	 * Next, figure out the strips. They're cut across the shorter side,
+	 * so that the band of each is the width of the strip, and if there's
+	 * only room for one, then it's just the banded solver after all.
+	 */
+	int				rows = [stencil getRowCount];
+	int				cols = [stencil getColCount];
+	BOOL			byCols = (cols <= rows);
+	int				length = (byCols ? cols : rows);
+	if (!error) {
+		int			cores = (int)[[NSProcessInfo processInfo] activeProcessorCount];
+		count = MIN(MAX(cores, length / STRIP_WIDTH), length / MIN_STRIP_WIDTH);
+		if (count < 2) {
+			NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the %dx%d grid is too small to split up, so it's going to the banded LU.", rows, cols);
+			return [self _solveBandedStencil:stencil withRHS:[stencil getRHS] into:v];
+		}
+	}
+
+	// now cut the grid into the strips, each reaching into its neighbors
+	if (!error) {
+		blocks = (SchwarzBlock *) calloc(count, sizeof(SchwarzBlock));
+		if (blocks == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - while trying to allocate the %d blocks, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count);
+		} else {
+			int		overlap = MAX((int)(OVERLAP_FRACTION * length / count), MIN_OVERLAP);
+			for (int k = 0; !error && (k < count); k++) {
+				int		lo = MAX((int)(((size_t)k * length) / count) - overlap, 0);
+				int		hi = MIN((int)(((size_t)(k + 1) * length) / count) + overlap, length);
+				blocks[k].r0 = (byCols ? 0 : lo);
+				blocks[k].c0 = (byCols ? lo : 0);
+				blocks[k].stencil = [stencil createBlockAtRow:blocks[k].r0 andCol:blocks[k].c0 withRows:(byCols ? rows : (hi - lo)) andCols:(byCols ? (hi - lo) : cols)];
+				blocks[k].x = (double *) calloc([blocks[k].stencil getNodeCount], sizeof(double));
+				if ((blocks[k].stencil == nil) || (blocks[k].x == NULL)) {
+					error = YES;
+					NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the block %d of the %dx%d grid could not be created. Please check the logs for a possible cause.", k, rows, cols);
+				}
+			}
+		}
+	}
+
+	// factor all the strips at once - they're completely independent
+	if (!error) {
+		__block BOOL	failed = NO;
+		NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+		dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t k) {
+			blocks[k].lu = [[BandedFactorization alloc] initWithStencil:blocks[k].stencil];
+			if (blocks[k].lu == nil) {
+				failed = YES;
+			}
+		});
+		if (failed) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - one or more of the %d blocks could not be factored. Please check the logs for a possible cause.", count);
+		} else {
+			[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+			for (int k = 0; k < count; k++) {
+				[self _reportFactorization:blocks[k].lu];
+			}
+			[self _setReportValue:[NSString stringWithFormat:@"%d overlapping strips, %@", count, [blocks[0].lu getOrdering]] forKey:kReportOrdering];
+		}
+	}
+
+	/*
+	 * Now build up the coarse grids for the correction, if we're doing
+	 * it - at least one of them, no matter how small the grid is to start
+	 * with. The coarsest one is factored once, and the RHS and solution of
+	 * each level are kept so the residual can be moved down to it, and
+	 * the correction moved back up, every sweep.
+	 */
+	if (!error && [self getSchwarzCoarseCorrection]) {
+		levels = [NSMutableArray arrayWithObject:stencil];
+		PoissonStencil*		s = stencil;
+		while (!error && (([levels count] == 1) || ([s getNodeCount] > MAX_COARSE_NODES)) &&
+			   (MIN([s getRowCount], [s getColCount]) >= MIN_COARSENING_DIMENSION)) {
+			s = [s createCoarseStencil];
+			if (s == nil) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the coarse stencil for level %lu could not be created. Please check the logs for a possible cause.", (unsigned long)[levels count]);
+			} else {
+				[levels addObject:s];
+			}
+		}
+		depth = (int)[levels count];
+		if (!error && (depth > 1)) {
+			cb = (double **) calloc(depth, sizeof(double *));
+			cx = (double **) calloc(depth, sizeof(double *));
+			if ((cb == NULL) || (cx == NULL)) {
+				error = YES;
+			}
+			for (int l = 1; !error && (l < depth); l++) {
+				int		n = [[levels objectAtIndex:l] getNodeCount];
+				cb[l] = (double *) calloc(n, sizeof(double));
+				cx[l] = (double *) calloc(n, sizeof(double));
+				if ((cb[l] == NULL) || (cx[l] == NULL)) {
+					error = YES;
+				}
+			}
+			if (error) {
+				NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - while trying to allocate the vectors for the %d coarse grids, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", (depth - 1));
+			} else {
+				NSTimeInterval	start = [NSDate timeIntervalSinceReferenceDate];
+				coarse = [[BandedFactorization alloc] initWithStencil:[levels lastObject]];
+				if (coarse == nil) {
+					error = YES;
+					NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the coarsest grid could not be factored. Please check the logs for a possible cause.");
+				} else {
+					// the ordering in the report is still that of the strips
+					[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+					[self _addReportValue:(double)[coarse getFactorNonZeros] forKey:kReportFill];
+					[self _addReportValue:(double)[coarse getFactorSize] forKey:kReportMemory];
+				}
+			}
+		}
+	}
+
+	// the only storage we need beyond that is for the residual
+	if (!error) {
+		r = (double *) calloc([stencil getNodeCount], sizeof(double));
+		if (r == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - while trying to allocate the residual vector (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", [stencil getNodeCount]);
+		}
+	}
+
+	// start with the fixed potentials, and the last solution - if any
+	BOOL		warm = NO;
+	if (!error) {
+		warm = [self _seedSolution:v forStencil:stencil];
+	}
+
+	// now sweep until we're there, or we've run out of patience
+	if (!error) {
+		double*		b = [stencil getRHS];
+		int			n = [stencil getNodeCount];
+		double		bnorm = 0.0;
+		for (int i = 0; i < n; i++) {
+			bnorm += b[i] * b[i];
+		}
+		bnorm = (bnorm > 0.0 ? sqrt(bnorm) : 1.0);
+		double		rnorm = [stencil residualConcurrentlyOf:v forRHS:b into:r];
+		int			maxIter = ([self getMaxIterations] > 0 ? [self getMaxIterations] : DEFAULT_MAX_SWEEPS);
+		int			iter = 0;
+		[self _addResidualToReport:(rnorm / bnorm)];
+		while (!error && (rnorm > [self getTolerance] * bnorm) && (iter < maxIter)) {
+			error = ![self _sweepSchwarzBlocks:blocks count:count of:stencil into:v];
+			// move the residual all the way down, solve, and bring it back up
+			if (!error && (coarse != nil)) {
+				[stencil residualConcurrentlyOf:v forRHS:b into:r];
+				for (int l = 1; l < depth; l++) {
+					PoissonStencil*		fine = [levels objectAtIndex:(l - 1)];
+					[fine restrictResidual:(l == 1 ? r : cb[l - 1]) toCoarse:[levels objectAtIndex:l] into:cb[l]];
+				}
+				if (![coarse solve:cb[depth - 1] count:1 into:cx[depth - 1]]) {
+					error = YES;
+					NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - the coarse grid correction of sweep %d failed. Please check the logs for a possible cause.", (iter + 1));
+				} else {
+					for (int l = depth - 1; l > 0; l--) {
+						PoissonStencil*		fine = [levels objectAtIndex:(l - 1)];
+						if (l > 1) {
+							memset(cx[l - 1], 0, [fine getNodeCount] * sizeof(double));
+						}
+						[fine addCorrection:cx[l] fromCoarse:[levels objectAtIndex:l] into:(l == 1 ? v : cx[l - 1])];
+					}
+				}
+			}
+			if (!error) {
+				rnorm = [stencil residualConcurrentlyOf:v forRHS:b into:r];
+				iter++;
+				[self _addResidualToReport:(rnorm / bnorm)];
+			}
+		}
+		[self _setReportValue:[NSNumber numberWithInt:iter] forKey:kReportIterations];
+		if (!error) {
+			if (rnorm > [self getTolerance] * bnorm) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - after %d sweeps over %d blocks from a %@ start the relative residual is still %g which is above the tolerance of %g. You might want to raise the maximum iterations.", iter, count, (warm ? @"warm" : @"cold"), rnorm/bnorm, [self getTolerance]);
+			} else {
+				NSLog(@"[SimWorkspace -_solveUsingSchwarz:into:] - %d sweeps over %d blocks %@ a coarse grid correction from a %@ start brought the relative residual to %g", iter, count, (coarse != nil ? @"with" : @"without"), (warm ? @"warm" : @"cold"), rnorm/bnorm);
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (blocks != NULL) {
+		for (int k = 0; k < count; k++) {
+			[blocks[k].lu release];
+			if (blocks[k].x != NULL) {
+				free(blocks[k].x);
+			}
+		}
+		free(blocks);
+	}
+	if (cb != NULL) {
+		for (int l = 1; l < depth; l++) {
+			if (cb[l] != NULL) {
+				free(cb[l]);
+			}
+		}
+		free(cb);
+	}
+	if (cx != NULL) {
+		for (int l = 1; l < depth; l++) {
+			if (cx[l] != NULL) {
+				free(cx[l]);
+			}
+		}
+		free(cx);
+	}
+	[coarse release];
+	if (r != NULL) {
+		free(r);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method does one sweep over the 'count' blocks of the stencil -
+ first the even ones and then the odd ones, each set all at once on all
+ the cores. The inner edges of each block are filled in from 'v', the
+ RHS of the rest from the stencil, and the solution of each block is
+ put back into 'v' for all the nodes it doesn't hold fixed.
+ */
+- (BOOL) _sweepSchwarzBlocks:(SchwarzBlock*)blocks count:(int)count of:(PoissonStencil*)stencil into:(double*)v
+{
+	__block BOOL	failed = NO;
+	double*			b = [stencil getRHS];
+	BOOL*			pfixed = [stencil getFixedMask];
+	int				cols = [stencil getColCount];
+
+	/*
+	 * The blocks of one color never touch each other's nodes - there's a
+	 * whole block of the other color between them, and it's wider than
+	 * the two overlaps - so they can all be solved at the same time.
+	 */
+	for (int color = 0; color < 2; color++) {
+		dispatch_apply((count - color + 1) / 2, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+			SchwarzBlock*	blk = &blocks[2*i + color];
+			int				brows = [blk->stencil getRowCount];
+			int				bcols = [blk->stencil getColCount];
+			BOOL*			fixed = [blk->stencil getFixedMask];
+			// the RHS of the block, with its inner edges from the solution
+			for (int r = 0; r < brows; r++) {
+				for (int c = 0; c < bcols; c++) {
+					size_t		ij = (size_t)r * bcols + c;
+					size_t		pj = (size_t)(blk->r0 + r) * cols + (blk->c0 + c);
+					blk->x[ij] = ((fixed[ij] && !pfixed[pj]) ? v[pj] : b[pj]);
+				}
+			}
+			// ...solve it, and put what it's found back in the solution
+			if (![blk->lu solve:blk->x count:1 into:blk->x]) {
+				failed = YES;
+			} else {
+				for (int r = 0; r < brows; r++) {
+					for (int c = 0; c < bcols; c++) {
+						size_t		ij = (size_t)r * bcols + c;
+						if (!fixed[ij]) {
+							v[(size_t)(blk->r0 + r) * cols + (blk->c0 + c)] = blk->x[ij];
+						}
+					}
+				}
+			}
+		});
+	}
+	if (failed) {
+		NSLog(@"[SimWorkspace -_sweepSchwarzBlocks:count:of:into:] - one or more of the %d blocks could not be solved. Please check the logs for a possible cause.", count);
+	}
+
+	return !failed;
+}
+
+@end
@@ -0,0 +1,61 @@
+//
+//  SimWorkspace_Sparse.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+#import "PoissonStencil.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the sparse direct solver methods on the SimWorkspace. The
+ band of the banded solvers is as wide as the short side of the grid,
+ so the fill - and the memory - grows as n*sqrt(n) for a square grid.
+ Assembling just the non-zeros, ordering them by nested dissection and
+ handing them to the supernodal Cholesky in Accelerate brings that down
+ to about n*log(n), and that makes the big square grids possible.
+ */
+@interface SimWorkspace (Sparse)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method folds the fixed nodes of the stencil into the RHS 'b' so
+ that the system is symmetric positive definite - just like the banded
+ Cholesky does - assembles the non-zeros in compressed column form, and
+ solves it with the sparse Cholesky factorization in Accelerate using a
+ nested dissection ordering. The size of the factor is known from the
+ symbolic factorization, and if that's more than we can afford, this
+ says so, and by how much, before the factor is ever allocated. The
+ solution is placed in the row-major vector 'x', which can be the same
+ as 'b' if the caller wishes.
+ */
+- (BOOL) _solveSparseStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x;
+
+@end
@@ -0,0 +1,287 @@
+//
+//  SimWorkspace_Sparse.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Accelerate/Accelerate.h>
+
+// System Headers
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Sparse.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * We won't start a factorization that needs more than this fraction of
+ * the physical memory of the machine - past that, it's all paging, and
+ * the user is better off with one of the iterative engines.
+ */
+#define	MAX_MEMORY_FRACTION		0.5
+
+// Public Macros
+#define	MEGABYTES(b)			((double)(b) / (1024.0 * 1024.0))
+
+
+/*!
+ @class SimWorkspace
+ These are the sparse direct solver methods on the SimWorkspace. The
+ band of the banded solvers is as wide as the short side of the grid,
+ so the fill - and the memory - grows as n*sqrt(n) for a square grid.
+ Assembling just the non-zeros, ordering them by nested dissection and
+ handing them to the supernodal Cholesky in Accelerate brings that down
+ to about n*log(n), and that makes the big square grids possible.
+ */
+@implementation SimWorkspace (Sparse)
+
+//----------------------------------------------------------------------------
+//               Solver Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method folds the fixed nodes of the stencil into the RHS 'b' so
+ that the system is symmetric positive definite - just like the banded
+ Cholesky does - assembles the non-zeros in compressed column form, and
+ solves it with the sparse Cholesky factorization in Accelerate using a
+ nested dissection ordering. The size of the factor is known from the
+ symbolic factorization, and if that's more than we can afford, this
+ says so, and by how much, before the factor is ever allocated. The
+ solution is placed in the row-major vector 'x', which can be the same
+ as 'b' if the caller wishes.
+ */
+- (BOOL) _solveSparseStencil:(PoissonStencil*)stencil withRHS:(double*)b into:(double*)x
+{
+	BOOL			error = NO;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if ((stencil == nil) || (b == NULL) || (x == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the stencil, RHS or solution vector is missing, and that means there's nothing I can do. Please make sure the arguments to this method are not nil.");
+		}
+	}
+
+	// the corners of a 9-point stencil aren't symmetric with these weights
+	if (!error && [stencil hasCorners]) {
+		return [self _solveBandedStencil:stencil withRHS:b into:x];
+	}
+
+	/*
+	 * The lower triangle of each column has at most the diagonal and the
+	 * 'right' and 'bottom' neighbors in it, so we know exactly how much
+	 * the assembly is going to need, and what we can afford, before we
+	 * allocate any of it.
+	 */
+	int				rows = [stencil getRowCount];
+	int				cols = [stencil getColCount];
+	int				n = rows * cols;
+	size_t			maxNonZeros = 3 * (size_t)n;
+	size_t			assemblySize = (n + 1) * sizeof(long) + maxNonZeros * (sizeof(int) + sizeof(double)) +
+								   (n + cols + rows) * sizeof(double);
+	double			available = MAX_MEMORY_FRACTION * [[NSProcessInfo processInfo] physicalMemory];
+	if (!error) {
+		if (assemblySize > available) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the %dx%d grid needs %.1f MB just to assemble the sparse matrix, and we only allow ourselves %.1f MB. Please use one of the iterative engines for a grid this size.", rows, cols, MEGABYTES(assemblySize), MEGABYTES(available));
+		}
+	}
+
+	// now get the compressed column storage for the lower triangle
+	long*			colStarts = NULL;
+	int*			rowIndices = NULL;
+	double*			values = NULL;
+	double*			bb = NULL;
+	double*			wx = NULL;
+	double*			wy = NULL;
+	if (!error) {
+		colStarts = (long *) calloc(n + 1, sizeof(long));
+		rowIndices = (int *) calloc(maxNonZeros, sizeof(int));
+		values = (double *) calloc(maxNonZeros, sizeof(double));
+		bb = (double *) calloc(n, sizeof(double));
+		wx = (double *) calloc(cols, sizeof(double));
+		wy = (double *) calloc(rows, sizeof(double));
+		if ((colStarts == NULL) || (rowIndices == NULL) || (values == NULL) ||
+			(bb == NULL) || (wx == NULL) || (wy == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - while trying to allocate the %.1f MB for the sparse matrix of the %dx%d grid, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", MEGABYTES(assemblySize), rows, cols);
+		} else {
+			[stencil getColWeights:wx andRowWeights:wy];
+		}
+	}
+
+	/*
+	 * Now we can assemble the matrix. The nodes are numbered row-major,
+	 * as the ordering is going to be done by the factorization anyway,
+	 * and column 'ij' holds the diagonal and the couplings to the free
+	 * 'right' and 'bottom' neighbors - the upper triangle is implied by
+	 * the symmetry, and because the matrix is symmetric, this is just as
+	 * much the compressed row form of the upper triangle.
+	 *
+	 * Exactly as in the banded Cholesky, a fixed node is an identity row
+	 * and column, its potential is moved to the RHS of its free neighbors,
+	 * and a free row is scaled by -wx*wy, the area of its cell.
+	 */
+	long			nnz = 0;
+	if (!error) {
+		StencilArrays*	a = [stencil getArrays];
+		BOOL*			fixed = a->fixed;
+		for (int row = 0; row < rows; row++) {
+			for (int col = 0; col < cols; col++) {
+				int			ij = row * cols + col;
+				colStarts[ij] = nnz;
+				// the fixed nodes are simply their own potential
+				if (fixed[ij]) {
+					rowIndices[nnz] = ij;
+					values[nnz++] = 1.0;
+					bb[ij] = b[ij];
+					continue;
+				}
+				double		w = -wx[col] * wy[row];
+				double		rhs = b[ij];
+				rowIndices[nnz] = ij;
+				values[nnz++] = w * a->center[ij];
+				// the 'right' node - it always has a larger node number
+				if (a->right[ij] != 0.0) {
+					if (fixed[ij + 1]) {
+						rhs -= a->right[ij] * b[ij + 1];
+					} else {
+						rowIndices[nnz] = ij + 1;
+						values[nnz++] = w * a->right[ij];
+					}
+				}
+				// the 'bottom' node - it always has a larger node number
+				if (a->bottom[ij] != 0.0) {
+					if (fixed[ij + cols]) {
+						rhs -= a->bottom[ij] * b[ij + cols];
+					} else {
+						rowIndices[nnz] = ij + cols;
+						values[nnz++] = w * a->bottom[ij];
+					}
+				}
+				// the 'top' and 'left' nodes are in the transpose
+				if ((a->top[ij] != 0.0) && fixed[ij - cols]) {
+					rhs -= a->top[ij] * b[ij - cols];
+				}
+				if ((a->left[ij] != 0.0) && fixed[ij - 1]) {
+					rhs -= a->left[ij] * b[ij - 1];
+				}
+				// ...and the RHS of Ax=b
+				bb[ij] = w * rhs;
+			}
+		}
+		colStarts[n] = nnz;
+	}
+
+	/*
+	 * The symbolic factorization does the nested dissection ordering and
+	 * works out the structure of the factor without any of its values,
+	 * and that tells us just how big the factor is going to be. If that's
+	 * too much, we say so now, rather than running out part way through.
+	 */
+	SparseMatrixStructure				structure;
+	SparseOpaqueSymbolicFactorization	symbolic;
+	SparseOpaqueFactorization_Double	factor;
+	BOOL								haveSymbolic = NO;
+	BOOL								haveFactor = NO;
+	NSTimeInterval						start = [NSDate timeIntervalSinceReferenceDate];
+	if (!error) {
+		structure.rowCount = n;
+		structure.columnCount = n;
+		structure.columnStarts = colStarts;
+		structure.rowIndices = rowIndices;
+		structure.attributes = (SparseAttributes_t){ .kind = SparseSymmetric, .triangle = SparseLowerTriangle };
+		structure.blockSize = 1;
+		SparseSymbolicFactorOptions		options = {
+			.control = SparseDefaultControl,
+			.orderMethod = SparseOrderMetis,
+			.order = NULL,
+			.ignoreRowsAndColumns = NULL,
+			.malloc = malloc,
+			.free = free,
+			.reportError = NULL
+		};
+		symbolic = SparseFactor(SparseFactorizationCholesky, structure, options);
+		if (symbolic.status != SparseStatusOK) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the symbolic factorization of the %dx%d grid failed with status %d. Please check into this as soon as possible.", rows, cols, (int)symbolic.status);
+		} else {
+			haveSymbolic = YES;
+			size_t		factorSize = symbolic.factorSize_Double + symbolic.workspaceSize_Double;
+			if (assemblySize + factorSize > available) {
+				error = YES;
+				NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the Cholesky factor of the %dx%d grid would need %.1f MB on top of the %.1f MB for the matrix, and we only allow ourselves %.1f MB. Please use one of the iterative engines for a grid this size.", rows, cols, MEGABYTES(factorSize), MEGABYTES(assemblySize), MEGABYTES(available));
+			} else {
+				NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the Cholesky factor of the %dx%d grid needs %.1f MB for %ld non-zeros in the matrix", rows, cols, MEGABYTES(factorSize), nnz);
+				[self _addReportValue:(double)symbolic.factorSize_Double / sizeof(double) forKey:kReportFill];
+				[self _addReportValue:(double)(assemblySize + factorSize) forKey:kReportMemory];
+				[self _setReportValue:@"nested dissection (METIS)" forKey:kReportOrdering];
+			}
+		}
+	}
+
+	// now we can do the numeric factorization and solve in place
+	if (!error) {
+		SparseMatrix_Double		A = { .structure = structure, .data = values };
+		factor = SparseFactor(symbolic, A);
+		[self _addReportValue:([NSDate timeIntervalSinceReferenceDate] - start) forKey:kReportFactorTime];
+		if (factor.status != SparseStatusOK) {
+			error = YES;
+			NSLog(@"[SimWorkspace -_solveSparseStencil:withRHS:into:] - the numeric factorization of the %dx%d grid failed with status %d, which shouldn't happen once the fixed nodes have been folded in. Please check into this.", rows, cols, (int)factor.status);
+		} else {
+			haveFactor = YES;
+			DenseVector_Double		v = { .count = n, .data = bb };
+			SparseSolve(factor, v);
+		}
+	}
+
+	// ...and copy the solution back for the caller
+	if (!error) {
+		memcpy(x, bb, n * sizeof(double));
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (haveFactor) {
+		SparseCleanup(factor);
+	}
+	if (haveSymbolic) {
+		SparseCleanup(symbolic);
+	}
+	if (colStarts != NULL) {
+		free(colStarts);
+	}
+	if (rowIndices != NULL) {
+		free(rowIndices);
+	}
+	if (values != NULL) {
+		free(values);
+	}
+	if (bb != NULL) {
+		free(bb);
+	}
+	if (wx != NULL) {
+		free(wx);
+	}
+	if (wy != NULL) {
+		free(wy);
+	}
+
+	return !error;
+}
+
+@end
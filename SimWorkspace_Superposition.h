@@ -0,0 +1,110 @@
+//
+//  SimWorkspace_Superposition.h
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Foundation/Foundation.h>
+
+// System Headers
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+/*
+ * This is the permittivity of free space, in farads per meter, that
+ * turns the flux of er E out of a conductor into its charge.
+ */
+#define	EPSILON_0					8.8541878128e-12
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the superposition methods on the SimWorkspace. The potential
+ is linear in the voltages on the conductors, so once the workspace has
+ solved for the charges alone - every conductor grounded - and for each
+ conductor at 1 V with the rest grounded and no charge, the solution
+ for any set of conductor voltages is just the weighted sum of those
+ stored solutions. That makes a sweep of the conductor voltages cost
+ one pass over the stored solutions per set of voltages, and not a
+ complete solve of the system.
+
+ The same basis gives the capacitance matrix of the conductors: the
+ charge on each conductor, from the flux of the field out through the
+ faces of its nodes, with each of the conductors in turn at 1 V.
+ */
+@interface SimWorkspace (Superposition)
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the number of conductors in the superposition
+ basis of the workspace, or 0 if -prepareSuperpositionForConductors:
+ hasn't been called since the workspace was last cleared.
+ */
+- (int) getSuperpositionConductorCount;
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method builds the superposition basis for the workspace as it
+ sits now. The 'conductors' are MaskedMatrix instances the size of the
+ workspace - one per conductor - where the nodes with a value are the
+ nodes of that conductor. Every one of those nodes has to have a fixed
+ potential on the workspace, and where conductors overlap, the later
+ one wins, just as it does when they are added to the workspace. Any
+ fixed potentials that aren't on one of the conductors stay at their
+ values in every solution. The one factorization of the operator is
+ used for all the solutions.
+ */
+- (BOOL) prepareSuperpositionForConductors:(NSArray*)conductors;
+
+/*!
+ This method takes the 'count' conductor voltages - in the same order
+ as the conductors given to -prepareSuperpositionForConductors: - and
+ forms the solution for them from the superposition basis. The result
+ is saved in the workspace just as -simulateWorkspace would, so the
+ resultant voltage and electric field are available as always.
+ */
+- (BOOL) superposeConductorVoltages:(double*)volts count:(int)count;
+
+//----------------------------------------------------------------------------
+//               Capacitance Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the capacitance matrix of the 'conductors' - the
+ same maps of the nodes of each conductor that are given to
+ -prepareSuperpositionForConductors:, which is called to build the
+ basis with the one factorization. Element (i, j) is the charge on
+ conductor i with conductor j at 1 V and the rest - and any other
+ fixed potentials - grounded, from the flux of er E through the faces
+ between the nodes of conductor i and the free nodes around it. With
+ the workspace in meters, it's in farads per meter of depth for a
+ planar workspace, and in farads for an axisymmetric one. The matrix
+ is made symmetric, as it has to be, and the returned MaskedMatrix is
+ autoreleased.
+ */
+- (MaskedMatrix*) extractCapacitanceForConductors:(NSArray*)conductors;
+
+@end
@@ -0,0 +1,450 @@
+//
+//  SimWorkspace_Superposition.m
+//  Potentials
+//
+//  Created by agent on Sat Oct 17 2026.
+//  Copyright (c) 2026 The Man from S.P.U.D.. All rights reserved.
+//
+
+// Apple Headers
+#import <Accelerate/Accelerate.h>
+
+// System Headers
+#include <math.h>
+#include <string.h>
+
+// Third Party Headers
+
+// Other Headers
+
+// Class Headers
+#import "SimWorkspace_Superposition.h"
+#import "SimWorkspace_Protected.h"
+#import "SimWorkspace_Banded.h"
+
+// Superclass Headers
+
+// Forward Class Declarations
+
+// Public Data Types
+
+// Public Constants
+
+// Public Macros
+
+
+/*!
+ @class SimWorkspace
+ These are the superposition methods on the SimWorkspace. The potential
+ is linear in the voltages on the conductors, so once the workspace has
+ solved for the charges alone - every conductor grounded - and for each
+ conductor at 1 V with the rest grounded and no charge, the solution
+ for any set of conductor voltages is just the weighted sum of those
+ stored solutions. That makes a sweep of the conductor voltages cost
+ one pass over the stored solutions per set of voltages, and not a
+ complete solve of the system.
+
+ The same basis gives the capacitance matrix of the conductors: the
+ charge on each conductor, from the flux of the field out through the
+ faces of its nodes, with each of the conductors in turn at 1 V.
+ */
+@implementation SimWorkspace (Superposition)
+
+//----------------------------------------------------------------------------
+//               Accessor Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the number of conductors in the superposition
+ basis of the workspace, or 0 if -prepareSuperpositionForConductors:
+ hasn't been called since the workspace was last cleared.
+ */
+- (int) getSuperpositionConductorCount
+{
+	return MAX([self _getSuperpositionCount] - 1, 0);
+}
+
+
+//----------------------------------------------------------------------------
+//               Simulation Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method builds the superposition basis for the workspace as it
+ sits now. The 'conductors' are MaskedMatrix instances the size of the
+ workspace - one per conductor - where the nodes with a value are the
+ nodes of that conductor. Every one of those nodes has to have a fixed
+ potential on the workspace, and where conductors overlap, the later
+ one wins, just as it does when they are added to the workspace. Any
+ fixed potentials that aren't on one of the conductors stay at their
+ values in every solution. The one factorization of the operator is
+ used for all the solutions.
+ */
+- (BOOL) prepareSuperpositionForConductors:(NSArray*)conductors
+{
+	BOOL			error = NO;
+	int				rows = [self getRowCount];
+	int				cols = [self getColCount];
+	int				count = (int)[conductors count];
+
+	// first, make sure we're set up for this
+	if (!error) {
+		if ((rows <= 1) || (cols <= 1) || ([self getEpsilonR] == nil) ||
+			([self getRho] == nil) || ([self getVoltage] == nil)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - this workspace is not yet set up properly for a simulation. You need to set reasonable simulation node counts as well as initializing this class for the simulation. Please make sure you call one of the -init methods before calling this method.");
+		} else if (count == 0) {
+			error = YES;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - there are no conductors to build the superposition basis for. Please pass in at least one conductor.");
+		}
+	}
+
+	// start the timer on the solution...
+	NSTimeInterval begin = [NSDate timeIntervalSinceReferenceDate];
+
+	// drop any existing basis as it's about to be replaced
+	[self _setSuperpositionBasis:NULL withCount:0];
+
+	// the stencil of the workspace has the operator for all the solutions
+	PoissonStencil*			stencil = nil;
+	BandedFactorization*	lu = nil;
+	if (!error) {
+		stencil = [self _createStencil];
+		if (stencil == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - the stencil for the system of equations could not be created. Please check the logs for a possible cause.");
+		} else {
+			lu = [self _getFactorizationOf:stencil];
+			if (lu == nil) {
+				error = YES;
+			}
+		}
+	}
+
+	// get the storage for the basis, and which conductor owns each node
+	size_t			n = (size_t)rows * cols;
+	double*			basis = NULL;
+	int*			owner = NULL;
+	if (!error) {
+		basis = (double *) calloc(n * (count + 1), sizeof(double));
+		owner = (int *) malloc(n * sizeof(int));
+		if ((basis == NULL) || (owner == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - while trying to allocate the %d solutions (%lux1) for the superposition basis, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", (count + 1), (unsigned long)n);
+		} else {
+			for (size_t i = 0; i < n; i++) {
+				owner[i] = -1;
+			}
+		}
+	}
+
+	// map out the nodes of each of the conductors
+	if (!error) {
+		BOOL*		fixed = [stencil getFixedMask];
+		for (int k = 0; !error && (k < count); k++) {
+			MaskedMatrix*	map = [conductors objectAtIndex:k];
+			if (([map getRowCount] != rows) || ([map getColCount] != cols)) {
+				error = YES;
+				NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - the map of conductor %d is not the same size as the %dx%d workspace. Please check the arguments.", k, rows, cols);
+				break;
+			}
+			for (int row = 0; !error && (row < rows); row++) {
+				for (int col = 0; col < cols; col++) {
+					if ([map haveValueAtRow:row andCol:col]) {
+						size_t		ij = (size_t)row * cols + col;
+						if (!fixed[ij]) {
+							error = YES;
+							NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - conductor %d covers the node (row=%d, col=%d) but that node doesn't have a fixed potential on the workspace. Please make sure the conductors have been added to the workspace.", k, row, col);
+							break;
+						}
+						owner[ij] = k;
+					}
+				}
+			}
+		}
+	}
+
+	/*
+	 * The first RHS is the workspace with all the conductors grounded, and
+	 * the rest are each conductor at 1 V with everything else grounded and
+	 * no charge at all - which leaves just the 1.0 on that conductor.
+	 */
+	if (!error) {
+		memcpy(basis, [stencil getRHS], n * sizeof(double));
+		for (size_t i = 0; i < n; i++) {
+			if (owner[i] >= 0) {
+				basis[i] = 0.0;
+				basis[(owner[i] + 1) * n + i] = 1.0;
+			}
+		}
+	}
+
+	// now solve them all at once with the one factorization
+	if (!error) {
+		if (![lu solve:basis count:(count + 1) into:basis]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - the %d solutions for the superposition basis could not be found. Please check the logs for a possible cause.", (count + 1));
+		} else {
+			[self _setSuperpositionBasis:basis withCount:(count + 1)];
+			basis = NULL;
+			NSLog(@"[SimWorkspace -prepareSuperpositionForConductors:] - the superposition basis for %d conductors took %.3f msec", count, ([NSDate timeIntervalSinceReferenceDate] - begin) * 1000);
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (basis != NULL) {
+		free(basis);
+	}
+	if (owner != NULL) {
+		free(owner);
+	}
+
+	return !error;
+}
+
+
+/*!
+ This method takes the 'count' conductor voltages - in the same order
+ as the conductors given to -prepareSuperpositionForConductors: - and
+ forms the solution for them from the superposition basis. The result
+ is saved in the workspace just as -simulateWorkspace would, so the
+ resultant voltage and electric field are available as always.
+ */
+- (BOOL) superposeConductorVoltages:(double*)volts count:(int)count
+{
+	BOOL			error = NO;
+	double*			basis = [self _getSuperpositionBasis];
+	int				n = [self getRowCount] * [self getColCount];
+	double*			v = NULL;
+
+	// first, make sure we have something to do
+	if (!error) {
+		if (basis == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -superposeConductorVoltages:count:] - there is no superposition basis for this workspace. Please call -prepareSuperpositionForConductors: before calling this method.");
+		} else if ((volts == NULL) || (count != [self getSuperpositionConductorCount])) {
+			error = YES;
+			NSLog(@"[SimWorkspace -superposeConductorVoltages:count:] - the basis has %d conductors, but %d voltages were given. Please pass in one voltage for each conductor.", [self getSuperpositionConductorCount], (volts == NULL ? 0 : count));
+		}
+	}
+
+	// get the storage for the solution - in row-major order
+	if (!error) {
+		v = (double *) malloc(n * sizeof(double));
+		if (v == NULL) {
+			error = YES;
+			NSLog(@"[SimWorkspace -superposeConductorVoltages:count:] - while trying to allocate the solution vector (%dx1), we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", n);
+		}
+	}
+
+	// v = charges alone + sum of each conductor's voltage times its solution
+	if (!error) {
+		cblas_dcopy(n, basis, 1, v, 1);
+		cblas_dgemv(CblasColMajor, CblasNoTrans, n, count, 1.0, basis + n, n, volts, 1, 1.0, v, 1);
+	}
+
+	// ...and save it just like any other solution
+	if (!error) {
+		if (![self _saveResultantVoltages:v]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -superposeConductorVoltages:count:] - the superposed solution could not be saved in the workspace. Please check the logs for a possible cause.");
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (v != NULL) {
+		free(v);
+	}
+
+	return !error;
+}
+
+
+//----------------------------------------------------------------------------
+//               Capacitance Methods
+//----------------------------------------------------------------------------
+
+/*!
+ This method returns the capacitance matrix of the 'conductors' - the
+ same maps of the nodes of each conductor that are given to
+ -prepareSuperpositionForConductors:, which is called to build the
+ basis with the one factorization. Element (i, j) is the charge on
+ conductor i with conductor j at 1 V and the rest - and any other
+ fixed potentials - grounded, from the flux of er E through the faces
+ between the nodes of conductor i and the free nodes around it. With
+ the workspace in meters, it's in farads per meter of depth for a
+ planar workspace, and in farads for an axisymmetric one. The matrix
+ is made symmetric, as it has to be, and the returned MaskedMatrix is
+ autoreleased.
+ */
+- (MaskedMatrix*) extractCapacitanceForConductors:(NSArray*)conductors
+{
+	BOOL			error = NO;
+	int				rows = [self getRowCount];
+	int				cols = [self getColCount];
+	int				count = (int)[conductors count];
+	size_t			n = (size_t)rows * cols;
+	PoissonStencil*	stencil = nil;
+	int*			owner = NULL;
+	double*			wx = NULL;
+	double*			wy = NULL;
+	double*			cap = NULL;
+	MaskedMatrix*	retval = nil;
+
+	// first, solve for each conductor at 1 V - all with the one factorization
+	if (!error) {
+		if (![self prepareSuperpositionForConductors:conductors]) {
+			error = YES;
+			NSLog(@"[SimWorkspace -extractCapacitanceForConductors:] - the solutions for the %d conductors could not be found. Please check the logs for a possible cause.", count);
+		}
+	}
+
+	// the stencil has the spacing and dielectric of the faces
+	if (!error) {
+		stencil = [self _createStencil];
+		if (stencil == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -extractCapacitanceForConductors:] - the stencil for the system of equations could not be created. Please check the logs for a possible cause.");
+		}
+	}
+
+	// get the storage for the owners of the nodes, the cells and the matrix
+	if (!error) {
+		owner = (int *) malloc(n * sizeof(int));
+		wx = (double *) malloc(cols * sizeof(double));
+		wy = (double *) malloc(rows * sizeof(double));
+		cap = (double *) calloc((size_t)count * count, sizeof(double));
+		if ((owner == NULL) || (wx == NULL) || (wy == NULL) || (cap == NULL)) {
+			error = YES;
+			NSLog(@"[SimWorkspace -extractCapacitanceForConductors:] - while trying to allocate the storage for the %dx%d capacitance matrix, we ran into an allocation problem and couldn't get it. Please check into this as soon as possible.", count, count);
+		} else {
+			for (size_t i = 0; i < n; i++) {
+				owner[i] = -1;
+			}
+			// ...the later conductor wins, just as it does on the workspace
+			for (int k = 0; k < count; k++) {
+				MaskedMatrix*	map = [conductors objectAtIndex:k];
+				for (int r = 0; r < rows; r++) {
+					for (int c = 0; c < cols; c++) {
+						if ([map haveValueAtRow:r andCol:c]) {
+							owner[(size_t)r * cols + c] = k;
+						}
+					}
+				}
+			}
+			[stencil getColWeights:wx andRowWeights:wy];
+		}
+	}
+
+	/*
+	 * The charge on a conductor is the flux of er E out through the faces
+	 * between its nodes and the free nodes around it. Each face is as
+	 * long as the other axis of the free node's cell - and on an
+	 * axisymmetric grid, the radial faces are rings at the radius of the
+	 * face and the axial ones are the ring of the cell - which is just
+	 * what the stencil was built from, so it's the charge of the
+	 * discrete solution, node for node.
+	 */
+	if (!error) {
+		double*		basis = [self _getSuperpositionBasis];
+		BOOL*		fixed = [stencil getFixedMask];
+		double*		er = [stencil getDielectric];
+		double*		hx = [stencil getColSpacing];
+		double*		hy = [stencil getRowSpacing];
+		BOOL		radial = [stencil isAxisymmetric];
+		double		scale = (radial ? 2.0 * M_PI : 1.0) * EPSILON_0;
+		for (int r = 0; r < rows; r++) {
+			double		x = [stencil getInnerRadius];
+			for (int c = 0; c < cols; c++) {
+				size_t		ij = (size_t)r * cols + c;
+				int			i = owner[ij];
+				double		xc = x;
+				x += hx[c];
+				if (i < 0) {
+					continue;
+				}
+				// the four neighbors, the length of each face, and its width
+				int			nr[4] = { r, r, r - 1, r + 1 };
+				int			nc[4] = { c - 1, c + 1, c, c };
+				for (int f = 0; f < 4; f++) {
+					if ((nr[f] < 0) || (nr[f] >= rows) || (nc[f] < 0) || (nc[f] >= cols)) {
+						continue;
+					}
+					size_t		kl = (size_t)nr[f] * cols + nc[f];
+					if (fixed[kl]) {
+						continue;
+					}
+					double		g = 0.0;
+					if (f < 2) {
+						double		h = hx[MIN(c, nc[f])];
+						g = wy[nr[f]] / h;
+						if (radial) {
+							g *= xc + (f == 0 ? -0.5 : 0.5) * h;
+						}
+					} else {
+						g = wx[nc[f]] / hy[MIN(r, nr[f])];
+					}
+					g *= scale * er[kl];
+					// ...the flux out of this node for each conductor at 1 V
+					for (int j = 0; j < count; j++) {
+						double*		v = basis + (size_t)(j + 1) * n;
+						cap[(size_t)i * count + j] += g * (v[ij] - v[kl]);
+					}
+				}
+			}
+		}
+	}
+
+	/*
+	 * The matrix has to be symmetric, so the difference between the two
+	 * sides of it is how well the charges were integrated - and it's
+	 * the average of the two that's returned.
+	 */
+	if (!error) {
+		double		skew = 0.0;
+		double		diag = 0.0;
+		for (int i = 0; i < count; i++) {
+			diag = MAX(diag, fabs(cap[(size_t)i * count + i]));
+			for (int j = 0; j < i; j++) {
+				double		a = cap[(size_t)i * count + j];
+				double		b = cap[(size_t)j * count + i];
+				skew = MAX(skew, fabs(a - b));
+				cap[(size_t)i * count + j] = cap[(size_t)j * count + i] = 0.5 * (a + b);
+			}
+		}
+		NSLog(@"[SimWorkspace -extractCapacitanceForConductors:] - the %dx%d capacitance matrix is symmetric to within %g of its largest diagonal", count, count, (diag > 0.0 ? skew / diag : 0.0));
+	}
+
+	// ...and put it in a matrix for the caller
+	if (!error) {
+		retval = [[[MaskedMatrix alloc] initWithRows:count andCols:count] autorelease];
+		if (retval == nil) {
+			error = YES;
+			NSLog(@"[SimWorkspace -extractCapacitanceForConductors:] - the %dx%d capacitance matrix could not be created and this is a serious storage problem. Check into this.", count, count);
+		} else {
+			for (int i = 0; i < count; i++) {
+				for (int j = 0; j < count; j++) {
+					[retval setValue:cap[(size_t)i * count + j] atRow:i andCol:j];
+				}
+			}
+		}
+	}
+
+	// in the end, we can release what it is that we don't need
+	if (owner != NULL) {
+		free(owner);
+	}
+	if (wx != NULL) {
+		free(wx);
+	}
+	if (wy != NULL) {
+		free(wy);
+	}
+	if (cap != NULL) {
+		free(cap);
+	}
+
+	return error ? nil : retval;
+}
+
+@end